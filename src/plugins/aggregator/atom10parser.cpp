@@ -30,6 +30,7 @@
 #include <QDomDocument>
 #include <QDomElement>
 #include <QString>
+#include <QXmlStreamReader>
 #include <QtDebug>
 #include "atom10parser.h"
 
@@ -57,6 +58,16 @@ namespace Aggregator
 		return true;
 	}
 	
+	bool Atom10Parser::CouldParseStream (const QXmlStreamReader& reader) const
+	{
+		if (reader.name () != "feed")
+			return false;
+		const auto& attrs = reader.attributes ();
+		if (attrs.hasAttribute ("version") && attrs.value ("version") != "1.0")
+			return false;
+		return true;
+	}
+	
 	channels_container_t Atom10Parser::Parse (const QDomDocument& doc,
 			const IDType_t& feedId) const
 	{
@@ -65,6 +76,43 @@ namespace Aggregator
 		channels.push_back (chan);
 	
 		QDomElement root = doc.documentElement ();
+		FillChannel (root, chan);
+	
+		QDomElement entry = root.firstChildElement ("entry");
+		while (!entry.isNull ())
+		{
+			chan->Items_.push_back (Item_ptr (ParseItem (entry, chan->ChannelID_)));
+			entry = entry.nextSiblingElement ("entry");
+		}
+	
+		return channels;
+	}
+	
+	channels_container_t Atom10Parser::ParseStream (QXmlStreamReader& reader,
+			const IDType_t& feedId) const
+	{
+		Channel_ptr chan (new Channel (feedId));
+	
+		QDomDocument doc;
+		auto root = StartElement (reader, doc);
+		while (reader.readNextStartElement ())
+		{
+			if (reader.name () == "entry")
+			{
+				QDomDocument entryDoc;
+				const auto& entry = ReadElement (reader, entryDoc);
+				chan->Items_.push_back (Item_ptr (ParseItem (entry, chan->ChannelID_)));
+			}
+			else
+				root.appendChild (ReadElement (reader, doc));
+		}
+	
+		FillChannel (root, chan);
+		return { chan };
+	}
+	
+	void Atom10Parser::FillChannel (const QDomElement& root, const Channel_ptr& chan) const
+	{
 		chan->Title_ = root.firstChildElement ("title").text ().trimmed ();
 		if (chan->Title_.isEmpty ())
 			chan->Title_ = QObject::tr ("(No title)");
@@ -81,15 +129,6 @@ namespace Aggregator
 				")";
 		}
 		chan->Language_ = "<>";
-	
-		QDomElement entry = root.firstChildElement ("entry");
-		while (!entry.isNull ())
-		{
-			chan->Items_.push_back (Item_ptr (ParseItem (entry, chan->ChannelID_)));
-			entry = entry.nextSiblingElement ("entry");
-		}
-	
-		return channels;
 	}
 	
 	Item* Atom10Parser::ParseItem (const QDomElement& entry,
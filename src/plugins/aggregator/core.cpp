@@ -36,9 +36,12 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QTimer>
+#include <QThread>
 #include <QTextCodec>
 #include <QXmlStreamWriter>
 #include <QNetworkReply>
+#include <QXmlStreamReader>
+#include <QtConcurrentRun>
 #include <interfaces/iwebbrowser.h>
 #include <interfaces/core/icoreproxy.h>
 #include <interfaces/core/itagsmanager.h>
@@ -52,6 +55,7 @@
 #include <util/shortcuts/shortcutmanager.h>
 #include <util/sll/prelude.h>
 #include <util/sll/qtutil.h>
+#include <util/threads/futures.h>
 #include "core.h"
 #include "xmlsettingsmanager.h"
 #include "parserfactory.h"
@@ -91,6 +95,8 @@ namespace Aggregator
 		qRegisterMetaType<Channel_ptr> ("Channel_ptr");
 		qRegisterMetaType<channels_container_t> ("channels_container_t");
 		qRegisterMetaTypeStreamOperators<Feed> ("LeechCraft::Plugins::Aggregator::Feed");
+
+		ParsePool_.setMaxThreadCount (std::max (1, QThread::idealThreadCount () / 2));
 	}
 
 	Core& Core::Instance ()
@@ -101,6 +107,9 @@ namespace Aggregator
 
 	void Core::Release ()
 	{
+		ParsePool_.clear ();
+		ParsePool_.waitForDone ();
+
 		DBUpThread_.reset ();
 
 		delete JobHolderRepresentation_;
@@ -375,7 +384,6 @@ namespace Aggregator
 
 	bool Core::ReinitStorage ()
 	{
-		Pools_.clear ();
 		ChannelsModel_->Clear ();
 
 		StorageBackend_.reset (new DumbStorage);
@@ -444,11 +452,7 @@ namespace Aggregator
 		}
 
 		for (int type = 0; type < PTMAX; ++type)
-		{
-			Util::IDPool<IDType_t> pool;
-			pool.SetID (StorageBackend_->GetHighestID (static_cast<PoolType> (type)) + 1);
-			Pools_ [static_cast<PoolType> (type)] = pool;
-		}
+			Pools_ [type].SetID (StorageBackend_->GetHighestID (static_cast<PoolType> (type)) + 1);
 
 		return true;
 	}
@@ -1061,93 +1065,140 @@ namespace Aggregator
 		browser->Open (url);
 	}
 
-	void Core::handleJobFinished (int id)
+	Core::FeedParseResult Core::ParseFeedFile (const PendingJob& pj, qint64 maxSize)
 	{
-		if (!PendingJobs_.contains (id))
-		{
-			if (PendingOPMLs_.contains (id))
-			{
-				StartAddingOPML (PendingOPMLs_ [id].Filename_);
-				PendingOPMLs_.remove (id);
-			}
-			return;
-		}
-		PendingJob pj = PendingJobs_ [id];
-		PendingJobs_.remove (id);
-		ID2Downloader_.remove (id);
-
 		Util::FileRemoveGuard file (pj.Filename_);
 		if (!file.open (QIODevice::ReadOnly))
 		{
 			qWarning () << Q_FUNC_INFO << "could not open file for pj " << pj.Filename_;
-			return;
+			return FeedParseResult::Error ({});
 		}
 		if (!file.size ())
+			return FeedParseResult::Error (tr ("Downloaded file from url %1 has null size.")
+					.arg (pj.URL_));
+		if (file.size () > maxSize)
+			return FeedParseResult::Error (tr ("Downloaded file from url %1 is too big: "
+						"%2 bytes, while at most %3 bytes are allowed.")
+					.arg (pj.URL_)
+					.arg (file.size ())
+					.arg (maxSize));
+
+		QXmlStreamReader reader (&file);
+		if (reader.readNextStartElement ())
+			if (const auto parser = ParserFactory::Instance ().Return (reader))
+			{
+				auto channels = parser->ParseFeedStream (reader, IDNotFound);
+				if (!reader.hasError ())
+					return { channels, {} };
+
+				qWarning () << Q_FUNC_INFO
+						<< "stream parsing failed for"
+						<< pj.URL_
+						<< reader.errorString ()
+						<< "; falling back to DOM";
+			}
+
+		file.seek (0);
+
+		QDomDocument doc;
+		QString errorMsg;
+		int errorLine, errorColumn;
+		if (!doc.setContent (&file, true, &errorMsg, &errorLine, &errorColumn))
 		{
-			if (pj.Role_ != PendingJob::RFeedExternalData)
-				ErrorNotification (tr ("Feed error"),
-						tr ("Downloaded file from url %1 has null size.").arg (pj.URL_));
-			return;
+			file.copy (QDir::tempPath () + "/failedFile.xml");
+			return FeedParseResult::Error (tr ("XML file parse error: %1, line %2, column %3, filename %4, from %5")
+					.arg (errorMsg)
+					.arg (errorLine)
+					.arg (errorColumn)
+					.arg (pj.Filename_)
+					.arg (pj.URL_));
 		}
 
-		channels_container_t channels;
-		if (pj.Role_ != PendingJob::RFeedExternalData)
+		const auto parser = ParserFactory::Instance ().Return (doc);
+		if (!parser)
 		{
-			QByteArray data = file.readAll ();
-			QDomDocument doc;
-			QString errorMsg;
-			int errorLine, errorColumn;
-			if (!doc.setContent (data, true, &errorMsg, &errorLine, &errorColumn))
-			{
-				file.copy (QDir::tempPath () + "/failedFile.xml");
-				ErrorNotification (tr ("Feed error"),
-						tr ("XML file parse error: %1, line %2, column %3, filename %4, from %5")
-						.arg (errorMsg)
-						.arg (errorLine)
-						.arg (errorColumn)
-						.arg (pj.Filename_)
-						.arg (pj.URL_));
-				return;
-			}
+			file.copy (QDir::tempPath () + "/failedFile.xml");
+			return FeedParseResult::Error (tr ("Could not find parser to parse file %1 from %2")
+					.arg (pj.Filename_)
+					.arg (pj.URL_));
+		}
 
-			Parser *parser = ParserFactory::Instance ().Return (doc);
-			if (!parser)
-			{
-				file.copy (QDir::tempPath () + "/failedFile.xml");
-				ErrorNotification (tr ("Feed error"),
-						tr ("Could not find parser to parse file %1 from %2")
-						.arg (pj.Filename_)
-						.arg (pj.URL_));
-				return;
-			}
+		return { parser->ParseFeed (doc, IDNotFound), {} };
+	}
 
-			IDType_t feedId = IDNotFound;
-			if (pj.Role_ == PendingJob::RFeedAdded)
+	void Core::handleJobFinished (int id)
+	{
+		if (!PendingJobs_.contains (id))
+		{
+			if (PendingOPMLs_.contains (id))
 			{
-				const auto& feed = std::make_shared<Feed> ();
-				feed->URL_ = pj.URL_;
-				StorageBackend_->AddFeed (feed);
-				feedId = feed->FeedID_;
+				StartAddingOPML (PendingOPMLs_ [id].Filename_);
+				PendingOPMLs_.remove (id);
 			}
-			else
-				feedId = StorageBackend_->FindFeed (pj.URL_);
+			return;
+		}
+		PendingJob pj = PendingJobs_ [id];
+		PendingJobs_.remove (id);
+		ID2Downloader_.remove (id);
 
-			if (feedId == IDNotFound)
+		if (pj.Role_ == PendingJob::RFeedExternalData)
+		{
+			Util::FileRemoveGuard file (pj.Filename_);
+			if (!file.open (QIODevice::ReadOnly))
 			{
-				ErrorNotification (tr ("Feed error"),
-						tr ("Feed with url %1 not found.").arg (pj.URL_));
+				qWarning () << Q_FUNC_INFO << "could not open file for pj " << pj.Filename_;
 				return;
 			}
-
-			channels = parser->ParseFeed (doc, feedId);
+			if (file.size ())
+				HandleExternalData (pj.URL_, file);
+			return;
 		}
 
-		if (pj.Role_ == PendingJob::RFeedAdded)
-			HandleFeedAdded (channels, pj);
-		else if (pj.Role_ == PendingJob::RFeedUpdated)
-			HandleFeedUpdated (channels, pj);
-		else if (pj.Role_ == PendingJob::RFeedExternalData)
-			HandleExternalData (pj.URL_, file);
+		const auto maxSize = XmlSettingsManager::Instance ()->
+				property ("MaxFeedSize").toLongLong () * 1024 * 1024;
+		Util::Sequence (this,
+				QtConcurrent::run (&ParsePool_,
+						[pj, maxSize] { return ParseFeedFile (pj, maxSize); })) >>
+				[this, pj] (const FeedParseResult& result)
+				{
+					if (!StorageBackend_)
+						return;
+
+					if (result.Error_)
+					{
+						if (!result.Error_->isEmpty ())
+							ErrorNotification (tr ("Feed error"), *result.Error_);
+						return;
+					}
+
+					const auto& channels = result.Channels_;
+
+					IDType_t feedId = IDNotFound;
+					if (pj.Role_ == PendingJob::RFeedAdded)
+					{
+						const auto& feed = std::make_shared<Feed> ();
+						feed->URL_ = pj.URL_;
+						StorageBackend_->AddFeed (feed);
+						feedId = feed->FeedID_;
+					}
+					else
+						feedId = StorageBackend_->FindFeed (pj.URL_);
+
+					if (feedId == IDNotFound)
+					{
+						ErrorNotification (tr ("Feed error"),
+								tr ("Feed with url %1 not found.").arg (pj.URL_));
+						return;
+					}
+
+					for (const auto& channel : channels)
+						channel->FeedID_ = feedId;
+
+					if (pj.Role_ == PendingJob::RFeedAdded)
+						HandleFeedAdded (channels, pj);
+					else if (pj.Role_ == PendingJob::RFeedUpdated)
+						HandleFeedUpdated (channels, pj);
+				};
 	}
 
 	void Core::handleJobRemoved (int id)
@@ -29,13 +29,16 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
+#include <boost/optional.hpp>
 #include <QAbstractItemModel>
 #include <QString>
 #include <QMap>
 #include <QPair>
 #include <QList>
 #include <QDateTime>
+#include <QThreadPool>
 #include <interfaces/idownload.h>
 #include <interfaces/core/icoreproxy.h>
 #include <interfaces/core/ihookproxy.h>
@@ -133,9 +136,15 @@ namespace Aggregator
 
 		Util::ShortcutManager *ShortcutMgr_ = nullptr;
 
+		QThreadPool ParsePool_;
+
 		Core ();
 	private:
-		QHash<PoolType, Util::IDPool<IDType_t>> Pools_;
+		/** Channels and items get their IDs in the parsing threads, so
+		 * this is a fixed array that is never modified after
+		 * construction, and the pools' counters themselves are atomic.
+		 */
+		std::array<Util::IDPool<IDType_t>, PTMAX> Pools_;
 	public:
 		struct ChannelInfo
 		{
@@ -251,6 +260,27 @@ namespace Aggregator
 		void FetchPixmap (const Channel_ptr&);
 		void FetchFavicon (const Channel_ptr&);
 		void HandleExternalData (const QString&, const QFile&);
+		struct FeedParseResult
+		{
+			channels_container_t Channels_;
+
+			/** Set if parsing failed. An empty message means the
+			 * error has already been logged and shouldn't be
+			 * reported to the user.
+			 */
+			boost::optional<QString> Error_;
+
+			static FeedParseResult Error (const QString& msg)
+			{
+				return { {}, msg };
+			}
+		};
+
+		/** Parses the downloaded feed file. Runs in the ParsePool_
+		 * worker threads, so only thread-safe parts of Core may be
+		 * touched here.
+		 */
+		static FeedParseResult ParseFeedFile (const PendingJob&, qint64);
 		void HandleFeedAdded (const channels_container_t&,
 				const PendingJob&);
 		void HandleFeedUpdated (const channels_container_t&,
@@ -30,11 +30,12 @@
 #include "dbupdatethreadworker.h"
 #include <stdexcept>
 #include <boost/optional.hpp>
+#include <QHash>
 #include <QUrl>
 #include <QtDebug>
 #include <util/xpc/util.h>
 #include <util/xpc/defaulthookproxy.h>
-#include <util/sll/lazy.h>
+#include <util/sll/prelude.h>
 #include <interfaces/core/ientitymanager.h>
 #include "xmlsettingsmanager.h"
 #include "storagebackend.h"
@@ -67,6 +68,7 @@ namespace Aggregator
 		}
 
 		SB_->Prepare ();
+		SB_->StartTextIndexBackfill ();
 	}
 
 	void DBUpdateThreadWorker::WithWorker (const std::function<void (DBUpdateThreadWorker*)>& func)
@@ -131,7 +133,7 @@ namespace Aggregator
 		Proxy_->GetEntityManager ()->HandleEntity (Util::MakeNotification ("Aggregator", str, PInfo_));
 	}
 
-	bool DBUpdateThreadWorker::AddItem (const Item_ptr& item, const Channel_ptr& channel,
+	bool DBUpdateThreadWorker::PrepareNewItem (const Item_ptr& item, const Channel_ptr& channel,
 			const Feed::FeedSettings& settings)
 	{
 		if (item->PubDate_.isValid ())
@@ -143,12 +145,23 @@ namespace Aggregator
 			item->FixDate ();
 
 		item->ChannelID_ = channel->ChannelID_;
-		SB_->AddItem (item);
+		return true;
+	}
 
-		emit hookGotNewItems (std::make_shared<Util::DefaultHookProxy> (), { item });
+	void DBUpdateThreadWorker::HandleNewItems (const items_container_t& items, const Channel_ptr& channel,
+			const Feed::FeedSettings& settings)
+	{
+		if (items.empty ())
+			return;
+
+		emit hookGotNewItems (std::make_shared<Util::DefaultHookProxy> (),
+				Util::Map (items, [] (const Item_ptr& item) { return Item_cptr { item }; }));
+
+		if (!settings.AutoDownloadEnclosures_)
+			return;
 
 		const auto iem = Proxy_->GetEntityManager ();
-		if (settings.AutoDownloadEnclosures_)
+		for (const auto& item : items)
 			for (const auto& e : item->Enclosures_)
 			{
 				auto de = Util::MakeEntity (QUrl (e.URL_),
@@ -159,11 +172,9 @@ namespace Aggregator
 				de.Additional_ [" Tags"] = channel->Tags_;
 				iem->HandleEntity (de);
 			}
-
-		return true;
 	}
 
-	bool DBUpdateThreadWorker::UpdateItem (const Item_ptr& item, const Item_ptr& ourItem)
+	bool DBUpdateThreadWorker::MergeItem (const Item_ptr& item, const Item_ptr& ourItem)
 	{
 		if (!IsModified (ourItem, item))
 			return false;
@@ -192,8 +203,6 @@ namespace Aggregator
 				ourItem->MRSSEntries_ << entry;
 			}
 
-		SB_->UpdateItem (ourItem);
-
 		return true;
 	}
 
@@ -259,36 +268,44 @@ namespace Aggregator
 				continue;
 			}
 
-			int newItems = 0;
-			int updatedItems = 0;
+			auto index = SB_->GetItemsIndex (ourChannel->ChannelID_);
+
+			items_container_t newItems;
+			items_container_t updatedItems;
+
+			// Items of this batch by their IDs, so that duplicates in
+			// the feed are merged into the already classified ones.
+			QHash<IDType_t, Item_ptr> batchItems;
 
 			for (const auto& item : channel->Items_)
 			{
-				auto mkLazy = [] (auto&& f) { return Util::MakeLazyF<boost::optional<IDType_t>> (f); };
-				const auto& ourItemID = Util::Msum ({
-							mkLazy ([&] { return SB_->FindItem (item->Title_, item->Link_, ourChannel->ChannelID_); }),
-							mkLazy ([&] { return SB_->FindItemByLink (item->Link_, ourChannel->ChannelID_); }),
-							mkLazy ([&]
-									{
-										if (!item->Link_.isEmpty ())
-											return boost::optional<IDType_t> {};
-
-										return SB_->FindItemByTitle (item->Title_, ourChannel->ChannelID_);
-									})
-						}) ();
-				if (ourItemID)
+				const auto& ourItemID = index.Find (item->Title_, item->Link_);
+				if (!ourItemID)
 				{
-					const auto& ourItem = SB_->GetItem (*ourItemID);
-					if (UpdateItem (item, ourItem))
-						++updatedItems;
+					if (!PrepareNewItem (item, ourChannel, feedSettings))
+						continue;
+
+					newItems.push_back (item);
+					batchItems [item->ItemID_] = item;
+					index.Add (item->ItemID_, item->Title_, item->Link_);
+					continue;
 				}
-				else if (AddItem (item, ourChannel, feedSettings))
-					++newItems;
+
+				const auto& batchItem = batchItems.value (*ourItemID);
+				const auto& ourItem = batchItem ? batchItem : SB_->GetItem (*ourItemID);
+				if (!MergeItem (item, ourItem) || batchItem)
+					continue;
+
+				updatedItems.push_back (ourItem);
+				batchItems [*ourItemID] = ourItem;
 			}
 
+			SB_->StoreItems (ourChannel->ChannelID_, newItems, updatedItems);
+			HandleNewItems (newItems, ourChannel, feedSettings);
+
 			SB_->TrimChannel (ourChannel->ChannelID_, days, ipc);
 
-			NotifyUpdates (newItems, updatedItems, channel);
+			NotifyUpdates (newItems.size (), updatedItems.size (), channel);
 		}
 	}
 }
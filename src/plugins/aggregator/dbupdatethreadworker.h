@@ -58,9 +58,11 @@ namespace Aggregator
 	private:
 		Feed::FeedSettings GetFeedSettings (IDType_t);
 		void AddChannel (const Channel_ptr& channel, const Feed::FeedSettings& settings);
-		bool AddItem (const Item_ptr& item, const Channel_ptr& channel,
+		bool PrepareNewItem (const Item_ptr& item, const Channel_ptr& channel,
 				const Feed::FeedSettings& settings);
-		bool UpdateItem (const Item_ptr& item, const Item_ptr& ourItem);
+		void HandleNewItems (const items_container_t& items, const Channel_ptr& channel,
+				const Feed::FeedSettings& settings);
+		bool MergeItem (const Item_ptr& item, const Item_ptr& ourItem);
 		void NotifyUpdates (int newItems, int updatedItems, const Channel_ptr& channel);
 	public slots:
 		void toggleChannelUnread (IDType_t channel, bool state);
@@ -144,6 +144,17 @@ namespace Aggregator
 		endResetModel ();
 	}
 
+	void ItemsListModel::Reset (const items_shorts_t& items)
+	{
+		beginResetModel ();
+
+		CurrentChannel_ = -1;
+		CurrentRow_ = -1;
+		CurrentItems_ = items;
+
+		endResetModel ();
+	}
+
 	void ItemsListModel::RemoveItems (const QSet<IDType_t>& ids)
 	{
 		if (ids.isEmpty ())
@@ -1498,15 +1498,21 @@ namespace Aggregator
 	void ItemsWidget::updateItemsFilter ()
 	{
 		const int section = Impl_->Ui_.SearchType_->currentIndex ();
+		const QString& text = Impl_->Ui_.SearchLine_->text ();
 		if (section == 4)
 		{
 			const auto& sb = Core::Instance ().MakeStorageBackendForThread ();
 			Impl_->CurrentItemsModel_->Reset (sb->GetItemsForTag ("_important"));
 		}
+		else if (section == 5 && !text.trimmed ().isEmpty ())
+		{
+			const int maxResults = 500;
+			const auto& sb = Core::Instance ().MakeStorageBackendForThread ();
+			Impl_->CurrentItemsModel_->Reset (sb->SearchItems (text, 0, maxResults));
+		}
 		else
 			CurrentChannelChanged (Impl_->LastSelectedChannel_);
 
-		const QString& text = Impl_->Ui_.SearchLine_->text ();
 		switch (section)
 		{
 		case 1:
@@ -1515,6 +1521,10 @@ namespace Aggregator
 		case 2:
 			Impl_->ItemsFilterModel_->setFilterRegExp (text);
 			break;
+		case 5:
+			// The storage has already matched the items.
+			Impl_->ItemsFilterModel_->setFilterFixedString ({});
+			break;
 		default:
 			Impl_->ItemsFilterModel_->setFilterFixedString (text);
 			break;
@@ -31,6 +31,7 @@
 #include <boost/optional.hpp>
 #include <QDomElement>
 #include <QStringList>
+#include <QXmlStreamReader>
 #include <QObject>
 #include <QtDebug>
 
@@ -66,22 +67,92 @@ namespace Aggregator
 	{
 	}
 
+	namespace
+	{
+		channels_container_t FixupChannels (channels_container_t newes)
+		{
+			for (const auto& newChannel : newes)
+			{
+				if (newChannel->Link_.isEmpty ())
+				{
+					qWarning () << Q_FUNC_INFO
+						<< "detected empty link for"
+						<< newChannel->Title_;
+					newChannel->Link_ = "about:blank";
+				}
+				for (const auto& item : newChannel->Items_)
+					item->Title_ = item->Title_.trimmed ().simplified ();
+			}
+			return newes;
+		}
+	}
+
 	channels_container_t Parser::ParseFeed (const QDomDocument& recent, const IDType_t& feedId) const
 	{
-		channels_container_t newes = Parse (recent, feedId);
-		for (const auto& newChannel : newes)
+		return FixupChannels (Parse (recent, feedId));
+	}
+
+	bool Parser::CouldParseStream (const QXmlStreamReader&) const
+	{
+		return false;
+	}
+
+	channels_container_t Parser::ParseFeedStream (QXmlStreamReader& reader, const IDType_t& feedId) const
+	{
+		return FixupChannels (ParseStream (reader, feedId));
+	}
+
+	channels_container_t Parser::ParseStream (QXmlStreamReader&, const IDType_t&) const
+	{
+		return {};
+	}
+
+	QDomElement Parser::StartElement (const QXmlStreamReader& reader, QDomDocument& doc)
+	{
+		auto elem = doc.createElementNS (reader.namespaceUri ().toString (),
+				reader.qualifiedName ().toString ());
+		for (const auto& attr : reader.attributes ())
+			elem.setAttributeNS (attr.namespaceUri ().toString (),
+					attr.qualifiedName ().toString (),
+					attr.value ().toString ());
+		return elem;
+	}
+
+	QDomElement Parser::ReadElement (QXmlStreamReader& reader, QDomDocument& doc)
+	{
+		const auto& root = StartElement (reader, doc);
+		auto current = root;
+
+		while (!reader.atEnd ())
 		{
-			if (newChannel->Link_.isEmpty ())
+			switch (reader.readNext ())
 			{
-				qWarning () << Q_FUNC_INFO
-					<< "detected empty link for"
-					<< newChannel->Title_;
-				newChannel->Link_ = "about:blank";
+			case QXmlStreamReader::StartElement:
+			{
+				const auto& child = StartElement (reader, doc);
+				current.appendChild (child);
+				current = child;
+				break;
+			}
+			case QXmlStreamReader::EndElement:
+				if (current == root)
+					return root;
+				current = current.parentNode ().toElement ();
+				break;
+			case QXmlStreamReader::Characters:
+				if (reader.isWhitespace ())
+					break;
+				if (reader.isCDATA ())
+					current.appendChild (doc.createCDATASection (reader.text ().toString ()));
+				else
+					current.appendChild (doc.createTextNode (reader.text ().toString ()));
+				break;
+			default:
+				break;
 			}
-			for (const auto& item : newChannel->Items_)
-				item->Title_ = item->Title_.trimmed ().simplified ();
 		}
-		return newes;
+
+		return root;
 	}
 
 	namespace
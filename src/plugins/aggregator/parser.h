@@ -34,6 +34,8 @@
 #include <QDomDocument>
 #include "channel.h"
 
+class QXmlStreamReader;
+
 namespace LeechCraft
 {
 namespace Aggregator
@@ -62,6 +64,32 @@ namespace Aggregator
 			*/
 		virtual channels_container_t ParseFeed (const QDomDocument& document,
 				const IDType_t& feedId) const;
+
+		/** @brief Indicates whether parser could parse the stream.
+			*
+			* Parsers supporting the streaming mode should reimplement
+			* this function along with ParseStream(). The default
+			* implementation returns false.
+			*
+			* @param[in] reader The reader positioned at the start of
+			* the root element.
+			* @return Whether the stream can be parsed by this parser.
+			*/
+		virtual bool CouldParseStream (const QXmlStreamReader& reader) const;
+
+		/** @brief Parses the document from the stream.
+			*
+			* This is the streaming counterpart of ParseFeed(): the
+			* document is never loaded as a whole, only the elements
+			* of a single item at a time are.
+			*
+			* @param[in] reader The reader positioned at the start of
+			* the root element.
+			* @param[in] feedId The ID of the parent feed.
+			* @return Container (channels_container_t) with new items.
+			*/
+		channels_container_t ParseFeedStream (QXmlStreamReader& reader,
+				const IDType_t& feedId) const;
 	protected:
 		static const QString DC_;
 		static const QString WFW_;
@@ -77,6 +105,24 @@ namespace Aggregator
 
 		virtual channels_container_t Parse (const QDomDocument&,
 				const IDType_t&) const = 0;
+		virtual channels_container_t ParseStream (QXmlStreamReader&,
+				const IDType_t&) const;
+
+		/** @brief Creates an element for the current start element.
+			*
+			* Only the element itself with its attributes is created,
+			* its children aren't read.
+			*/
+		static QDomElement StartElement (const QXmlStreamReader&, QDomDocument&);
+
+		/** @brief Reads the current element with all its children.
+			*
+			* The elements are created in the same way
+			* QDomDocument::setContent() with namespace processing does,
+			* so the resulting subtree can be passed to the DOM-based
+			* helpers. The reader is left at the end of the element.
+			*/
+		static QDomElement ReadElement (QXmlStreamReader&, QDomDocument&);
 		QString GetDescription (const QDomElement&) const;
 		void GetDescription (const QDomElement&, QString&) const;
 		QString GetLink (const QDomElement&) const;
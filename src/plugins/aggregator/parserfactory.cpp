@@ -61,6 +61,14 @@ namespace Aggregator
 			}
 		return result;
 	}
+	
+	Parser* ParserFactory::Return (const QXmlStreamReader& reader) const
+	{
+		for (const auto parser : Parsers_)
+			if (parser->CouldParseStream (reader))
+				return parser;
+		return nullptr;
+	}
 }
 }
 
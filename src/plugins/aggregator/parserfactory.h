@@ -32,6 +32,7 @@
 #include <QList>
 
 class QDomDocument;
+class QXmlStreamReader;
 
 namespace LeechCraft
 {
@@ -47,6 +48,7 @@ namespace Aggregator
 		static ParserFactory& Instance ();
 		void Register (Parser*);
 		Parser* Return (const QDomDocument&) const;
+		Parser* Return (const QXmlStreamReader&) const;
 	};
 }
 }
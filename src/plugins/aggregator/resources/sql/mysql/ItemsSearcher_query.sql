@@ -0,0 +1,5 @@
+SELECT item_id, channel_id, title, url, category, pub_date, unread
+    FROM items
+        WHERE MATCH (title, description, author, category) AGAINST (? IN BOOLEAN MODE)
+            ORDER BY MATCH (title, description, author, category) AGAINST (? IN BOOLEAN MODE) DESC
+                LIMIT ? OFFSET ?
@@ -0,0 +1 @@
+CREATE FULLTEXT INDEX idx_items_fulltext ON items (title, description, author, category);
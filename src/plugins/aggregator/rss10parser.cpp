@@ -27,6 +27,7 @@
  * DEALINGS IN THE SOFTWARE.
  **********************************************************************/
 
+#include <QXmlStreamReader>
 #include <QtDebug>
 #include "rss10parser.h"
 
@@ -54,6 +55,11 @@ namespace Aggregator
 		return root.tagName () == "RDF";
 	}
 	
+	bool RSS10Parser::CouldParseStream (const QXmlStreamReader& reader) const
+	{
+		return reader.name () == "RDF";
+	}
+	
 	channels_container_t RSS10Parser::Parse (const QDomDocument& doc,
 			const IDType_t& feedId) const
 	{
@@ -64,64 +70,118 @@ namespace Aggregator
 		QDomElement channelDescr = root.firstChildElement ("channel");
 		while (!channelDescr.isNull ())
 		{
-			Channel_ptr channel (new Channel (feedId));
-			channel->Title_ = channelDescr.firstChildElement ("title").text ().trimmed ();
-			channel->Link_ = channelDescr.firstChildElement ("link").text ();
-			channel->Description_ =
-				channelDescr.firstChildElement ("description").text ();
-			channel->PixmapURL_ =
-				channelDescr.firstChildElement ("image")
-				.firstChildElement ("url").text ();
-			channel->LastBuild_ = GetDCDateTime (channelDescr);
-	
-			QDomElement itemsRoot = channelDescr.firstChildElement ("items");
-			QDomNodeList seqs = itemsRoot.elementsByTagNameNS (RDF_, "Seq");
-	
+			if (const auto& channel = ParseChannel (channelDescr, feedId, item2Channel))
+				result.push_back (channel);
 			channelDescr = channelDescr.nextSiblingElement ("channel");
-	
-			if (!seqs.size ())
-				continue;
-	
-			QDomElement seqElem = seqs.at (0).toElement ();
-			QDomNodeList lis = seqElem.elementsByTagNameNS (RDF_, "li");
-			for (int i = 0; i < lis.size (); ++i)
-				item2Channel [lis.at (i).toElement ().attribute ("resource")] = channel;
-	
-			result.push_back (channel);
 		}
 	
 		QDomElement itemDescr = root.firstChildElement ("item");
 		while (!itemDescr.isNull ())
 		{
-			QString about = itemDescr.attributeNS (RDF_, "about");
-			if (item2Channel.contains (about))
+			ParseItem (itemDescr, item2Channel);
+			itemDescr = itemDescr.nextSiblingElement ("item");
+		}
+	
+		return result;
+	}
+	
+	channels_container_t RSS10Parser::ParseStream (QXmlStreamReader& reader,
+			const IDType_t& feedId) const
+	{
+		channels_container_t result;
+	
+		QMap<QString, Channel_ptr> item2Channel;
+	
+		// Items may only be bound to the channels once the
+		// corresponding channel is known, so the ones preceding it are
+		// kept until the end of the document.
+		QList<QDomDocument> orphanItems;
+	
+		while (reader.readNextStartElement ())
+		{
+			QDomDocument doc;
+			if (reader.name () == "channel")
 			{
-				Item_ptr item (new Item (item2Channel [about]->ChannelID_));
-				item->Title_ = itemDescr.firstChildElement ("title").text ();
-				item->Link_ = itemDescr.firstChildElement ("link").text ();
-				item->Description_ = itemDescr.firstChildElement ("description").text ();
-				GetDescription (itemDescr, item->Description_);
-	
-				item->Categories_ = GetAllCategories (itemDescr);
-				item->Author_ = GetAuthor (itemDescr);
-				item->PubDate_ = GetDCDateTime (itemDescr);
-				item->Unread_ = true;
-				item->NumComments_ = GetNumComments (itemDescr);
-				item->CommentsLink_ = GetCommentsRSS (itemDescr);
-				item->CommentsPageLink_ = GetCommentsLink (itemDescr);
-				item->Enclosures_ = GetEncEnclosures (itemDescr, item->ItemID_);
-				QPair<double, double> point = GetGeoPoint (itemDescr);
-				item->Latitude_ = point.first;
-				item->Longitude_ = point.second;
-				if (item->Guid_.isEmpty ())
-					item->Guid_ = "empty";
-	
-				item2Channel [about]->Items_.push_back (item);
+				const auto& channelDescr = ReadElement (reader, doc);
+				if (const auto& channel = ParseChannel (channelDescr, feedId, item2Channel))
+					result.push_back (channel);
 			}
-			itemDescr = itemDescr.nextSiblingElement ("item");
+			else if (reader.name () == "item")
+			{
+				const auto& itemDescr = ReadElement (reader, doc);
+				if (!ParseItem (itemDescr, item2Channel))
+				{
+					doc.appendChild (itemDescr);
+					orphanItems << doc;
+				}
+			}
+			else
+				reader.skipCurrentElement ();
 		}
 	
+		for (const auto& itemDoc : orphanItems)
+			ParseItem (itemDoc.documentElement (), item2Channel);
+	
 		return result;
 	}
+	
+	Channel_ptr RSS10Parser::ParseChannel (const QDomElement& channelDescr,
+			const IDType_t& feedId, QMap<QString, Channel_ptr>& item2Channel) const
+	{
+		Channel_ptr channel (new Channel (feedId));
+		channel->Title_ = channelDescr.firstChildElement ("title").text ().trimmed ();
+		channel->Link_ = channelDescr.firstChildElement ("link").text ();
+		channel->Description_ =
+			channelDescr.firstChildElement ("description").text ();
+		channel->PixmapURL_ =
+			channelDescr.firstChildElement ("image")
+			.firstChildElement ("url").text ();
+		channel->LastBuild_ = GetDCDateTime (channelDescr);
+	
+		QDomElement itemsRoot = channelDescr.firstChildElement ("items");
+		QDomNodeList seqs = itemsRoot.elementsByTagNameNS (RDF_, "Seq");
+		if (!seqs.size ())
+			return {};
+	
+		QDomElement seqElem = seqs.at (0).toElement ();
+		QDomNodeList lis = seqElem.elementsByTagNameNS (RDF_, "li");
+		for (int i = 0; i < lis.size (); ++i)
+			item2Channel [lis.at (i).toElement ().attribute ("resource")] = channel;
+	
+		return channel;
+	}
+	
+	bool RSS10Parser::ParseItem (const QDomElement& itemDescr,
+			const QMap<QString, Channel_ptr>& item2Channel) const
+	{
+		QString about = itemDescr.attributeNS (RDF_, "about");
+		if (!item2Channel.contains (about))
+			return false;
+	
+		const auto& channel = item2Channel [about];
+	
+		Item_ptr item (new Item (channel->ChannelID_));
+		item->Title_ = itemDescr.firstChildElement ("title").text ();
+		item->Link_ = itemDescr.firstChildElement ("link").text ();
+		item->Description_ = itemDescr.firstChildElement ("description").text ();
+		GetDescription (itemDescr, item->Description_);
+	
+		item->Categories_ = GetAllCategories (itemDescr);
+		item->Author_ = GetAuthor (itemDescr);
+		item->PubDate_ = GetDCDateTime (itemDescr);
+		item->Unread_ = true;
+		item->NumComments_ = GetNumComments (itemDescr);
+		item->CommentsLink_ = GetCommentsRSS (itemDescr);
+		item->CommentsPageLink_ = GetCommentsLink (itemDescr);
+		item->Enclosures_ = GetEncEnclosures (itemDescr, item->ItemID_);
+		QPair<double, double> point = GetGeoPoint (itemDescr);
+		item->Latitude_ = point.first;
+		item->Longitude_ = point.second;
+		if (item->Guid_.isEmpty ())
+			item->Guid_ = "empty";
+	
+		channel->Items_.push_back (item);
+		return true;
+	}
 }
 }
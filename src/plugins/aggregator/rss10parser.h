@@ -29,6 +29,7 @@
 
 #ifndef PLUGINS_AGGREGATOR_RSS10PARSER_H
 #define PLUGINS_AGGREGATOR_RSS10PARSER_H
+#include <QMap>
 #include "rssparser.h"
 #include "channel.h"
 
@@ -43,9 +44,15 @@ namespace Aggregator
 		virtual ~RSS10Parser ();
 		static RSS10Parser& Instance ();
 		virtual bool CouldParse (const QDomDocument&) const;
+		virtual bool CouldParseStream (const QXmlStreamReader&) const;
 	private:
 		channels_container_t Parse (const QDomDocument&,
 				const IDType_t&) const;
+		channels_container_t ParseStream (QXmlStreamReader&,
+				const IDType_t&) const;
+		Channel_ptr ParseChannel (const QDomElement&, const IDType_t&,
+				QMap<QString, Channel_ptr>&) const;
+		bool ParseItem (const QDomElement&, const QMap<QString, Channel_ptr>&) const;
 	};
 }
 }
@@ -30,6 +30,7 @@
 #include <QDomDocument>
 #include <QDomElement>
 #include <QStringList>
+#include <QXmlStreamReader>
 #include <QtDebug>
 #include "rss20parser.h"
 
@@ -58,6 +59,12 @@ namespace Aggregator
 			root.attribute ("version") == "2.0";
 	}
 
+	bool RSS20Parser::CouldParseStream (const QXmlStreamReader& reader) const
+	{
+		return reader.name () == "rss" &&
+			reader.attributes ().value ("version") == "2.0";
+	}
+
 	channels_container_t RSS20Parser::Parse (const QDomDocument& doc,
 			const IDType_t& feedId) const
 	{
@@ -67,17 +74,6 @@ namespace Aggregator
 		while (!channel.isNull ())
 		{
 			Channel_ptr chan (new Channel (feedId));
-			chan->Title_ = channel.firstChildElement ("title").text ().trimmed ();
-			chan->Description_ = channel.firstChildElement ("description").text ();
-			chan->Link_ = GetLink (channel);
-			chan->LastBuild_ = RFC822TimeToQDateTime (channel.firstChildElement ("lastBuildDate").text ());
-			chan->Language_ = channel.firstChildElement ("language").text ();
-			chan->Author_ = GetAuthor (channel);
-			if (chan->Author_.isEmpty ())
-				chan->Author_ = channel.firstChildElement ("managingEditor").text ();
-			if (chan->Author_.isEmpty ())
-				chan->Author_ = channel.firstChildElement ("webMaster").text ();
-			chan->PixmapURL_ = channel.firstChildElement ("image").attribute ("url");
 
 			auto& itemsList = chan->Items_;
 			itemsList.reserve (20);
@@ -88,19 +84,71 @@ namespace Aggregator
 				itemsList.push_back (Item_ptr (ParseItem (item, chan->ChannelID_)));
 				item = item.nextSiblingElement ("item");
 			}
-			if (!chan->LastBuild_.isValid () || chan->LastBuild_.isNull ())
+
+			FillChannel (channel, chan);
+			channels.push_back (chan);
+			channel = channel.nextSiblingElement ("channel");
+		}
+		return channels;
+	}
+
+	channels_container_t RSS20Parser::ParseStream (QXmlStreamReader& reader,
+			const IDType_t& feedId) const
+	{
+		channels_container_t channels;
+		while (reader.readNextStartElement ())
+		{
+			if (reader.name () != "channel")
 			{
-				if (!itemsList.empty ())
-					chan->LastBuild_ = itemsList.at (0)->PubDate_;
+				reader.skipCurrentElement ();
+				continue;
+			}
+
+			Channel_ptr chan (new Channel (feedId));
+
+			QDomDocument doc;
+			auto channel = StartElement (reader, doc);
+			while (reader.readNextStartElement ())
+			{
+				if (reader.name () == "item")
+				{
+					QDomDocument itemDoc;
+					const auto& item = ReadElement (reader, itemDoc);
+					chan->Items_.push_back (Item_ptr (ParseItem (item, chan->ChannelID_)));
+				}
 				else
-					chan->LastBuild_ = QDateTime::currentDateTime ();
+					channel.appendChild (ReadElement (reader, doc));
 			}
+
+			FillChannel (channel, chan);
 			channels.push_back (chan);
-			channel = channel.nextSiblingElement ("channel");
 		}
 		return channels;
 	}
 
+	void RSS20Parser::FillChannel (const QDomElement& channel, const Channel_ptr& chan) const
+	{
+		chan->Title_ = channel.firstChildElement ("title").text ().trimmed ();
+		chan->Description_ = channel.firstChildElement ("description").text ();
+		chan->Link_ = GetLink (channel);
+		chan->LastBuild_ = RFC822TimeToQDateTime (channel.firstChildElement ("lastBuildDate").text ());
+		chan->Language_ = channel.firstChildElement ("language").text ();
+		chan->Author_ = GetAuthor (channel);
+		if (chan->Author_.isEmpty ())
+			chan->Author_ = channel.firstChildElement ("managingEditor").text ();
+		if (chan->Author_.isEmpty ())
+			chan->Author_ = channel.firstChildElement ("webMaster").text ();
+		chan->PixmapURL_ = channel.firstChildElement ("image").attribute ("url");
+
+		if (!chan->LastBuild_.isValid () || chan->LastBuild_.isNull ())
+		{
+			if (!chan->Items_.empty ())
+				chan->LastBuild_ = chan->Items_.at (0)->PubDate_;
+			else
+				chan->LastBuild_ = QDateTime::currentDateTime ();
+		}
+	}
+
 	Item* RSS20Parser::ParseItem (const QDomElement& item,
 			const IDType_t& channelId) const
 	{
@@ -43,9 +43,13 @@ namespace Aggregator
 		virtual ~RSS20Parser ();
 		static RSS20Parser& Instance ();
 		virtual bool CouldParse (const QDomDocument&) const;
+		virtual bool CouldParseStream (const QXmlStreamReader&) const;
 	private:
 		channels_container_t Parse (const QDomDocument&,
 				const IDType_t&) const;
+		channels_container_t ParseStream (QXmlStreamReader&,
+				const IDType_t&) const;
+		void FillChannel (const QDomElement&, const Channel_ptr&) const;
 		Item* ParseItem (const QDomElement&,
 				const IDType_t&) const;
 	};
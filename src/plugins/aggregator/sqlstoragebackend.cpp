@@ -34,6 +34,7 @@
 #include <QBuffer>
 #include <QSqlError>
 #include <QThread>
+#include <QTimer>
 #include <QVariant>
 #include <QSqlRecord>
 #include <util/util.h>
@@ -44,11 +45,28 @@
 #include <interfaces/core/itagsmanager.h>
 #include "xmlsettingsmanager.h"
 #include "core.h"
+#include "searchqueries.h"
 
 namespace LeechCraft
 {
 namespace Aggregator
 {
+	namespace
+	{
+		/** The full-text document of an item for PostgreSQL, with the
+		 * title weighted higher than the author and categories, which
+		 * are in turn weighted higher than the description.
+		 *
+		 * The index expression and the search query should use the
+		 * very same expression for the index to be used.
+		 */
+		const QString PgItemTextVector = "("
+				"setweight (to_tsvector ('simple', coalesce (title, '')), 'A') || "
+				"setweight (to_tsvector ('simple', coalesce (author, '') || ' ' || coalesce (category, '')), 'B') || "
+				"to_tsvector ('simple', coalesce (description, ''))"
+				")";
+	}
+
 	SQLStorageBackend::SQLStorageBackend (StorageBackend::Type t, const QString& id)
 	: Type_ (t)
 	{
@@ -779,6 +797,48 @@ namespace Aggregator
 		GetItemsForTag_ = QSqlQuery (DB_);
 		GetItemsForTag_.prepare ("SELECT item_id FROM items2tags "
 				"WHERE tag = :tag");
+
+		ItemsSearcher_ = QSqlQuery (DB_);
+		switch (Type_)
+		{
+		case SBSQLite:
+			ItemsSearcher_.prepare ("SELECT "
+					"items.item_id, "
+					"items.channel_id, "
+					"items.title, "
+					"items.url, "
+					"items.category, "
+					"items.pub_date, "
+					"items.unread "
+					"FROM ("
+						"SELECT rowid, rank FROM items_fts "
+						"WHERE items_fts MATCH :query "
+						"ORDER BY rank "
+						"LIMIT :limit OFFSET :offset"
+					") AS found "
+					"JOIN items ON items.item_id = found.rowid "
+					"ORDER BY found.rank");
+			break;
+		case SBPostgres:
+			ItemsSearcher_.prepare (QString ("WITH search AS "
+						"(SELECT plainto_tsquery ('simple', :query) AS query) "
+					"SELECT "
+					"item_id, "
+					"channel_id, "
+					"title, "
+					"url, "
+					"category, "
+					"pub_date, "
+					"unread "
+					"FROM items, search "
+					"WHERE %1 @@ search.query "
+					"ORDER BY ts_rank (%1, search.query) DESC "
+					"LIMIT :limit OFFSET :offset")
+						.arg (PgItemTextVector));
+			break;
+		case SBMysql:
+			break;
+		}
 	}
 
 	void SQLStorageBackend::GetFeedsIDs (ids_t& result) const
@@ -883,6 +943,51 @@ namespace Aggregator
 		return result;
 	}
 
+	items_shorts_t SQLStorageBackend::SearchItems (const QString& text, int offset, int limit) const
+	{
+		if (!HasTextIndex_)
+			return {};
+
+		const auto& query = Type_ == SBSQLite ? MakeFTS5Query (text) : text.simplified ();
+		if (query.isEmpty ())
+			return {};
+
+		ItemsSearcher_.bindValue (":query", query);
+		ItemsSearcher_.bindValue (":limit", limit);
+		ItemsSearcher_.bindValue (":offset", offset);
+		if (!ItemsSearcher_.exec ())
+		{
+			Util::DBLock::DumpError (ItemsSearcher_);
+			return {};
+		}
+
+		items_shorts_t result;
+		while (ItemsSearcher_.next ())
+			result.push_back ({
+					ItemsSearcher_.value (0).value<IDType_t> (),
+					ItemsSearcher_.value (1).value<IDType_t> (),
+					ItemsSearcher_.value (2).toString (),
+					ItemsSearcher_.value (3).toString (),
+					ItemsSearcher_.value (4).toString ()
+						.split ("<<<", QString::SkipEmptyParts),
+					ItemsSearcher_.value (5).toDateTime (),
+					ItemsSearcher_.value (6).toBool ()
+				});
+
+		ItemsSearcher_.finish ();
+		return result;
+	}
+
+	void SQLStorageBackend::StartTextIndexBackfill ()
+	{
+		if (Type_ != SBSQLite || !HasTextIndex_)
+			return;
+
+		QTimer::singleShot (0,
+				this,
+				SLOT (backfillTextIndex ()));
+	}
+
 	IDType_t SQLStorageBackend::GetHighestID (const PoolType& type) const
 	{
 		QString field, table;
@@ -1509,6 +1614,12 @@ namespace Aggregator
 	}
 
 	void SQLStorageBackend::UpdateItem (Item_ptr item)
+	{
+		WriteUpdatedItem (item);
+		EmitItemsUpdated (item->ChannelID_, { item });
+	}
+
+	void SQLStorageBackend::WriteUpdatedItem (const Item_ptr& item)
 	{
 		UpdateItem_.bindValue (":item_id", item->ItemID_);
 		UpdateItem_.bindValue (":description", item->Description_);
@@ -1541,21 +1652,6 @@ namespace Aggregator
 
 		WriteEnclosures (item->Enclosures_);
 		WriteMRSSEntries (item->MRSSEntries_);
-
-		try
-		{
-			IDType_t cid = item->ChannelID_;
-			Channel_ptr channel = GetChannel (cid,
-					FindParentFeedForChannel (cid));
-			emit itemDataUpdated (item, channel);
-			emit channelDataUpdated (channel);
-		}
-		catch (const ChannelNotFoundError&)
-		{
-			qWarning () << Q_FUNC_INFO
-				<< "channel not found"
-				<< item->ChannelID_;
-		}
 	}
 
 	void SQLStorageBackend::UpdateItem (const ItemShort& item)
@@ -1597,40 +1693,79 @@ namespace Aggregator
 
 	void SQLStorageBackend::AddChannel (Channel_ptr channel)
 	{
-		InsertChannel_.bindValue (":channel_id", channel->ChannelID_);
-		InsertChannel_.bindValue (":feed_id", channel->FeedID_);
-		InsertChannel_.bindValue (":url", channel->Link_);
-		InsertChannel_.bindValue (":title", channel->Title_);
-		InsertChannel_.bindValue (":display_title", channel->DisplayTitle_);
-		InsertChannel_.bindValue (":description", channel->Description_);
-		InsertChannel_.bindValue (":last_build", channel->LastBuild_);
-		InsertChannel_.bindValue (":tags",
-				Core::Instance ().GetProxy ()->GetTagsManager ()->Join (channel->Tags_));
-		InsertChannel_.bindValue (":language", channel->Language_);
-		InsertChannel_.bindValue (":author", channel->Author_);
-		InsertChannel_.bindValue (":pixmap_url", channel->PixmapURL_);
-		InsertChannel_.bindValue (":pixmap", SerializePixmap (channel->Pixmap_));
-		InsertChannel_.bindValue (":favicon", SerializePixmap (channel->Favicon_));
-
-		if (!InsertChannel_.exec ())
 		{
-			qWarning () << Q_FUNC_INFO;
-			Util::DBLock::DumpError (InsertChannel_);
-			throw std::runtime_error (qPrintable (QString (
-							"Failed to save channel {id: %1, title: %2, url: %3, parent: %4}")
-						.arg (channel->ChannelID_)
-						.arg (channel->Title_)
-						.arg (channel->Link_)
-						.arg (channel->FeedID_)));
-		}
+			Util::DBLock lock (DB_);
+			lock.Init ();
+
+			InsertChannel_.bindValue (":channel_id", channel->ChannelID_);
+			InsertChannel_.bindValue (":feed_id", channel->FeedID_);
+			InsertChannel_.bindValue (":url", channel->Link_);
+			InsertChannel_.bindValue (":title", channel->Title_);
+			InsertChannel_.bindValue (":display_title", channel->DisplayTitle_);
+			InsertChannel_.bindValue (":description", channel->Description_);
+			InsertChannel_.bindValue (":last_build", channel->LastBuild_);
+			InsertChannel_.bindValue (":tags",
+					Core::Instance ().GetProxy ()->GetTagsManager ()->Join (channel->Tags_));
+			InsertChannel_.bindValue (":language", channel->Language_);
+			InsertChannel_.bindValue (":author", channel->Author_);
+			InsertChannel_.bindValue (":pixmap_url", channel->PixmapURL_);
+			InsertChannel_.bindValue (":pixmap", SerializePixmap (channel->Pixmap_));
+			InsertChannel_.bindValue (":favicon", SerializePixmap (channel->Favicon_));
+
+			if (!InsertChannel_.exec ())
+			{
+				qWarning () << Q_FUNC_INFO;
+				Util::DBLock::DumpError (InsertChannel_);
+				throw std::runtime_error (qPrintable (QString (
+								"Failed to save channel {id: %1, title: %2, url: %3, parent: %4}")
+							.arg (channel->ChannelID_)
+							.arg (channel->Title_)
+							.arg (channel->Link_)
+							.arg (channel->FeedID_)));
+			}
+
+			InsertChannel_.finish ();
+
+			for (const auto& item : channel->Items_)
+				WriteNewItem (item);
 
-		InsertChannel_.finish ();
+			lock.Good ();
+		}
 
-		std::for_each (channel->Items_.begin (), channel->Items_.end (),
-				[this] (Item_ptr item) { AddItem (item); });
+		if (!channel->Items_.empty ())
+			EmitItemsUpdated (channel->ChannelID_, channel->Items_);
 	}
 
 	void SQLStorageBackend::AddItem (Item_ptr item)
+	{
+		WriteNewItem (item);
+		EmitItemsUpdated (item->ChannelID_, { item });
+	}
+
+	void SQLStorageBackend::StoreItems (const IDType_t& channelId,
+			const items_container_t& added, const items_container_t& updated)
+	{
+		if (added.empty () && updated.empty ())
+			return;
+
+		{
+			Util::DBLock lock (DB_);
+			lock.Init ();
+
+			for (const auto& item : added)
+				WriteNewItem (item);
+			for (const auto& item : updated)
+				WriteUpdatedItem (item);
+
+			lock.Good ();
+		}
+
+		auto all = added;
+		all.insert (all.end (), updated.begin (), updated.end ());
+		EmitItemsUpdated (channelId, all);
+	}
+
+	void SQLStorageBackend::WriteNewItem (const Item_ptr& item)
 	{
 		InsertItem_.bindValue (":item_id", item->ItemID_);
 		InsertItem_.bindValue (":channel_id", item->ChannelID_);
@@ -1664,20 +1799,23 @@ namespace Aggregator
 
 		WriteEnclosures (item->Enclosures_);
 		WriteMRSSEntries (item->MRSSEntries_);
+	}
 
+	void SQLStorageBackend::EmitItemsUpdated (const IDType_t& channelId, const items_container_t& items)
+	{
 		try
 		{
-			IDType_t cid = item->ChannelID_;
-			Channel_ptr channel = GetChannel (cid,
-					FindParentFeedForChannel (cid));
-			emit itemDataUpdated (item, channel);
+			const auto& channel = GetChannel (channelId,
+					FindParentFeedForChannel (channelId));
+			for (const auto& item : items)
+				emit itemDataUpdated (item, channel);
 			emit channelDataUpdated (channel);
 		}
 		catch (const ChannelNotFoundError&)
 		{
 			qWarning () << Q_FUNC_INFO
 				<< "channel not found"
-				<< item->ChannelID_;
+				<< channelId;
 		}
 	}
 
@@ -2345,9 +2483,247 @@ namespace Aggregator
 			}
 		}
 
+		HasTextIndex_ = InitializeTextIndex ();
+		if (!HasTextIndex_)
+			qWarning () << Q_FUNC_INFO
+					<< "could not create full-text index, search would be unavailable";
+
 		return true;
 	}
 
+	bool SQLStorageBackend::InitializeTextIndex ()
+	{
+		QSqlQuery query (DB_);
+		switch (Type_)
+		{
+		case SBSQLite:
+		{
+			const QStringList legacyTriggers
+			{
+				"items_fts_insert",
+				"items_fts_update",
+				"items_fts_delete"
+			};
+			const QStringList ftsTriggers
+			{
+				"items_fts_ai",
+				"items_fts_ad",
+				"items_fts_au"
+			};
+
+			const auto& tables = DB_.tables ();
+			bool hadTable = tables.contains ("items_fts");
+			if (hadTable && !query.exec ("SELECT 1 FROM items_fts LIMIT 0;"))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "the full-text index exists, but FTS5 is unavailable, dropping its triggers";
+				Util::DBLock::DumpError (query);
+
+				// The triggers would make every write to `items` fail
+				// otherwise.
+				for (const auto& trigger : ftsTriggers + legacyTriggers)
+					query.exec (QString ("DROP TRIGGER IF EXISTS %1;").arg (trigger));
+				return false;
+			}
+
+			Util::DBLock lock (DB_);
+			try
+			{
+				lock.Init ();
+			}
+			catch (const std::runtime_error& e)
+			{
+				qWarning () << Q_FUNC_INFO << e.what ();
+				return false;
+			}
+
+			// Earlier versions kept a full copy of the items' texts in
+			// the index and filled it synchronously.
+			if (hadTable && !tables.contains ("items_fts_backfill"))
+			{
+				qDebug () << Q_FUNC_INFO
+						<< "replacing the old full-text index";
+				QStringList dropQueries;
+				for (const auto& trigger : legacyTriggers)
+					dropQueries << QString ("DROP TRIGGER IF EXISTS %1;").arg (trigger);
+				dropQueries << "DROP TABLE items_fts;";
+
+				for (const auto& str : dropQueries)
+					if (!query.exec (str))
+					{
+						Util::DBLock::DumpError (query);
+						return false;
+					}
+
+				hadTable = false;
+			}
+
+			if (!hadTable)
+			{
+				// Items with IDs up to `last_id` are not indexed yet and
+				// are added to the index in batches by
+				// backfillTextIndex(), from the newest to the oldest
+				// ones. The triggers only maintain the already indexed
+				// items, since the 'delete' command of an external
+				// content table requires the indexed values.
+				const QStringList queries
+				{
+					"CREATE VIRTUAL TABLE items_fts USING fts5 ("
+						"title, "
+						"description, "
+						"author, "
+						"category, "
+						"content = 'items', "
+						"content_rowid = 'item_id', "
+						"tokenize = 'unicode61 remove_diacritics 1'"
+						");",
+					"INSERT INTO items_fts (items_fts, rank) "
+						"VALUES ('rank', 'bm25(10.0, 1.0, 2.0, 2.0)');",
+					"DROP TABLE IF EXISTS items_fts_backfill;",
+					"CREATE TABLE items_fts_backfill (last_id INTEGER NOT NULL);",
+					"INSERT INTO items_fts_backfill (last_id) "
+						"SELECT COALESCE (MAX (item_id), 0) FROM items;"
+				};
+
+				for (const auto& str : queries)
+					if (!query.exec (str))
+					{
+						Util::DBLock::DumpError (query);
+						return false;
+					}
+			}
+
+			const QStringList triggersQueries
+			{
+				"CREATE TRIGGER IF NOT EXISTS items_fts_ai AFTER INSERT ON items "
+					"WHEN new.item_id > (SELECT last_id FROM items_fts_backfill) BEGIN "
+					"INSERT INTO items_fts (rowid, title, description, author, category) "
+					"VALUES (new.item_id, new.title, new.description, new.author, new.category); "
+					"END;",
+				"CREATE TRIGGER IF NOT EXISTS items_fts_ad AFTER DELETE ON items "
+					"WHEN old.item_id > (SELECT last_id FROM items_fts_backfill) BEGIN "
+					"INSERT INTO items_fts (items_fts, rowid, title, description, author, category) "
+					"VALUES ('delete', old.item_id, old.title, old.description, old.author, old.category); "
+					"END;",
+				"CREATE TRIGGER IF NOT EXISTS items_fts_au "
+					"AFTER UPDATE OF title, description, author, category ON items "
+					"WHEN old.item_id > (SELECT last_id FROM items_fts_backfill) BEGIN "
+					"INSERT INTO items_fts (items_fts, rowid, title, description, author, category) "
+					"VALUES ('delete', old.item_id, old.title, old.description, old.author, old.category); "
+					"INSERT INTO items_fts (rowid, title, description, author, category) "
+					"VALUES (new.item_id, new.title, new.description, new.author, new.category); "
+					"END;"
+			};
+
+			for (const auto& str : triggersQueries)
+				if (!query.exec (str))
+				{
+					Util::DBLock::DumpError (query);
+					return false;
+				}
+
+			lock.Good ();
+			return true;
+		}
+		case SBPostgres:
+			if (!query.exec (QString ("CREATE INDEX IF NOT EXISTS idx_items_fts "
+						"ON items USING GIN (%1);").arg (PgItemTextVector)))
+			{
+				Util::DBLock::DumpError (query);
+				return false;
+			}
+			return true;
+		case SBMysql:
+			break;
+		}
+
+		return false;
+	}
+
+	void SQLStorageBackend::backfillTextIndex ()
+	{
+		const int batchSize = 500;
+
+		Util::DBLock lock (DB_);
+		try
+		{
+			lock.Init ();
+		}
+		catch (const std::runtime_error& e)
+		{
+			qWarning () << Q_FUNC_INFO << e.what ();
+			QTimer::singleShot (10000,
+					this,
+					SLOT (backfillTextIndex ()));
+			return;
+		}
+
+		QSqlQuery query (DB_);
+		if (!query.exec ("SELECT last_id FROM items_fts_backfill;") ||
+				!query.next ())
+		{
+			Util::DBLock::DumpError (query);
+			return;
+		}
+		const auto lastId = query.value (0).value<IDType_t> ();
+		query.finish ();
+
+		if (!lastId)
+			return;
+
+		query.prepare ("SELECT item_id FROM items "
+				"WHERE item_id <= :last_id "
+				"ORDER BY item_id DESC "
+				"LIMIT 1 OFFSET :batch_size");
+		query.bindValue (":last_id", lastId);
+		query.bindValue (":batch_size", batchSize);
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
+			return;
+		}
+		const IDType_t nextLastId = query.next () ?
+				query.value (0).value<IDType_t> () :
+				0;
+		query.finish ();
+
+		query.prepare ("INSERT INTO items_fts (rowid, title, description, author, category) "
+				"SELECT item_id, title, description, author, category FROM items "
+				"WHERE item_id <= :last_id AND item_id > :next_last_id");
+		query.bindValue (":last_id", lastId);
+		query.bindValue (":next_last_id", nextLastId);
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
+			return;
+		}
+
+		query.prepare ("UPDATE items_fts_backfill SET last_id = :next_last_id");
+		query.bindValue (":next_last_id", nextLastId);
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
+			return;
+		}
+
+		lock.Good ();
+
+		if (!nextLastId)
+		{
+			qDebug () << Q_FUNC_INFO
+					<< "the full-text index is complete";
+			return;
+		}
+
+		qDebug () << Q_FUNC_INFO
+				<< "indexed items down to"
+				<< nextLastId + 1;
+
+		QTimer::singleShot (100,
+				this,
+				SLOT (backfillTextIndex ()));
+	}
+
 	QByteArray SQLStorageBackend::SerializePixmap (const QImage& pixmap) const
 	{
 		QByteArray bytes;
@@ -571,7 +571,24 @@ namespace Aggregator
 							 * Binds:
 							 * - tag
 							 */
-							GetItemsForTag_;
+							GetItemsForTag_,
+							/** Returns:
+							 * - item_id
+							 * - channel_id
+							 * - title
+							 * - url
+							 * - category
+							 * - pub_date
+							 * - unread
+							 *
+							 * Binds:
+							 * - query
+							 * - limit
+							 * - offset
+							 */
+							ItemsSearcher_;
+
+		bool HasTextIndex_ = false;
 	public:
 		SQLStorageBackend (Type, const QString&);
 		virtual ~SQLStorageBackend ();
@@ -605,6 +622,8 @@ namespace Aggregator
 		virtual void UpdateItem (const ItemShort&);
 		virtual void AddChannel (Channel_ptr);
 		virtual void AddItem (Item_ptr);
+		virtual void StoreItems (const IDType_t&,
+				const items_container_t&, const items_container_t&);
 		virtual void RemoveItems (const QSet<IDType_t>&);
 		virtual void RemoveChannel (const IDType_t&);
 		virtual void RemoveFeed (const IDType_t&);
@@ -617,12 +636,16 @@ namespace Aggregator
 		virtual void SetItemTags (const IDType_t&, const QList<ITagsManager::tag_id>&);
 		virtual QList<IDType_t> GetItemsForTag (const ITagsManager::tag_id&);
 
+		virtual items_shorts_t SearchItems (const QString&, int, int) const;
+		virtual void StartTextIndexBackfill ();
+
 		virtual IDType_t GetHighestID (const PoolType&) const;
 
 	private:
 		QString GetBoolType () const;
 		QString GetBlobType () const;
 		bool InitializeTables ();
+		bool InitializeTextIndex ();
 		QByteArray SerializePixmap (const QImage&) const;
 		QImage UnserializePixmap (const QByteArray&) const;
 
@@ -644,12 +667,17 @@ namespace Aggregator
 				QList<MRSSEntry>&, const IDType_t&) const;
 
 		IDType_t FindParentFeedForChannel (const IDType_t&) const;
+		void WriteNewItem (const Item_ptr&);
+		void WriteUpdatedItem (const Item_ptr&);
+		void EmitItemsUpdated (const IDType_t&, const items_container_t&);
 		void FillItem (const QSqlQuery&, Item_ptr&) const;
 		void WriteEnclosures (const QList<Enclosure>&);
 		void GetEnclosures (const IDType_t&, QList<Enclosure>&) const;
 		void WriteMRSSEntries (const QList<MRSSEntry>&);
 		void GetMRSSEntries (const IDType_t&, QList<MRSSEntry>&) const;
 		IDType_t GetHighestID (const QString&, const QString&) const;
+	private slots:
+		void backfillTextIndex ();
 	};
 }
 }
@@ -39,6 +39,7 @@
 #include <util/db/dblock.h>
 #include "xmlsettingsmanager.h"
 #include "core.h"
+#include "searchqueries.h"
 
 namespace LeechCraft
 {
@@ -219,6 +220,9 @@ namespace Aggregator
 
 		RemoveMediaRSSScenes_ = QSqlQuery (DB_);
 		RemoveMediaRSSScenes_.prepare (StorageBackend::LoadQuery ("mysql", "RemoveMediaRSSScenes_query"));
+
+		ItemsSearcher_ = QSqlQuery (DB_);
+		ItemsSearcher_.prepare (StorageBackend::LoadQuery ("mysql", "ItemsSearcher_query"));
 	}
 
 	void SQLStorageBackendMysql::GetFeedsIDs (ids_t& result) const
@@ -1229,6 +1233,39 @@ namespace Aggregator
 		return QList<IDType_t> ();
 	}
 
+	items_shorts_t SQLStorageBackendMysql::SearchItems (const QString& text, int offset, int limit) const
+	{
+		const auto& query = MakeMysqlBooleanQuery (text);
+		if (query.isEmpty ())
+			return {};
+
+		ItemsSearcher_.bindValue (0, query);				//match
+		ItemsSearcher_.bindValue (1, query);				//order by match
+		ItemsSearcher_.bindValue (2, limit);				//limit
+		ItemsSearcher_.bindValue (3, offset);				//offset
+		if (!ItemsSearcher_.exec ())
+		{
+			Util::DBLock::DumpError (ItemsSearcher_);
+			return {};
+		}
+
+		items_shorts_t result;
+		while (ItemsSearcher_.next ())
+			result.push_back ({
+					ItemsSearcher_.value (0).value<IDType_t> (),
+					ItemsSearcher_.value (1).value<IDType_t> (),
+					ItemsSearcher_.value (2).toString (),
+					ItemsSearcher_.value (3).toString (),
+					ItemsSearcher_.value (4).toString ()
+						.split ("<<<", QString::SkipEmptyParts),
+					ItemsSearcher_.value (5).toDateTime (),
+					ItemsSearcher_.value (6).toBool ()
+				});
+
+		ItemsSearcher_.finish ();
+		return result;
+	}
+
 	bool SQLStorageBackendMysql::UpdateFeedsStorage (int, int)
 	{
 		return true;
@@ -1290,6 +1327,16 @@ namespace Aggregator
 				}
 		}
 
+		if (!query.exec ("SHOW INDEX FROM items WHERE Key_name = 'idx_items_fulltext'"))
+			Util::DBLock::DumpError (query);
+		else if (!query.next () &&
+				!query.exec (StorageBackend::LoadQuery ("mysql", "create_index_items_fulltext")))
+		{
+			Util::DBLock::DumpError (query);
+			qWarning () << Q_FUNC_INFO
+					<< "could not create full-text index, search would be unavailable";
+		}
+
 		return true;
 	}
 
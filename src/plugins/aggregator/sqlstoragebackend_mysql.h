@@ -536,7 +536,23 @@ namespace Aggregator
 							/** Binds:
 							* - item_id
 							*/
-							RemoveMediaRSSScenes_;
+							RemoveMediaRSSScenes_,
+							/** Returns:
+							* - item_id
+							* - channel_id
+							* - title
+							* - url
+							* - category
+							* - pub_date
+							* - unread
+							*
+							* Binds:
+							* - match query
+							* - order by query
+							* - limit
+							* - offset
+							*/
+							ItemsSearcher_;
 	public:
 		SQLStorageBackendMysql (Type, const QString&);
 		virtual ~SQLStorageBackendMysql ();
@@ -582,6 +598,8 @@ namespace Aggregator
 		virtual void SetItemTags (const IDType_t&, const QList<ITagsManager::tag_id>&);
 		virtual QList<IDType_t> GetItemsForTag (const ITagsManager::tag_id&);
 
+		virtual items_shorts_t SearchItems (const QString&, int, int) const;
+
 		virtual IDType_t GetHighestID (const PoolType&) const;
 
 	private:
@@ -73,6 +73,66 @@ namespace Aggregator
 		return Create (type, id);
 	}
 
+	void StorageBackend::ItemsIndex::Add (IDType_t id, const QString& title, const QString& link)
+	{
+		const auto& titleLink = qMakePair (title, link);
+		if (!ByTitleLink_.contains (titleLink))
+			ByTitleLink_ [titleLink] = id;
+		if (!link.isEmpty () && !ByLink_.contains (link))
+			ByLink_ [link] = id;
+		if (!ByTitle_.contains (title))
+			ByTitle_ [title] = id;
+	}
+
+	boost::optional<IDType_t> StorageBackend::ItemsIndex::Find (const QString& title, const QString& link) const
+	{
+		const auto titleLinkPos = ByTitleLink_.find ({ title, link });
+		if (titleLinkPos != ByTitleLink_.end ())
+			return *titleLinkPos;
+
+		if (!link.isEmpty ())
+		{
+			const auto linkPos = ByLink_.find (link);
+			if (linkPos != ByLink_.end ())
+				return *linkPos;
+			return {};
+		}
+
+		const auto titlePos = ByTitle_.find (title);
+		if (titlePos != ByTitle_.end ())
+			return *titlePos;
+		return {};
+	}
+
+	auto StorageBackend::GetItemsIndex (const IDType_t& channel) const -> ItemsIndex
+	{
+		items_shorts_t shorts;
+		GetItems (shorts, channel);
+
+		ItemsIndex index;
+		for (const auto& item : shorts)
+			index.Add (item.ItemID_, item.Title_, item.URL_);
+		return index;
+	}
+
+	void StorageBackend::StoreItems (const IDType_t&,
+			const items_container_t& added, const items_container_t& updated)
+	{
+		for (const auto& item : added)
+			AddItem (item);
+		for (const auto& item : updated)
+			UpdateItem (item);
+	}
+
+	items_shorts_t StorageBackend::SearchItems (const QString&, int, int) const
+	{
+		return {};
+	}
+
+	void StorageBackend::StartTextIndexBackfill ()
+	{
+	}
+
 	StorageBackend_ptr StorageBackend::Create (Type type, const QString& id)
 	{
 		StorageBackend_ptr result;
@@ -32,6 +32,8 @@
 #include <boost/optional.hpp>
 #include <QObject>
 #include <QSet>
+#include <QHash>
+#include <QPair>
 #include <interfaces/core/ihookproxy.h>
 #include <interfaces/core/itagsmanager.h>
 #include "feed.h"
@@ -60,6 +62,47 @@ namespace Aggregator
 		struct FeedGettingError {};
 		struct FeedNotFoundError {};
 
+		/** @brief In-memory index of the items of a channel.
+		 *
+		 * Allows to look up already stored items by their titles and
+		 * links without querying the storage for each item, following
+		 * the same rules as FindItem(), FindItemByLink() and
+		 * FindItemByTitle() applied in this order.
+		 *
+		 * @sa GetItemsIndex()
+		 */
+		class ItemsIndex
+		{
+			QHash<QPair<QString, QString>, IDType_t> ByTitleLink_;
+			QHash<QString, IDType_t> ByLink_;
+			QHash<QString, IDType_t> ByTitle_;
+		public:
+			/** @brief Adds an item to the index.
+			 *
+			 * If there is already an item with the same title and/or
+			 * link, the previously added one takes precedence.
+			 *
+			 * @param[in] id The ID of the item.
+			 * @param[in] title The title of the item.
+			 * @param[in] link The link of the item.
+			 */
+			void Add (IDType_t id, const QString& title, const QString& link);
+
+			/** @brief Finds the item with the given title and link.
+			 *
+			 * An item with both the same title and link is looked up
+			 * first, then an item with the same link if it's not
+			 * empty, and then an item with the same title if the link
+			 * is empty.
+			 *
+			 * @param[in] title The title of the item to be found.
+			 * @param[in] link The link of the item to be found.
+			 * @return ID of the found item or an empty optional object
+			 * if no such item exists.
+			 */
+			boost::optional<IDType_t> Find (const QString& title, const QString& link) const;
+		};
+
 		enum Type
 		{
 			SBSQLite,
@@ -281,6 +324,37 @@ namespace Aggregator
 		virtual void GetItems (items_container_t& items,
 				const IDType_t& id) const = 0;
 
+		/** @brief Returns the index of items in the channel.
+		 *
+		 * The index is built with a single request to the storage and
+		 * is intended to be used when a lot of items should be checked
+		 * against the ones already stored, like during feed updates.
+		 *
+		 * The default implementation builds the index from the results
+		 * of GetItems().
+		 *
+		 * @param[in] channel The ID of the channel.
+		 * @return The index of the channel's items.
+		 */
+		virtual ItemsIndex GetItemsIndex (const IDType_t& channel) const;
+
+		/** @brief Adds and updates a batch of items of a channel.
+		 *
+		 * This function is equivalent to calling AddItem() for each of
+		 * \em added items and UpdateItem() for each of \em updated
+		 * items, but backends may do it in a more efficient way, for
+		 * example, in a single transaction.
+		 *
+		 * The channelDataUpdated() signal is emitted once per call,
+		 * after all the items are stored.
+		 *
+		 * @param[in] channel ID of the channel the items belong to.
+		 * @param[in] added The items to be added.
+		 * @param[in] updated The items to be updated.
+		 */
+		virtual void StoreItems (const IDType_t& channel,
+				const items_container_t& added, const items_container_t& updated);
+
 		/** @brief Puts a feed and all its child channels and items into the
 		 * storage.
 		 *
@@ -443,6 +517,37 @@ namespace Aggregator
 		virtual void SetItemTags (const IDType_t& id, const QList<ITagsManager::tag_id>& tags) = 0;
 		virtual QList<IDType_t> GetItemsForTag (const ITagsManager::tag_id& tag) = 0;
 
+		/** @brief Searches for items matching the given text.
+		 *
+		 * Looks up the items in all the channels whose title,
+		 * description, author or categories contain all the words of
+		 * the \em text, using the full-text index of the storage.
+		 * The results are ordered by relevance, most relevant first.
+		 *
+		 * The default implementation returns an empty list, meaning
+		 * that the backend doesn't support searching.
+		 *
+		 * @param[in] text The text to search for.
+		 * @param[in] offset The number of most relevant results to
+		 * skip.
+		 * @param[in] limit The maximum number of results to return.
+		 * @return Short information about the found items.
+		 */
+		virtual items_shorts_t SearchItems (const QString& text, int offset, int limit) const;
+
+		/** @brief Starts indexing the items not covered by the
+		 * full-text index yet.
+		 *
+		 * The indexing is done in batches from the event loop of the
+		 * thread this backend lives in, so it is only started by the
+		 * database update thread.
+		 *
+		 * The default implementation does nothing.
+		 *
+		 * @sa SearchItems()
+		 */
+		virtual void StartTextIndexBackfill ();
+
 		/** @brief Searches for highest id of given type in the database
 		 *
 		 * @param[in] type of id to find
@@ -210,6 +210,8 @@ namespace Azoth
 				SLOT (handleChatWindowSearch (QString)));
 
 		DummyMsgManager::Instance ().ClearMessages (GetCLEntry ());
+		MessagesLimit_ = XmlSettingsManager::Instance ()
+				.property ("ChatViewMessagesLimit").toInt ();
 		PrepareTheme ();
 
 		auto entry = GetEntry<ICLEntry> ();
@@ -284,6 +286,7 @@ namespace Azoth
 				</html>)delim")
 					.arg (tr ("Unable to load style, please check you've enabled at least one styles plugin."));
 
+		Ui_.View_->page ()->mainFrame ()->setProperty ("Azoth/MessagesLimit", MessagesLimit_);
 		Ui_.View_->setContent (data.toUtf8 (),
 				"text/html", //"application/xhtml+xml" fails to work, though better to use it
 				Core::Instance ().GetSelectedChatTemplateURL (entry));
@@ -729,29 +732,20 @@ namespace Azoth
 
 	void ChatTab::on_View__loadFinished (bool)
 	{
-		for (const auto msg : HistoryMessages_)
+		auto messages = GetViewMessages ();
+		if (MessagesLimit_ > 0 && messages.size () > MessagesLimit_)
+			messages = messages.mid (messages.size () - MessagesLimit_);
+
+		for (const auto msg : messages)
 			AppendMessage (msg);
 
-		ICLEntry *e = GetEntry<ICLEntry> ();
-		if (!e)
+		if (!GetEntry<ICLEntry> ())
 		{
 			qWarning () << Q_FUNC_INFO
 					<< "null entry";
 			return;
 		}
 
-		auto messages = e->GetAllMessages ();
-
-		const auto& dummyMsgs = DummyMsgManager::Instance ().GetIMessages (e->GetQObject ());
-		if (!dummyMsgs.isEmpty ())
-		{
-			messages += dummyMsgs;
-			std::sort (messages.begin (), messages.end (), Util::ComparingBy (&IMessage::GetDateTime));
-		}
-
-		for (const auto msg : messages)
-			AppendMessage (msg);
-
 		QFile scrollerJS (":/plugins/azoth/resources/scripts/scrollers.js");
 		if (!scrollerJS.open (QIODevice::ReadOnly))
 			qWarning () << Q_FUNC_INFO
@@ -826,8 +820,6 @@ namespace Azoth
 		if (!entry)
 			return;
 
-		ScrollbackPos_ = 0;
-
 		const auto grace = XmlSettingsManager::Instance ()
 				.property ("ChatClearGraceTime").toInt ();
 		const auto& upTo = grace ? QDateTime::currentDateTime ().addSecs (-grace) : QDateTime {};
@@ -839,19 +831,47 @@ namespace Azoth
 		CoreMessages_.clear ();
 		DummyMsgManager::Instance ().ClearMessages (GetCLEntry ());
 		LastDateTime_ = QDateTime ();
+		MessagesLimit_ = XmlSettingsManager::Instance ()
+				.property ("ChatViewMessagesLimit").toInt ();
 		PrepareTheme ();
 	}
 
 	void ChatTab::handleHistoryBack ()
 	{
-		ScrollbackPos_ += 50;
-		qDeleteAll (HistoryMessages_);
-		HistoryMessages_.clear ();
-		qDeleteAll (CoreMessages_);
-		CoreMessages_.clear ();
+		const int scrollbackStep = 50;
+
 		DummyMsgManager::Instance ().ClearMessages (GetCLEntry ());
-		LastDateTime_ = QDateTime ();
-		RequestLogs (ScrollbackPos_);
+
+		// Bring back the messages dropped from the view first, if any,
+		// and only go to the history once all of them are shown.
+		if (MessagesLimit_ > 0)
+		{
+			const auto wasShown = MessagesLimit_;
+			MessagesLimit_ += scrollbackStep;
+			if (GetViewMessages ().size () > wasShown)
+			{
+				qDeleteAll (CoreMessages_);
+				CoreMessages_.clear ();
+				LastDateTime_ = QDateTime ();
+				PrepareTheme ();
+				return;
+			}
+		}
+
+		QDateTime oldest;
+		if (!HistoryMessages_.isEmpty ())
+			oldest = HistoryMessages_.first ()->GetDateTime ();
+		else if (const auto entry = GetEntry<ICLEntry> ())
+		{
+			const auto& msgs = entry->GetAllMessages ();
+			if (!msgs.isEmpty ())
+				oldest = msgs.first ()->GetDateTime ();
+		}
+
+		if (!oldest.isValid ())
+			oldest = QDateTime::currentDateTime ();
+
+		RequestLogs (scrollbackStep, oldest);
 	}
 
 	namespace
@@ -1328,6 +1348,7 @@ namespace Azoth
 		auto rMsgs = entry->GetAllMessages ();
 		std::reverse (rMsgs.begin (), rMsgs.end ());
 
+		bool changed = false;
 		for (const auto msgObj : messages)
 		{
 			const auto msg = qobject_cast<IMessage*> (msgObj);
@@ -1340,7 +1361,25 @@ namespace Azoth
 								tMsg->GetBody () == msg->GetBody () &&
 								std::abs (tMsg->GetDateTime ().secsTo (msg->GetDateTime ())) < 5;
 					}))
+			{
+				delete msgObj;
+				continue;
+			}
+
+			// Scrollback pages overlap on the boundary message(s).
+			if (std::any_of (HistoryMessages_.begin (), HistoryMessages_.end (),
+					[msg, &dt] (IMessage *hMsg)
+					{
+						return hMsg->GetDateTime () == dt &&
+								hMsg->GetDirection () == msg->GetDirection () &&
+								hMsg->GetBody () == msg->GetBody ();
+					}))
+			{
+				delete msgObj;
 				continue;
+			}
+
+			changed = true;
 
 			if (HistoryMessages_.isEmpty () ||
 					HistoryMessages_.last ()->GetDateTime () <= dt)
@@ -1353,8 +1392,13 @@ namespace Azoth
 			}
 		}
 
-		if (!messages.isEmpty ())
+		if (changed)
+		{
+			qDeleteAll (CoreMessages_);
+			CoreMessages_.clear ();
+			LastDateTime_ = QDateTime ();
 			PrepareTheme ();
+		}
 
 		disconnect (sender (),
 				SIGNAL (gotLastMessages (QObject*, const QList<QObject*>&)),
@@ -1778,7 +1822,28 @@ namespace Azoth
 				this, "handleMinLinesHeightChanged");
 	}
 
-	void ChatTab::RequestLogs (int num)
+	QList<IMessage*> ChatTab::GetViewMessages ()
+	{
+		auto messages = HistoryMessages_;
+
+		const auto e = GetEntry<ICLEntry> ();
+		if (!e)
+			return messages;
+
+		auto entryMessages = e->GetAllMessages ();
+
+		const auto& dummyMsgs = DummyMsgManager::Instance ().GetIMessages (e->GetQObject ());
+		if (!dummyMsgs.isEmpty ())
+		{
+			entryMessages += dummyMsgs;
+			std::sort (entryMessages.begin (), entryMessages.end (),
+					Util::ComparingBy (&IMessage::GetDateTime));
+		}
+
+		return messages + entryMessages;
+	}
+
+	void ChatTab::RequestLogs (int num, const QDateTime& before)
 	{
 		ICLEntry *entry = GetEntry<ICLEntry> ();
 		if (!entry)
@@ -1805,7 +1870,10 @@ namespace Azoth
 					SLOT (handleGotLastMessages (QObject*, const QList<QObject*>&)),
 					Qt::UniqueConnection);
 
-			hist->RequestLastMessages (entryObj, num);
+			if (before.isValid ())
+				hist->RequestMessagesBefore (entryObj, before, num);
+			else
+				hist->RequestLastMessages (entryObj, num);
 		}
 	}
 
@@ -100,11 +100,11 @@ namespace Azoth
 
 		bool HadHighlight_ = false;
 		int NumUnreadMsgs_ = 0;
-		int ScrollbackPos_ = 0;
 
 		QList<IMessage*> HistoryMessages_;
 		QDateTime LastDateTime_;
 		QList<CoreMessage*> CoreMessages_;
+		int MessagesLimit_ = 0;
 
 		QIcon TabIcon_;
 		bool IsMUC_ = false;
@@ -248,7 +248,8 @@ namespace Azoth
 		void InitMsgEdit ();
 		void RegisterSettings ();
 
-		void RequestLogs (int);
+		QList<IMessage*> GetViewMessages ();
+		void RequestLogs (int, const QDateTime& = {});
 
 		void UpdateTextHeight ();
 
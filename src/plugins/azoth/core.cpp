@@ -40,6 +40,7 @@
 #include <QStringListModel>
 #include <QMessageBox>
 #include <QClipboard>
+#include <QTimer>
 #include <QtDebug>
 #include <util/util.h>
 #include <util/xpc/util.h>
@@ -1404,15 +1405,12 @@ namespace Azoth
 
 	void Core::RecalculateOnlineForCat (QStandardItem *catItem)
 	{
-		int result = 0;
-		for (int i = 0; i < catItem->rowCount (); ++i)
-		{
-			auto entryObj = catItem->child (i)->
-					data (CLREntryObject).value<QObject*> ();
-			result += qobject_cast<ICLEntry*> (entryObj)->GetStatus ().State_ != SOffline;
-		}
+		if (PendingOnlineRecalcs_.isEmpty ())
+			QTimer::singleShot (0,
+					this,
+					SLOT (recalculatePendingOnline ()));
 
-		catItem->setData (result, CLRNumOnline);
+		PendingOnlineRecalcs_ << QPersistentModelIndex { catItem->index () };
 	}
 
 	void Core::HandlePowerNotification (Entity e)
@@ -2358,6 +2356,30 @@ namespace Azoth
 		RIEX::HandleRIEXItemsSuggested (items, from, message);
 	}
 
+	void Core::recalculatePendingOnline ()
+	{
+		const auto pending = PendingOnlineRecalcs_;
+		PendingOnlineRecalcs_.clear ();
+
+		for (const auto& idx : pending)
+		{
+			if (!idx.isValid ())
+				continue;
+
+			const auto catItem = CLModel_->itemFromIndex (idx);
+
+			int result = 0;
+			for (int i = 0; i < catItem->rowCount (); ++i)
+			{
+				auto entryObj = catItem->child (i)->
+						data (CLREntryObject).value<QObject*> ();
+				result += qobject_cast<ICLEntry*> (entryObj)->GetStatus ().State_ != SOffline;
+			}
+
+			catItem->setData (result, CLRNumOnline);
+		}
+	}
+
 	void Core::invalidateSmoothAvatarCache (QObject *entryObj)
 	{
 		const auto entry = qobject_cast<ICLEntry*> (entryObj);
@@ -36,6 +36,7 @@
 #include <QIcon>
 #include <QDateTime>
 #include <QUrl>
+#include <QPersistentModelIndex>
 #include <interfaces/core/ihookproxy.h>
 #include <interfaces/an/ianemitter.h>
 #include <interfaces/iinfo.h>
@@ -122,6 +123,8 @@ namespace Azoth
 
 		AnimatedIconManager<QStandardItem*> *ItemIconManager_;
 
+		QSet<QPersistentModelIndex> PendingOnlineRecalcs_;
+
 		QMap<State, int> StateCounter_;
 
 		std::shared_ptr<SourceTrackingModel<IEmoticonResourceSource>> SmilesOptionsModel_;
@@ -333,6 +336,11 @@ namespace Azoth
 		 */
 		void RecalculateUnreadForParents (QStandardItem*);
 
+		/** Schedules recalculating the number of online entries in the
+		 * given category. The recalculations are coalesced till the next
+		 * event loop iteration, so a presence storm in a large category
+		 * rescans it just once.
+		 */
 		void RecalculateOnlineForCat (QStandardItem*);
 
 		void HandlePowerNotification (Entity);
@@ -465,6 +473,8 @@ namespace Azoth
 		void handleRIEXItemsSuggested (QList<LeechCraft::Azoth::RIEXItem>, QObject*, QString);
 
 		void invalidateSmoothAvatarCache (QObject*);
+
+		void recalculatePendingOnline ();
 	signals:
 		void gotEntity (const LeechCraft::Entity&);
 		void delegateEntity (const LeechCraft::Entity&, int*, QObject**);
@@ -122,6 +122,17 @@ namespace Azoth
 		 * This function is called whenever a new message should be
 		 * appended to the chat view located in the given frame.
 		 *
+		 * The implementation is free to defer the actual DOM update
+		 * for a short while to coalesce several messages arriving in
+		 * a row into a single insertion.
+		 *
+		 * The chat window may set the <code>Azoth/MessagesLimit</code>
+		 * dynamic property on the frame. If it is positive, the
+		 * implementation is expected to drop the oldest messages from
+		 * the view so that no more than this many of them are kept.
+		 * Styles grouping consecutive messages may count each group as
+		 * a single message.
+		 *
 		 * @param[in] frame The chat view frame.
 		 * @param[in] message The message to be appended.
 		 * @param[in] info Additional chat message info structure.
@@ -119,6 +119,31 @@ namespace Azoth
 		 */
 		virtual void RequestLastMessages (QObject *entry, int num) = 0;
 
+		/** @brief Requests messages older than the given moment.
+		 *
+		 * This method requests up to num latest messages from the chat
+		 * log with the entry that are not newer than \em before. This
+		 * is used to scroll back in the history page by page, and the
+		 * implementation is expected to make the cost of this call
+		 * independent of how old \em before is.
+		 *
+		 * The messages with the date equal to \em before may be
+		 * returned as well, so the caller should be ready to skip the
+		 * messages it already has.
+		 *
+		 * Like RequestLastMessages(), this method is asynchronous, and
+		 * the result is expected to be emitted via the
+		 * gotLastMessages() signal.
+		 *
+		 * @param[in] entry The entry for which to query the history
+		 * (implements ICLEntry).
+		 * @param[in] before The upper bound of the messages dates.
+		 * @param[in] num The maximum number of messages to retrieve.
+		 *
+		 * @sa RequestLastMessages(), gotLastMessages()
+		 */
+		virtual void RequestMessagesBefore (QObject *entry, const QDateTime& before, int num) = 0;
+
 		using MaxTimestampResult_t = Util::Either<QString, QDateTime>;
 
 		virtual QFuture<MaxTimestampResult_t> RequestMaxTimestamp (IAccount *acc) = 0;
@@ -142,7 +167,8 @@ namespace Azoth
 		 *
 		 * This signal should be emitted when last chat messages with
 		 * the given entry have been retrieved from the history as the
-		 * result of the call to RequestLastMessages().
+		 * result of the call to RequestLastMessages() or
+		 * RequestMessagesBefore().
 		 *
 		 * If there are no messages for the entry, the implementation
 		 * may either emit this signal with empty messages list or
@@ -150,7 +176,7 @@ namespace Azoth
 		 *
 		 * @note This function is expected to be a signal.
 		 *
-		 * @sa RequestLastMessages()
+		 * @sa RequestLastMessages(), RequestMessagesBefore()
 		 */
 		virtual void gotLastMessages (QObject *entry, const QList<QObject*>& messages) = 0;
 	};
@@ -158,4 +184,4 @@ namespace Azoth
 }
 
 Q_DECLARE_INTERFACE (LeechCraft::Azoth::IHistoryPlugin,
-		"org.Deviant.LeechCraft.Azoth.IHistoryPlugin/1.0")
+		"org.Deviant.LeechCraft.Azoth.IHistoryPlugin/1.1")
@@ -0,0 +1,237 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "irclinetokenizer.h"
+
+namespace LeechCraft
+{
+namespace Azoth
+{
+namespace Acetamide
+{
+	const int IrcLineTokens::MaxMiddleParams;
+
+	namespace
+	{
+		int IndexOf (const char *data, int pos, int end, char ch)
+		{
+			for (; pos < end; ++pos)
+				if (data [pos] == ch)
+					return pos;
+			return -1;
+		}
+
+		int SkipSpaces (const char *data, int pos, int end)
+		{
+			while (pos < end && data [pos] == ' ')
+				++pos;
+			return pos;
+		}
+
+		int TokenEnd (const char *data, int pos, int end)
+		{
+			const auto space = IndexOf (data, pos, end, ' ');
+			return space >= 0 ? space : end;
+		}
+
+		bool IsAlpha (char ch)
+		{
+			return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+		}
+
+		bool IsDigit (char ch)
+		{
+			return ch >= '0' && ch <= '9';
+		}
+
+		bool IsValidCommand (const char *data, const IrcSlice& cmd)
+		{
+			if (cmd.IsEmpty ())
+				return false;
+
+			if (IsDigit (data [cmd.Begin_]))
+				return cmd.Size () == 3 &&
+						IsDigit (data [cmd.Begin_ + 1]) &&
+						IsDigit (data [cmd.Begin_ + 2]);
+
+			for (auto i = cmd.Begin_; i < cmd.End_; ++i)
+				if (!IsAlpha (data [i]))
+					return false;
+			return true;
+		}
+
+		void SplitPrefix (const char *data, IrcLineTokens& tokens)
+		{
+			const auto& prefix = tokens.Prefix_;
+
+			const auto at = IndexOf (data, prefix.Begin_, prefix.End_, '@');
+			const auto bang = IndexOf (data, prefix.Begin_, at >= 0 ? at : prefix.End_, '!');
+
+			if (at < 0 && bang < 0)
+			{
+				tokens.Nick_ = prefix;
+				tokens.Host_ = prefix;
+				return;
+			}
+
+			const auto userEnd = at >= 0 ? at : prefix.End_;
+			tokens.Nick_ = { prefix.Begin_, bang >= 0 ? bang : userEnd };
+			if (bang >= 0)
+				tokens.User_ = { bang + 1, userEnd };
+			if (at >= 0)
+				tokens.Host_ = { at + 1, prefix.End_ };
+		}
+	}
+
+	bool TokenizeIrcLine (const QByteArray& line, IrcLineTokens& tokens)
+	{
+		tokens = IrcLineTokens {};
+
+		const auto data = line.constData ();
+		auto end = line.size ();
+		while (end > 0 && (data [end - 1] == '\n' || data [end - 1] == '\r'))
+			--end;
+
+		int pos = 0;
+
+		if (pos < end && data [pos] == '@')
+		{
+			const auto tagsEnd = IndexOf (data, pos + 1, end, ' ');
+			if (tagsEnd < 0)
+				return false;
+
+			tokens.Tags_ = { pos + 1, tagsEnd };
+			pos = SkipSpaces (data, tagsEnd, end);
+		}
+
+		if (pos < end && data [pos] == ':')
+		{
+			const auto prefixEnd = IndexOf (data, pos + 1, end, ' ');
+			if (prefixEnd <= pos + 1)
+				return false;
+
+			tokens.Prefix_ = { pos + 1, prefixEnd };
+			SplitPrefix (data, tokens);
+			pos = SkipSpaces (data, prefixEnd, end);
+		}
+
+		tokens.Command_ = { pos, TokenEnd (data, pos, end) };
+		if (!IsValidCommand (data, tokens.Command_))
+			return false;
+
+		pos = tokens.Command_.End_;
+		while ((pos = SkipSpaces (data, pos, end)) < end)
+		{
+			if (data [pos] == ':' ||
+					tokens.ParamsCount_ == IrcLineTokens::MaxMiddleParams)
+			{
+				const auto begin = data [pos] == ':' ? pos + 1 : pos;
+				tokens.Trailing_ = { begin, end };
+				tokens.HasTrailing_ = true;
+				break;
+			}
+
+			const IrcSlice param { pos, TokenEnd (data, pos, end) };
+			tokens.Params_ [tokens.ParamsCount_++] = param;
+			pos = param.End_;
+		}
+
+		return true;
+	}
+
+	bool FindIrcTag (const QByteArray& line, const IrcSlice& tags,
+			const QByteArray& key, IrcSlice& value)
+	{
+		const auto data = line.constData ();
+
+		auto pos = tags.Begin_;
+		while (pos < tags.End_)
+		{
+			const auto semicolon = IndexOf (data, pos, tags.End_, ';');
+			const auto tagEnd = semicolon >= 0 ? semicolon : tags.End_;
+			const auto eq = IndexOf (data, pos, tagEnd, '=');
+			const auto keyEnd = eq >= 0 ? eq : tagEnd;
+
+			if (keyEnd - pos == key.size () &&
+					!qstrncmp (data + pos, key.constData (), key.size ()))
+			{
+				value = eq >= 0 ?
+						IrcSlice { eq + 1, tagEnd } :
+						IrcSlice { tagEnd, tagEnd };
+				return true;
+			}
+
+			pos = tagEnd + 1;
+		}
+
+		return false;
+	}
+
+	QByteArray UnescapeIrcTagValue (const QByteArray& line, const IrcSlice& value)
+	{
+		const auto data = line.constData ();
+
+		QByteArray result;
+		result.reserve (value.Size ());
+		for (auto i = value.Begin_; i < value.End_; ++i)
+		{
+			const auto ch = data [i];
+			if (ch != '\\')
+			{
+				result += ch;
+				continue;
+			}
+
+			if (++i == value.End_)
+				break;
+
+			switch (data [i])
+			{
+			case ':':
+				result += ';';
+				break;
+			case 's':
+				result += ' ';
+				break;
+			case 'r':
+				result += '\r';
+				break;
+			case 'n':
+				result += '\n';
+				break;
+			default:
+				result += data [i];
+				break;
+			}
+		}
+		return result;
+	}
+}
+}
+}
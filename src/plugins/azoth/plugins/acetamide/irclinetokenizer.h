@@ -0,0 +1,133 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <array>
+#include <QByteArray>
+
+namespace LeechCraft
+{
+namespace Azoth
+{
+namespace Acetamide
+{
+	/** @brief A [Begin_, End_) range of bytes in a raw IRC line.
+	 *
+	 * Slices don't own any data and are only meaningful together with
+	 * the line they have been produced from.
+	 */
+	struct IrcSlice
+	{
+		int Begin_ = 0;
+		int End_ = 0;
+
+		bool IsEmpty () const
+		{
+			return Begin_ == End_;
+		}
+
+		int Size () const
+		{
+			return End_ - Begin_;
+		}
+	};
+
+	/** @brief The tokens of a single IRC line.
+	 *
+	 * The line is split according to RFC 1459 with the IRCv3 message
+	 * tags extension. None of the fields are decoded or copied.
+	 */
+	struct IrcLineTokens
+	{
+		/** RFC 1459 allows at most 15 parameters, the last of which
+		 * is stored in Trailing_.
+		 */
+		static const int MaxMiddleParams = 14;
+
+		/** The raw IRCv3 tags, without the leading '@'.
+		 */
+		IrcSlice Tags_;
+
+		/** The whole prefix, without the leading ':'.
+		 */
+		IrcSlice Prefix_;
+
+		/** The nickname (or the server name) from the prefix.
+		 */
+		IrcSlice Nick_;
+		IrcSlice User_;
+		IrcSlice Host_;
+
+		IrcSlice Command_;
+
+		std::array<IrcSlice, MaxMiddleParams> Params_;
+		int ParamsCount_ = 0;
+
+		/** The trailing parameter, without the leading ':'.
+		 */
+		IrcSlice Trailing_;
+		bool HasTrailing_ = false;
+	};
+
+	/** @brief Splits the raw IRC \em line into tokens.
+	 *
+	 * The trailing CR/LF characters, if any, are ignored.
+	 *
+	 * @param[in] line The raw line as received from the server.
+	 * @param[out] tokens The tokens of the line.
+	 * @return Whether the line is a well-formed IRC message.
+	 */
+	bool TokenizeIrcLine (const QByteArray& line, IrcLineTokens& tokens);
+
+	/** @brief Looks up the IRCv3 tag \em key among the \em tags.
+	 *
+	 * @param[in] line The line the tags have been tokenized from.
+	 * @param[in] tags The tags slice as returned by TokenizeIrcLine().
+	 * @param[in] key The name of the tag, including the vendor prefix
+	 * if any.
+	 * @param[out] value The still escaped value of the tag, empty if
+	 * the tag has no value.
+	 * @return Whether the tag is present.
+	 *
+	 * @sa UnescapeIrcTagValue()
+	 */
+	bool FindIrcTag (const QByteArray& line, const IrcSlice& tags,
+			const QByteArray& key, IrcSlice& value);
+
+	/** @brief Unescapes the IRCv3 tag value.
+	 *
+	 * @param[in] line The line the value has been tokenized from.
+	 * @param[in] value The escaped value as returned by FindIrcTag().
+	 * @return The unescaped value.
+	 */
+	QByteArray UnescapeIrcTagValue (const QByteArray& line, const IrcSlice& value);
+}
+}
+}
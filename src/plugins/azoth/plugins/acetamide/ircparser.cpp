@@ -28,13 +28,10 @@
  **********************************************************************/
 
 #include "ircparser.h"
-#include <boost/bind.hpp>
-#include <boost/spirit/include/classic_core.hpp>
-#include <boost/spirit/include/classic_loops.hpp>
-#include <boost/spirit/include/classic_push_back_actor.hpp>
 #include <QTextCodec>
 #include <util/sll/prelude.h>
 #include "ircaccount.h"
+#include "irclinetokenizer.h"
 #include "ircserverhandler.h"
 
 namespace LeechCraft
@@ -43,8 +40,6 @@ namespace Azoth
 {
 namespace Acetamide
 {
-	using namespace boost::spirit::classic;
-
 	IrcParser::IrcParser (IrcServerHandler *sh)
 	: QObject (sh)
 	, ISH_ (sh)
@@ -416,77 +411,42 @@ namespace Acetamide
 
 	bool IrcParser::ParseMessage (const QByteArray& message)
 	{
-		const auto& msg = GetCodec ()->toUnicode (message);
-
-		IrcMessageOptions_.Command_.clear ();
-		IrcMessageOptions_.Nick_.clear ();
-		IrcMessageOptions_.Message_.clear ();
-		IrcMessageOptions_.Parameters_.clear ();
-		IrcMessageOptions_.UserName_.clear ();
-		IrcMessageOptions_.Host_.clear ();
-
-		std::string nickStr;
-		std::string userStr;
-		std::string hostStr;
-		std::string commandStr;
-		std::string msgStr;
-		QList<std::string> opts;
-
-		range<> ascii (char (0x01), char (0x7F));
-		rule<> special = lexeme_d [ch_p ('[') | ']' | '\\' | '`' |
-				'_' | '^' | '{' | '|' | '}'];
-		rule<> shortname = *(alnum_p
-				>> *(alnum_p || ch_p ('-'))
-				>> *alnum_p);
-		rule<> hostname = (shortname
-				>> *(ch_p ('.')
-				>> shortname)) [assign_a (hostStr)];
-		rule<> nickname = (alpha_p | special)
-				>> *(alnum_p | special | ch_p ('-'));
-		rule<> user =  +(ascii - '\r' - '\n' - ' ' - '@' - '\0');
-		rule<> host = lexeme_d [+(anychar_p - ' ')] ;
-		rule<> nick = lexeme_d [nickname [assign_a (nickStr)]
-				>> !(!(ch_p ('!')
-				>> user [assign_a (userStr)])
-				>> ch_p ('@')
-				>> host [assign_a (hostStr)])];
-		rule<> nospcrlfcl = (anychar_p - '\0' - '\r' - '\n' -
-				' ' - ':');
-		rule<> lastParam = lexeme_d [ch_p (' ')
-				>> !ch_p (':')
-				>> (*(ch_p (':') | ch_p (' ') | nospcrlfcl))
-					[assign_a (msgStr)]];
-		rule<> firsParam = lexeme_d [ch_p (' ')
-				>> (nospcrlfcl
-				>> *(ch_p (':') | nospcrlfcl))
-					[push_back_a (opts)]];
-		rule<> params =  *firsParam
-				>> !lastParam;
-		rule<> command = longest_d [(+alpha_p) |
-				(repeat_p (3) [digit_p])] [assign_a (commandStr)];
-		rule<> prefix = longest_d [hostname | nick];
-		rule<> reply = (lexeme_d [!(ch_p (':')
-				>> prefix >> ch_p (' '))]
-				>> command
-				>> !params
-				>> eol_p);
-
-		bool res = parse (msg.toUtf8 ().constData (), reply).full;
-
-		if (!res)
+		IrcMessageOptions_ = IrcMessageOptions {};
+
+		IrcLineTokens tokens;
+		if (!TokenizeIrcLine (message, tokens))
 		{
-			qWarning () << "input string is not a valide IRC command"
-					<< msg;
+			qWarning () << Q_FUNC_INFO
+					<< "input string is not a valid IRC command"
+					<< message;
 			return false;
 		}
-		else
+
+		const auto codec = GetCodec ();
+		const auto data = message.constData ();
+		const auto decode = [codec, data] (const IrcSlice& slice)
+		{
+			return slice.IsEmpty () ?
+					QString {} :
+					codec->toUnicode (data + slice.Begin_, slice.Size ());
+		};
+
+		IrcMessageOptions_.Nick_ = decode (tokens.Nick_);
+		IrcMessageOptions_.UserName_ = decode (tokens.User_);
+		IrcMessageOptions_.Host_ = decode (tokens.Host_);
+		IrcMessageOptions_.Command_ = QString::fromLatin1 (data + tokens.Command_.Begin_,
+				tokens.Command_.Size ()).toLower ();
+		IrcMessageOptions_.Message_ = decode (tokens.Trailing_);
+
+		// The handlers expect UTF-8 here, which is what most of the
+		// servers send anyway, so there is nothing to recode then.
+		const bool isUtf8 = codec->name () == "UTF-8";
+		for (int i = 0; i < tokens.ParamsCount_; ++i)
 		{
-			IrcMessageOptions_.Nick_ = QString::fromUtf8 (nickStr.c_str ());
-			IrcMessageOptions_.Command_ = QString::fromUtf8 (commandStr.c_str ()).toLower ();
-			IrcMessageOptions_.Message_ = QString::fromUtf8 (msgStr.c_str ());
-			IrcMessageOptions_.UserName_ = QString::fromUtf8 (userStr.c_str ());
-			IrcMessageOptions_.Host_ = QString::fromUtf8 (hostStr.c_str ());
-			IrcMessageOptions_.Parameters_ = opts;
+			const auto& param = tokens.Params_ [i];
+			IrcMessageOptions_.Parameters_ << (isUtf8 ?
+					std::string (data + param.Begin_, param.Size ()) :
+					decode (param).toStdString ());
 		}
 
 		return true;
@@ -99,7 +99,8 @@ namespace Acetamide
 		void ChanModeCommand (const QStringList&);
 		void ChannelsListCommand (const QStringList&);
 
-		/** Automatically converts the \em ba to UTF-8.
+		/** Tokenizes the \em ba and decodes the resulting fields
+		 * using the server encoding.
 		 */
 		bool ParseMessage (const QByteArray& ba);
 		IrcMessageOptions GetIrcMessageOptions () const;
@@ -0,0 +1,229 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "irclinetokenizertest.h"
+#include <QtTest>
+#include "irclinetokenizer.cpp"
+
+QTEST_APPLESS_MAIN (LeechCraft::Azoth::Acetamide::IrcLineTokenizerTest)
+
+namespace LeechCraft
+{
+namespace Azoth
+{
+namespace Acetamide
+{
+	namespace
+	{
+		QByteArray Get (const QByteArray& line, const IrcSlice& slice)
+		{
+			return line.mid (slice.Begin_, slice.Size ());
+		}
+
+		QList<QByteArray> GetParams (const QByteArray& line, const IrcLineTokens& tokens)
+		{
+			QList<QByteArray> result;
+			for (int i = 0; i < tokens.ParamsCount_; ++i)
+				result << Get (line, tokens.Params_ [i]);
+			return result;
+		}
+	}
+
+	void IrcLineTokenizerTest::testServerPrefix ()
+	{
+		const QByteArray line { ":irc.example.net NOTICE * :*** Looking up your hostname\r\n" };
+
+		IrcLineTokens tokens;
+		QVERIFY (TokenizeIrcLine (line, tokens));
+		QCOMPARE (Get (line, tokens.Prefix_), QByteArray { "irc.example.net" });
+		QCOMPARE (Get (line, tokens.Nick_), QByteArray { "irc.example.net" });
+		QCOMPARE (Get (line, tokens.Host_), QByteArray { "irc.example.net" });
+		QVERIFY (tokens.User_.IsEmpty ());
+		QCOMPARE (Get (line, tokens.Command_), QByteArray { "NOTICE" });
+		QCOMPARE (GetParams (line, tokens), QList<QByteArray> { "*" });
+		QVERIFY (tokens.HasTrailing_);
+		QCOMPARE (Get (line, tokens.Trailing_), QByteArray { "*** Looking up your hostname" });
+	}
+
+	void IrcLineTokenizerTest::testUserPrefix ()
+	{
+		const QByteArray line { ":nick!~user@host.example.com PRIVMSG #chan :hello world\r\n" };
+
+		IrcLineTokens tokens;
+		QVERIFY (TokenizeIrcLine (line, tokens));
+		QCOMPARE (Get (line, tokens.Nick_), QByteArray { "nick" });
+		QCOMPARE (Get (line, tokens.User_), QByteArray { "~user" });
+		QCOMPARE (Get (line, tokens.Host_), QByteArray { "host.example.com" });
+		QCOMPARE (Get (line, tokens.Command_), QByteArray { "PRIVMSG" });
+		QCOMPARE (GetParams (line, tokens), QList<QByteArray> { "#chan" });
+		QCOMPARE (Get (line, tokens.Trailing_), QByteArray { "hello world" });
+	}
+
+	void IrcLineTokenizerTest::testNoPrefix ()
+	{
+		const QByteArray line { "PING :irc.example.net\r\n" };
+
+		IrcLineTokens tokens;
+		QVERIFY (TokenizeIrcLine (line, tokens));
+		QVERIFY (tokens.Prefix_.IsEmpty ());
+		QVERIFY (tokens.Nick_.IsEmpty ());
+		QCOMPARE (Get (line, tokens.Command_), QByteArray { "PING" });
+		QCOMPARE (tokens.ParamsCount_, 0);
+		QCOMPARE (Get (line, tokens.Trailing_), QByteArray { "irc.example.net" });
+	}
+
+	void IrcLineTokenizerTest::testNumeric ()
+	{
+		const QByteArray line { ":irc.example.net 353 me = #chan :@op +voice plain\r\n" };
+
+		IrcLineTokens tokens;
+		QVERIFY (TokenizeIrcLine (line, tokens));
+		QCOMPARE (Get (line, tokens.Command_), QByteArray { "353" });
+		QCOMPARE (GetParams (line, tokens), (QList<QByteArray> { "me", "=", "#chan" }));
+		QCOMPARE (Get (line, tokens.Trailing_), QByteArray { "@op +voice plain" });
+	}
+
+	void IrcLineTokenizerTest::testTrailingWithColons ()
+	{
+		const QByteArray line { ":a!b@c PRIVMSG #chan ::) see http://example.com:80\n" };
+
+		IrcLineTokens tokens;
+		QVERIFY (TokenizeIrcLine (line, tokens));
+		QCOMPARE (Get (line, tokens.Trailing_), QByteArray { ":) see http://example.com:80" });
+	}
+
+	void IrcLineTokenizerTest::testEmptyTrailing ()
+	{
+		const QByteArray line { ":a!b@c TOPIC #chan :\r\n" };
+
+		IrcLineTokens tokens;
+		QVERIFY (TokenizeIrcLine (line, tokens));
+		QVERIFY (tokens.HasTrailing_);
+		QVERIFY (tokens.Trailing_.IsEmpty ());
+		QCOMPARE (GetParams (line, tokens), QList<QByteArray> { "#chan" });
+	}
+
+	void IrcLineTokenizerTest::testMaxParams ()
+	{
+		const QByteArray line { "CMD 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16" };
+
+		IrcLineTokens tokens;
+		QVERIFY (TokenizeIrcLine (line, tokens));
+		QCOMPARE (tokens.ParamsCount_, IrcLineTokens::MaxMiddleParams);
+		QCOMPARE (Get (line, tokens.Trailing_), QByteArray { "15 16" });
+	}
+
+	void IrcLineTokenizerTest::testTags ()
+	{
+		const QByteArray line { "@time=2014-05-01T12:00:00.000Z;account=someone;solo "
+				":nick!user@host PRIVMSG #chan :hi\r\n" };
+
+		IrcLineTokens tokens;
+		QVERIFY (TokenizeIrcLine (line, tokens));
+		QCOMPARE (Get (line, tokens.Nick_), QByteArray { "nick" });
+		QCOMPARE (Get (line, tokens.Command_), QByteArray { "PRIVMSG" });
+
+		IrcSlice value;
+		QVERIFY (FindIrcTag (line, tokens.Tags_, "time", value));
+		QCOMPARE (Get (line, value), QByteArray { "2014-05-01T12:00:00.000Z" });
+		QVERIFY (FindIrcTag (line, tokens.Tags_, "account", value));
+		QCOMPARE (Get (line, value), QByteArray { "someone" });
+		QVERIFY (FindIrcTag (line, tokens.Tags_, "solo", value));
+		QVERIFY (value.IsEmpty ());
+		QVERIFY (!FindIrcTag (line, tokens.Tags_, "acc", value));
+	}
+
+	void IrcLineTokenizerTest::testTagsUnescape ()
+	{
+		const QByteArray line { "@msg=a\\sb\\:c\\\\d TAGMSG" };
+
+		IrcLineTokens tokens;
+		QVERIFY (TokenizeIrcLine (line, tokens));
+
+		IrcSlice value;
+		QVERIFY (FindIrcTag (line, tokens.Tags_, "msg", value));
+		QCOMPARE (UnescapeIrcTagValue (line, value), QByteArray { "a b;c\\d" });
+	}
+
+	void IrcLineTokenizerTest::testInvalid ()
+	{
+		IrcLineTokens tokens;
+		QVERIFY (!TokenizeIrcLine ("", tokens));
+		QVERIFY (!TokenizeIrcLine ("\r\n", tokens));
+		QVERIFY (!TokenizeIrcLine (":prefix.only\r\n", tokens));
+		QVERIFY (!TokenizeIrcLine (": PRIVMSG #chan :hi\r\n", tokens));
+		QVERIFY (!TokenizeIrcLine (":a 12 #chan\r\n", tokens));
+		QVERIFY (!TokenizeIrcLine (":a PRIV_MSG #chan\r\n", tokens));
+		QVERIFY (!TokenizeIrcLine ("@only=tags\r\n", tokens));
+	}
+
+	namespace
+	{
+		QList<QByteArray> GetNamesBurst ()
+		{
+			QList<QByteArray> lines;
+			for (int chan = 0; chan < 50; ++chan)
+			{
+				const auto& chanName = "#channel" + QByteArray::number (chan);
+				for (int i = 0; i < 40; ++i)
+				{
+					QByteArray names;
+					for (int j = 0; j < 25; ++j)
+					{
+						if (!(j % 5))
+							names += '@';
+						names += "user" + QByteArray::number (i * 25 + j) + ' ';
+					}
+					lines << ":irc.example.net 353 me = " + chanName + " :" + names + "\r\n";
+				}
+				for (int i = 0; i < 100; ++i)
+					lines << ":irc.example.net 352 me " + chanName + " ~ident host" +
+							QByteArray::number (i) + ".example.com irc.example.net user" +
+							QByteArray::number (i) + " H :0 Real Name\r\n";
+				lines << ":irc.example.net 366 me " + chanName + " :End of /NAMES list.\r\n";
+			}
+			return lines;
+		}
+	}
+
+	void IrcLineTokenizerTest::benchmarkNamesBurst ()
+	{
+		const auto& lines = GetNamesBurst ();
+
+		QBENCHMARK {
+			IrcLineTokens tokens;
+			volatile int params = 0;
+			for (const auto& line : lines)
+				if (TokenizeIrcLine (line, tokens))
+					params += tokens.ParamsCount_;
+		}
+	}
+}
+}
+}
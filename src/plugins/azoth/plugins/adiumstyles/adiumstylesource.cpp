@@ -397,6 +397,7 @@ namespace AdiumStyles
 
 		const QString& command = isNextMsg ? "appendNextMessage(\"%1\");" : "appendMessage(\"%1\");";
 		frame->evaluateJavaScript (command.arg (body));
+		TrimFrame (frame);
 
 		if (templ.contains ("%stateElementId%"))
 		{
@@ -429,6 +430,21 @@ namespace AdiumStyles
 		return true;
 	}
 
+	void AdiumStyleSource::TrimFrame (QWebFrame *frame)
+	{
+		const auto limit = frame->property ("Azoth/MessagesLimit").toInt ();
+		if (limit <= 0)
+			return;
+
+		// Consecutive messages are grouped into one top-level element
+		// of the #Chat node, and the template inserts the messages
+		// lazily, so the view may hold a few more messages than the
+		// limit for a while.
+		const auto& elems = frame->findAllElements ("#Chat > *");
+		for (int i = 0, excess = elems.count () - limit; i < excess; ++i)
+			elems.at (i).removeFromDocument ();
+	}
+
 	void AdiumStyleSource::FrameFocused (QWebFrame*)
 	{
 	}
@@ -90,6 +90,7 @@ namespace AdiumStyles
 		QString ParseMsgTemplate (QString templ, const QString& path,
 				QWebFrame*, QObject*, const ChatMsgAppendInfo&);
 		QString GetMessageID (QObject*);
+		void TrimFrame (QWebFrame*);
 	private slots:
 		void handleMessageDelivered ();
 		void handleMessageDestroyed ();
@@ -28,6 +28,7 @@
  **********************************************************************/
 
 #include "chathistory.h"
+#include <limits>
 #include <QDir>
 #include <QIcon>
 #include <QAction>
@@ -160,21 +161,18 @@ namespace ChatHistory
 
 	void Plugin::RequestLastMessages (QObject *entryObj, int num)
 	{
-		ICLEntry *entry = qobject_cast<ICLEntry*> (entryObj);
-		if (!entry)
+		RequestLogsBefore (entryObj, {}, num);
+	}
+
+	void Plugin::RequestMessagesBefore (QObject *entryObj, const QDateTime& before, int num)
+	{
+		if (!before.isValid ())
 		{
-			qWarning () << Q_FUNC_INFO
-					<< entryObj
-					<< "doesn't implement ICLEntry";
+			RequestLastMessages (entryObj, num);
 			return;
 		}
 
-		const auto account = entry->GetParentAccount ();
-		const QString& accId = account->GetAccountID ();
-		const QString& entryId = entry->GetEntryID ();
-		Util::Sequence (this, StorageMgr_->GetChatLogs (accId, entryId, 0, num)) >>
-				std::bind (&Plugin::HandleGotChatLogs,
-						this, QPointer<QObject> { entryObj }, std::placeholders::_1);
+		RequestLogsBefore (entryObj, { before, std::numeric_limits<qint64>::max () }, num);
 	}
 
 	QFuture<Plugin::MaxTimestampResult_t> Plugin::RequestMaxTimestamp (IAccount *acc)
@@ -282,6 +280,26 @@ namespace ChatHistory
 		StorageMgr_->Process (message);
 	}
 
+	void Plugin::RequestLogsBefore (QObject *entryObj, const HistoryCursor& cursor, int num)
+	{
+		ICLEntry *entry = qobject_cast<ICLEntry*> (entryObj);
+		if (!entry)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< entryObj
+					<< "doesn't implement ICLEntry";
+			return;
+		}
+
+		const auto account = entry->GetParentAccount ();
+		const QString& accId = account->GetAccountID ();
+		const QString& entryId = entry->GetEntryID ();
+		Util::Sequence (this,
+				StorageMgr_->GetChatLogs (accId, entryId, PageDirection::Before, cursor, num)) >>
+				std::bind (&Plugin::HandleGotChatLogs,
+						this, QPointer<QObject> { entryObj }, std::placeholders::_1);
+	}
+
 	void Plugin::HandleGotChatLogs (const QPointer<QObject>& entryObj,
 			const ChatLogsResult_t& result)
 	{
@@ -307,7 +325,7 @@ namespace ChatHistory
 				QObjectList ();
 
 		QList<QObject*> logs;
-		for (const auto& item : result.GetRight ())
+		for (const auto& item : result.GetRight ().Items_)
 		{
 			QObject *participantObj = nullptr;
 			for (auto part : parts)
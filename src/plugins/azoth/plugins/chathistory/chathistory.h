@@ -112,11 +112,13 @@ namespace ChatHistory
 		// IHistoryPlugin
 		bool IsHistoryEnabledFor (QObject*) const;
 		void RequestLastMessages (QObject*, int);
+		void RequestMessagesBefore (QObject*, const QDateTime&, int);
 		QFuture<MaxTimestampResult_t> RequestMaxTimestamp (IAccount*);
 		void AddRawMessages (const QString&, const QString&, const QString&, const QList<HistoryItem>&);
 	private:
 		void InitWidget (ChatHistoryWidget*);
 
+		void RequestLogsBefore (QObject*, const HistoryCursor&, int);
 		void HandleGotChatLogs (const QPointer<QObject>&, const ChatLogsResult_t&);
 	public slots:
 		void initPlugin (QObject*);
@@ -33,6 +33,7 @@
 #include <QMessageBox>
 #include <QShortcut>
 #include <QToolBar>
+#include <QListWidget>
 #include <util/xpc/util.h>
 #include <util/gui/clearlineeditaddon.h>
 #include <util/threads/futures.h>
@@ -53,6 +54,11 @@ namespace ChatHistory
 {
 	using namespace std::placeholders;
 
+	namespace
+	{
+		const int HitsPageSize = 50;
+	}
+
 	ChatHistoryWidget::ChatHistoryWidget (const InitParams& params, ICLEntry *entry, QWidget *parent)
 	: QWidget (parent)
 	, Params_ (params)
@@ -255,7 +261,8 @@ namespace ChatHistory
 	}
 
 	void ChatHistoryWidget::HandleGotChatLogs (const QString& accountId,
-			const QString& entryId, const ChatLogsResult_t& result)
+			const QString& entryId, PageDirection dir, bool isLatest,
+			Highlight highlight, const ChatLogsResult_t& result)
 	{
 		const auto& selEntry = Ui_.Contacts_->selectionModel ()->
 				currentIndex ().data (MRIDRole).toString ();
@@ -264,7 +271,19 @@ namespace ChatHistory
 				entryId != selEntry)
 			return;
 
-		Amount_ = 0;
+		if (const auto page = result.MaybeRight ())
+			if (page->Items_.isEmpty () && !isLatest)
+			{
+				// Nothing past the requested position: either there is
+				// nothing newer, so the latest page is the one to show,
+				// or we have just hit the oldest message already shown.
+				if (dir == PageDirection::After)
+					RequestLogs ();
+				else
+					IsOldestPage_ = true;
+				return;
+			}
+
 		Ui_.HistView_->clear ();
 
 		auto& formatter = Params_.PluginProxy_->GetFormatterProxy ();
@@ -296,10 +315,32 @@ namespace ChatHistory
 		const auto& bgColor = palette ().color (QPalette::Base);
 		const auto& colors = formatter.GenerateColors ("hash", bgColor);
 
+		const auto& page = result.GetRight ();
+		const auto& logs = page.Items_;
+
+		PageFirst_ = page.First_;
+		PageLast_ = page.Last_;
+		IsOldestPage_ = dir == PageDirection::Before && logs.size () < PerPageAmount_;
+		IsLatestPage_ = isLatest || (dir == PageDirection::After && logs.size () < PerPageAmount_);
+
+		int highlightIdx = -1;
+		switch (highlight)
+		{
+		case Highlight::None:
+			break;
+		case Highlight::First:
+			highlightIdx = 0;
+			break;
+		case Highlight::Last:
+			highlightIdx = logs.size () - 1;
+			break;
+		}
+
 		int scrollPos = -1;
 
-		for (const auto& logItem : result.GetRight ())
+		for (int i = 0; i < logs.size (); ++i)
 		{
+			const auto& logItem = logs.at (i);
 			const bool isChat = logItem.Type_ == IMessage::Type::ChatMessage;
 			const bool isIncoming = logItem.Dir_ == IMessage::Direction::In;
 
@@ -352,7 +393,7 @@ namespace ChatHistory
 
 			html += postNick + ' ' + msgText;
 
-			const bool isSearchRes = SearchResultPosition_ == PerPageAmount_ - ++Amount_;
+			const bool isSearchRes = i == highlightIdx;
 			if (isChat && !isSearchRes)
 			{
 				const auto& color = formatter.GetNickColor (isIncoming ? remoteName : ourName, colors);
@@ -379,11 +420,11 @@ namespace ChatHistory
 		}
 	}
 
-	void ChatHistoryWidget::HandleGotSearchPosition (const QString& accountId,
-			const QString& entryId, const SearchResult_t& result)
+	void ChatHistoryWidget::HandleGotSearchHits (const QString& text,
+			int offset, const SearchHitsResult_t& result)
 	{
-		if (accountId != CurrentAccount_ ||
-				entryId != CurrentEntry_)
+		if (text != PreviousSearchText_ ||
+				offset != Hits_.size ())
 			return;
 
 		if (const auto err = result.MaybeLeft ())
@@ -394,61 +435,28 @@ namespace ChatHistory
 			return;
 		}
 
-		const auto position = result.GetRight ();
+		const auto& hits = result.GetRight ();
+		if (hits.size () < HitsPageSize)
+			HitsExhausted_ = true;
 
-		if (!position)
+		if (hits.isEmpty ())
 		{
-			if (!(FindBox_->GetFlags () & ChatFindBox::FindWrapsAround) || !SearchShift_)
-				QMessageBox::warning (this,
-						"LeechCraft",
-						tr ("No more search results for %1.")
-							.arg ("<em>" + PreviousSearchText_ + "</em>"));
-			else
-			{
-				SearchShift_ = 0;
-
-				const auto& e = Util::MakeNotification ("Azoth ChatHistory",
-						tr ("No more search results for %1, searching from the beginning now.")
-							.arg ("<em>" + PreviousSearchText_ + "</em>"),
-						PInfo_);
-				Params_.CoreProxy_->GetEntityManager ()->HandleEntity (e);
-
-				RequestSearch (FindBox_->GetFlags ());
-			}
+			HandleNoMoreHits ();
 			return;
 		}
 
-		if (CurrentEntry_ != entryId)
+		Hits_ += hits;
+		for (const auto& hit : hits)
 		{
-			ContactSelectedAsGlobSearch_ = true;
-			CurrentEntry_ = entryId;
-			if (CurrentAccount_ == accountId)
-				for (int i = 0; i < ContactsModel_->rowCount (); ++i)
-				{
-					auto item = ContactsModel_->item (i);
-					if (item->data (MRIDRole) == CurrentEntry_)
-					{
-						Ui_.Contacts_->setCurrentIndex (item->index ());
-						break;
-					}
-				}
-		}
-		if (CurrentAccount_ != accountId)
-		{
-			ContactSelectedAsGlobSearch_ = true;
-			CurrentAccount_ = accountId;
-			for (int i = 0; i < Ui_.AccountBox_->count (); ++i)
-				if (accountId == Ui_.AccountBox_->itemData (i).toString ())
-				{
-					Ui_.AccountBox_->setCurrentIndex (i);
-					CurrentEntry_ = entryId;
-					break;
-				}
+			const auto& name = EntryID2NameCache_.value (hit.EntryID_, hit.EntryID_);
+			const auto item = new QListWidgetItem (QString::fromUtf8 ("[%1] %2: %3")
+						.arg (hit.Date_.toString (Qt::DefaultLocaleShortDate), name, hit.Snippet_));
+			item->setToolTip (hit.Snippet_);
+			Ui_.SearchHits_->addItem (item);
 		}
+		Ui_.SearchHits_->show ();
 
-		Backpages_ = *position / PerPageAmount_;
-		SearchResultPosition_ = *position % PerPageAmount_;
-		RequestLogs ();
+		RequestSearch (FindBox_->GetFlags ());
 	}
 
 	void ChatHistoryWidget::HandleGotDaysForSheet (const QString& accountId,
@@ -495,11 +503,11 @@ namespace ChatHistory
 		{
 			SearchShift_ = 0;
 			PreviousSearchText_.clear ();
-			Backpages_ = 0;
-			SearchResultPosition_ = -1;
+			ResetSearchHits ();
 		}
 		ContactSelectedAsGlobSearch_ = false;
 
+		ResetPages ();
 		ShowLoading ();
 
 		RequestLogs ();
@@ -519,12 +527,10 @@ namespace ChatHistory
 		ShowLoading ();
 
 		PreviousSearchText_.clear ();
+		ResetSearchHits ();
 		FindBox_->clear ();
 
-		Util::Sequence (this,
-				Params_.StorageMgr_->Search (CurrentAccount_, CurrentEntry_, QDateTime { date })) >>
-				std::bind (&ChatHistoryWidget::HandleGotSearchPosition,
-						this, CurrentAccount_, CurrentEntry_, _1);
+		RequestLogs (PageDirection::After, { QDateTime { date }, -1 }, Highlight::First);
 	}
 
 	void ChatHistoryWidget::handleNext (const QString& text, ChatFindBox::FindFlags flags)
@@ -534,16 +540,20 @@ namespace ChatHistory
 		if (text.isEmpty ())
 		{
 			PreviousSearchText_.clear ();
-			Backpages_ = 0;
-			SearchResultPosition_ = -1;
+			ResetSearchHits ();
 			RequestLogs ();
 			return;
 		}
 
-		if (text != PreviousSearchText_)
+		const bool cs = flags & ChatFindBox::FindCaseSensitively;
+		if (text != PreviousSearchText_ || cs != PreviousSearchCS_)
 		{
+			ResetSearchHits ();
 			SearchShift_ = 0;
 			PreviousSearchText_ = text;
+			PreviousSearchCS_ = cs;
+			SearchAccount_ = CurrentAccount_;
+			SearchEntry_ = CurrentEntry_;
 		}
 		else if (!(flags & ChatFindBox::FindBackwards))
 			++SearchShift_;
@@ -555,22 +565,18 @@ namespace ChatHistory
 
 	void ChatHistoryWidget::previousHistory ()
 	{
-		if (Amount_ < PerPageAmount_)
+		if (IsOldestPage_ || PageFirst_.IsNull ())
 			return;
 
-		++Backpages_;
-		SearchResultPosition_ = -1;
-		RequestLogs ();
+		RequestLogs (PageDirection::Before, PageFirst_);
 	}
 
 	void ChatHistoryWidget::nextHistory ()
 	{
-		if (Backpages_ <= 0)
+		if (IsLatestPage_ || PageLast_.IsNull ())
 			return;
 
-		--Backpages_;
-		SearchResultPosition_ = -1;
-		RequestLogs ();
+		RequestLogs (PageDirection::After, PageLast_);
 	}
 
 	void ChatHistoryWidget::clearHistory ()
@@ -594,7 +600,8 @@ namespace ChatHistory
 			ContactsModel_->removeRow (item->row ());
 		}
 
-		Backpages_ = 0;
+		ResetPages ();
+		ResetSearchHits ();
 		RequestLogs ();
 	}
 
@@ -605,6 +612,17 @@ namespace ChatHistory
 				FromUserInitiated | OnlyHandle));
 	}
 
+	void ChatHistoryWidget::on_SearchHits__itemActivated (QListWidgetItem *item)
+	{
+		const auto row = Ui_.SearchHits_->row (item);
+		if (row < 0 || row >= Hits_.size ())
+			return;
+
+		SearchShift_ = row;
+		ShowLoading ();
+		ShowSearchHit (row);
+	}
+
 	void ChatHistoryWidget::handleBgLinkRequested (const QUrl& url)
 	{
 		auto e = Util::MakeEntity (url,
@@ -650,23 +668,132 @@ namespace ChatHistory
 						this, CurrentAccount_, CurrentEntry_, year, month, _1);
 	}
 
-	void ChatHistoryWidget::RequestLogs ()
+	void ChatHistoryWidget::RequestLogs (PageDirection dir,
+			const HistoryCursor& cursor, Highlight highlight)
 	{
 		const auto& future = Params_.StorageMgr_->GetChatLogs (CurrentAccount_,
-				CurrentEntry_, Backpages_, PerPageAmount_);
+				CurrentEntry_, dir, cursor, PerPageAmount_);
 		Util::Sequence (this, future) >>
-				std::bind (&ChatHistoryWidget::HandleGotChatLogs, this, CurrentAccount_, CurrentEntry_, _1);
+				std::bind (&ChatHistoryWidget::HandleGotChatLogs,
+						this, CurrentAccount_, CurrentEntry_,
+						dir, cursor.IsNull (), highlight, _1);
+	}
+
+	void ChatHistoryWidget::ResetPages ()
+	{
+		PageFirst_ = {};
+		PageLast_ = {};
+		IsLatestPage_ = true;
+		IsOldestPage_ = false;
 	}
 
 	void ChatHistoryWidget::RequestSearch (ChatFindBox::FindFlags flags)
 	{
-		const auto& future = Params_.StorageMgr_->Search (CurrentAccount_, CurrentEntry_,
-				PreviousSearchText_, SearchShift_,
-				flags & ChatFindBox::FindCaseSensitively);
+		if (SearchShift_ < Hits_.size ())
+		{
+			ShowSearchHit (SearchShift_);
+			return;
+		}
+
+		if (HitsExhausted_)
+		{
+			HandleNoMoreHits ();
+			return;
+		}
+
+		const auto offset = Hits_.size ();
+		const auto& future = Params_.StorageMgr_->SearchHits (SearchAccount_, SearchEntry_,
+				PreviousSearchText_, flags & ChatFindBox::FindCaseSensitively,
+				offset, HitsPageSize);
 		Util::Sequence (this, future) >>
-				std::bind (&ChatHistoryWidget::HandleGotSearchPosition,
-						this, CurrentAccount_, CurrentEntry_, _1);
+				std::bind (&ChatHistoryWidget::HandleGotSearchHits,
+						this, PreviousSearchText_, offset, _1);
+	}
+
+	void ChatHistoryWidget::ResetSearchHits ()
+	{
+		Hits_.clear ();
+		HitsExhausted_ = false;
+
+		Ui_.SearchHits_->clear ();
+		Ui_.SearchHits_->hide ();
+	}
+
+	void ChatHistoryWidget::ShowSearchHit (int idx)
+	{
+		const auto& hit = Hits_.at (idx);
+
+		Ui_.SearchHits_->setCurrentRow (idx);
+
+		SelectEntry (hit.AccountID_, hit.EntryID_);
+
+		// The cursor is just past the hit, so the hit itself is the last
+		// message of the page and the page shows the context leading to it.
+		const HistoryCursor cursor { hit.Cursor_.Date_, hit.Cursor_.RowID_ + 1 };
+		RequestLogs (PageDirection::Before, cursor, Highlight::Last);
 	}
+
+	void ChatHistoryWidget::HandleNoMoreHits ()
+	{
+		if (!(FindBox_->GetFlags () & ChatFindBox::FindWrapsAround) || !SearchShift_)
+		{
+			QMessageBox::warning (this,
+					"LeechCraft",
+					tr ("No more search results for %1.")
+						.arg ("<em>" + PreviousSearchText_ + "</em>"));
+
+			if (!Hits_.isEmpty ())
+			{
+				SearchShift_ = Hits_.size () - 1;
+				ShowSearchHit (SearchShift_);
+			}
+			else
+				RequestLogs ();
+			return;
+		}
+
+		SearchShift_ = 0;
+
+		const auto& e = Util::MakeNotification ("Azoth ChatHistory",
+				tr ("No more search results for %1, searching from the beginning now.")
+					.arg ("<em>" + PreviousSearchText_ + "</em>"),
+				PInfo_);
+		Params_.CoreProxy_->GetEntityManager ()->HandleEntity (e);
+
+		RequestSearch (FindBox_->GetFlags ());
+	}
+
+	void ChatHistoryWidget::SelectEntry (const QString& accountId, const QString& entryId)
+	{
+		if (CurrentEntry_ != entryId)
+		{
+			ContactSelectedAsGlobSearch_ = true;
+			CurrentEntry_ = entryId;
+			if (CurrentAccount_ == accountId)
+				for (int i = 0; i < ContactsModel_->rowCount (); ++i)
+				{
+					auto item = ContactsModel_->item (i);
+					if (item->data (MRIDRole) == CurrentEntry_)
+					{
+						Ui_.Contacts_->setCurrentIndex (SortFilter_->mapFromSource (item->index ()));
+						break;
+					}
+				}
+		}
+		if (CurrentAccount_ != accountId)
+		{
+			ContactSelectedAsGlobSearch_ = true;
+			CurrentAccount_ = accountId;
+			for (int i = 0; i < Ui_.AccountBox_->count (); ++i)
+				if (accountId == Ui_.AccountBox_->itemData (i).toString ())
+				{
+					Ui_.AccountBox_->setCurrentIndex (i);
+					CurrentEntry_ = entryId;
+					break;
+				}
+		}
+	}
+}
 }
 }
 }
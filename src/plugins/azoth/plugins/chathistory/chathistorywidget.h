@@ -38,6 +38,7 @@
 class QStandardItemModel;
 class QStandardItem;
 class QSortFilterProxyModel;
+class QListWidgetItem;
 
 namespace LeechCraft
 {
@@ -77,14 +78,21 @@ namespace ChatHistory
 
 		QStandardItemModel *ContactsModel_;
 		QSortFilterProxyModel *SortFilter_;
-		int Backpages_ = 0;
-		int Amount_ = 0;
 		int SearchShift_ = 0;
-		int SearchResultPosition_ = -1;
 		bool ContactSelectedAsGlobSearch_ = false;
 		QString CurrentAccount_;
 		QString CurrentEntry_;
 		QString PreviousSearchText_;
+		bool PreviousSearchCS_ = false;
+		QString SearchAccount_;
+		QString SearchEntry_;
+		QList<SearchHit> Hits_;
+		bool HitsExhausted_ = false;
+
+		HistoryCursor PageFirst_;
+		HistoryCursor PageLast_;
+		bool IsLatestPage_ = true;
+		bool IsOldestPage_ = false;
 		QToolBar *Toolbar_;
 
 		QHash<QString, QString> EntryID2NameCache_;
@@ -97,6 +105,13 @@ namespace ChatHistory
 		{
 			MRIDRole = Qt::UserRole + 1
 		};
+
+		enum class Highlight
+		{
+			None,
+			First,
+			Last
+		};
 	public:
 		ChatHistoryWidget (const InitParams&, ICLEntry* = 0, QWidget* = 0);
 
@@ -108,8 +123,9 @@ namespace ChatHistory
 	private:
 		void HandleGotOurAccounts (const QStringList&);
 		void HandleGotUsersForAccount (const QString&, const UsersForAccountResult_t&);
-		void HandleGotChatLogs (const QString&, const QString&, const ChatLogsResult_t&);
-		void HandleGotSearchPosition (const QString&, const QString&, const SearchResult_t&);
+		void HandleGotChatLogs (const QString&, const QString&,
+				PageDirection, bool, Highlight, const ChatLogsResult_t&);
+		void HandleGotSearchHits (const QString&, int, const SearchHitsResult_t&);
 		void HandleGotDaysForSheet (const QString&, const QString&, int, int, const DaysResult_t&);
 	private slots:
 		void on_AccountBox__currentIndexChanged (int);
@@ -124,14 +140,22 @@ namespace ChatHistory
 		void clearHistory ();
 
 		void on_HistView__anchorClicked (const QUrl&);
+		void on_SearchHits__itemActivated (QListWidgetItem*);
 		void handleBgLinkRequested (const QUrl&);
 	private:
 		QStandardItem* FindContactItem (const QString&) const;
 
 		void ShowLoading ();
 		void UpdateDates ();
-		void RequestLogs ();
+		void RequestLogs (PageDirection = PageDirection::Before,
+				const HistoryCursor& = {}, Highlight = Highlight::None);
+		void ResetPages ();
 		void RequestSearch (ChatFindBox::FindFlags);
+
+		void ResetSearchHits ();
+		void ShowSearchHit (int);
+		void HandleNoMoreHits ();
+		void SelectEntry (const QString& accountId, const QString& entryId);
 	signals:
 		void removeSelf (QWidget*);
 
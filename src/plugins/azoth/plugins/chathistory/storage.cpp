@@ -53,18 +53,6 @@ namespace Azoth
 {
 namespace ChatHistory
 {
-	Storage::RawSearchResult::RawSearchResult (qint32 entryId, qint32 accountId, qint64 rowId)
-	: EntryID_ { entryId }
-	, AccountID_ { accountId }
-	, RowID_ { rowId }
-	{
-	}
-
-	bool Storage::RawSearchResult::IsEmpty () const
-	{
-		return RowID_ < 0 || !EntryID_ || !AccountID_;
-	}
-
 	Storage::Storage (QObject *parent)
 	: QObject (parent)
 	, DB_ (std::make_shared<QSqlDatabase> (QSqlDatabase::addDatabase ("QSQLITE",
@@ -145,18 +133,6 @@ namespace ChatHistory
 		UsersForAccountGetter_.prepare ("SELECT DISTINCT azoth_acc2users2.UserId, EntryID FROM azoth_users, azoth_acc2users2 "
 				"WHERE azoth_acc2users2.UserId = azoth_users.Id AND azoth_acc2users2.AccountID = :account_id;");
 
-		RowID2Pos_ = QSqlQuery (*DB_);
-		RowID2Pos_.prepare ("SELECT COUNT(1) FROM azoth_history "
-				"WHERE Id = :entry_id "
-				"AND AccountID = :account_id "
-				"AND rowid > :rowid");
-
-		Date2Pos_ = QSqlQuery (*DB_);
-		Date2Pos_.prepare ("SELECT COUNT(1) FROM azoth_history "
-				"WHERE Id = :entry_id "
-				"AND AccountID = :account_id "
-				"AND Date >= :date");
-
 		GetMonthDates_ = QSqlQuery (*DB_);
 		GetMonthDates_.prepare ("SELECT Date FROM azoth_history "
 				"WHERE Id = :entry_id "
@@ -164,36 +140,67 @@ namespace ChatHistory
 				"AND Date >= :lower_date "
 				"AND Date <= :upper_date");
 
-		LogsSearcher_ = QSqlQuery (*DB_);
-		LogsSearcher_.prepare ("SELECT Rowid FROM azoth_history "
-				"WHERE Id = :inner_entry_id "
-				"AND AccountID = :inner_account_id "
-				"AND ((Message LIKE :text AND :insensitive) OR (Message GLOB :ctext AND :sensitive)) "
-				"ORDER BY Rowid DESC "
-				"LIMIT 1 OFFSET :offset;");
+		// The account and entry IDs are joined in right away so that
+		// the hits don't need reverse lookups in Accounts_ and Users_,
+		// and with FTS the snippet is computed by the same query.
+		const auto& hitsTemplate = HasFTS_ ?
+				QString::fromUtf8 (R"(
+					SELECT h.rowid, a.AccountID, u.EntryID, h.Date,
+						snippet (azoth_history_fts, 0, '', '', '…', 16)
+					FROM azoth_history_fts
+					INNER JOIN azoth_history h ON h.rowid = azoth_history_fts.rowid
+					INNER JOIN azoth_accounts a ON a.Id = h.AccountID
+					INNER JOIN azoth_users u ON u.Id = h.Id
+					WHERE azoth_history_fts MATCH :query
+						%1
+						AND (:insensitive OR h.Message GLOB :ctext)
+					ORDER BY azoth_history_fts.rank
+					LIMIT :limit OFFSET :offset;
+					)") :
+				QString { R"(
+					SELECT h.rowid, a.AccountID, u.EntryID, h.Date, h.Message
+					FROM azoth_history h
+					INNER JOIN azoth_accounts a ON a.Id = h.AccountID
+					INNER JOIN azoth_users u ON u.Id = h.Id
+					WHERE ((h.Message LIKE :text AND :insensitive) OR (h.Message GLOB :ctext AND :sensitive))
+						%1
+					ORDER BY h.rowid DESC
+					LIMIT :limit OFFSET :offset;
+					)" };
+
+		HitsSearcher_ = QSqlQuery (*DB_);
+		HitsSearcher_.prepare (hitsTemplate.arg ("AND h.Id = :entry_id AND h.AccountID = :account_id"));
+
+		HitsSearcherWOContact_ = QSqlQuery (*DB_);
+		HitsSearcherWOContact_.prepare (hitsTemplate.arg ("AND h.AccountID = :account_id"));
+
+		HitsSearcherWOContactAccount_ = QSqlQuery (*DB_);
+		HitsSearcherWOContactAccount_.prepare (hitsTemplate.arg (QString {}));
 
-		LogsSearcherWOContact_ = QSqlQuery (*DB_);
-		LogsSearcherWOContact_.prepare ("SELECT Date, Id FROM azoth_history "
+		HistoryGetter_ = QSqlQuery (*DB_);
+		HistoryGetter_.prepare ("SELECT Rowid, Date, Direction, Message, Variant, Type, RichMessage, EscapePolicy "
+				"FROM azoth_history "
 				"WHERE AccountID = :account_id "
-				"AND Date = (SELECT Date FROM azoth_history "
-				"	WHERE AccountID = :inner_account_id "
-				"	AND ((Message LIKE :text AND :insensitive) OR (Message GLOB :ctext AND :sensitive)) "
-				"	ORDER BY Rowid DESC "
-				"	LIMIT 1 OFFSET :offset);");
-
-		LogsSearcherWOContactAccount_ = QSqlQuery (*DB_);
-		LogsSearcherWOContactAccount_.prepare ("SELECT Date, Id, AccountID FROM azoth_history "
-				"WHERE Date = (SELECT Date FROM azoth_history "
-				"	WHERE ((Message LIKE :text AND :insensitive) OR (Message GLOB :ctext AND :sensitive)) "
-				"	ORDER BY Rowid DESC "
-				"	LIMIT 1 OFFSET :offset);");
+				"AND Id = :entry_id "
+				"ORDER BY Date DESC, Rowid DESC LIMIT :limit;");
 
-		HistoryGetter_ = QSqlQuery (*DB_);
-		HistoryGetter_.prepare ("SELECT Date, Direction, Message, Variant, Type, RichMessage, EscapePolicy "
+		HistoryGetterBefore_ = QSqlQuery (*DB_);
+		HistoryGetterBefore_.prepare ("SELECT Rowid, Date, Direction, Message, Variant, Type, RichMessage, EscapePolicy "
 				"FROM azoth_history "
-				"WHERE Id = :entry_id "
-				"AND AccountID = :account_id "
-				"ORDER BY Rowid DESC LIMIT :limit OFFSET :offset;");
+				"WHERE AccountID = :account_id "
+				"AND Id = :entry_id "
+				"AND Date <= :date "
+				"AND (Date < :date_strict OR Rowid < :rowid) "
+				"ORDER BY Date DESC, Rowid DESC LIMIT :limit;");
+
+		HistoryGetterAfter_ = QSqlQuery (*DB_);
+		HistoryGetterAfter_.prepare ("SELECT Rowid, Date, Direction, Message, Variant, Type, RichMessage, EscapePolicy "
+				"FROM azoth_history "
+				"WHERE AccountID = :account_id "
+				"AND Id = :entry_id "
+				"AND Date >= :date "
+				"AND (Date > :date_strict OR Rowid > :rowid) "
+				"ORDER BY Date ASC, Rowid ASC LIMIT :limit;");
 
 		HistoryClearer_ = QSqlQuery (*DB_);
 		HistoryClearer_.prepare ("DELETE FROM azoth_history WHERE Id = :entry_id AND AccountID = :account_id;");
@@ -320,12 +327,18 @@ namespace ChatHistory
 
 		UpdateTables ();
 
-		if (!query.exec ("CREATE INDEX IF NOT EXISTS azoth_history_id_accountid ON azoth_history (Id, AccountId);"))
+		if (!query.exec ("CREATE INDEX IF NOT EXISTS azoth_history_accountid_id_date ON azoth_history (AccountId, Id, Date);"))
 		{
 			Util::DBLock::DumpError (query);
 			throw std::runtime_error ("Unable to index `azoth_history`.");
 		}
 
+		// Superseded by the index above.
+		if (!query.exec ("DROP INDEX IF EXISTS azoth_history_id_accountid;"))
+			Util::DBLock::DumpError (query);
+
+		InitializeFTS ();
+
 		if (!hadAcc2User)
 			RegenUsersCache ();
 
@@ -367,6 +380,96 @@ namespace ChatHistory
 		}
 	}
 
+	void Storage::InitializeFTS ()
+	{
+		HasFTS_ = false;
+
+		QSqlQuery query { *DB_ };
+
+		const QStringList ftsTriggers
+		{
+			"azoth_history_fts_ai",
+			"azoth_history_fts_ad",
+			"azoth_history_fts_au"
+		};
+
+		const bool hadTable = DB_->tables ().contains ("azoth_history_fts");
+		if (!hadTable &&
+				!query.exec ("CREATE VIRTUAL TABLE azoth_history_fts USING fts5 ("
+						"Message, "
+						"content = 'azoth_history', "
+						"tokenize = 'unicode61 remove_diacritics 1'"
+						");"))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "FTS5 seems to be unavailable, history search will scan the whole history";
+			Util::DBLock::DumpError (query);
+			return;
+		}
+
+		if (hadTable && !query.exec ("SELECT 1 FROM azoth_history_fts LIMIT 0;"))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "the full-text index exists, but FTS5 is unavailable, dropping its triggers";
+			Util::DBLock::DumpError (query);
+
+			// The triggers would make every insert fail otherwise. The
+			// index will be rebuilt once FTS5 becomes available again.
+			for (const auto& trigger : ftsTriggers)
+				query.exec (QString { "DROP TRIGGER IF EXISTS %1;" }.arg (trigger));
+			return;
+		}
+
+		if (!query.exec ("SELECT COUNT(1) FROM sqlite_master "
+					"WHERE type = 'trigger' AND name LIKE 'azoth_history_fts_%';") ||
+				!query.next ())
+		{
+			Util::DBLock::DumpError (query);
+			throw std::runtime_error ("Unable to query the triggers of `azoth_history`.");
+		}
+		const bool hadTriggers = query.value (0).toInt () == ftsTriggers.size ();
+		query.finish ();
+
+		const QStringList triggersQueries
+		{
+			R"(
+				CREATE TRIGGER IF NOT EXISTS azoth_history_fts_ai AFTER INSERT ON azoth_history BEGIN
+					INSERT INTO azoth_history_fts (rowid, Message) VALUES (new.rowid, new.Message);
+				END;
+			)",
+			R"(
+				CREATE TRIGGER IF NOT EXISTS azoth_history_fts_ad AFTER DELETE ON azoth_history BEGIN
+					INSERT INTO azoth_history_fts (azoth_history_fts, rowid, Message) VALUES ('delete', old.rowid, old.Message);
+				END;
+			)",
+			R"(
+				CREATE TRIGGER IF NOT EXISTS azoth_history_fts_au AFTER UPDATE OF Message ON azoth_history BEGIN
+					INSERT INTO azoth_history_fts (azoth_history_fts, rowid, Message) VALUES ('delete', old.rowid, old.Message);
+					INSERT INTO azoth_history_fts (rowid, Message) VALUES (new.rowid, new.Message);
+				END;
+			)"
+		};
+		for (const auto& triggerQuery : triggersQueries)
+			if (!query.exec (triggerQuery))
+			{
+				Util::DBLock::DumpError (query);
+				throw std::runtime_error ("Unable to create the full-text index triggers for `azoth_history`.");
+			}
+
+		if (!hadTable || !hadTriggers)
+		{
+			qDebug () << Q_FUNC_INFO
+					<< "rebuilding the full-text index, this may take a while...";
+			if (!query.exec ("INSERT INTO azoth_history_fts (azoth_history_fts) VALUES ('rebuild');"))
+			{
+				Util::DBLock::DumpError (query);
+				throw std::runtime_error ("Unable to build the full-text index for `azoth_history`.");
+			}
+		}
+
+		HasFTS_ = true;
+	}
+
 	QHash<QString, qint32> Storage::GetUsers ()
 	{
 		if (!UserSelector_.exec ())
@@ -516,175 +619,6 @@ namespace ChatHistory
 		}
 	}
 
-	Storage::RawSearchResult Storage::SearchImpl (const QString& accountId,
-			const QString& entryId, const QString& text, int shift, bool cs)
-	{
-		if (!Accounts_.contains (accountId))
-		{
-			qWarning () << Q_FUNC_INFO
-					<< "Accounts_ doesn't contain"
-					<< accountId
-					<< "; raw contents"
-					<< Accounts_;
-			return {};
-		}
-		if (!Users_.contains (entryId))
-		{
-			qWarning () << Q_FUNC_INFO
-					<< "Users_ doesn't contain"
-					<< entryId
-					<< "; raw contents"
-					<< Users_;
-			return {};
-		}
-
-		const qint32 intEntryId = Users_ [entryId];
-		const qint32 intAccId = Accounts_ [accountId];
-		LogsSearcher_.bindValue (":entry_id", intEntryId);
-		LogsSearcher_.bindValue (":account_id", intAccId);
-		LogsSearcher_.bindValue (":inner_entry_id", intEntryId);
-		LogsSearcher_.bindValue (":inner_account_id", intAccId);
-		LogsSearcher_.bindValue (":text", '%' + text + '%');
-		LogsSearcher_.bindValue (":ctext", '*' + text + '*');
-		LogsSearcher_.bindValue (":sensitive", static_cast<int> (cs));
-		LogsSearcher_.bindValue (":insensitive", static_cast<int> (!cs));
-		LogsSearcher_.bindValue (":offset", shift);
-		if (!LogsSearcher_.exec ())
-		{
-			Util::DBLock::DumpError (LogsSearcher_);
-			return {};
-		}
-		auto guard = CleanupQueryGuard (LogsSearcher_);
-
-		if (!LogsSearcher_.next ())
-		{
-			qWarning () << Q_FUNC_INFO
-					<< "unable to move to the next entry";
-			Util::DBLock::DumpError (LogsSearcher_);
-			return {};
-		}
-
-		return { intEntryId, intAccId, LogsSearcher_.value (0).value<qint64> () };
-	}
-
-	Storage::RawSearchResult Storage::SearchImpl (const QString& accountId,
-			const QString& text, int shift, bool cs)
-	{
-		if (!Accounts_.contains (accountId))
-		{
-			qWarning () << Q_FUNC_INFO
-					<< "Accounts_ doesn't contain"
-					<< accountId
-					<< "; raw contents"
-					<< Accounts_;
-			return {};
-		}
-
-		const qint32 intAccId = Accounts_ [accountId];
-		LogsSearcherWOContact_.bindValue (":account_id", intAccId);
-		LogsSearcherWOContact_.bindValue (":inner_account_id", intAccId);
-		LogsSearcherWOContact_.bindValue (":text", '%' + text + '%');
-		LogsSearcherWOContact_.bindValue (":ctext", '*' + text + '*');
-		LogsSearcherWOContact_.bindValue (":sensitive", static_cast<int> (cs));
-		LogsSearcherWOContact_.bindValue (":insensitive", static_cast<int> (!cs));
-		LogsSearcherWOContact_.bindValue (":offset", shift);
-		if (!LogsSearcherWOContact_.exec ())
-		{
-			Util::DBLock::DumpError (LogsSearcherWOContact_);
-			return RawSearchResult ();
-		}
-
-		if (!LogsSearcherWOContact_.next ())
-		{
-			qWarning () << Q_FUNC_INFO
-					<< "unable to move to the next entry";
-			return RawSearchResult ();
-		}
-
-		auto guard = CleanupQueryGuard (LogsSearcherWOContact_);
-
-		return
-		{
-			LogsSearcherWOContact_.value (1).toInt (),
-			intAccId,
-			LogsSearcherWOContact_.value (0).value<qint64> ()
-		};
-	}
-
-	Storage::RawSearchResult Storage::SearchImpl (const QString& text, int shift, bool cs)
-	{
-		LogsSearcherWOContactAccount_.bindValue (":text", '%' + text + '%');
-		LogsSearcherWOContactAccount_.bindValue (":ctext", '*' + text + '*');
-		LogsSearcherWOContactAccount_.bindValue (":sensitive", static_cast<int> (cs));
-		LogsSearcherWOContactAccount_.bindValue (":insensitive", static_cast<int> (!cs));
-		LogsSearcherWOContactAccount_.bindValue (":offset", shift);
-		if (!LogsSearcherWOContactAccount_.exec ())
-		{
-			Util::DBLock::DumpError (LogsSearcherWOContactAccount_);
-			return RawSearchResult ();
-		}
-
-		if (!LogsSearcherWOContactAccount_.next ())
-		{
-			qWarning () << Q_FUNC_INFO
-					<< "unable to move to the next entry";
-			return RawSearchResult ();
-		}
-
-		auto guard = CleanupQueryGuard (LogsSearcherWOContactAccount_);
-
-		return
-		{
-			LogsSearcherWOContactAccount_.value (1).toInt (),
-			LogsSearcherWOContactAccount_.value (2).toInt (),
-			LogsSearcherWOContactAccount_.value (0).value<qint64> ()
-		};
-	}
-
-	SearchResult_t Storage::SearchRowIdImpl (qint32 accountId, qint32 entryId, qint64 rowId)
-	{
-		RowID2Pos_.bindValue (":rowid", rowId);
-		RowID2Pos_.bindValue (":account_id", accountId);
-		RowID2Pos_.bindValue (":entry_id", entryId);
-		if (!RowID2Pos_.exec ())
-		{
-			Util::DBLock::DumpError (RowID2Pos_);
-			return SearchResult_t::Left ("Unable to execute search query.");
-		}
-
-		if (!RowID2Pos_.next ())
-			return SearchResult_t::Right ({});
-
-		const int index = RowID2Pos_.value (0).toInt ();
-		RowID2Pos_.finish ();
-
-		return SearchResult_t::Right (index);
-	}
-
-	SearchResult_t Storage::SearchDateImpl (qint32 accountId, qint32 entryId, const QDateTime& dt)
-	{
-		Date2Pos_.bindValue (":date", dt);
-		Date2Pos_.bindValue (":account_id", accountId);
-		Date2Pos_.bindValue (":entry_id", entryId);
-		if (!Date2Pos_.exec ())
-		{
-			Util::DBLock::DumpError (Date2Pos_);
-			return SearchResult_t::Left ("Unable to execute search query.");
-		}
-
-		if (!Date2Pos_.next ())
-		{
-			qWarning () << Q_FUNC_INFO
-					<< "unable to navigate to next record";
-			return SearchResult_t::Left ("Unable to navigate to the search results.");
-		}
-
-		const int index = Date2Pos_.value (0).toInt ();
-		Date2Pos_.finish ();
-
-		return SearchResult_t::Right (index);
-	}
-
 	boost::optional<int> Storage::GetAllHistoryCount ()
 	{
 		QSqlQuery query { *DB_ };
@@ -944,10 +878,50 @@ namespace ChatHistory
 					IMessage::EscapePolicy::NoEscape :
 					IMessage::EscapePolicy::Escape;
 		}
+
+		ChatLogsPage FetchPage (QSqlQuery& query, PageDirection dir)
+		{
+			ChatLogsPage page;
+
+			HistoryCursor first;
+			HistoryCursor last;
+			while (query.next ())
+			{
+				const auto& rawDate = query.value (1);
+				page.Items_.push_back ({
+						rawDate.toDateTime (),
+						GetMsgDirection (query.value (2)),
+						query.value (3).toString (),
+						query.value (4).toString (),
+						GetMsgType (query.value (5)),
+						query.value (6).toString (),
+						GetMsgEscapePolicy (query.value (7))
+					});
+
+				last = { rawDate, query.value (0).value<qint64> () };
+				if (first.IsNull ())
+					first = last;
+			}
+
+			switch (dir)
+			{
+			case PageDirection::Before:
+				std::reverse (page.Items_.begin (), page.Items_.end ());
+				page.First_ = last;
+				page.Last_ = first;
+				break;
+			case PageDirection::After:
+				page.First_ = first;
+				page.Last_ = last;
+				break;
+			}
+
+			return page;
+		}
 	}
 
 	ChatLogsResult_t Storage::GetChatLogs (const QString& accountId,
-			const QString& entryId, int backpages, int amount)
+			const QString& entryId, PageDirection dir, const HistoryCursor& cursor, int amount)
 	{
 		if (!Accounts_.contains (accountId))
 		{
@@ -968,75 +942,142 @@ namespace ChatHistory
 			return ChatLogsResult_t::Left ("Unknown user.");
 		}
 
-		HistoryGetter_.bindValue (":entry_id", Users_ [entryId]);
-		HistoryGetter_.bindValue (":account_id", Accounts_ [accountId]);
-		HistoryGetter_.bindValue (":limit", amount);
-		HistoryGetter_.bindValue (":offset", amount * backpages);
-
-		if (!HistoryGetter_.exec ())
+		if (cursor.IsNull () && dir == PageDirection::After)
 		{
-			Util::DBLock::DumpError (HistoryGetter_);
-			return ChatLogsResult_t::Left ("Unable to execute the SQL query.");
+			qWarning () << Q_FUNC_INFO
+					<< "null cursor for a page after it";
+			return ChatLogsResult_t::Left ("Invalid history position.");
 		}
 
-		LogList_t result;
-		while (HistoryGetter_.next ())
-			result.push_back ({
-					HistoryGetter_.value (0).toDateTime (),
-					GetMsgDirection (HistoryGetter_.value (1)),
-					HistoryGetter_.value (2).toString (),
-					HistoryGetter_.value (3).toString (),
-					GetMsgType (HistoryGetter_.value (4)),
-					HistoryGetter_.value (5).toString (),
-					GetMsgEscapePolicy (HistoryGetter_.value (6))
-				});
+		auto& query = [&] () -> QSqlQuery&
+		{
+			if (cursor.IsNull ())
+				return HistoryGetter_;
+
+			auto& getter = dir == PageDirection::Before ?
+					HistoryGetterBefore_ :
+					HistoryGetterAfter_;
+			getter.bindValue (":date", cursor.Date_);
+			getter.bindValue (":date_strict", cursor.Date_);
+			getter.bindValue (":rowid", cursor.RowID_);
+			return getter;
+		} ();
 
-		std::reverse (result.begin (), result.end ());
+		query.bindValue (":entry_id", Users_ [entryId]);
+		query.bindValue (":account_id", Accounts_ [accountId]);
+		query.bindValue (":limit", amount);
 
-		return ChatLogsResult_t::Right (result);
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
+			return ChatLogsResult_t::Left ("Unable to execute the SQL query.");
+		}
+		auto guard = CleanupQueryGuard (query);
+
+		return ChatLogsResult_t::Right (FetchPage (query, dir));
 	}
 
-	SearchResult_t Storage::Search (const QString& accountId,
-			const QString& entryId, const QString& text, int shift, bool cs)
+	namespace
 	{
-		RawSearchResult res;
-		if (!accountId.isEmpty () && !entryId.isEmpty ())
-			res = SearchImpl (accountId, entryId, text, shift, cs);
-		else if (!accountId.isEmpty ())
-			res = SearchImpl (accountId, text, shift, cs);
-		else
-			res = SearchImpl (text, shift, cs);
+		QString MakeFTSQuery (const QString& text)
+		{
+			auto phrase = text;
+			phrase.replace ('"', "\"\"");
+			return '"' + phrase + "\"*";
+		}
+
+		QString MakeScanSnippet (const QString& message, const QString& text, bool cs)
+		{
+			const int context = 48;
 
-		if (res.IsEmpty ())
-			return SearchResult_t::Right ({});
+			const auto pos = message.indexOf (text, 0, cs ? Qt::CaseSensitive : Qt::CaseInsensitive);
+			const auto start = std::max (pos - context, 0);
+			const auto length = text.size () + 2 * context;
 
-		return SearchRowIdImpl (res.AccountID_, res.EntryID_, res.RowID_);
+			auto snippet = message.mid (start, length);
+			if (start > 0)
+				snippet.prepend (QString::fromUtf8 ("…"));
+			if (start + length < message.size ())
+				snippet.append (QString::fromUtf8 ("…"));
+			return snippet;
+		}
 	}
 
-	SearchResult_t Storage::SearchDate (const QString& account, const QString& entry, const QDateTime& dt)
+	SearchHitsResult_t Storage::SearchHits (const QString& accountId,
+			const QString& entryId, const QString& text, bool cs, int offset, int amount)
 	{
-		if (!Accounts_.contains (account))
+		if (!accountId.isEmpty () && !Accounts_.contains (accountId))
 		{
 			qWarning () << Q_FUNC_INFO
 					<< "Accounts_ doesn't contain"
-					<< account
+					<< accountId
 					<< "; raw contents"
 					<< Accounts_;
-			return SearchResult_t::Left ("Unknown account.");
+			return SearchHitsResult_t::Right ({});
 		}
-		if (!Users_.contains (entry))
+		if (!entryId.isEmpty () && !Users_.contains (entryId))
 		{
 			qWarning () << Q_FUNC_INFO
 					<< "Users_ doesn't contain"
-					<< entry
+					<< entryId
 					<< "; raw contents"
 					<< Users_;
-			return SearchResult_t::Left ("Unknown user.");
+			return SearchHitsResult_t::Right ({});
+		}
+
+		auto& query = [&] () -> QSqlQuery&
+		{
+			if (!accountId.isEmpty () && !entryId.isEmpty ())
+			{
+				HitsSearcher_.bindValue (":entry_id", Users_ [entryId]);
+				HitsSearcher_.bindValue (":account_id", Accounts_ [accountId]);
+				return HitsSearcher_;
+			}
+			else if (!accountId.isEmpty ())
+			{
+				HitsSearcherWOContact_.bindValue (":account_id", Accounts_ [accountId]);
+				return HitsSearcherWOContact_;
+			}
+			else
+				return HitsSearcherWOContactAccount_;
+		} ();
+
+		if (HasFTS_)
+			query.bindValue (":query", MakeFTSQuery (text));
+		else
+		{
+			query.bindValue (":text", '%' + text + '%');
+			query.bindValue (":sensitive", static_cast<int> (cs));
+		}
+		query.bindValue (":ctext", '*' + text + '*');
+		query.bindValue (":insensitive", static_cast<int> (!cs));
+		query.bindValue (":limit", amount);
+		query.bindValue (":offset", offset);
+
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
+			return SearchHitsResult_t::Left ("Unable to execute search query.");
+		}
+
+		QList<SearchHit> result;
+		while (query.next ())
+		{
+			const auto& date = query.value (3);
+			const auto& snippetSource = query.value (4).toString ();
+			result.append ({
+					query.value (1).toString (),
+					query.value (2).toString (),
+					{ date, query.value (0).value<qint64> () },
+					date.toDateTime (),
+					HasFTS_ ?
+						snippetSource.simplified () :
+						MakeScanSnippet (snippetSource, text, cs).simplified ()
+				});
 		}
+		query.finish ();
 
-		const qint32 entryId = Users_ [entry];
-		const qint32 accId = Accounts_ [account];
-		return SearchDateImpl (accId, entryId, dt);
+		return SearchHitsResult_t::Right (result);
 	}
 
 	DaysResult_t Storage::GetDaysForSheet (const QString& account, const QString& entry, int year, int month)
@@ -63,13 +63,13 @@ namespace ChatHistory
 		QSqlQuery MessageDumper_;
 		QSqlQuery MessageDumperFuzzy_;
 		QSqlQuery UsersForAccountGetter_;
-		QSqlQuery RowID2Pos_;
-		QSqlQuery Date2Pos_;
 		QSqlQuery GetMonthDates_;
-		QSqlQuery LogsSearcher_;
-		QSqlQuery LogsSearcherWOContact_;
-		QSqlQuery LogsSearcherWOContactAccount_;
+		QSqlQuery HitsSearcher_;
+		QSqlQuery HitsSearcherWOContact_;
+		QSqlQuery HitsSearcherWOContactAccount_;
 		QSqlQuery HistoryGetter_;
+		QSqlQuery HistoryGetterBefore_;
+		QSqlQuery HistoryGetterAfter_;
 		QSqlQuery HistoryClearer_;
 		QSqlQuery UserClearer_;
 		QSqlQuery EntryCacheSetter_;
@@ -81,17 +81,7 @@ namespace ChatHistory
 
 		QHash<qint32, QString> EntryCache_;
 
-		struct RawSearchResult
-		{
-			qint32 EntryID_ = 0;
-			qint32 AccountID_ = 0;
-			qint64 RowID_ = -1;
-
-			RawSearchResult () = default;
-			RawSearchResult (qint32 entryId, qint32 accountId, qint64 rowId);
-
-			bool IsEmpty () const;
-		};
+		bool HasFTS_ = false;
 	public:
 		Storage (QObject* = nullptr);
 
@@ -113,16 +103,52 @@ namespace ChatHistory
 
 		QStringList GetOurAccounts () const;
 		UsersForAccountResult_t GetUsersForAccount (const QString&);
-		ChatLogsResult_t GetChatLogs (const QString& accountId,
-				const QString& entryId, int backpages, int amount);
+		/** @brief Returns a page of the history relative to a cursor.
+		 *
+		 * The page is fetched by seeking the (AccountID, Id, Date) index
+		 * to the \em cursor, so the cost of this call doesn't depend on
+		 * how deep the \em cursor is in the history.
+		 *
+		 * @param[in] accountId The ID of the account.
+		 * @param[in] entryId The ID of the entry.
+		 * @param[in] dir The direction of the page relative to the
+		 * \em cursor.
+		 * @param[in] cursor The cursor, like ChatLogsPage::First_ of a
+		 * previously fetched page. It may be null only if \em dir is
+		 * PageDirection::Before.
+		 * @param[in] amount The maximum number of messages in the page.
+		 * @return The page with the messages in chronological order.
+		 */
+		ChatLogsResult_t GetChatLogs (const QString& accountId, const QString& entryId,
+				PageDirection dir, const HistoryCursor& cursor, int amount);
 
 		void AddMessages (const QString& accountId, const QString& entryId,
 				const QString& visibleName, const QList<LogItem>&, bool fuzzy);
 
-		SearchResult_t Search (const QString& accountId, const QString& entryId,
-				const QString& text, int shift, bool cs);
-		SearchResult_t SearchDate (const QString& accountId,
-				const QString& entryId, const QDateTime& dt);
+		/** @brief Performs a full-text search over the history.
+		 *
+		 * If \em entryId is empty, all the entries of \em accountId are
+		 * searched, and if \em accountId is empty as well, the whole
+		 * history is searched.
+		 *
+		 * If SQLite supports FTS5, the search uses the full-text index,
+		 * matches words by their prefixes and returns the hits ordered
+		 * by their relevance. Otherwise, the whole history is scanned for
+		 * \em text as a substring and the hits are ordered from the most
+		 * recent one.
+		 *
+		 * @param[in] accountId The ID of the account to search in, or
+		 * an empty string.
+		 * @param[in] entryId The ID of the entry to search in, or an
+		 * empty string.
+		 * @param[in] text The text to search for.
+		 * @param[in] cs Whether the search should be case-sensitive.
+		 * @param[in] offset The number of hits to skip.
+		 * @param[in] amount The maximum number of hits to return.
+		 * @return The list of hits, empty if there are no more hits.
+		 */
+		SearchHitsResult_t SearchHits (const QString& accountId, const QString& entryId,
+				const QString& text, bool cs, int offset, int amount);
 
 		DaysResult_t GetDaysForSheet (const QString& accountId, const QString& entryId, int year, int month);
 
@@ -133,6 +159,7 @@ namespace ChatHistory
 	private:
 		void InitializeTables ();
 		void UpdateTables ();
+		void InitializeFTS ();
 
 		QHash<QString, qint32> GetUsers ();
 		qint32 GetUserID (const QString&);
@@ -143,13 +170,6 @@ namespace ChatHistory
 		QHash<QString, qint32> GetAccounts ();
 		qint32 GetAccountID (const QString&);
 		void AddAccount (const QString& id);
-		RawSearchResult SearchImpl (const QString& accountId, const QString& entryId,
-				const QString& text, int shift, bool cs);
-		RawSearchResult SearchImpl (const QString& accountId, const QString& text, int shift, bool cs);
-		RawSearchResult SearchImpl (const QString& text, int shift, bool cs);
-
-		SearchResult_t SearchRowIdImpl (qint32, qint32, qint64);
-		SearchResult_t SearchDateImpl (qint32, qint32, const QDateTime&);
 	};
 }
 }
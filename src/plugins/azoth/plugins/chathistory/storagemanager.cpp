@@ -176,22 +176,17 @@ namespace ChatHistory
 	}
 
 	QFuture<ChatLogsResult_t> StorageManager::GetChatLogs (const QString& accountId,
-			const QString& entryId, int backpages, int amount)
+			const QString& entryId, PageDirection dir, const HistoryCursor& cursor, int amount)
 	{
-		return StorageThread_->Schedule (&Storage::GetChatLogs, accountId, entryId, backpages, amount);
+		return StorageThread_->Schedule (&Storage::GetChatLogs,
+				accountId, entryId, dir, cursor, amount);
 	}
 
-	QFuture<SearchResult_t> StorageManager::Search (const QString& accountId, const QString& entryId,
-			const QString& text, int shift, bool cs)
+	QFuture<SearchHitsResult_t> StorageManager::SearchHits (const QString& accountId, const QString& entryId,
+			const QString& text, bool cs, int offset, int amount)
 	{
-		return StorageThread_->Schedule (&Storage::Search,
-				accountId, entryId, text, shift, cs);
-	}
-
-	QFuture<SearchResult_t> StorageManager::Search (const QString& accountId, const QString& entryId, const QDateTime& dt)
-	{
-		return StorageThread_->Schedule (&Storage::SearchDate,
-				accountId, entryId, dt);
+		return StorageThread_->Schedule (&Storage::SearchHits,
+				accountId, entryId, text, cs, offset, amount);
 	}
 
 	QFuture<DaysResult_t> StorageManager::GetDaysForSheet (const QString& accountId, const QString& entryId, int year, int month)
@@ -57,11 +57,10 @@ namespace ChatHistory
 		QFuture<UsersForAccountResult_t> GetUsersForAccount (const QString&);
 
 		QFuture<ChatLogsResult_t> GetChatLogs (const QString& accountId, const QString& entryId,
-				int backpages, int amount);
+				PageDirection dir, const HistoryCursor& cursor, int amount);
 
-		QFuture<SearchResult_t> Search (const QString& accountId, const QString& entryId,
-				const QString& text, int shift, bool cs);
-		QFuture<SearchResult_t> Search (const QString& accountId, const QString& entryId, const QDateTime& dt);
+		QFuture<SearchHitsResult_t> SearchHits (const QString& accountId, const QString& entryId,
+				const QString& text, bool cs, int offset, int amount);
 
 		QFuture<DaysResult_t> GetDaysForSheet (const QString& accountId, const QString& entryId, int year, int month);
 		void ClearHistory (const QString& accountId, const QString& entryId);
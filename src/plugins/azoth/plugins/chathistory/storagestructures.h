@@ -31,6 +31,8 @@
 
 #include <boost/optional.hpp>
 #include <QStringList>
+#include <QDateTime>
+#include <QVariant>
 #include <util/sll/either.h>
 #include <interfaces/azoth/imessage.h>
 #include <interfaces/azoth/ihistoryplugin.h>
@@ -52,9 +54,86 @@ namespace ChatHistory
 
 	using UsersForAccountResult_t = Util::Either<QString, UsersForAccount>;
 
-	using ChatLogsResult_t = Util::Either<QString, LogList_t>;
+	/** @brief A position in the history of an entry.
+	 *
+	 * Messages are ordered by their dates, and messages with the same
+	 * date are ordered by their rowids. A cursor identifies a point in
+	 * this order, so pages can be fetched relative to it in constant
+	 * time regardless of how deep in the history it is.
+	 */
+	struct HistoryCursor
+	{
+		/** @brief The date of the message.
+		 *
+		 * This is the date value as it is stored in the database, so
+		 * that it compares exactly equal to the stored one. A QDateTime
+		 * can also be used to point at an arbitrary moment of time.
+		 */
+		QVariant Date_;
+
+		/** @brief The rowid of the message.
+		 */
+		qint64 RowID_ = -1;
+
+		bool IsNull () const
+		{
+			return !Date_.isValid ();
+		}
+	};
+
+	/** @brief The direction of a page relative to a HistoryCursor.
+	 */
+	enum class PageDirection
+	{
+		/** @brief Messages strictly older than the cursor.
+		 *
+		 * For a null cursor these are the latest messages.
+		 */
+		Before,
+
+		/** @brief Messages strictly newer than the cursor.
+		 */
+		After
+	};
+
+	/** @brief A page of the history.
+	 */
+	struct ChatLogsPage
+	{
+		/** @brief The messages in chronological order.
+		 */
+		LogList_t Items_;
+
+		/** @brief The cursor of the oldest message in Items_.
+		 */
+		HistoryCursor First_;
+
+		/** @brief The cursor of the newest message in Items_.
+		 */
+		HistoryCursor Last_;
+	};
+
+	using ChatLogsResult_t = Util::Either<QString, ChatLogsPage>;
+
+	/** @brief A single full-text search hit.
+	 */
+	struct SearchHit
+	{
+		QString AccountID_;
+		QString EntryID_;
+
+		/** @brief The position of the matching message.
+		 */
+		HistoryCursor Cursor_;
+
+		QDateTime Date_;
+
+		/** @brief A plain-text excerpt of the message around the match.
+		 */
+		QString Snippet_;
+	};
 
-	using SearchResult_t = Util::Either<QString, boost::optional<int>>;
+	using SearchHitsResult_t = Util::Either<QString, QList<SearchHit>>;
 
 	using DaysResult_t = Util::Either<QString, QList<int>>;
 }
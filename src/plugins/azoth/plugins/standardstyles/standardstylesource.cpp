@@ -29,6 +29,7 @@
 
 #include "standardstylesource.h"
 #include <QTextDocument>
+#include <QTimer>
 #include <QWebElement>
 #include <QWebFrame>
 #include <QApplication>
@@ -53,11 +54,21 @@ namespace StandardStyles
 	: QObject (parent)
 	, StylesLoader_ (new Util::ResourceLoader ("azoth/styles/standard/", this))
 	, Proxy_ (proxy)
+	, FlushTimer_ (new QTimer (this))
 	{
 		StylesLoader_->AddGlobalPrefix ();
 		StylesLoader_->AddLocalPrefix ();
 
 		StylesLoader_->SetCacheParams (256, 0);
+
+		// Roughly one frame at 60 fps: a burst of messages arriving
+		// within it ends up in a single DOM insertion.
+		FlushTimer_->setSingleShot (true);
+		FlushTimer_->setInterval (16);
+		connect (FlushTimer_,
+				SIGNAL (timeout ()),
+				this,
+				SLOT (flushPending ()));
 	}
 
 	QAbstractItemModel* StandardStyleSource::GetOptionsModel() const
@@ -80,15 +91,19 @@ namespace StandardStyles
 	}
 
 	QString StandardStyleSource::GetHTMLTemplate (const QString& pack,
-			const QString&, QObject *entryObj, QWebFrame*) const
+			const QString&, QObject *entryObj, QWebFrame *frame) const
 	{
 		Coloring2Colors_.clear ();
 		if (pack != LastPack_)
 		{
 			LastPack_ = pack;
 			StylesLoader_->FlushCache ();
+			FormattedBodies_.clear ();
 		}
 
+		// The frame is going to be reloaded and refilled from scratch.
+		PendingChunks_.remove (frame);
+
 		ICLEntry *entry = qobject_cast<ICLEntry*> (entryObj);
 
 		Util::QIODevice_ptr dev;
@@ -193,7 +208,7 @@ namespace StandardStyles
 		if (body.isEmpty ())
 			body = msg->GetEscapedBody ();
 
-		body = formatter.FormatBody (body, msg->GetQObject (), colors);
+		body = FormatBody (body, msgObj, colors);
 
 		const QString dateBegin ("<span class='datetime'>");
 		const QString dateEnd ("</span>");
@@ -311,8 +326,6 @@ namespace StandardStyles
 					.arg (msgId));
 		string.append (body);
 
-		QWebElement elem = frame->findFirstElement ("body");
-
 		if (msg->GetMessageType () == IMessage::Type::ChatMessage ||
 			msg->GetMessageType () == IMessage::Type::MUCMessage)
 		{
@@ -320,17 +333,21 @@ namespace StandardStyles
 			if (!isActiveChat &&
 					!isRead && IsLastMsgRead_.value (frame, false))
 			{
-				auto hr = elem.findFirst ("hr[class=\"lastSeparator\"]");
+				const QString separator ("<hr class=\"lastSeparator\" />");
+
+				auto hr = frame->findFirstElement ("hr[class=\"lastSeparator\"]");
 				if (!hr.isNull ())
 					hr.removeFromDocument ();
-				elem.appendInside ("<hr class=\"lastSeparator\" />");
+				PendingChunks_ [frame].removeAll (separator);
+
+				ScheduleAppend (frame, separator);
 			}
 			IsLastMsgRead_ [frame] = isRead;
 		}
 
-		elem.appendInside (QString ("<div class='%1' style='word-wrap: break-word;'>%2</div>")
-					.arg (divClass)
-					.arg (string));
+		ScheduleAppend (frame,
+				QString ("<div class='%1' style='word-wrap: break-word;'>%2</div>")
+					.arg (divClass, string));
 		return true;
 	}
 
@@ -383,12 +400,67 @@ namespace StandardStyles
 		return Util::GetAsBase64Src (img);
 	}
 
+	QString StandardStyleSource::FormatBody (const QString& body,
+			QObject *msgObj, const QList<QColor>& colors)
+	{
+		auto& cached = FormattedBodies_ [msgObj];
+		if (cached.Formatted_.isNull () ||
+				cached.Source_ != body ||
+				cached.Colors_ != colors)
+			cached = { body, colors, Proxy_->GetFormatterProxy ().FormatBody (body, msgObj, colors) };
+		return cached.Formatted_;
+	}
+
+	void StandardStyleSource::ScheduleAppend (QWebFrame *frame, const QString& html)
+	{
+		if (!PendingChunks_.contains (frame))
+			connect (frame,
+					SIGNAL (destroyed (QObject*)),
+					this,
+					SLOT (handleFrameDestroyed ()),
+					Qt::UniqueConnection);
+
+		PendingChunks_ [frame] << html;
+
+		if (!FlushTimer_->isActive ())
+			FlushTimer_->start ();
+	}
+
+	void StandardStyleSource::FlushFrame (QWebFrame *frame)
+	{
+		const auto& chunks = PendingChunks_.take (frame);
+		if (chunks.isEmpty ())
+			return;
+
+		frame->findFirstElement ("body").appendInside (chunks.join (QString ()));
+		TrimFrame (frame);
+	}
+
+	void StandardStyleSource::TrimFrame (QWebFrame *frame)
+	{
+		const auto limit = frame->property ("Azoth/MessagesLimit").toInt ();
+		if (limit <= 0)
+			return;
+
+		const auto& elems = frame->findAllElements ("body > div");
+		for (int i = 0, excess = elems.count () - limit; i < excess; ++i)
+			elems.at (i).removeFromDocument ();
+	}
+
+	void StandardStyleSource::flushPending ()
+	{
+		for (const auto frame : PendingChunks_.keys ())
+			FlushFrame (frame);
+	}
+
 	void StandardStyleSource::handleMessageDelivered ()
 	{
 		QWebFrame *frame = Msg2Frame_.take (sender ());
 		if (!frame)
 			return;
 
+		FlushFrame (frame);
+
 		const QString& msgId = GetMessageID (sender ());
 		QWebElement elem = frame->findFirstElement ("img[id=\"" + msgId + "\"]");
 		elem.setAttribute ("src", GetStatusImage ("notification_chat_delivery_ok"));
@@ -402,11 +474,13 @@ namespace StandardStyles
 	void StandardStyleSource::handleMessageDestroyed ()
 	{
 		Msg2Frame_.remove (sender ());
+		FormattedBodies_.remove (sender ());
 	}
 
 	void StandardStyleSource::handleFrameDestroyed ()
 	{
 		IsLastMsgRead_.remove (static_cast<QWebFrame*> (sender ()));
+		PendingChunks_.remove (static_cast<QWebFrame*> (sender ()));
 		const QObject *snd = sender ();
 		for (QHash<QObject*, QWebFrame*>::iterator i = Msg2Frame_.begin ();
 				i != Msg2Frame_.end (); )
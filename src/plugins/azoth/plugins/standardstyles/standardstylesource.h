@@ -34,8 +34,11 @@
 #include <QDateTime>
 #include <QHash>
 #include <QColor>
+#include <QStringList>
 #include <interfaces/azoth/ichatstyleresourcesource.h>
 
+class QTimer;
+
 namespace LeechCraft
 {
 namespace Util
@@ -65,6 +68,17 @@ namespace StandardStyles
 		mutable QString LastPack_;
 
 		QHash<QObject*, QWebFrame*> Msg2Frame_;
+
+		struct FormattedBody
+		{
+			QString Source_;
+			QList<QColor> Colors_;
+			QString Formatted_;
+		};
+		mutable QHash<QObject*, FormattedBody> FormattedBodies_;
+
+		mutable QHash<QWebFrame*, QStringList> PendingChunks_;
+		QTimer * const FlushTimer_;
 	public:
 		StandardStyleSource (IProxyObject*, QObject* = 0);
 
@@ -79,7 +93,13 @@ namespace StandardStyles
 		QList<QColor> CreateColors (const QString&, QWebFrame*);
 		QString GetMessageID (QObject*);
 		QString GetStatusImage (const QString&);
+		QString FormatBody (const QString&, QObject*, const QList<QColor>&);
+
+		void ScheduleAppend (QWebFrame*, const QString&);
+		void FlushFrame (QWebFrame*);
+		void TrimFrame (QWebFrame*);
 	private slots:
+		void flushPending ();
 		void handleMessageDelivered ();
 		void handleMessageDestroyed ();
 		void handleFrameDestroyed ();
@@ -28,6 +28,7 @@
  **********************************************************************/
 
 #include "sortfilterproxymodel.h"
+#include <array>
 #include "interfaces/azoth/iaccount.h"
 #include "interfaces/azoth/iclentry.h"
 #include "interfaces/azoth/imucperms.h"
@@ -93,6 +94,50 @@ namespace Azoth
 		invalidateFilter ();
 	}
 
+	void SortFilterProxyModel::setSourceModel (QAbstractItemModel *model)
+	{
+		if (const auto old = sourceModel ())
+		{
+			disconnect (old,
+					SIGNAL (dataChanged (QModelIndex, QModelIndex, QVector<int>)),
+					this,
+					SLOT (handleSourceDataChanged (QModelIndex, QModelIndex, QVector<int>)));
+			disconnect (old,
+					SIGNAL (rowsAboutToBeRemoved (QModelIndex, int, int)),
+					this,
+					SLOT (handleSourceRowsAboutToBeRemoved (QModelIndex, int, int)));
+			disconnect (old,
+					SIGNAL (modelAboutToBeReset ()),
+					this,
+					SLOT (handleSourceAboutToBeReset ()));
+		}
+
+		Keys_.clear ();
+		MUC2PermClasses_.clear ();
+
+		/* Connected before QSortFilterProxyModel connects its own
+		 * handlers, so that the cached keys are already up to date when
+		 * it re-filters and re-positions the changed rows.
+		 */
+		if (model)
+		{
+			connect (model,
+					SIGNAL (dataChanged (QModelIndex, QModelIndex, QVector<int>)),
+					this,
+					SLOT (handleSourceDataChanged (QModelIndex, QModelIndex, QVector<int>)));
+			connect (model,
+					SIGNAL (rowsAboutToBeRemoved (QModelIndex, int, int)),
+					this,
+					SLOT (handleSourceRowsAboutToBeRemoved (QModelIndex, int, int)));
+			connect (model,
+					SIGNAL (modelAboutToBeReset ()),
+					this,
+					SLOT (handleSourceAboutToBeReset ()));
+		}
+
+		QSortFilterProxyModel::setSourceModel (model);
+	}
+
 	void SortFilterProxyModel::showOfflineContacts (bool show)
 	{
 		ShowOffline_ = show;
@@ -137,12 +182,59 @@ namespace Azoth
 			return idx.data (Core::CLREntryType).value<Core::CLEntryType> ();
 		}
 
-		ICLEntry* GetEntry (const QModelIndex& idx)
+		QObject* GetEntryObject (const QModelIndex& idx)
 		{
-			return qobject_cast<ICLEntry*> (idx.data (Core::CLREntryObject).value<QObject*> ());
+			return idx.data (Core::CLREntryObject).value<QObject*> ();
+		}
+
+		int GetStatusRank (State state)
+		{
+			static const auto ranks = []
+			{
+				std::array<int, SInvalid + 1> result;
+				for (int i = SOffline; i <= SInvalid; ++i)
+				{
+					result [i] = 0;
+					for (int j = SOffline; j <= SInvalid; ++j)
+						result [i] += IsLess (static_cast<State> (j), static_cast<State> (i));
+				}
+				return result;
+			} ();
+
+			return state >= SOffline && state <= SInvalid ?
+					ranks [state] :
+					static_cast<int> (ranks.size ());
 		}
 	}
 
+	void SortFilterProxyModel::handleSourceDataChanged (const QModelIndex& topLeft,
+			const QModelIndex& bottomRight, const QVector<int>&)
+	{
+		for (int row = topLeft.row (); row <= bottomRight.row (); ++row)
+		{
+			const auto& idx = topLeft.sibling (row, 0);
+			if (GetType (idx) != Core::CLETContact)
+				continue;
+
+			const auto entryObj = GetEntryObject (idx);
+			const auto pos = Keys_.find (entryObj);
+			if (pos != Keys_.end ())
+				pos->second = MakeKey (entryObj, idx);
+		}
+	}
+
+	void SortFilterProxyModel::handleSourceRowsAboutToBeRemoved (const QModelIndex& parent,
+			int first, int last)
+	{
+		ForgetKeys (parent, first, last);
+	}
+
+	void SortFilterProxyModel::handleSourceAboutToBeReset ()
+	{
+		Keys_.clear ();
+		MUC2PermClasses_.clear ();
+	}
+
 	bool SortFilterProxyModel::filterAcceptsRow (int row, const QModelIndex& parent) const
 	{
 		return MUCMode_ ?
@@ -166,27 +258,19 @@ namespace Azoth
 				return rightIsMuc;
 		}
 
-		const auto lE = GetEntry (left);
-		const auto rE = GetEntry (right);
+		const auto& lKey = GetKey (left);
+		const auto& rKey = GetKey (right);
 
-		if (lE->GetEntryType () == ICLEntry::EntryType::PrivateChat &&
-				rE->GetEntryType () == ICLEntry::EntryType::PrivateChat &&
-				lE->GetParentCLEntry () == rE->GetParentCLEntry ())
-			if (const auto lp = qobject_cast<IMUCPerms*> (lE->GetParentCLEntryObject ()))
-			{
-				bool less = lp->IsLessByPerm (lE->GetQObject (), rE->GetQObject ());
-				bool more = lp->IsLessByPerm (rE->GetQObject (), lE->GetQObject ());
-				if (less || more)
-					return more;
-			}
+		if (lKey.PermsParent_ &&
+				lKey.PermsParent_ == rKey.PermsParent_ &&
+				lKey.PermRank_ != rKey.PermRank_)
+			return rKey.PermRank_ < lKey.PermRank_;
 
-		const auto lState = lE->GetStatus ().State_;
-		const auto rState = rE->GetStatus ().State_;
-		if (lState == rState ||
+		if (lKey.State_ == rKey.State_ ||
 				!OrderByStatus_)
-			return lE->GetEntryName ().localeAwareCompare (rE->GetEntryName ()) < 0;
+			return lKey.NameKey_.compare (rKey.NameKey_) < 0;
 		else
-			return IsLess (lState, rState);
+			return lKey.StatusRank_ < rKey.StatusRank_;
 	}
 
 	bool SortFilterProxyModel::FilterAcceptsMucMode (int row, const QModelIndex& parent) const
@@ -221,34 +305,33 @@ namespace Azoth
 					idx.data ().toString ().contains (filterRegExp ()) :
 					true;
 
-		if (idx.data (Core::CLRUnreadMsgCount).toInt ())
-			return true;
-
 		const auto type = GetType (idx);
 
 		if (type == Core::CLETContact)
 		{
-			const auto entry = GetEntry (idx);
-			const auto state = entry->GetStatus ().State_;
+			const auto& key = GetKey (idx);
+			if (key.Unread_)
+				return true;
 
 			if (!ShowOffline_ &&
 					HideErroring_ &&
-					state == SError)
+					key.State_ == SError)
 				return false;
 
 			if (!ShowOffline_ &&
-					state == SOffline &&
-					!idx.data (Core::CLRUnreadMsgCount).toInt ())
+					key.State_ == SOffline)
 				return false;
 
 			if (HideMUCParts_ &&
-					entry->GetEntryType () == ICLEntry::EntryType::PrivateChat)
+					key.Type_ == ICLEntry::EntryType::PrivateChat)
 				return false;
 
 			if (!ShowSelfContacts_ &&
-					entry->GetEntryFeatures () & ICLEntry::FSelfContact)
+					key.IsSelfContact_)
 				return false;
 		}
+		else if (idx.data (Core::CLRUnreadMsgCount).toInt ())
+			return true;
 		else if (type == Core::CLETCategory)
 		{
 			if (!ShowOffline_ &&
@@ -266,5 +349,117 @@ namespace Azoth
 
 		return QSortFilterProxyModel::filterAcceptsRow (row, parent);
 	}
+
+	const SortFilterProxyModel::EntryKey& SortFilterProxyModel::GetKey (const QModelIndex& idx) const
+	{
+		const auto entryObj = GetEntryObject (idx);
+		auto pos = Keys_.find (entryObj);
+		if (pos == Keys_.end ())
+			pos = Keys_.emplace (entryObj, MakeKey (entryObj, idx)).first;
+		return pos->second;
+	}
+
+	SortFilterProxyModel::EntryKey SortFilterProxyModel::MakeKey (QObject *entryObj, const QModelIndex& idx) const
+	{
+		const auto entry = qobject_cast<ICLEntry*> (entryObj);
+		const auto state = entry->GetStatus ().State_;
+		const auto& name = idx.data ().toString ();
+
+		EntryKey key
+		{
+			state,
+			GetStatusRank (state),
+			entry->GetEntryType (),
+			static_cast<bool> (entry->GetEntryFeatures () & ICLEntry::FSelfContact),
+			idx.data (Core::CLRUnreadMsgCount).toInt (),
+			nullptr,
+			0,
+			name,
+			Collator_.sortKey (name)
+		};
+
+		if (key.Type_ == ICLEntry::EntryType::PrivateChat)
+		{
+			const auto mucObj = entry->GetParentCLEntryObject ();
+			if (const auto perms = qobject_cast<IMUCPerms*> (mucObj))
+			{
+				key.PermsParent_ = mucObj;
+				key.PermRank_ = GetPermRank (perms, mucObj, entryObj);
+			}
+		}
+
+		return key;
+	}
+
+	qint64 SortFilterProxyModel::GetPermRank (IMUCPerms *perms, QObject *muc, QObject *participant) const
+	{
+		QByteArray signature;
+		const auto& permsMap = perms->GetPerms (participant);
+		for (auto i = permsMap.begin (), end = permsMap.end (); i != end; ++i)
+		{
+			signature += i.key () + '=';
+			for (const auto& value : i.value ())
+				signature += value + ',';
+			signature += ';';
+		}
+
+		/* The permission classes of a room are kept ordered by
+		 * IsLessByPerm(), assuming it depends on the permissions only, so
+		 * a participant is compared against a class representative just
+		 * once. A rank is never changed once given out, thus the ranks
+		 * already cached in Keys_ stay comparable with the new ones.
+		 */
+		auto& classes = MUC2PermClasses_ [muc];
+		for (auto& cls : classes)
+			if (cls.Signature_ == signature)
+			{
+				if (!cls.Representative_)
+					cls.Representative_ = participant;
+				return cls.Rank_;
+			}
+
+		int pos = 0;
+		for ( ; pos < classes.size (); ++pos)
+		{
+			const auto repr = classes [pos].Representative_.data ();
+			if (repr && perms->IsLessByPerm (participant, repr))
+				break;
+		}
+
+		const qint64 gap = 1ll << 32;
+		const auto prev = pos ? classes [pos - 1].Representative_.data () : nullptr;
+
+		qint64 rank = 0;
+		if (prev && !perms->IsLessByPerm (prev, participant))
+			rank = classes [pos - 1].Rank_;
+		else if (classes.isEmpty ())
+			rank = 0;
+		else if (!pos)
+			rank = classes.first ().Rank_ - gap;
+		else if (pos == classes.size ())
+			rank = classes.last ().Rank_ + gap;
+		else
+			rank = classes [pos - 1].Rank_ + (classes [pos].Rank_ - classes [pos - 1].Rank_) / 2;
+
+		classes.insert (pos, PermClass { signature, participant, rank });
+		return rank;
+	}
+
+	void SortFilterProxyModel::ForgetKeys (const QModelIndex& parent, int first, int last)
+	{
+		const auto model = sourceModel ();
+		for (int row = first; row <= last; ++row)
+		{
+			const auto& idx = model->index (row, 0, parent);
+			if (GetType (idx) == Core::CLETContact)
+			{
+				const auto entryObj = GetEntryObject (idx);
+				Keys_.erase (entryObj);
+				MUC2PermClasses_.remove (entryObj);
+			}
+			else if (const auto rc = model->rowCount (idx))
+				ForgetKeys (idx, 0, rc - 1);
+		}
+	}
 }
 }
@@ -29,12 +29,19 @@
 
 #pragma once
 
+#include <unordered_map>
 #include <QSortFilterProxyModel>
+#include <QCollator>
+#include <QPointer>
+#include "interfaces/azoth/azothcommon.h"
+#include "interfaces/azoth/iclentry.h"
 
 namespace LeechCraft
 {
 namespace Azoth
 {
+	class IMUCPerms;
+
 	class SortFilterProxyModel : public QSortFilterProxyModel
 	{
 		Q_OBJECT
@@ -46,12 +53,48 @@ namespace Azoth
 		bool ShowSelfContacts_ = true;
 		bool HideErroring_ = true;
 		QObject *MUCEntry_ = nullptr;
+
+		/** Everything lessThan() and filterAcceptsRow() need to know
+		 * about a contact, so that sorting a large roster or MUC doesn't
+		 * query the entry and the source model on each comparison.
+		 */
+		struct EntryKey
+		{
+			State State_;
+			int StatusRank_;
+			ICLEntry::EntryType Type_;
+			bool IsSelfContact_;
+			int Unread_;
+
+			QObject *PermsParent_;
+			qint64 PermRank_;
+
+			QString Name_;
+			QCollatorSortKey NameKey_;
+		};
+		/* References to the elements should survive rehashing, since
+		 * lessThan() holds two of them while the second one may be
+		 * just being inserted.
+		 */
+		mutable std::unordered_map<QObject*, EntryKey> Keys_;
+
+		struct PermClass
+		{
+			QByteArray Signature_;
+			QPointer<QObject> Representative_;
+			qint64 Rank_;
+		};
+		mutable QHash<QObject*, QList<PermClass>> MUC2PermClasses_;
+
+		QCollator Collator_;
 	public:
 		SortFilterProxyModel (QObject* = nullptr);
 
 		void SetMUCMode (bool);
 		bool IsMUCMode () const;
 		void SetMUC (QObject*);
+
+		void setSourceModel (QAbstractItemModel*) override;
 	public slots:
 		void showOfflineContacts (bool);
 	private slots:
@@ -60,12 +103,22 @@ namespace Azoth
 		void handleShowSelfContactsChanged ();
 		void handleHideErrorContactsChanged ();
 		void handleMUCDestroyed ();
+
+		void handleSourceDataChanged (const QModelIndex&, const QModelIndex&, const QVector<int>&);
+		void handleSourceRowsAboutToBeRemoved (const QModelIndex&, int, int);
+		void handleSourceAboutToBeReset ();
 	protected:
 		bool filterAcceptsRow (int, const QModelIndex&) const override;
 		bool lessThan (const QModelIndex&, const QModelIndex&) const override;
 	private:
 		bool FilterAcceptsMucMode (int, const QModelIndex&) const;
 		bool FilterAcceptsNonMucMode (int, const QModelIndex&) const;
+
+		const EntryKey& GetKey (const QModelIndex&) const;
+		EntryKey MakeKey (QObject*, const QModelIndex&) const;
+		qint64 GetPermRank (IMUCPerms*, QObject*, QObject*) const;
+
+		void ForgetKeys (const QModelIndex&, int, int);
 	signals:
 		void mucMode ();
 		void wholeMode ();
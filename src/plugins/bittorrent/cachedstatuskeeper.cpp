@@ -33,25 +33,36 @@ namespace LeechCraft
 {
 namespace BitTorrent
 {
-	libtorrent::torrent_status CachedStatusKeeper::GetStatus (const libtorrent::torrent_handle& handle, uint32_t flags)
+	const libtorrent::torrent_status& CachedStatusKeeper::GetStatus (const libtorrent::torrent_handle& handle, uint32_t flags)
 	{
-		if (Handle2Status_.contains (handle))
+		const auto pos = Handle2Status_.find (handle);
+		if (pos != Handle2Status_.end ())
 		{
-			const auto& item = Handle2Status_ [handle];
-			if ((item.ReqFlags_ & flags) == flags)
-				return item.Status_;
-			else
-				flags |= item.ReqFlags_;
+			auto& item = pos->second;
+			if ((item.ReqFlags_ & flags) != flags)
+			{
+				item.ReqFlags_ |= flags;
+				item.Status_ = handle.status (item.ReqFlags_);
+			}
+			return item.Status_;
 		}
 
-		const auto& status = handle.status (flags);
-		Handle2Status_ [handle] = { status, flags };
-		return status;
+		auto& item = Handle2Status_ [handle];
+		item = { handle.status (flags), flags };
+		return item.Status_;
 	}
 
-	void CachedStatusKeeper::HandleStatusUpdatePosted (const libtorrent::torrent_status& status)
+	libtorrent::torrent_status CachedStatusKeeper::HandleStatusUpdatePosted (const libtorrent::torrent_status& status)
 	{
-		Handle2Status_ [status.handle] = { status, 0xffffffff };
+		auto& item = Handle2Status_ [status.handle];
+		auto previous = std::move (item.Status_);
+		item = { status, 0xffffffff };
+		return previous;
+	}
+
+	void CachedStatusKeeper::Remove (const libtorrent::torrent_handle& handle)
+	{
+		Handle2Status_.erase (handle);
 	}
 }
 }
@@ -29,8 +29,9 @@
 
 #pragma once
 
+#include <unordered_map>
+#include <boost/functional/hash.hpp>
 #include <QObject>
-#include <QMap>
 #include <libtorrent/version.hpp>
 #include <libtorrent/torrent_handle.hpp>
 
@@ -42,6 +43,16 @@ namespace LeechCraft
 {
 namespace BitTorrent
 {
+	/** @brief Caches the statuses of the torrents.
+	 *
+	 * The statuses are kept in a hash table keyed by the torrent
+	 * handle and are updated from the state_update_alerts, so that
+	 * querying a status of a torrent doesn't involve a round trip to
+	 * the libtorrent session.
+	 *
+	 * The references returned by GetStatus() stay valid until the
+	 * corresponding torrent is removed via Remove().
+	 */
 	class CachedStatusKeeper : public QObject
 	{
 		struct CachedItem
@@ -50,12 +61,22 @@ namespace BitTorrent
 			uint32_t ReqFlags_;
 		};
 
-		QMap<libtorrent::torrent_handle, CachedItem> Handle2Status_;
+		std::unordered_map<libtorrent::torrent_handle, CachedItem,
+				boost::hash<libtorrent::torrent_handle>> Handle2Status_;
 	public:
 		using QObject::QObject;
 
-		libtorrent::torrent_status GetStatus (const libtorrent::torrent_handle&, uint32_t flags);
-		void HandleStatusUpdatePosted (const libtorrent::torrent_status&);
+		const libtorrent::torrent_status& GetStatus (const libtorrent::torrent_handle&, uint32_t flags);
+
+		/** @brief Updates the cached status of the corresponding torrent.
+		 *
+		 * @param[in] status The new status of the torrent.
+		 * @return The previous status of the torrent, or an empty
+		 * status if it hasn't been cached before.
+		 */
+		libtorrent::torrent_status HandleStatusUpdatePosted (const libtorrent::torrent_status& status);
+
+		void Remove (const libtorrent::torrent_handle&);
 	};
 }
 }
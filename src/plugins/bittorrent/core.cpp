@@ -40,6 +40,7 @@
 #include <QSettings>
 #include <QToolBar>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QMenu>
 #include <QDomDocument>
 #include <QDomElement>
@@ -57,6 +58,8 @@
 #include <QDataStream>
 #include <QDesktopServices>
 #include <QUrlQuery>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
 #include <libtorrent/bencode.hpp>
 #include <libtorrent/entry.hpp>
 #include <libtorrent/create_torrent.hpp>
@@ -68,6 +71,7 @@
 #include <libtorrent/ip_filter.hpp>
 #include <libtorrent/version.hpp>
 #include <libtorrent/session.hpp>
+#include <libtorrent/error_code.hpp>
 
 #if LIBTORRENT_VERSION_NUM >= 10100
 #include <libtorrent/lazy_entry.hpp>
@@ -89,6 +93,7 @@
 #include <util/sll/qtutil.h>
 #include <util/sll/prelude.h>
 #include <util/sys/paths.h>
+#include <util/threads/futures.h>
 #include "xmlsettingsmanager.h"
 #include "piecesmodel.h"
 #include "peersmodel.h"
@@ -99,6 +104,7 @@
 #include "sessionsettingsmanager.h"
 #include "cachedstatuskeeper.h"
 #include "geoip.h"
+#include "torrentstatestore.h"
 
 Q_DECLARE_METATYPE (QMenu*)
 Q_DECLARE_METATYPE (QToolBar*)
@@ -162,6 +168,11 @@ namespace BitTorrent
 			};
 		}
 
+		QByteArray GetInfoHash (const libtorrent::torrent_handle& handle)
+		{
+			return QByteArray::fromStdString (handle.info_hash ().to_string ()).toHex ();
+		}
+
 #if LIBTORRENT_VERSION_NUM >= 10100
 		bool DecodeEntry (const QByteArray& data, libtorrent::bdecode_node& e)
 		{
@@ -265,6 +276,7 @@ namespace BitTorrent
 				this,
 				SLOT (writeSettings ()));
 
+		StateStore_ = std::make_shared<TorrentStateStore> ();
 		RestoreTorrents ();
 	}
 
@@ -272,6 +284,7 @@ namespace BitTorrent
 	{
 		Session_->pause ();
 		writeSettings ();
+		WaitResumeData ();
 
 		FinishedTimer_.reset ();
 		WarningWatchdog_.reset ();
@@ -481,6 +494,99 @@ namespace BitTorrent
 			else
 				return stateStr;
 		}
+
+		static_assert (Core::ColumnRatio + 1 == std::tuple_size<decltype (TorrentSortKeys::Numeric_)>::value,
+				"sort keys count doesn't match the columns count");
+
+		TorrentSortKeys MakeSortKeys (const libtorrent::torrent_status& status)
+		{
+			TorrentSortKeys keys;
+			keys.Name_ = QString::fromStdString (status.name);
+
+			auto& numeric = keys.Numeric_;
+			numeric [Core::ColumnState] = status.paused ?
+					-1 :
+					static_cast<int> (status.state);
+			numeric [Core::ColumnProgress] = status.progress;
+			numeric [Core::ColumnDownSpeed] = status.download_payload_rate;
+			numeric [Core::ColumnUpSpeed] = status.upload_payload_rate;
+			numeric [Core::ColumnLeechers] = status.num_peers - status.num_seeds;
+			numeric [Core::ColumnSeeders] = status.num_seeds;
+			numeric [Core::ColumnSize] = status.total_wanted;
+			numeric [Core::ColumnDownloaded] = status.all_time_download;
+			numeric [Core::ColumnUploaded] = status.all_time_upload;
+			if (status.all_time_download)
+				numeric [Core::ColumnRatio] = static_cast<double> (status.all_time_upload) / status.all_time_download;
+			else
+				numeric [Core::ColumnRatio] = status.all_time_upload ?
+						std::numeric_limits<double>::max () :
+						0;
+
+			keys.IsValid_ = true;
+			return keys;
+		}
+
+		/** Returns the bitmask of the columns whose contents differ
+		 * for the given statuses of the same torrent.
+		 */
+		uint32_t GetChangedColumns (const libtorrent::torrent_status& o, const libtorrent::torrent_status& n)
+		{
+			uint32_t result = 0;
+			auto mark = [&result] (int column, bool changed)
+			{
+				if (changed)
+					result |= 1 << column;
+			};
+
+			const bool stateChanged = o.state != n.state ||
+					o.paused != n.paused ||
+					o.error != n.error;
+			const bool isDownloading = n.state == libtorrent::torrent_status::downloading;
+
+			mark (Core::ColumnName, stateChanged || o.name != n.name);
+			mark (Core::ColumnState, stateChanged ||
+					(isDownloading &&
+						(o.download_rate != n.download_rate ||
+						 o.total_wanted_done != n.total_wanted_done ||
+						 o.total_wanted != n.total_wanted)));
+			mark (Core::ColumnProgress, stateChanged ||
+					o.progress != n.progress ||
+					o.total_wanted_done != n.total_wanted_done ||
+					o.total_wanted != n.total_wanted ||
+					o.download_payload_rate != n.download_payload_rate ||
+					o.upload_payload_rate != n.upload_payload_rate ||
+					o.num_peers != n.num_peers ||
+					o.num_seeds != n.num_seeds ||
+					o.num_incomplete != n.num_incomplete ||
+					o.list_peers != n.list_peers ||
+					o.list_seeds != n.list_seeds);
+			mark (Core::ColumnDownSpeed, o.download_payload_rate != n.download_payload_rate);
+			mark (Core::ColumnUpSpeed, o.upload_payload_rate != n.upload_payload_rate);
+			mark (Core::ColumnLeechers, o.num_peers - o.num_seeds != n.num_peers - n.num_seeds);
+			mark (Core::ColumnSeeders, o.num_seeds != n.num_seeds);
+			mark (Core::ColumnSize, o.total_wanted != n.total_wanted);
+			mark (Core::ColumnDownloaded, o.all_time_download != n.all_time_download);
+			mark (Core::ColumnUploaded, o.all_time_upload != n.all_time_upload);
+			mark (Core::ColumnRatio, o.all_time_download != n.all_time_download ||
+					o.all_time_upload != n.all_time_upload);
+
+			return result;
+		}
+	}
+
+	const TorrentSortKeys& Core::GetSortKeys (int row) const
+	{
+		if (!CheckValidity (row))
+		{
+			static const TorrentSortKeys empty;
+			return empty;
+		}
+
+		const auto& torrent = Handles_.at (row);
+		if (!torrent.SortKeys_.IsValid_)
+			torrent.SortKeys_ = MakeSortKeys (StatusKeeper_->GetStatus (torrent.Handle_,
+						libtorrent::torrent_handle::query_name));
+		return torrent.SortKeys_;
 	}
 
 	QVariant Core::data (const QModelIndex& index, int role) const
@@ -537,34 +643,18 @@ namespace BitTorrent
 			case ColumnID:
 				return row + 1;
 			case ColumnName:
-				return QString::fromStdString (status.name);
+				return GetSortKeys (row).Name_;
 			case ColumnState:
-				return status.paused ?
-						-1 :
-						static_cast<int> (status.state);
 			case ColumnProgress:
-				return status.progress;
 			case ColumnDownSpeed:
-				return status.download_payload_rate;
 			case ColumnUpSpeed:
-				return status.upload_payload_rate;
 			case ColumnLeechers:
-				return status.num_peers - status.num_seeds;
 			case ColumnSeeders:
-				return status.num_seeds;
 			case ColumnDownloaded:
-				return static_cast<quint64> (status.all_time_download);
 			case ColumnSize:
-				return static_cast<quint64> (status.total_wanted);
 			case ColumnUploaded:
-				return static_cast<quint64> (status.all_time_upload);
 			case ColumnRatio:
-				if (status.all_time_download)
-					return static_cast<double> (status.all_time_upload) / status.all_time_download;
-
-				return status.all_time_upload ?
-						std::numeric_limits<double>::max () :
-						0;
+				return GetSortKeys (row).Numeric_ [column];
 			default:
 				return {};
 			}
@@ -1085,6 +1175,10 @@ namespace BitTorrent
 		if (!CheckValidity (pos))
 			return;
 
+		StateStore_->Remove (GetInfoHash (Handles_.at (pos).Handle_));
+
+		StatusKeeper_->Remove (Handles_.at (pos).Handle_);
+
 		beginRemoveRows (QModelIndex (), pos, pos);
 		Session_->remove_torrent (Handles_.at (pos).Handle_, roptions);
 		int id = Handles_.at (pos).ID_;
@@ -1420,8 +1514,10 @@ namespace BitTorrent
 		return result;
 	}
 
-	void Core::SaveResumeData (const libtorrent::save_resume_data_alert& a) const
+	void Core::SaveResumeData (const libtorrent::save_resume_data_alert& a)
 	{
+		HandleResumeDataFinished ();
+
 		const auto torrent = FindHandle (a.handle);
 		if (torrent == Handles_.end ())
 		{
@@ -1440,23 +1536,16 @@ namespace BitTorrent
 			return;
 		}
 
-		const auto& filePath = Util::CreateIfNotExists ("bittorrent")
-				.filePath (torrent->TorrentFileName_ + ".resume");
-		QFile file { filePath };
-
-		if (!file.open (QIODevice::WriteOnly))
-		{
-			qWarning () << QString ("Could not open file %1 for write: %2")
-				.arg (file.fileName ())
-				.arg (file.errorString ());
-			return;
-		}
-
-		std::deque<char> outbuf;
-		libtorrent::bencode (std::back_inserter (outbuf), *a.resume_data.get ());
+		QByteArray resumeData;
+		libtorrent::bencode (std::back_inserter (resumeData), *a.resume_data.get ());
+		// Written on the next periodic save, which is also what requests it.
+		StateStore_->UpdateResumeData (GetInfoHash (a.handle), resumeData);
+	}
 
-		for (size_t i = 0; i < outbuf.size (); ++i)
-			file.write (&outbuf.at (i), 1);
+	void Core::HandleResumeDataFinished ()
+	{
+		if (PendingResumeData_ > 0)
+			--PendingResumeData_;
 	}
 
 	void Core::HandleMetadata (const libtorrent::metadata_received_alert& a)
@@ -1496,26 +1585,33 @@ namespace BitTorrent
 		ScheduleSave ();
 	}
 
-	void Core::PieceRead (const libtorrent::read_piece_alert& a)
-	{
-		LiveStreamManager_->PieceRead (a);
-	}
-
 	void Core::UpdateStatus (const std::vector<libtorrent::torrent_status>& statuses)
 	{
 		for (const auto& status : statuses)
 		{
-			StatusKeeper_->HandleStatusUpdatePosted (status);
-			const auto pos = FindHandle (status.handle);
-			if (pos == Handles_.end ())
+			const auto& previous = StatusKeeper_->HandleStatusUpdatePosted (status);
+			const auto row = FindRow (status.handle);
+			if (row < 0)
 			{
 				qWarning () << Q_FUNC_INFO
 						<< "unknown handle";
 				continue;
 			}
 
-			const auto row = std::distance (Handles_.begin (), pos);
-			emit dataChanged (index (row, 0), index (row, columnCount () - 1));
+			const auto& torrent = Handles_.at (row);
+			torrent.SortKeys_ = MakeSortKeys (status);
+
+			const auto changed = GetChangedColumns (previous, status);
+			if (!changed)
+				continue;
+
+			int first = 0;
+			while (!(changed & (1 << first)))
+				++first;
+			int last = ColumnRatio;
+			while (!(changed & (1 << last)))
+				--last;
+			emit dataChanged (index (row, first), index (row, last));
 		}
 	}
 
@@ -1669,14 +1765,35 @@ namespace BitTorrent
 
 	auto Core::FindHandle (const libtorrent::torrent_handle& h) -> HandleDict_t::iterator
 	{
-		return std::find_if (Handles_.begin (), Handles_.end (),
-				[&h] (const TorrentStruct& ts) { return ts.Handle_ == h; });
+		const auto row = FindRow (h);
+		return row >= 0 ? Handles_.begin () + row : Handles_.end ();
 	}
 
 	auto Core::FindHandle (const libtorrent::torrent_handle& h) const -> HandleDict_t::const_iterator
 	{
-		return std::find_if (Handles_.begin (), Handles_.end (),
-				[&h] (const TorrentStruct& ts) { return ts.Handle_ == h; });
+		const auto row = FindRow (h);
+		return row >= 0 ? Handles_.begin () + row : Handles_.end ();
+	}
+
+	int Core::FindRow (const libtorrent::torrent_handle& h) const
+	{
+		const auto isActual = [this, &h] (int row)
+		{
+			return row < Handles_.size () && Handles_.at (row).Handle_ == h;
+		};
+
+		const auto pos = Handle2Row_.find (h);
+		if (pos != Handle2Row_.end () && isActual (pos->second))
+			return pos->second;
+
+		Handle2Row_.clear ();
+		for (int i = 0; i < Handles_.size (); ++i)
+			Handle2Row_ [Handles_.at (i).Handle_] = i;
+
+		const auto rebuiltPos = Handle2Row_.find (h);
+		return rebuiltPos != Handle2Row_.end () ?
+				rebuiltPos->second :
+				-1;
 	}
 
 	void Core::MoveToTop (int row)
@@ -1705,20 +1822,300 @@ namespace BitTorrent
 		endInsertRows ();
 	}
 
-	void Core::RestoreTorrents ()
+	namespace
 	{
-		const auto& torrentsDir = Util::CreateIfNotExists ("bittorrent");
+		struct PreparedTorrent
+		{
+			SavedTorrent Saved_;
+			std::vector<int> Priorities_;
+			libtorrent::add_torrent_params Params_;
+			bool IsValid_ = false;
+		};
+
+		PreparedTorrent PrepareRestore (const SavedTorrent& saved, libtorrent::storage_mode_t storageMode)
+		{
+			PreparedTorrent result;
+			result.Saved_ = saved;
 
+#if LIBTORRENT_VERSION_NUM >= 10100
+			libtorrent::bdecode_node e;
+#else
+			libtorrent::lazy_entry e;
+#endif
+			if (!DecodeEntry (saved.TorrentFile_, e))
+				return result;
+
+			const auto& state = saved.State_;
+
+			auto& atp = result.Params_;
+			try
+			{
+#if LIBTORRENT_VERSION_NUM >= 10100
+				atp.ti = boost::make_shared<libtorrent::torrent_info> (e);
+#else
+				atp.ti = new libtorrent::torrent_info (e);
+#endif
+			}
+			catch (const std::exception& ex)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to load torrent info for"
+						<< state.Filename_
+						<< ex.what ();
+				return result;
+			}
+
+			atp.storage_mode = storageMode;
+			atp.save_path = state.SavePath_.toUtf8 ().constData ();
+			if (!state.AutoManaged_)
+				atp.flags &= ~libtorrent::add_torrent_params::flag_auto_managed;
+			if (state.Parameters_ & NoAutostart)
+				atp.flags |= libtorrent::add_torrent_params::flag_paused;
+			atp.flags |= libtorrent::add_torrent_params::flag_duplicate_is_error;
+
+			atp.resume_data.assign (saved.ResumeData_.constData (),
+					saved.ResumeData_.constData () + saved.ResumeData_.size ());
+
+			result.Priorities_ = state.Priorities_;
+			if (result.Priorities_.empty ())
+				result.Priorities_.resize (atp.ti->num_files (), 1);
+
+			result.Saved_.InfoHash_ = QByteArray::fromStdString (atp.ti->info_hash ().to_string ()).toHex ();
+			result.IsValid_ = true;
+			return result;
+		}
+
+		/** The maximum number of torrents being added to the session
+		 * at once, so that the corresponding add_torrent_alerts fit
+		 * into the alert queue.
+		 */
+		const int MaxInFlightRestores = 100;
+	}
+
+	void Core::RestoreTorrents ()
+	{
 		QSettings settings (QCoreApplication::organizationName (),
 				QCoreApplication::applicationName () + "_Torrent");
 		settings.beginGroup ("Core");
+
+		IsMigratingRestore_ = !StateStore_->HasSavedState ();
+
+		const auto storageMode = GetCurrentStorageMode ();
+		const auto store = StateStore_;
+		const auto& legacy = IsMigratingRestore_ ?
+				LoadLegacyTorrents (settings) :
+				QList<SavedTorrent> {};
+
+		Util::Sequence (this,
+				QtConcurrent::run ([legacy, store, storageMode]
+					{
+						if (!legacy.isEmpty ())
+							return QtConcurrent::blockingMapped (legacy,
+									std::function<PreparedTorrent (SavedTorrent)>
+									{
+										[storageMode] (const SavedTorrent& saved)
+										{
+											return PrepareRestore (saved, storageMode);
+										}
+									});
+
+						return QtConcurrent::blockingMapped (store->LoadOrder (),
+								std::function<PreparedTorrent (QByteArray)>
+								{
+									[store, storageMode] (const QByteArray& infoHash)
+									{
+										const auto& saved = store->LoadTorrent (infoHash);
+										if (saved)
+											return PrepareRestore (*saved, storageMode);
+
+										PreparedTorrent broken;
+										broken.Saved_.InfoHash_ = infoHash;
+										return broken;
+									}
+								});
+					})) >>
+				[this] (const QList<PreparedTorrent>& prepared)
+				{
+					if (!Session_)
+						return;
+
+					for (const auto& torrent : prepared)
+					{
+						if (!torrent.IsValid_)
+						{
+							// Nothing would ever overwrite or remove the
+							// stored files of a torrent that fails to load.
+							if (!IsMigratingRestore_ && !torrent.Saved_.InfoHash_.isEmpty ())
+								StateStore_->Remove (torrent.Saved_.InfoHash_);
+							continue;
+						}
+
+						const auto& infoHash = torrent.Saved_.InfoHash_;
+						if (PendingRestores_.contains (infoHash))
+						{
+							qWarning () << Q_FUNC_INFO
+									<< "duplicate torrent"
+									<< infoHash;
+							continue;
+						}
+
+						PendingRestores_ [infoHash] = { torrent.Saved_, torrent.Priorities_ };
+						RestoreQueue_.push_back (torrent.Params_);
+					}
+
+					qDebug () << Q_FUNC_INFO
+							<< "gonna restore"
+							<< PendingRestores_.size ()
+							<< "of"
+							<< prepared.size ()
+							<< "torrents";
+
+					RestoreTotal_ = PendingRestores_.size ();
+					RestoreDone_ = 0;
+					emit restoreProgress (0, RestoreTotal_);
+
+					if (RestoreQueue_.empty ())
+					{
+						FlushRestoredBatch ();
+						return;
+					}
+
+					SubmitRestores ();
+					WarningWatchdog_->start (100);
+				};
+
+		int filters = settings.beginReadArray ("IPFilter");
+		for (int i = 0; i < filters; ++i)
+		{
+			settings.setArrayIndex (i);
+			BanRange_t range (settings.value ("First").toString (),
+					settings.value ("Last").toString ());
+			bool block = settings.value ("Block").toBool ();
+			BanPeers (range, block);
+		}
+		settings.endArray ();
+		settings.endGroup ();
+	}
+
+	void Core::SubmitRestores ()
+	{
+		const int inFlight = PendingRestores_.size () - static_cast<int> (RestoreQueue_.size ());
+		for (int i = inFlight; i < MaxInFlightRestores && !RestoreQueue_.empty (); ++i)
+		{
+			Session_->async_add_torrent (RestoreQueue_.front ());
+			RestoreQueue_.pop_front ();
+		}
+	}
+
+	void Core::HandleTorrentAdded (const libtorrent::add_torrent_alert& a)
+	{
+		const auto& ti = a.params.ti;
+		if (!ti)
+			return;
+
+		const auto& infoHash = QByteArray::fromStdString (ti->info_hash ().to_string ()).toHex ();
+		const auto pos = PendingRestores_.find (infoHash);
+		if (pos == PendingRestores_.end ())
+			return;
+
+		const auto restoring = *pos;
+		PendingRestores_.erase (pos);
+		++RestoreDone_;
+
+		const auto& saved = restoring.Saved_;
+		const auto& state = saved.State_;
+
+		auto handle = a.handle;
+		if (a.error || !handle.is_valid ())
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to restore"
+					<< state.Filename_
+					<< a.error.message ().c_str ();
+
+			// A duplicate is already in the session and uses the same
+			// stored files.
+			if (!IsMigratingRestore_ &&
+					a.error != libtorrent::errors::duplicate_torrent)
+				StateStore_->Remove (infoHash);
+			return;
+		}
+
+		handle.prioritize_files (restoring.Priorities_);
+
+		RestoredBatch_.append ({
+				restoring.Priorities_,
+				handle,
+				saved.TorrentFile_,
+				state.Filename_,
+				state.Tags_,
+				state.AutoManaged_,
+				Proxy_->GetID (),
+				state.Parameters_
+			});
+
+		if (IsMigratingRestore_)
+			StateStore_->UpdateResumeData (infoHash, saved.ResumeData_);
+		else
+			StateStore_->MarkLoaded (saved);
+	}
+
+	void Core::FlushRestoredBatch ()
+	{
+		if (!RestoredBatch_.isEmpty ())
+		{
+			beginInsertRows ({}, Handles_.size (), Handles_.size () + RestoredBatch_.size () - 1);
+			Handles_ += RestoredBatch_;
+			endInsertRows ();
+
+			RestoredBatch_.clear ();
+		}
+
+		if (!PendingRestores_.isEmpty ())
+		{
+			emit restoreProgress (RestoreDone_, RestoreTotal_);
+			SubmitRestores ();
+			return;
+		}
+
+		if (!RestoreTotal_)
+			return;
+
+		qDebug () << Q_FUNC_INFO
+				<< "restored"
+				<< Handles_.size ()
+				<< "torrents";
+		emit restoreProgress (RestoreTotal_, RestoreTotal_);
+		RestoreTotal_ = 0;
+		RestoreDone_ = 0;
+
+		if (WarningWatchdog_)
+			WarningWatchdog_->start (2000);
+
+		if (IsMigratingRestore_)
+		{
+			qDebug () << Q_FUNC_INFO
+					<< "migrating the torrents to the new storage";
+			IsMigratingRestore_ = false;
+			ScheduleSave ();
+		}
+	}
+
+	QPair<int, int> Core::GetRestoreProgress () const
+	{
+		return { RestoreDone_, RestoreTotal_ };
+	}
+
+	QList<SavedTorrent> Core::LoadLegacyTorrents (QSettings& settings)
+	{
+		const auto& torrentsDir = Util::CreateIfNotExists ("bittorrent");
+
+		QList<SavedTorrent> result;
+
 		int torrents = settings.beginReadArray ("AddedTorrents");
-		qDebug () << Q_FUNC_INFO << "gonna restore" << torrents << "torrents";
 		for (int i = 0; i < torrents; ++i)
 		{
 			settings.setArrayIndex (i);
-			const auto& pathStr = settings.value ("SavePath").toString ();
-			const auto& path = std::string (pathStr.toUtf8 ().constData ());
 			QString filename = settings.value ("Filename").toString ();
 			QFile torrent (torrentsDir.filePath (filename));
 			if (!torrent.open (QIODevice::ReadOnly))
@@ -1744,119 +2141,25 @@ namespace BitTorrent
 				resumeDataFile.close ();
 			}
 
-			bool automanaged = settings.value ("AutoManaged", true).toBool ();
-			TaskParameters taskParameters = static_cast<TaskParameters> (settings
-						.value ("Parameters").toInt ());
-
-			auto handle = RestoreSingleTorrent (data,
-					resumed,
-					path,
-					automanaged,
-					taskParameters & NoAutostart);
-			if (!handle.is_valid ())
-			{
-				qWarning () << Q_FUNC_INFO
-						<< "got invalid handle for"
-						<< filename;
-				continue;
-			}
-
 			std::vector<int> priorities;
 			QByteArray prioritiesLine = settings.value ("Priorities").toByteArray ();
 			std::copy (prioritiesLine.begin (), prioritiesLine.end (),
 					std::back_inserter (priorities));
 
-			if (priorities.empty ())
+			const SavedTorrentState state
 			{
-#if LIBTORRENT_VERSION_NUM >= 10100
-				const auto& infoPtr = StatusKeeper_->GetStatus (handle,
-							libtorrent::torrent_handle::query_torrent_file).torrent_file.lock ();
-				const auto numFiles = infoPtr ? infoPtr->num_files () : 0;
-#else
-				const auto& infoPtr = StatusKeeper_->GetStatus (handle,
-							libtorrent::torrent_handle::query_torrent_file).torrent_file;
-				const auto numFiles = infoPtr ? infoPtr->num_files () : 0;
-#endif
-				priorities.resize (numFiles);
-				std::fill (priorities.begin (), priorities.end (), 1);
-			}
-
-			handle.prioritize_files (priorities);
-
-			beginInsertRows ({}, Handles_.size (), Handles_.size ());
-			Handles_.append ({
-					priorities,
-					handle,
-					data,
-					filename,
-					settings.value ("Tags").toStringList (),
-					automanaged,
-					Proxy_->GetID (),
-					taskParameters
-				});
-			endInsertRows ();
-			qDebug () << "restored a torrent";
-		}
-		settings.endArray ();
-
-		int filters = settings.beginReadArray ("IPFilter");
-		for (int i = 0; i < filters; ++i)
-		{
-			settings.setArrayIndex (i);
-			BanRange_t range (settings.value ("First").toString (),
-					settings.value ("Last").toString ());
-			bool block = settings.value ("Block").toBool ();
-			BanPeers (range, block);
+				settings.value ("SavePath").toString (),
+				filename,
+				settings.value ("Tags").toStringList (),
+				priorities,
+				settings.value ("AutoManaged", true).toBool (),
+				static_cast<TaskParameters> (settings.value ("Parameters").toInt ())
+			};
+			result.append ({ {}, state, data, resumed });
 		}
 		settings.endArray ();
-		settings.endGroup ();
-	}
-
-	libtorrent::torrent_handle Core::RestoreSingleTorrent (const QByteArray& data,
-			const QByteArray& resumeData,
-			const boost::filesystem::path& path,
-			bool automanaged,
-			bool pause)
-	{
-		libtorrent::torrent_handle handle;
-
-#if LIBTORRENT_VERSION_NUM >= 10100
-		libtorrent::bdecode_node e;
-#else
-		libtorrent::lazy_entry e;
-#endif
-		if (!DecodeEntry (data, e))
-			return handle;
-
-		try
-		{
-			libtorrent::add_torrent_params atp;
-#if LIBTORRENT_VERSION_NUM >= 10100
-			atp.ti = boost::make_shared<libtorrent::torrent_info> (e);
-#else
-			atp.ti = new libtorrent::torrent_info (e);
-#endif
-			atp.storage_mode = GetCurrentStorageMode ();
-			atp.save_path = path.string ();
-			if (!automanaged)
-				atp.flags &= ~libtorrent::add_torrent_params::flag_auto_managed;
-			if (pause)
-				atp.flags |= libtorrent::add_torrent_params::flag_paused;
-			atp.flags |= libtorrent::add_torrent_params::flag_duplicate_is_error;
-
-			std::copy (resumeData.constData (),
-					resumeData.constData () + resumeData.size (),
-					std::back_inserter (atp.resume_data));
-
-			handle = Session_->add_torrent (atp);
-		}
-		catch (const libtorrent::libtorrent_exception& e)
-		{
-			qWarning () << Q_FUNC_INFO << e.what ();
-			HandleLibtorrentException (e);
-		}
 
-		return handle;
+		return result;
 	}
 
 	void Core::HandleSingleFinished (int i)
@@ -2019,15 +2322,9 @@ namespace BitTorrent
 	{
 		SaveScheduled_ = false;
 
-		const auto& torrentsDir = Util::CreateIfNotExists ("bittorrent");
-
-		QSettings settings (QCoreApplication::organizationName (),
-				QCoreApplication::applicationName () + "_Torrent");
-		settings.beginGroup ("Core");
-		settings.beginWriteArray ("AddedTorrents");
+		QList<QByteArray> order;
 		for (int i = 0; i < Handles_.size (); ++i)
 		{
-			settings.setArrayIndex (i);
 			if (!CheckValidity (i))
 			{
 				qWarning () << Q_FUNC_INFO
@@ -2035,52 +2332,40 @@ namespace BitTorrent
 					<< i;
 				continue;
 			}
-			if (Handles_.at (i).TorrentFileName_.isEmpty ())
+
+			const auto& torrent = Handles_.at (i);
+			if (torrent.TorrentFileName_.isEmpty ())
 			{
 				qWarning () << Q_FUNC_INFO
 					<< "empty file name"
 					<< i;
 				continue;
 			}
-			int oldCurrent = CurrentTorrent_;
-			CurrentTorrent_ = i;
+
 			try
 			{
-				QFile file_info (torrentsDir.filePath (Handles_.at (i).TorrentFileName_));
-				if (!file_info.open (QIODevice::WriteOnly))
-					ShowError (QString ("Cannot write settings! "
-								"Cannot open file %1 for write!")
-							.arg (Handles_.at (i).TorrentFileName_));
-				else
+				const auto& handle = torrent.Handle_;
+				if (handle.need_save_resume_data ())
 				{
-					file_info.write (Handles_.at (i).TorrentFileContents_);
-					file_info.close ();
-
-					const auto& handle = Handles_.at (i).Handle_;
-					if (handle.need_save_resume_data ())
-						handle.save_resume_data ();
-
-					const auto& savePath = StatusKeeper_->GetStatus (handle,
-								libtorrent::torrent_handle::query_save_path).save_path;
-					settings.setValue ("SavePath",
-							QString::fromUtf8 (savePath.c_str ()));
-					settings.setValue ("Filename",
-							Handles_.at (i).TorrentFileName_);
-					settings.setValue ("Tags",
-							Handles_.at (i).Tags_);
-					settings.setValue ("ID",
-							Handles_.at (i).ID_);
-					settings.setValue ("Parameters",
-							static_cast<int> (Handles_.at (i).Parameters_));
-					settings.setValue ("AutoManaged",
-							Handles_.at (i).AutoManaged_);
-
-					QByteArray prioritiesLine;
-					std::copy (Handles_.at (i).FilePriorities_.begin (),
-							Handles_.at (i).FilePriorities_.end (),
-							std::back_inserter (prioritiesLine));
-					settings.setValue ("Priorities", prioritiesLine);
+					handle.save_resume_data ();
+					++PendingResumeData_;
 				}
+
+				const auto& savePath = StatusKeeper_->GetStatus (handle,
+							libtorrent::torrent_handle::query_save_path).save_path;
+
+				const auto& infoHash = GetInfoHash (handle);
+				StateStore_->UpdateState (infoHash,
+						{
+							QString::fromUtf8 (savePath.c_str ()),
+							torrent.TorrentFileName_,
+							torrent.Tags_,
+							torrent.FilePriorities_,
+							torrent.AutoManaged_,
+							torrent.Parameters_
+						});
+				StateStore_->UpdateTorrentFile (infoHash, torrent.TorrentFileContents_);
+				order << infoHash;
 			}
 			catch (const std::exception& e)
 			{
@@ -2090,10 +2375,16 @@ namespace BitTorrent
 			{
 				qWarning () << Q_FUNC_INFO << "unknown exception";
 			}
-			CurrentTorrent_ = oldCurrent;
 		}
-		settings.endArray ();
 
+		// The torrents that are still being restored aren't in Handles_
+		// yet, so the order would lose them.
+		if (PendingRestores_.isEmpty ())
+			StateStore_->UpdateOrder (order);
+
+		QSettings settings (QCoreApplication::organizationName (),
+				QCoreApplication::applicationName () + "_Torrent");
+		settings.beginGroup ("Core");
 		settings.beginWriteArray ("IPFilter");
 		settings.remove ("");
 		int i = 0;
@@ -2121,6 +2412,23 @@ namespace BitTorrent
 		Session_->wait_for_alert (libtorrent::time_duration (5));
 
 		queryLibtorrentForWarnings ();
+
+		StateStore_->Flush ();
+	}
+
+	void Core::WaitResumeData ()
+	{
+		// The resume data requested by writeSettings() arrives asynchronously.
+		QElapsedTimer timer;
+		timer.start ();
+		while (PendingResumeData_ > 0 && timer.elapsed () < 10000)
+		{
+			Session_->wait_for_alert (libtorrent::seconds (1));
+			queryLibtorrentForWarnings ();
+		}
+
+		StateStore_->Flush ();
+		StateStore_->WaitFlushed ();
 	}
 
 	void Core::checkFinished ()
@@ -2191,6 +2499,8 @@ namespace BitTorrent
 
 		void operator() (const libtorrent::save_resume_data_failed_alert& a) const
 		{
+			Core::Instance ()->HandleResumeDataFinished ();
+
 			const auto& text = QObject::tr ("Saving resume data failed for torrent:<br />%1<br />%2")
 					.arg (GetTorrentName (a.handle))
 					.arg (QString::fromUtf8 (a.error.message ().c_str ()));
@@ -2246,11 +2556,6 @@ namespace BitTorrent
 			IEM_->HandleEntity (Util::MakeNotification ("BitTorrent", text, PCritical_));
 		}
 
-		void operator() (const libtorrent::read_piece_alert& a) const
-		{
-			Core::Instance ()->PieceRead (a);
-		}
-
 		void operator() (const libtorrent::state_update_alert& a)
 		{
 			Core::Instance ()->UpdateStatus (a.status);
@@ -2328,6 +2633,12 @@ namespace BitTorrent
 		{
 			Core::Instance ()->UpdateStatus ({ a.handle.status () });
 		}
+
+		void operator() (const libtorrent::add_torrent_alert& a)
+		{
+			Core::Instance ()->HandleTorrentAdded (a);
+			NeedToLog_ = false;
+		}
 	private:
 		QString GetTorrentName (const libtorrent::torrent_handle& handle) const
 		{
@@ -2404,7 +2715,6 @@ namespace BitTorrent
 					, libtorrent::file_error_alert
 					, libtorrent::file_renamed_alert
 					, libtorrent::file_rename_failed_alert
-					, libtorrent::read_piece_alert
 					, libtorrent::state_update_alert
 					, libtorrent::torrent_paused_alert
 					, libtorrent::torrent_resumed_alert
@@ -2414,6 +2724,7 @@ namespace BitTorrent
 					, libtorrent::dht_bootstrap_alert
 					, libtorrent::dht_get_peers_alert
 					, libtorrent::torrent_error_alert
+					, libtorrent::add_torrent_alert
 					> (alert, sd);
 			}
 			catch (const libtorrent::libtorrent_exception&)
@@ -2436,6 +2747,8 @@ namespace BitTorrent
 				qWarning () << Q_FUNC_INFO << typeid (e).name ();
 			}
 		}
+
+		FlushRestoredBatch ();
 	}
 
 	void Core::scrape ()
@@ -33,11 +33,15 @@
 #include <list>
 #include <deque>
 #include <memory>
+#include <array>
+#include <unordered_map>
+#include <boost/functional/hash.hpp>
 #include <QAbstractItemModel>
 #include <QPair>
 #include <QList>
 #include <QVector>
 #include <QIcon>
+#include <libtorrent/add_torrent_params.hpp>
 #include <libtorrent/alert_types.hpp>
 #include <libtorrent/torrent_info.hpp>
 #include <libtorrent/torrent_handle.hpp>
@@ -48,12 +52,14 @@
 #include "torrentinfo.h"
 #include "fileinfo.h"
 #include "peerinfo.h"
+#include "torrentstatestore.h"
 
 class QTimer;
 class QDomElement;
 class QToolBar;
 class QStandardItemModel;
 class QDataStream;
+class QSettings;
 
 namespace libtorrent
 {
@@ -84,6 +90,20 @@ namespace BitTorrent
 
 	using BanRange_t = QPair<QString, QString>;
 
+	/** @brief Precomputed keys for sorting the torrents list.
+	 */
+	struct TorrentSortKeys
+	{
+		QString Name_;
+
+		/** The numeric keys indexed by Core::Columns, the ID and
+		 * the name columns are unused.
+		 */
+		std::array<double, 12> Numeric_ {};
+
+		bool IsValid_ = false;
+	};
+
 	class Core : public QAbstractItemModel
 	{
 		Q_OBJECT
@@ -114,6 +134,11 @@ namespace BitTorrent
 
 			bool PauseAfterCheck_ = false;
 
+			/** Updated on each status change, lazily computed from the
+			 * cached status if there were no changes yet.
+			 */
+			mutable TorrentSortKeys SortKeys_;
+
 			TorrentStruct (const libtorrent::torrent_handle& handle,
 					const QStringList& tags,
 					int id,
@@ -163,12 +188,20 @@ namespace BitTorrent
 
 		typedef QList<TorrentStruct> HandleDict_t;
 		HandleDict_t Handles_;
+
+		/** Maps torrent handles to their rows in Handles_. It isn't
+		 * updated when rows are moved or removed, instead it's rebuilt
+		 * by FindRow() once a stale entry is found.
+		 */
+		mutable std::unordered_map<libtorrent::torrent_handle, int,
+				boost::hash<libtorrent::torrent_handle>> Handle2Row_;
 		QList<QString> Headers_;
 		mutable int CurrentTorrent_ = -1;
 		std::shared_ptr<QTimer> FinishedTimer_, WarningWatchdog_;
 		std::shared_ptr<LiveStreamManager> LiveStreamManager_;
 		QString ExternalAddress_;
 		bool SaveScheduled_ = false;
+		int PendingResumeData_ = 0;
 		QToolBar *Toolbar_ = nullptr;
 		QWidget *TabWidget_ = nullptr;
 		ICoreProxy_ptr Proxy_;
@@ -176,6 +209,22 @@ namespace BitTorrent
 		Util::ShortcutManager *ShortcutMgr_ = nullptr;
 
 		std::shared_ptr<GeoIP> GeoIP_;
+		std::shared_ptr<TorrentStateStore> StateStore_;
+
+		struct RestoringTorrent
+		{
+			SavedTorrent Saved_;
+			std::vector<int> Priorities_;
+		};
+		/** Torrents that are being restored, by hex-encoded infohash,
+		 * including the ones still waiting in RestoreQueue_.
+		 */
+		QHash<QByteArray, RestoringTorrent> PendingRestores_;
+		std::deque<libtorrent::add_torrent_params> RestoreQueue_;
+		QList<TorrentStruct> RestoredBatch_;
+		bool IsMigratingRestore_ = false;
+		int RestoreTotal_ = 0;
+		int RestoreDone_ = 0;
 
 		const QIcon TorrentIcon_ { "lcicons:/resources/images/bittorrent.svg" };
 
@@ -229,6 +278,7 @@ namespace BitTorrent
 		QAbstractItemModel* GetWebSeedsModel (int);
 		TorrentFilesModel* GetTorrentFilesModel (int);
 		CachedStatusKeeper* GetStatusKeeper () const;
+		const TorrentSortKeys& GetSortKeys (int row) const;
 
 		virtual int columnCount (const QModelIndex& = QModelIndex ()) const;
 		virtual QVariant data (const QModelIndex&, int = Qt::DisplayRole) const;
@@ -331,12 +381,19 @@ namespace BitTorrent
 		QMap<BanRange_t, bool> GetFilter () const;
 		bool CheckValidity (int) const;
 
-		void SaveResumeData (const libtorrent::save_resume_data_alert&) const;
+		void SaveResumeData (const libtorrent::save_resume_data_alert&);
+		void HandleResumeDataFinished ();
 		void HandleMetadata (const libtorrent::metadata_received_alert&);
-		void PieceRead (const libtorrent::read_piece_alert&);
 		void UpdateStatus (const std::vector<libtorrent::torrent_status>&);
 
 		void HandleTorrentChecked (const libtorrent::torrent_handle&);
+		void HandleTorrentAdded (const libtorrent::add_torrent_alert&);
+
+		/** Returns the number of the torrents restored so far and
+		 * the total number of the torrents being restored, or a pair
+		 * of zeroes if no restore is in progress.
+		 */
+		QPair<int, int> GetRestoreProgress () const;
 
 		void MoveUp (const std::vector<int>&);
 		void MoveDown (const std::vector<int>&);
@@ -347,15 +404,16 @@ namespace BitTorrent
 	private:
 		HandleDict_t::iterator FindHandle (const libtorrent::torrent_handle&);
 		HandleDict_t::const_iterator FindHandle (const libtorrent::torrent_handle&) const;
+		int FindRow (const libtorrent::torrent_handle&) const;
 
 		void MoveToTop (int);
 		void MoveToBottom (int);
 		void RestoreTorrents ();
-		libtorrent::torrent_handle RestoreSingleTorrent (const QByteArray&,
-				const QByteArray&,
-				const boost::filesystem::path&,
-				bool,
-				bool);
+		QList<SavedTorrent> LoadLegacyTorrents (QSettings&);
+		void SubmitRestores ();
+		void FlushRestoredBatch ();
+
+		void WaitResumeData ();
 
 		void HandleSingleFinished (int);
 		void HandleFileRenamed (const libtorrent::file_renamed_alert&);
@@ -389,6 +447,12 @@ namespace BitTorrent
 		void taskFinished (int);
 		void taskRemoved (int);
 		void fileRenamed (int torrent, int file, const QString& newName);
+
+		/** Emitted as the saved torrents are being restored on
+		 * startup, and once more with both parameters being equal
+		 * when all of them are processed.
+		 */
+		void restoreProgress (int done, int total);
 	};
 }
 }
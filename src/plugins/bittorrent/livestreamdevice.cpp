@@ -28,8 +28,10 @@
  **********************************************************************/
 
 #include "livestreamdevice.h"
+#include <QTimer>
 #include <QtDebug>
 #include "cachedstatuskeeper.h"
+#include "xmlsettingsmanager.h"
 
 namespace LeechCraft
 {
@@ -56,6 +58,9 @@ namespace BitTorrent
 			return *tf;
 		} ()
 	}
+	, ReadAheadBudget_ (XmlSettingsManager::Instance ()->
+			property ("LiveStreamReadAhead").toLongLong () * 1024 * 1024)
+	, PollTimer_ (new QTimer (this))
 	{
 		const auto& tpath = keeper->GetStatus (h, th::query_save_path).save_path;
 #if LIBTORRENT_VERSION_NUM >= 10100
@@ -73,24 +78,19 @@ namespace BitTorrent
 			throw std::runtime_error { QIODevice::errorString ().toStdString () };
 		}
 
+		connect (PollTimer_,
+				SIGNAL (timeout ()),
+				this,
+				SLOT (poll ()));
+		PollTimer_->start (250);
+
+		RefreshPieces ();
 		reschedule ();
 	}
 
 	qint64 LiveStreamDevice::bytesAvailable () const
 	{
-		qint64 result = 0;
-		const auto& pieces = StatusKeeper_->GetStatus (Handle_, th::query_pieces).pieces;
-		qDebug () << Q_FUNC_INFO << Offset_ << ReadPos_ << pieces [ReadPos_];
-		for (int i = ReadPos_; pieces [i]; ++i)
-		{
-			result += TI_.piece_size (i);
-			qDebug () << "added:" << result;
-		}
-		result -= Offset_;
-		if (result < 0)
-			result = 0;
-		qDebug () << "result:" << result;
-		return result;
+		return GetContiguousAvailable () + QIODevice::bytesAvailable ();
 	}
 
 	bool LiveStreamDevice::isSequential () const
@@ -110,28 +110,24 @@ namespace BitTorrent
 
 	qint64 LiveStreamDevice::pos () const
 	{
-		qint64 result = 0;
-		for (int i = 0; i < ReadPos_; ++i)
-			result += TI_.piece_size (i);
-		result += Offset_;
-		return result;
+		return Pos_;
 	}
 
 	bool LiveStreamDevice::seek (qint64 pos)
 	{
-		QIODevice::seek (pos);
-		qDebug () << Q_FUNC_INFO << pos;
+		if (pos < 0 || pos > size ())
+			return false;
 
-		int i = 0;
-		while (pos >= TI_.piece_size (i))
-			pos -= TI_.piece_size (i++);
-		ReadPos_ = i;
-		Offset_ = pos;
-
-		qDebug () << ReadPos_ << Offset_;
+		QIODevice::seek (pos);
+		Pos_ = pos;
 
 		reschedule ();
 
+		const auto available = GetContiguousAvailable ();
+		emit bufferChanged (available, ReadAheadBudget_);
+		if (available)
+			emit readyRead ();
+
 		return true;
 	}
 
@@ -140,31 +136,55 @@ namespace BitTorrent
 		return StatusKeeper_->GetStatus (Handle_, 0).total_wanted;
 	}
 
-	void LiveStreamDevice::PieceRead (const libtorrent::read_piece_alert&)
+	void LiveStreamDevice::CheckReady ()
 	{
-		CheckReady ();
-		CheckNextChunk ();
+		if (IsReady_ ||
+				static_cast<int> (Pieces_.size ()) < NumPieces_ ||
+				!Pieces_ [0] ||
+				!Pieces_ [NumPieces_ - 1])
+			return;
+
+		std::vector<int> prios (NumPieces_, 1);
+		Handle_.prioritize_pieces (prios);
+
+		IsReady_ = true;
 		reschedule ();
+		emit ready (this);
 	}
 
-	void LiveStreamDevice::CheckReady ()
+	void LiveStreamDevice::SetReadAheadBudget (qint64 budget)
 	{
-		const auto& pieces = StatusKeeper_->GetStatus (Handle_, th::query_pieces).pieces;
-		if (!IsReady_ &&
-				pieces [0] &&
-				pieces [NumPieces_ - 1])
-		{
-			std::vector<int> prios (NumPieces_, 1);
-			Handle_.prioritize_pieces (prios);
+		ReadAheadBudget_ = std::max<qint64> (budget, PieceLength_);
+		reschedule ();
+	}
 
-			IsReady_ = true;
-			emit ready (this);
-		}
+	auto LiveStreamDevice::GetBufferStats () const -> BufferStats
+	{
+		const auto first = GetPieceAt (Pos_);
+		const auto last = GetPieceAt (std::max (Pos_, std::min (Pos_ + ReadAheadBudget_, size ()) - 1));
+
+		int done = 0;
+		for (int i = first; i <= last; ++i)
+			if (i < static_cast<int> (Pieces_.size ()) && Pieces_ [i])
+				++done;
+
+		return
+		{
+			Pos_,
+			GetContiguousAvailable (),
+			ReadAheadBudget_,
+			last - first + 1,
+			done
+		};
 	}
 
 	qint64 LiveStreamDevice::readData (char *data, qint64 max)
 	{
-		if (!File_.open (QIODevice::ReadOnly))
+		const auto available = std::min (max, GetContiguousAvailable ());
+		if (available <= 0)
+			return 0;
+
+		if (!File_.isOpen () && !File_.open (QIODevice::ReadOnly))
 		{
 			qWarning () << Q_FUNC_INFO
 				<< "could not open underlying file"
@@ -172,18 +192,24 @@ namespace BitTorrent
 				<< File_.errorString ();
 			return -1;
 		}
-		qint64 ba = bytesAvailable ();
-		File_.seek (pos ());
-		const qint64 result = File_.read (data, std::min (max, ba));
-		File_.close ();
 
-		qDebug () << Q_FUNC_INFO << result << Offset_ << ReadPos_ << max << ba;
+		if (!File_.seek (Pos_))
+		{
+			qWarning () << Q_FUNC_INFO
+				<< "could not seek underlying file to"
+				<< Pos_
+				<< File_.errorString ();
+			return -1;
+		}
 
-		Offset_ += result;
-		while (Offset_ >= TI_.piece_size (ReadPos_))
-			Offset_ -= TI_.piece_size (ReadPos_++);
+		const qint64 result = File_.read (data, available);
+		if (result <= 0)
+			return result;
 
-		qDebug () << Offset_ << ReadPos_ << bytesAvailable ();
+		const auto prevPiece = GetPieceAt (Pos_);
+		Pos_ += result;
+		if (GetPieceAt (Pos_) != prevPiece)
+			reschedule ();
 
 		return result;
 	}
@@ -193,56 +219,107 @@ namespace BitTorrent
 		return -1;
 	}
 
-	void LiveStreamDevice::CheckNextChunk ()
+	int LiveStreamDevice::GetPieceAt (qint64 pos) const
 	{
-		bool hasMoreData = false;
-		const auto& pieces = StatusKeeper_->GetStatus (Handle_, th::query_pieces).pieces;
-		for (int i = ReadPos_ + 1;
-				i < NumPieces_ && pieces [i];
-				++i, hasMoreData = true);
+		return std::min<qint64> (pos / PieceLength_, NumPieces_ - 1);
+	}
 
-		if (hasMoreData)
-			emit readyRead ();
+	qint64 LiveStreamDevice::GetContiguousAvailable () const
+	{
+		const auto total = size ();
+		if (Pos_ >= total)
+			return 0;
+
+		const auto first = GetPieceAt (Pos_);
+		const auto numKnown = std::min<int> (NumPieces_, Pieces_.size ());
+
+		qint64 end = static_cast<qint64> (first) * PieceLength_;
+		for (int i = first; i < numKnown && Pieces_ [i]; ++i)
+			end += TI_.piece_size (i);
+
+		return std::max<qint64> (0, std::min (end, total) - Pos_);
+	}
+
+	void LiveStreamDevice::RefreshPieces ()
+	{
+		const auto& status = Handle_.status (th::query_pieces);
+		Pieces_ = status.pieces;
+		if (Pieces_.empty () && status.is_seeding)
+			Pieces_.resize (NumPieces_, true);
 	}
 
 	void LiveStreamDevice::reschedule ()
 	{
-		const auto& status = StatusKeeper_->GetStatus (Handle_, th::query_pieces);
-		const auto& pieces = status.pieces;
-		int speed = status.download_payload_rate;
-		int size = TI_.piece_length ();
-		const int time = speed ?
-			static_cast<double> (size) / speed * 1000 :
-			60000;
-
-		int thisDeadline = 0;
-		for (int i = ReadPos_; i < NumPieces_; ++i)
-			if (!pieces [i])
-				Handle_.set_piece_deadline (i,
-						IsReady_ ?
-							(thisDeadline += time) :
-							1000000,
-						1);
 		if (!IsReady_)
 		{
 			std::vector<int> prios (NumPieces_, 0);
-			if (pieces.size () > 1)
+			if (NumPieces_ > 1)
 				prios [1] = 1;
 
-			if (!pieces [0])
+			const auto has = [this] (int piece)
+			{
+				return piece < static_cast<int> (Pieces_.size ()) && Pieces_ [piece];
+			};
+
+			if (!has (0))
 			{
 				qDebug () << "scheduling first piece";
-				Handle_.set_piece_deadline (0, 500, 1);
+				Handle_.set_piece_deadline (0, 500);
 				prios [0] = 7;
 			}
-			if (!pieces [NumPieces_ - 1])
+			if (!has (NumPieces_ - 1))
 			{
 				qDebug () << "scheduling last piece";
-				Handle_.set_piece_deadline (NumPieces_ - 1, 500, 1);
+				Handle_.set_piece_deadline (NumPieces_ - 1, 500);
 				prios [NumPieces_ - 1] = 7;
 			}
 			Handle_.prioritize_pieces (prios);
+			return;
 		}
+
+		const auto& status = StatusKeeper_->GetStatus (Handle_, 0);
+		const int speed = status.download_payload_rate;
+		const int pieceTime = speed ?
+				std::max (static_cast<int> (static_cast<double> (PieceLength_) / speed * 1000), 50) :
+				60000;
+
+		const auto first = GetPieceAt (Pos_);
+		const auto last = GetPieceAt (std::max (Pos_, std::min (Pos_ + ReadAheadBudget_, size ()) - 1));
+
+		QSet<int> window;
+		for (int i = first; i <= last; ++i)
+		{
+			if (i < static_cast<int> (Pieces_.size ()) && Pieces_ [i])
+				continue;
+
+			window << i;
+			Handle_.set_piece_deadline (i, (i - first + 1) * pieceTime);
+		}
+
+		for (const auto piece : ScheduledPieces_ - window)
+			Handle_.reset_piece_deadline (piece);
+		ScheduledPieces_ = window;
+	}
+
+	void LiveStreamDevice::poll ()
+	{
+		const auto before = GetContiguousAvailable ();
+
+		RefreshPieces ();
+		CheckReady ();
+
+		const auto after = GetContiguousAvailable ();
+		if (after != before)
+		{
+			emit bufferChanged (after, ReadAheadBudget_);
+			if (after > before)
+				emit readyRead ();
+
+			reschedule ();
+		}
+
+		if (!Pieces_.empty () && Pieces_.all_set ())
+			PollTimer_->stop ();
 	}
 }
 }
@@ -29,11 +29,13 @@
 
 #pragma once
 
-#include <QVector>
+#include <QSet>
 #include <QFile>
 #include <libtorrent/torrent_handle.hpp>
 #include <libtorrent/torrent_info.hpp>
-#include <libtorrent/alert_types.hpp>
+#include <libtorrent/bitfield.hpp>
+
+class QTimer;
 
 namespace LeechCraft
 {
@@ -41,6 +43,16 @@ namespace BitTorrent
 {
 	class CachedStatusKeeper;
 
+	/** @brief Streams the first file of a torrent while it's being
+	 * downloaded.
+	 *
+	 * The device keeps a read-ahead window of pieces following the
+	 * current read position, whose size is limited by a byte budget.
+	 * The missing pieces in this window get deadlines graded by their
+	 * distance from the read position, so that the nearest ones are
+	 * downloaded first. Completed pieces are read directly from the
+	 * file on the disk.
+	 */
 	class LiveStreamDevice : public QIODevice
 	{
 		Q_OBJECT
@@ -50,36 +62,71 @@ namespace BitTorrent
 		const libtorrent::torrent_handle Handle_;
 		const libtorrent::torrent_info TI_;
 		const int NumPieces_ = TI_.num_pieces ();
+		const int PieceLength_ = TI_.piece_length ();
+
+		libtorrent::bitfield Pieces_;
+
+		qint64 Pos_ = 0;
+		qint64 ReadAheadBudget_;
 
-		int LastIndex_ = 0;
-		// Which piece would be read next.
-		int ReadPos_ = 0;
-		// Offset in the next piece pointed by ReadPos_;
-		int Offset_ = 0;
-		bool IsReady_ = 0;
+		QSet<int> ScheduledPieces_;
+
+		bool IsReady_ = false;
 		QFile File_;
+
+		QTimer * const PollTimer_;
 	public:
+		struct BufferStats
+		{
+			/// The current read position.
+			qint64 Position_;
+			/// The number of bytes available right after the position.
+			qint64 Buffered_;
+			/// The read-ahead budget in bytes.
+			qint64 Budget_;
+
+			/// The number of pieces in the read-ahead window.
+			int WindowPieces_;
+			/// The number of downloaded pieces in the window.
+			int WindowPiecesDone_;
+		};
+
 		LiveStreamDevice (const libtorrent::torrent_handle&, CachedStatusKeeper*, QObject* = nullptr);
 
-		virtual qint64 bytesAvailable () const;
-		virtual bool isSequential () const;
-		virtual bool isWritable () const;
-		virtual bool open (OpenMode);
-		virtual qint64 pos () const;
-		virtual bool seek (qint64);
-		virtual qint64 size () const;
+		qint64 bytesAvailable () const override;
+		bool isSequential () const override;
+		bool isWritable () const override;
+		bool open (OpenMode) override;
+		qint64 pos () const override;
+		bool seek (qint64) override;
+		qint64 size () const override;
 
-		void PieceRead (const libtorrent::read_piece_alert&);
 		void CheckReady ();
+
+		/** @brief Sets the size of the read-ahead window in bytes.
+		 *
+		 * By default it's taken from the LiveStreamReadAhead setting.
+		 */
+		void SetReadAheadBudget (qint64);
+
+		BufferStats GetBufferStats () const;
 	protected:
-		virtual qint64 readData (char*, qint64);
-		virtual qint64 writeData (const char*, qint64);
+		qint64 readData (char*, qint64) override;
+		qint64 writeData (const char*, qint64) override;
 	private:
-		void CheckNextChunk ();
+		int GetPieceAt (qint64) const;
+		qint64 GetContiguousAvailable () const;
+		void RefreshPieces ();
 	private slots:
 		void reschedule ();
+		void poll ();
 	signals:
 		void ready (LiveStreamDevice*);
+
+		/** Emitted when the number of bytes available after the
+		 * current read position changes.
+		 */
+		void bufferChanged (qint64 buffered, qint64 budget);
 	};
 }
 }
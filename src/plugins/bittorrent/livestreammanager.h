@@ -32,7 +32,6 @@
 #include <QObject>
 #include <QList>
 #include <libtorrent/torrent_handle.hpp>
-#include <libtorrent/alert_types.hpp>
 #include <interfaces/core/icoreproxy.h>
 #include <interfaces/structures.h>
 
@@ -55,7 +54,6 @@ namespace BitTorrent
 
 		void EnableOn (const libtorrent::torrent_handle&);
 		bool IsEnabledOn (const libtorrent::torrent_handle&);
-		void PieceRead (const libtorrent::read_piece_alert&);
 	private slots:
 		void handleDeviceReady (LiveStreamDevice*);
 	};
@@ -376,7 +376,6 @@ namespace BitTorrent
 			"NotificationPortMapping",
 			"NotificationStorage",
 			"NotificationTracker",
-			"NotificationStatus",
 			"NotificationProgress",
 			"NotificationIPBlock",
 			"NotificationDHT"
@@ -406,8 +405,9 @@ namespace BitTorrent
 			mask |= libtorrent::alert::storage_notification;
 		if (XmlSettingsManager::Instance ()->property ("NotificationTracker").toBool ())
 			mask |= libtorrent::alert::tracker_notification;
-		if (XmlSettingsManager::Instance ()->property ("NotificationStatus").toBool ())
-			mask |= libtorrent::alert::status_notification;
+		// Status notifications carry the add_torrent_alerts needed to
+		// finish restoring the torrents, so they are always enabled.
+		mask |= libtorrent::alert::status_notification;
 		if (XmlSettingsManager::Instance ()->property ("NotificationProgress").toBool ())
 			mask |= libtorrent::alert::progress_notification;
 		if (XmlSettingsManager::Instance ()->property ("NotificationIPBlock").toBool ())
@@ -31,6 +31,7 @@
 #include <interfaces/core/icoreproxy.h>
 #include <interfaces/core/itagsmanager.h>
 #include "core.h"
+#include "cachedstatuskeeper.h"
 
 namespace LeechCraft
 {
@@ -46,7 +47,7 @@ namespace BitTorrent
 	{
 		const auto& idx = Core::Instance ()->index (row, Core::ColumnName);
 		const auto& h = Core::Instance ()->GetTorrentHandle (idx.row ());
-		const auto state = h.status ().state;
+		const auto state = Core::Instance ()->GetStatusKeeper ()->GetStatus (h, 0).state;
 
 		switch (StateFilter_)
 		{
@@ -81,6 +82,21 @@ namespace BitTorrent
 		return false;
 	}
 
+	bool TabViewProxyModel::lessThan (const QModelIndex& left, const QModelIndex& right) const
+	{
+		const auto column = left.column ();
+		if (column == Core::ColumnID)
+			return left.row () < right.row ();
+
+		const auto core = Core::Instance ();
+		const auto& leftKeys = core->GetSortKeys (left.row ());
+		const auto& rightKeys = core->GetSortKeys (right.row ());
+		if (column == Core::ColumnName)
+			return QString::compare (leftKeys.Name_, rightKeys.Name_, sortCaseSensitivity ()) < 0;
+
+		return leftKeys.Numeric_ [column] < rightKeys.Numeric_ [column];
+	}
+
 	void TabViewProxyModel::setStateFilterMode (int mode)
 	{
 		StateFilter_ = static_cast<StateFilterMode> (mode);
@@ -49,6 +49,7 @@ namespace BitTorrent
 		TabViewProxyModel (QObject* = 0);
 	protected:
 		bool filterAcceptsRow (int, const QModelIndex&) const;
+		bool lessThan (const QModelIndex&, const QModelIndex&) const;
 	public slots:
 		void setStateFilterMode (int);
 	};
@@ -0,0 +1,365 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "torrentstatestore.h"
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtConcurrentRun>
+#include <QtDebug>
+#include <util/sys/paths.h>
+
+#ifdef Q_OS_UNIX
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	namespace
+	{
+		const QString StateExt = "state";
+		const QString TorrentExt = "torrent";
+		const QString ResumeExt = "resume";
+
+		QByteArray SerializeState (const SavedTorrentState& state)
+		{
+			QByteArray result;
+
+			QDataStream out { &result, QIODevice::WriteOnly };
+			out << static_cast<quint8> (1)
+					<< state.SavePath_
+					<< state.Filename_
+					<< state.Tags_
+					<< QVector<int>::fromStdVector (state.Priorities_)
+					<< state.AutoManaged_
+					<< static_cast<qint32> (state.Parameters_);
+
+			return result;
+		}
+
+		bool DeserializeState (const QByteArray& data, SavedTorrentState& state)
+		{
+			QDataStream in { data };
+
+			quint8 version = 0;
+			in >> version;
+			if (version != 1)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unknown version"
+						<< version;
+				return false;
+			}
+
+			QVector<int> priorities;
+			qint32 params = 0;
+			in >> state.SavePath_
+					>> state.Filename_
+					>> state.Tags_
+					>> priorities
+					>> state.AutoManaged_
+					>> params;
+			state.Priorities_ = priorities.toStdVector ();
+			state.Parameters_ = static_cast<TaskParameters> (params);
+
+			return in.status () == QDataStream::Ok;
+		}
+
+		QByteArray ReadFile (const QString& path)
+		{
+			QFile file { path };
+			if (!file.open (QIODevice::ReadOnly))
+				return {};
+
+			return file.readAll ();
+		}
+
+		/** Performs the removals and then the writes, returning the
+		 * paths that couldn't be written.
+		 */
+		QStringList WriteFiles (const QString& dirPath,
+				const QHash<QString, QByteArray>& writes, const QSet<QString>& removals)
+		{
+			for (const auto& path : removals)
+				if (QFile::exists (path) && !QFile::remove (path))
+					qWarning () << Q_FUNC_INFO
+							<< "unable to remove"
+							<< path;
+
+			QStringList failed;
+
+#ifdef Q_OS_UNIX
+			QStringList written;
+			for (auto i = writes.begin (); i != writes.end (); ++i)
+			{
+				QFile file { i.key () + ".tmp" };
+				if (!file.open (QIODevice::WriteOnly | QIODevice::Truncate) ||
+						file.write (*i) != i->size ())
+				{
+					qWarning () << Q_FUNC_INFO
+							<< "unable to write"
+							<< file.fileName ()
+							<< file.errorString ();
+					failed << i.key ();
+					continue;
+				}
+
+				written << i.key ();
+			}
+
+			const auto dirFd = ::open (QFile::encodeName (dirPath).constData (), O_RDONLY);
+#ifdef Q_OS_LINUX
+			if (dirFd >= 0)
+				::syncfs (dirFd);
+			else
+#endif
+				::sync ();
+
+			for (const auto& path : written)
+				if (std::rename (QFile::encodeName (path + ".tmp").constData (),
+							QFile::encodeName (path).constData ()))
+				{
+					qWarning () << Q_FUNC_INFO
+							<< "unable to rename"
+							<< path;
+					failed << path;
+				}
+
+			if (dirFd >= 0)
+			{
+				::fsync (dirFd);
+				::close (dirFd);
+			}
+#else
+			Q_UNUSED (dirPath)
+
+			for (auto i = writes.begin (); i != writes.end (); ++i)
+			{
+				QSaveFile file { i.key () };
+				if (!file.open (QIODevice::WriteOnly) ||
+						file.write (*i) != i->size () ||
+						!file.commit ())
+				{
+					qWarning () << Q_FUNC_INFO
+							<< "unable to write"
+							<< file.fileName ()
+							<< file.errorString ();
+					failed << i.key ();
+				}
+			}
+#endif
+
+			return failed;
+		}
+	}
+
+	TorrentStateStore::TorrentStateStore ()
+	: Dir_ { Util::CreateIfNotExists ("bittorrent/state") }
+	{
+		FlushPool_.setMaxThreadCount (1);
+	}
+
+	TorrentStateStore::~TorrentStateStore ()
+	{
+		WaitFlushed ();
+	}
+
+	bool TorrentStateStore::HasSavedState () const
+	{
+		return QFile::exists (GetOrderPath ());
+	}
+
+	QList<QByteArray> TorrentStateStore::LoadOrder () const
+	{
+		QList<QByteArray> result;
+		for (const auto& infoHash : ReadFile (GetOrderPath ()).split ('\n'))
+			if (!infoHash.isEmpty ())
+				result << infoHash;
+		return result;
+	}
+
+	boost::optional<SavedTorrent> TorrentStateStore::LoadTorrent (const QByteArray& infoHash) const
+	{
+		SavedTorrentState state;
+		if (!DeserializeState (ReadFile (GetPath (infoHash, StateExt)), state))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to load state for"
+					<< infoHash;
+			return {};
+		}
+
+		const auto& torrentFile = ReadFile (GetPath (infoHash, TorrentExt));
+		if (torrentFile.isEmpty ())
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "empty torrent data for"
+					<< infoHash;
+			return {};
+		}
+
+		return SavedTorrent
+		{
+			infoHash,
+			state,
+			torrentFile,
+			ReadFile (GetPath (infoHash, ResumeExt))
+		};
+	}
+
+	void TorrentStateStore::MarkLoaded (const SavedTorrent& torrent)
+	{
+		WrittenStates_ [torrent.InfoHash_] = SerializeState (torrent.State_);
+		WrittenTorrentFiles_ << torrent.InfoHash_;
+		WrittenOrder_ << torrent.InfoHash_;
+	}
+
+	void TorrentStateStore::UpdateState (const QByteArray& infoHash, const SavedTorrentState& state)
+	{
+		const auto& data = SerializeState (state);
+		if (WrittenStates_.value (infoHash) == data)
+			return;
+
+		WrittenStates_ [infoHash] = data;
+		PendingWrites_ [GetPath (infoHash, StateExt)] = data;
+	}
+
+	void TorrentStateStore::UpdateTorrentFile (const QByteArray& infoHash, const QByteArray& contents)
+	{
+		if (contents.isEmpty () || WrittenTorrentFiles_.contains (infoHash))
+			return;
+
+		WrittenTorrentFiles_ << infoHash;
+		PendingWrites_ [GetPath (infoHash, TorrentExt)] = contents;
+	}
+
+	void TorrentStateStore::UpdateResumeData (const QByteArray& infoHash, const QByteArray& resumeData)
+	{
+		if (resumeData.isEmpty ())
+			return;
+
+		PendingWrites_ [GetPath (infoHash, ResumeExt)] = resumeData;
+	}
+
+	void TorrentStateStore::UpdateOrder (const QList<QByteArray>& infoHashes)
+	{
+		if (WrittenOrder_ == infoHashes)
+			return;
+
+		WrittenOrder_ = infoHashes;
+
+		QByteArray data;
+		for (const auto& infoHash : infoHashes)
+			data += infoHash + '\n';
+		PendingWrites_ [GetOrderPath ()] = data;
+	}
+
+	void TorrentStateStore::Remove (const QByteArray& infoHash)
+	{
+		WrittenStates_.remove (infoHash);
+		WrittenTorrentFiles_.remove (infoHash);
+
+		for (const auto& ext : { StateExt, TorrentExt, ResumeExt })
+		{
+			const auto& path = GetPath (infoHash, ext);
+			PendingWrites_.remove (path);
+			PendingRemovals_ << path;
+		}
+	}
+
+	void TorrentStateStore::Flush ()
+	{
+		// The failed files are rewritten by the next Flush() after the
+		// corresponding Update*() call.
+		QStringList failed;
+		{
+			std::lock_guard<std::mutex> guard { FailedWritesMutex_ };
+			failed.swap (FailedWrites_);
+		}
+		for (const auto& path : failed)
+			Forget (path);
+
+		if (PendingWrites_.isEmpty () && PendingRemovals_.isEmpty ())
+			return;
+
+		const auto writes = PendingWrites_;
+		const auto removals = PendingRemovals_;
+		PendingWrites_.clear ();
+		PendingRemovals_.clear ();
+
+		const auto& dirPath = Dir_.absolutePath ();
+		QtConcurrent::run (&FlushPool_,
+				[this, dirPath, writes, removals]
+				{
+					const auto& failed = WriteFiles (dirPath, writes, removals);
+					if (failed.isEmpty ())
+						return;
+
+					std::lock_guard<std::mutex> guard { FailedWritesMutex_ };
+					FailedWrites_ += failed;
+				});
+	}
+
+	void TorrentStateStore::WaitFlushed ()
+	{
+		FlushPool_.waitForDone ();
+	}
+
+	QString TorrentStateStore::GetPath (const QByteArray& infoHash, const QString& ext) const
+	{
+		return Dir_.filePath (QString::fromLatin1 (infoHash) + '.' + ext);
+	}
+
+	QString TorrentStateStore::GetOrderPath () const
+	{
+		return Dir_.filePath ("order");
+	}
+
+	void TorrentStateStore::Forget (const QString& path)
+	{
+		if (path == GetOrderPath ())
+		{
+			WrittenOrder_.clear ();
+			return;
+		}
+
+		const QFileInfo fi { path };
+		const auto& infoHash = fi.completeBaseName ().toLatin1 ();
+		if (fi.suffix () == StateExt)
+			WrittenStates_.remove (infoHash);
+		else if (fi.suffix () == TorrentExt)
+			WrittenTorrentFiles_.remove (infoHash);
+	}
+}
+}
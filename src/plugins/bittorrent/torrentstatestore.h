@@ -0,0 +1,167 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <boost/optional.hpp>
+#include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <interfaces/structures.h>
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	/** @brief The persistent state of a single torrent.
+	 */
+	struct SavedTorrentState
+	{
+		QString SavePath_;
+		QString Filename_;
+		QStringList Tags_;
+		std::vector<int> Priorities_;
+		bool AutoManaged_ = true;
+		TaskParameters Parameters_ = NoParameters;
+	};
+
+	/** @brief A torrent as loaded from the persistent storage.
+	 */
+	struct SavedTorrent
+	{
+		/// The hex-encoded infohash of the torrent.
+		QByteArray InfoHash_;
+
+		SavedTorrentState State_;
+
+		QByteArray TorrentFile_;
+		QByteArray ResumeData_;
+	};
+
+	/** @brief Journaled per-torrent persistent storage.
+	 *
+	 * Each torrent is stored as a set of files named after its infohash
+	 * (the state record, the .torrent file and the resume data), plus
+	 * a separate file holding the order of the torrents.
+	 *
+	 * The Update*() methods only queue a write if the corresponding
+	 * data has actually changed since it was last written, and the
+	 * queued writes are performed all at once by Flush() in a
+	 * background thread. Each file is replaced atomically, and the data
+	 * is synced to the disk once per Flush() call rather than once per
+	 * file where the platform allows this.
+	 */
+	class TorrentStateStore
+	{
+		const QDir Dir_;
+
+		QHash<QByteArray, QByteArray> WrittenStates_;
+		QSet<QByteArray> WrittenTorrentFiles_;
+		QList<QByteArray> WrittenOrder_;
+
+		QHash<QString, QByteArray> PendingWrites_;
+		QSet<QString> PendingRemovals_;
+
+		/* Single-threaded, so that the flushes are performed in the
+		 * order they've been requested in.
+		 */
+		QThreadPool FlushPool_;
+
+		std::mutex FailedWritesMutex_;
+		QStringList FailedWrites_;
+	public:
+		TorrentStateStore ();
+		~TorrentStateStore ();
+
+		/** @brief Returns whether anything has been saved to this store.
+		 *
+		 * If this returns false, the torrents should be migrated from
+		 * the legacy storage.
+		 */
+		bool HasSavedState () const;
+
+		/** @brief Returns the infohashes of the saved torrents in order.
+		 *
+		 * This function is thread-safe.
+		 */
+		QList<QByteArray> LoadOrder () const;
+
+		/** @brief Loads the torrent with the given infohash.
+		 *
+		 * This function only reads the files belonging to the torrent
+		 * and thus may be called from several threads at once.
+		 *
+		 * @param[in] infoHash The hex-encoded infohash of the torrent.
+		 * @return The saved torrent, or an empty optional if its files
+		 * are missing or broken.
+		 *
+		 * @sa MarkLoaded()
+		 */
+		boost::optional<SavedTorrent> LoadTorrent (const QByteArray& infoHash) const;
+
+		/** @brief Notes that the given torrent has been restored.
+		 *
+		 * This is used to avoid rewriting the unchanged data of the
+		 * torrent returned by LoadTorrent() on the next Flush().
+		 *
+		 * @param[in] torrent The torrent previously returned by
+		 * LoadTorrent().
+		 */
+		void MarkLoaded (const SavedTorrent& torrent);
+
+		void UpdateState (const QByteArray& infoHash, const SavedTorrentState& state);
+		void UpdateTorrentFile (const QByteArray& infoHash, const QByteArray& contents);
+		void UpdateResumeData (const QByteArray& infoHash, const QByteArray& resumeData);
+		void UpdateOrder (const QList<QByteArray>& infoHashes);
+
+		void Remove (const QByteArray& infoHash);
+
+		/** @brief Writes the queued changes in a background thread.
+		 *
+		 * This function returns immediately.
+		 *
+		 * @sa WaitFlushed()
+		 */
+		void Flush ();
+
+		/** @brief Waits until all the requested flushes are done.
+		 */
+		void WaitFlushed ();
+	private:
+		QString GetPath (const QByteArray& infoHash, const QString& ext) const;
+		QString GetOrderPath () const;
+
+		void Forget (const QString& path);
+	};
+}
+}
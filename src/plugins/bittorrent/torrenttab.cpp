@@ -117,6 +117,13 @@ namespace BitTorrent
 				SLOT (handleTorrentSelected (QModelIndex)));
 		Ui_.TorrentsView_->sortByColumn (Core::ColumnID, Qt::SortOrder::AscendingOrder);
 
+		connect (Core::Instance (),
+				SIGNAL (restoreProgress (int, int)),
+				this,
+				SLOT (handleRestoreProgress (int, int)));
+		const auto& restoreProgress = Core::Instance ()->GetRestoreProgress ();
+		handleRestoreProgress (restoreProgress.first, restoreProgress.second);
+
 		const auto& fm = Ui_.TorrentsView_->fontMetrics ();
 		QHeaderView *header = Ui_.TorrentsView_->header ();
 		header->resizeSection (Core::Columns::ColumnID, fm.width ("999"));
@@ -382,6 +389,13 @@ namespace BitTorrent
 		menu.exec (Ui_.TorrentsView_->viewport ()->mapToGlobal (point));
 	}
 
+	void TorrentTab::handleRestoreProgress (int done, int total)
+	{
+		Ui_.RestoreProgress_->setVisible (done < total);
+		Ui_.RestoreProgress_->setMaximum (total);
+		Ui_.RestoreProgress_->setValue (done);
+	}
+
 	void TorrentTab::handleOpenTorrentTriggered ()
 	{
 		auto dia = new AddTorrent (this);
@@ -84,6 +84,7 @@ namespace BitTorrent
 	private slots:
 		void handleTorrentSelected (const QModelIndex&);
 		void setActionsEnabled ();
+		void handleRestoreProgress (int, int);
 
 		void on_TorrentsView__customContextMenuRequested (const QPoint&);
 
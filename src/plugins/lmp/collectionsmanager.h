@@ -59,6 +59,15 @@ namespace LMP
 
 		QAbstractItemModel* GetModel () const;
 
+		/** @brief Maps an index of GetModel() to the collection model.
+		 *
+		 * @param[in] index The index of the model returned by
+		 * GetModel().
+		 * @return The index of the concrete collection model (like
+		 * LocalCollectionModel) corresponding to \em index.
+		 */
+		QModelIndex MapToSource (const QModelIndex& index) const;
+
 		void Enqueue (const QList<QModelIndex>&, Player*);
 	};
 }
@@ -37,6 +37,7 @@
 #include <interfaces/core/iiconthememanager.h>
 #include "core.h"
 #include "localcollection.h"
+#include "localcollectionmodel.h"
 #include "palettefixerfilter.h"
 #include "collectiondelegate.h"
 #include "audiopropswidget.h"
@@ -54,9 +55,14 @@ namespace LMP
 	{
 		class CollectionFilterModel : public QSortFilterProxyModel
 		{
+			CollectionsManager * const CollMgr_;
+
+			mutable QString LastPattern_;
+			mutable QString LowerPattern_;
 		public:
-			CollectionFilterModel (QObject *parent = nullptr)
+			CollectionFilterModel (CollectionsManager *collMgr, QObject *parent = nullptr)
 			: QSortFilterProxyModel { parent }
+			, CollMgr_ { collMgr }
 			{
 				setDynamicSortFilter (true);
 			}
@@ -64,6 +70,11 @@ namespace LMP
 			bool filterAcceptsRow (int sourceRow, const QModelIndex& sourceParent) const
 			{
 				const auto& source = sourceModel ()->index (sourceRow, 0, sourceParent);
+
+				const auto& collSource = CollMgr_->MapToSource (source);
+				if (const auto localModel = qobject_cast<const LocalCollectionModel*> (collSource.model ()))
+					return localModel->MatchesFilter (collSource, GetLowerPattern ());
+
 				if (source.data (LocalCollectionModel::Role::IsTrackIgnored).toBool ())
 					return false;
 
@@ -89,13 +100,24 @@ namespace LMP
 						check (LocalCollectionModel::Role::TrackTitle) ||
 						check (LocalCollectionModel::Role::AlbumYear);
 			}
+		private:
+			const QString& GetLowerPattern () const
+			{
+				const auto& pattern = filterRegExp ().pattern ();
+				if (pattern != LastPattern_)
+				{
+					LastPattern_ = pattern;
+					LowerPattern_ = pattern.toLower ();
+				}
+				return LowerPattern_;
+			}
 		};
 	}
 
 	CollectionWidget::CollectionWidget (QWidget *parent)
 	: QWidget { parent }
 	, Player_ { Core::Instance ().GetPlayer () }
-	, CollectionFilterModel_ { new CollectionFilterModel { this } }
+	, CollectionFilterModel_ { new CollectionFilterModel { Core::Instance ().GetCollectionsManager (), this } }
 	{
 		Ui_.setupUi (this);
 
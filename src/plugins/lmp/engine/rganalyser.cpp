@@ -35,6 +35,11 @@
 #include <QMetaType>
 #include <QtDebug>
 #include <QUrl>
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#endif
+
 #include "util/lmp/gstutil.h"
 #include "../gstfix.h"
 #include "../xmlsettingsmanager.h"
@@ -106,6 +111,24 @@ namespace LMP
 		}
 	}
 
+	namespace
+	{
+		/* Called from the streaming threads of the pipeline as they are
+		 * entered, so that the analysis only uses otherwise idle CPU time.
+		 */
+		void LowerCurrentThreadPriority ()
+		{
+#ifdef Q_OS_LINUX
+			sched_param param {};
+			if (sched_setscheduler (0, SCHED_IDLE, &param))
+				qWarning () << Q_FUNC_INFO
+						<< "unable to set idle scheduling policy";
+#else
+			QThread::currentThread ()->setPriority (QThread::IdlePriority);
+#endif
+		}
+	}
+
 	RgAnalyser::RgAnalyser (const QStringList& paths, QObject *parent)
 	: QObject { parent }
 	, Paths_ { paths }
@@ -132,9 +155,26 @@ namespace LMP
 		g_object_set (GST_OBJECT (RGAnalysis_), "num-tracks", paths.size (), nullptr);
 		g_object_set (GST_OBJECT (Pipeline_), "audio-sink", SinkBin_, nullptr);
 
+		const auto bus = gst_pipeline_get_bus (GST_PIPELINE (Pipeline_));
+		gst_bus_set_sync_handler (bus,
+				[] (GstBus*, GstMessage *msg, gpointer) -> GstBusSyncReply
+				{
+					if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_STREAM_STATUS)
+					{
+						GstStreamStatusType type;
+						gst_message_parse_stream_status (msg, &type, nullptr);
+						if (type == GST_STREAM_STATUS_TYPE_ENTER)
+							LowerCurrentThreadPriority ();
+					}
+					return GST_BUS_PASS;
+				},
+				nullptr,
+				nullptr);
+		gst_object_unref (bus);
+
 		CheckFinish ();
 
-		PopThread_->start ();
+		PopThread_->start (QThread::LowestPriority);
 	}
 
 	RgAnalyser::~RgAnalyser ()
@@ -152,6 +192,16 @@ namespace LMP
 		return Result_;
 	}
 
+	void RgAnalyser::SetPaused (bool paused)
+	{
+		if (paused == IsPaused_)
+			return;
+
+		IsPaused_ = paused;
+		if (!CurrentPath_.isEmpty ())
+			gst_element_set_state (Pipeline_, paused ? GST_STATE_PAUSED : GST_STATE_PLAYING);
+	}
+
 	void RgAnalyser::CheckFinish ()
 	{
 		gst_element_set_state (Pipeline_, GST_STATE_NULL);
@@ -168,7 +218,7 @@ namespace LMP
 		const auto& url = QUrl::fromLocalFile (CurrentPath_);
 		g_object_set (GST_OBJECT (Pipeline_), "uri",
 				url.toEncoded ().constData (), nullptr);
-		gst_element_set_state (Pipeline_, GST_STATE_PLAYING);
+		gst_element_set_state (Pipeline_, IsPaused_ ? GST_STATE_PAUSED : GST_STATE_PLAYING);
 	}
 
 	void RgAnalyser::HandleTagMsg (GstMessage *msg)
@@ -79,11 +79,14 @@ namespace LMP
 		LightPopThread * const PopThread_;
 
 		bool IsDraining_ = false;
+		bool IsPaused_ = false;
 	public:
 		RgAnalyser (const QStringList&, QObject* = nullptr);
 		~RgAnalyser ();
 
 		const AlbumRgResult& GetResult () const;
+
+		void SetPaused (bool);
 	private:
 		void CheckFinish ();
 
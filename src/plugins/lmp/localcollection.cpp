@@ -31,10 +31,14 @@
 #include <functional>
 #include <algorithm>
 #include <numeric>
+#include <memory>
+#include <atomic>
 #include <QStandardItemModel>
-#include <QtConcurrentMap>
+#include <QFutureInterface>
 #include <QtConcurrentRun>
 #include <QTimer>
+#include <QThread>
+#include <QFile>
 #include <QtDebug>
 #include <util/sll/either.h>
 #include <util/xpc/util.h>
@@ -51,6 +55,11 @@
 #include "localcollectionwatcher.h"
 #include "localcollectionmodel.h"
 
+#ifdef Q_OS_LINUX
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#endif
+
 namespace LeechCraft
 {
 namespace LMP
@@ -158,48 +167,54 @@ namespace LMP
 
 			LocalCollectionStorage storage;
 
-			const auto& paths = storage.GetTracksPaths ();
+			QHash<QString, QDateTime> storedMTimes;
+			try
+			{
+				storedMTimes = storage.GetAllMTimes ();
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "error getting mtimes"
+						<< e.what ();
+			}
+
+			QHash<QString, QDateTime> mtimeUpdates;
 
 			const auto& allInfos = RecIterateInfo (path, symLinks);
 			for (const auto& info : allInfos)
 			{
 				const auto& trackPath = info.absoluteFilePath ();
 				const auto& mtime = info.lastModified ();
-				try
+
+				const auto storedPos = storedMTimes.constFind (trackPath);
+				if (storedPos != storedMTimes.constEnd ())
 				{
-					const auto& storedDt = storage.GetMTime (trackPath);
+					const auto& storedDt = *storedPos;
 					if (storedDt.isValid () &&
 							std::abs (storedDt.msecsTo (mtime)) < 1500)
 					{
 						result.UnchangedFiles_ << trackPath;
 						continue;
 					}
-				}
-				catch (const std::exception& e)
-				{
-					qWarning () << Q_FUNC_INFO
-							<< "error getting mtime"
-							<< trackPath
-							<< e.what ();
-				}
 
-				if (paths.contains (trackPath))
-				{
-					try
-					{
-						storage.SetMTime (trackPath, mtime);
-					}
-					catch (const std::exception& e)
-					{
-						qWarning () << Q_FUNC_INFO
-								<< "error setting mtime"
-								<< trackPath
-								<< e.what ();
-					}
+					mtimeUpdates [trackPath] = mtime;
 				}
+
 				result.ChangedFiles_ << trackPath;
 			}
 
+			try
+			{
+				storage.SetMTimes (mtimeUpdates);
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "error setting mtimes"
+						<< e.what ();
+			}
+
 			return result;
 		};
 		Util::Sequence (this, QtConcurrent::run (worker)) >>
@@ -214,6 +229,104 @@ namespace LMP
 				};
 	}
 
+	void LocalCollection::HandleChangedPaths (const QSet<QString>& changed, const QSet<QString>& removed)
+	{
+		for (const auto& path : removed)
+		{
+			// A removed path that isn't a known track might be a directory,
+			// and only then do we need to look for the tracks under it.
+			QSet<QString> toRemove;
+			if (PresentPaths_.contains (path))
+				toRemove << path;
+			else
+			{
+				const auto& dirPrefix = path + '/';
+				toRemove = Util::Filter (PresentPaths_,
+						[&dirPrefix] (const QString& present) { return present.startsWith (dirPrefix); });
+			}
+
+			try
+			{
+				for (const auto& item : toRemove)
+					RemoveTrack (item);
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "error removing"
+						<< path
+						<< e.what ();
+			}
+		}
+
+		if (changed.isEmpty ())
+			return;
+
+		const bool symLinks = XmlSettingsManager::Instance ()
+				.property ("FollowSymLinks").toBool ();
+		auto worker = [changed, symLinks]
+		{
+			LocalCollectionStorage storage;
+
+			QHash<QString, QDateTime> storedMTimes;
+			try
+			{
+				storedMTimes = storage.GetAllMTimes ();
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "error getting mtimes"
+						<< e.what ();
+			}
+
+			QSet<QString> result;
+			QHash<QString, QDateTime> mtimeUpdates;
+
+			for (const auto& path : changed)
+				for (const auto& info : RecIterateInfo (path, symLinks))
+				{
+					const auto& trackPath = info.absoluteFilePath ();
+					const auto& mtime = info.lastModified ();
+
+					const auto& storedDt = storedMTimes.value (trackPath);
+					if (storedDt.isValid ())
+					{
+						if (std::abs (storedDt.msecsTo (mtime)) < 1500)
+							continue;
+
+						mtimeUpdates [trackPath] = mtime;
+					}
+
+					result << trackPath;
+				}
+
+			try
+			{
+				storage.SetMTimes (mtimeUpdates);
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "error setting mtimes"
+						<< e.what ();
+			}
+
+			return result;
+		};
+		Util::Sequence (this, QtConcurrent::run (worker)) >>
+				[this] (const QSet<QString>& paths)
+				{
+					if (paths.isEmpty ())
+						return;
+
+					if (Watcher_->isRunning ())
+						NewPathsQueue_ << paths;
+					else
+						InitiateScan (paths);
+				};
+	}
+
 	void LocalCollection::Unscan (const QString& path)
 	{
 		if (!RootPaths_.contains (path))
@@ -425,6 +538,9 @@ namespace LMP
 
 	void LocalCollection::HandleExistingInfos (const QList<MediaInfo>& infos)
 	{
+		QList<MediaInfo> changedInfos;
+		QHash<QString, Collection::TrackStats> changedStats;
+
 		for (const auto& info : infos)
 		{
 			const auto& path = info.LocalPath_;
@@ -452,14 +568,22 @@ namespace LMP
 					track.Genres_ == info.Genres_)
 				continue;
 
-			auto stats = GetTrackStats (path);
+			changedStats [path] = GetTrackStats (path);
 			RemoveTrack (path);
 
-			const auto& newArts = Storage_->AddToCollection ({ info });
-			HandleNewArtists (newArts);
+			changedInfos << info;
+		}
+
+		if (changedInfos.isEmpty ())
+			return;
+
+		const auto& newArts = Storage_->AddToCollection (changedInfos);
+		HandleNewArtists (newArts);
 
-			const auto newTrackIdx = FindTrack (path);
-			stats.TrackID_ = newTrackIdx;
+		for (auto i = changedStats.begin (), end = changedStats.end (); i != end; ++i)
+		{
+			auto& stats = i.value ();
+			stats.TrackID_ = FindTrack (i.key ());
 			Storage_->SetTrackStats (stats);
 		}
 	}
@@ -865,10 +989,124 @@ namespace LMP
 			RemoveTrack (path);
 	}
 
+	namespace
+	{
+#ifdef Q_OS_LINUX
+		bool IsRotational (dev_t dev)
+		{
+			const auto& sysPath = QString { "/sys/dev/block/%1:%2" }
+					.arg (major (dev))
+					.arg (minor (dev));
+			auto devDir = QFileInfo { sysPath }.canonicalFilePath ();
+			if (devDir.isEmpty ())
+				return false;
+
+			if (QFile::exists (devDir + "/partition"))
+				devDir = QFileInfo { devDir }.path ();
+
+			QFile file { devDir + "/queue/rotational" };
+			if (!file.open (QIODevice::ReadOnly))
+				return false;
+
+			return file.readAll ().trimmed () == "1";
+		}
+#endif
+
+		bool HasRotationalStorage (const QSet<QString>& paths)
+		{
+#ifdef Q_OS_LINUX
+			QSet<QString> dirs;
+			for (const auto& path : paths)
+				dirs << QFileInfo { path }.path ();
+
+			QSet<dev_t> devices;
+			for (const auto& dir : dirs)
+			{
+				struct stat st;
+				if (!stat (QFile::encodeName (dir).constData (), &st))
+					devices << st.st_dev;
+			}
+
+			return std::any_of (devices.begin (), devices.end (), &IsRotational);
+#else
+			Q_UNUSED (paths)
+			return false;
+#endif
+		}
+
+		int GetScanThreadCount (const QSet<QString>& paths)
+		{
+			const auto forced = XmlSettingsManager::Instance ().property ("ScanThreads").toInt ();
+			if (forced > 0)
+				return forced;
+
+			/* Tag extraction on spinning disks is bound by seeks, and more
+			 * than a couple of concurrent readers only makes the head jump
+			 * around more. SSDs happily serve as many readers as we have cores.
+			 */
+			return HasRotationalStorage (paths) ?
+					2 :
+					std::max (QThread::idealThreadCount (), 2);
+		}
+
+		QFuture<MediaInfo> ResolvePaths (QThreadPool *pool,
+				const QStringList& paths, const std::function<MediaInfo (QString)>& resolver)
+		{
+			struct State
+			{
+				QStringList Paths_;
+				QFutureInterface<MediaInfo> Iface_;
+
+				std::atomic<int> NextIdx_ { 0 };
+				std::atomic<int> DoneCount_ { 0 };
+				std::atomic<int> RunningWorkers_ { 0 };
+			};
+
+			const auto state = std::make_shared<State> ();
+			state->Paths_ = paths;
+
+			auto& iface = state->Iface_;
+			iface.reportStarted ();
+			iface.setProgressRange (0, paths.size ());
+			const auto future = iface.future ();
+
+			const auto workersCount = std::min (pool->maxThreadCount (), paths.size ());
+			if (!workersCount)
+			{
+				iface.reportFinished ();
+				return future;
+			}
+
+			state->RunningWorkers_ = workersCount;
+			for (int i = 0; i < workersCount; ++i)
+				QtConcurrent::run (pool,
+						[state, resolver]
+						{
+							auto& iface = state->Iface_;
+
+							int idx = 0;
+							while ((idx = state->NextIdx_++) < state->Paths_.size () &&
+									!iface.isCanceled ())
+							{
+								iface.reportResult (resolver (state->Paths_.at (idx)), idx);
+								iface.setProgressValue (++state->DoneCount_);
+							}
+
+							if (!--state->RunningWorkers_)
+								iface.reportFinished ();
+						});
+
+			return future;
+		}
+	}
+
 	void LocalCollection::InitiateScan (const QSet<QString>& newPaths)
 	{
 		auto resolver = Core::Instance ().GetLocalFileResolver ();
 
+		ScanPool_.setMaxThreadCount (GetScanThreadCount (newPaths));
+		ScanTimer_.start ();
+
 		emit scanStarted (newPaths.size ());
 		auto worker = [resolver] (const QString& path)
 		{
@@ -881,9 +1119,7 @@ namespace LMP
 						return MediaInfo {};
 					});
 		};
-		const auto& future = QtConcurrent::mapped (newPaths,
-				std::function<MediaInfo (QString)> (worker));
-		Watcher_->setFuture (future);
+		Watcher_->setFuture (ResolvePaths (&ScanPool_, newPaths.toList (), worker));
 	}
 
 	void LocalCollection::RecordPlayedTrack (const QString& path)
@@ -915,6 +1151,19 @@ namespace LMP
 	void LocalCollection::handleScanFinished ()
 	{
 		auto future = Watcher_->future ();
+
+		const auto elapsed = std::max<qint64> (ScanTimer_.elapsed (), 1);
+		qDebug () << Q_FUNC_INFO
+				<< "resolved"
+				<< future.resultCount ()
+				<< "files in"
+				<< elapsed
+				<< "ms using"
+				<< ScanPool_.maxThreadCount ()
+				<< "threads:"
+				<< future.resultCount () * 1000.0 / elapsed
+				<< "files/sec";
+
 		QList<MediaInfo> newInfos, existingInfos;
 		for (const auto& info : future)
 		{
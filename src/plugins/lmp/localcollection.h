@@ -33,6 +33,8 @@
 #include <QHash>
 #include <QSet>
 #include <QFutureWatcher>
+#include <QThreadPool>
+#include <QElapsedTimer>
 #include <QIcon>
 #include "interfaces/lmp/collectiontypes.h"
 #include "interfaces/lmp/ilocalcollection.h"
@@ -84,6 +86,9 @@ namespace LMP
 		QFutureWatcher<MediaInfo> *Watcher_;
 		QList<QSet<QString>> NewPathsQueue_;
 
+		QThreadPool ScanPool_;
+		QElapsedTimer ScanTimer_;
+
 		int UpdateNewArtists_ = 0;
 		int UpdateNewAlbums_ = 0;
 		int UpdateNewTracks_ = 0;
@@ -122,6 +127,20 @@ namespace LMP
 
 		void Scan (const QString&, bool root = true);
 		void Unscan (const QString&);
+
+		/** @brief Updates the collection for exactly the given paths.
+		 *
+		 * The changed paths (files or whole directories) are resolved
+		 * again if their modification time differs from the recorded
+		 * one, and the tracks equal to or below any of the removed
+		 * paths are dropped from the collection.
+		 *
+		 * @param[in] changed The paths that have been written or moved
+		 * in.
+		 * @param[in] removed The paths that have been deleted or moved
+		 * out.
+		 */
+		void HandleChangedPaths (const QSet<QString>& changed, const QSet<QString>& removed);
 		void Rescan ();
 
 		DirStatus GetDirStatus (const QString&) const;
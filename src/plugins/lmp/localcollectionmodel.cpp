@@ -28,49 +28,185 @@
  **********************************************************************/
 
 #include "localcollectionmodel.h"
+#include <algorithm>
 #include <numeric>
 #include <QUrl>
 #include <QMimeData>
-#include <interfaces/core/iiconthememanager.h>
+#include <QtDebug>
 #include <util/sll/prelude.h>
-#include "core.h"
-#include "localcollection.h"
 
 namespace LeechCraft
 {
 namespace LMP
 {
+	namespace
+	{
+		const int TypeShift = 30;
+		const quintptr SlotMask = (static_cast<quintptr> (1) << TypeShift) - 1;
+
+		quintptr MakeId (LocalCollectionModel::NodeType type, int slot)
+		{
+			return (static_cast<quintptr> (type) << TypeShift) | static_cast<quintptr> (slot);
+		}
+
+		LocalCollectionModel::NodeType GetType (const QModelIndex& index)
+		{
+			return static_cast<LocalCollectionModel::NodeType> (index.internalId () >> TypeShift);
+		}
+
+		int GetSlot (const QModelIndex& index)
+		{
+			return static_cast<int> (index.internalId () & SlotMask);
+		}
+
+		template<typename T>
+		int Allocate (QVector<T>& nodes, QVector<int>& freeSlots, T&& node)
+		{
+			if (!freeSlots.isEmpty ())
+			{
+				const auto slot = freeSlots.takeLast ();
+				nodes [slot] = std::move (node);
+				return slot;
+			}
+
+			nodes.append (std::move (node));
+			return nodes.size () - 1;
+		}
+
+		template<typename T>
+		void RemoveRow (QVector<T>& nodes, QVector<int>& rows, int row)
+		{
+			rows.remove (row);
+			for (int i = row; i < rows.size (); ++i)
+				nodes [rows.at (i)].Row_ = i;
+		}
+
+		QString MakeAlbumTitle (int year, const QString& name)
+		{
+			return QString::fromUtf8 ("%1 — %2")
+					.arg (year)
+					.arg (name);
+		}
+
+		QString MakeTrackTitle (int number, const QString& name)
+		{
+			return QString::fromUtf8 ("%1 — %2")
+					.arg (number)
+					.arg (name);
+		}
+	}
+
 	LocalCollectionModel::LocalCollectionModel (QObject *parent)
-	: DndActionsMixin<QStandardItemModel> { parent }
+	: DndActionsMixin<QAbstractItemModel> { parent }
 	{
 		setSupportedDragActions (Qt::CopyAction);
 	}
 
-	QStringList LocalCollectionModel::mimeTypes () const
+	QModelIndex LocalCollectionModel::index (int row, int column, const QModelIndex& parent) const
 	{
-		return { "text/uri-list" };
+		if (!hasIndex (row, column, parent))
+			return {};
+
+		if (!parent.isValid ())
+			return createIndex (row, column, MakeId (NodeType::Artist, RootArtists_.at (row)));
+
+		const auto slot = GetSlot (parent);
+		switch (GetType (parent))
+		{
+		case NodeType::Artist:
+			return createIndex (row, column, MakeId (NodeType::Album, Artists_.at (slot).Albums_.at (row)));
+		case NodeType::Album:
+			return createIndex (row, column, MakeId (NodeType::Track, Albums_.at (slot).Tracks_.at (row)));
+		case NodeType::Track:
+			break;
+		}
+
+		return {};
 	}
 
-	namespace
+	QModelIndex LocalCollectionModel::parent (const QModelIndex& index) const
 	{
-		QStringList CollectPaths (const QModelIndex& index, const QAbstractItemModel *model)
+		if (!index.isValid ())
+			return {};
+
+		const auto slot = GetSlot (index);
+		switch (GetType (index))
 		{
-			const auto type = index.data (LocalCollectionModel::Role::Node).toInt ();
-			if (type == LocalCollectionModel::NodeType::Track)
-				return { index.data (LocalCollectionModel::Role::TrackPath).toString () };
+		case NodeType::Artist:
+			break;
+		case NodeType::Album:
+			return ArtistIndex (Albums_.at (slot).Artist_);
+		case NodeType::Track:
+			return AlbumIndex (Tracks_.at (slot).Album_);
+		}
+
+		return {};
+	}
+
+	int LocalCollectionModel::rowCount (const QModelIndex& parent) const
+	{
+		if (!parent.isValid ())
+			return RootArtists_.size ();
 
-			QStringList paths;
-			for (int i = 0; i < model->rowCount (index); ++i)
-				paths += CollectPaths (model->index (i, 0, index), model);
-			return paths;
+		if (parent.column ())
+			return 0;
+
+		const auto slot = GetSlot (parent);
+		switch (GetType (parent))
+		{
+		case NodeType::Artist:
+			return Artists_.at (slot).Albums_.size ();
+		case NodeType::Album:
+			return Albums_.at (slot).Tracks_.size ();
+		case NodeType::Track:
+			break;
 		}
+
+		return 0;
+	}
+
+	int LocalCollectionModel::columnCount (const QModelIndex&) const
+	{
+		return 1;
+	}
+
+	QVariant LocalCollectionModel::data (const QModelIndex& index, int role) const
+	{
+		if (!index.isValid ())
+			return {};
+
+		const auto slot = GetSlot (index);
+		switch (GetType (index))
+		{
+		case NodeType::Artist:
+			return GetArtistData (slot, role);
+		case NodeType::Album:
+			return GetAlbumData (slot, role);
+		case NodeType::Track:
+			return GetTrackSlotData (slot, role);
+		}
+
+		return {};
+	}
+
+	Qt::ItemFlags LocalCollectionModel::flags (const QModelIndex& index) const
+	{
+		if (!index.isValid ())
+			return Qt::NoItemFlags;
+
+		return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDragEnabled;
+	}
+
+	QStringList LocalCollectionModel::mimeTypes () const
+	{
+		return { "text/uri-list" };
 	}
 
 	QMimeData* LocalCollectionModel::mimeData (const QModelIndexList& indexes) const
 	{
 		QList<QUrl> urls;
 		for (const auto& index : indexes)
-			urls += Util::Map (CollectPaths (index, this), &QUrl::fromLocalFile);
+			urls += Util::Map (CollectPaths (index), &QUrl::fromLocalFile);
 
 		if (urls.isEmpty ())
 			return nullptr;
@@ -84,7 +220,7 @@ namespace LMP
 	{
 		const auto& paths = std::accumulate (indexes.begin (), indexes.end (), QStringList {},
 				[this] (const QStringList& paths, decltype (indexes.front ()) item)
-					{ return paths + CollectPaths (item, this); });
+					{ return paths + CollectPaths (item); });
 
 		QList<QUrl> result;
 		result.reserve (paths.size ());
@@ -93,129 +229,450 @@ namespace LMP
 		return result;
 	}
 
-	namespace
+	bool LocalCollectionModel::MatchesFilter (const QModelIndex& index, const QString& lowerPattern) const
 	{
-		template<typename T, typename Init, typename Parent, typename Idx>
-		QStandardItem* GetItem (T& c, Init f, Parent parent, Idx idx)
-		{
-			auto& item = c [idx];
-			if (item)
-				return item;
+		if (!index.isValid ())
+			return false;
 
-			item = new QStandardItem;
-			item->setEditable (false);
-			f (item);
-			parent->appendRow (item);
-			return item;
-		}
+		const auto trackMatches = [this, &lowerPattern] (int slot)
+		{
+			const auto& track = Tracks_.at (slot);
+			return !track.IsIgnored_ &&
+					(lowerPattern.isEmpty () || track.SearchKey_.contains (lowerPattern));
+		};
+		const auto albumMatches = [this, &trackMatches] (int slot)
+		{
+			const auto& tracks = Albums_.at (slot).Tracks_;
+			return std::any_of (tracks.begin (), tracks.end (), trackMatches);
+		};
 
-		template<typename T, typename Init, typename Parent, typename Idx, typename... Idxs>
-		QStandardItem* GetItem (T& c, Init f, Parent parent, Idx idx, Idxs... idxs)
+		const auto slot = GetSlot (index);
+		switch (GetType (index))
 		{
-			return GetItem (c [idx], f, parent, idxs...);
+		case NodeType::Artist:
+		{
+			const auto& albums = Artists_.at (slot).Albums_;
+			return std::any_of (albums.begin (), albums.end (), albumMatches);
+		}
+		case NodeType::Album:
+			return albumMatches (slot);
+		case NodeType::Track:
+			return trackMatches (slot);
 		}
+
+		return false;
 	}
 
 	void LocalCollectionModel::AddArtists (const Collection::Artists_t& artists)
 	{
+		auto attach = [this] (const QModelIndex& parent,
+				QVector<int>& rows, const QVector<int>& slots, auto& nodes)
+		{
+			if (slots.isEmpty ())
+				return;
+
+			const auto first = rows.size ();
+			beginInsertRows (parent, first, first + slots.size () - 1);
+			for (const auto slot : slots)
+			{
+				nodes [slot].Row_ = rows.size ();
+				rows << slot;
+			}
+			endInsertRows ();
+		};
+
+		QSet<int> seenArtists;
+		QVector<int> newArtists;
 		for (const auto& artist : artists)
 		{
-			auto artistItem = GetItem (Artist2Item_,
-					[this, &artist] (QStandardItem *item)
-					{
-						item->setIcon (ArtistIcon_);
-						item->setText (artist.Name_);
-						item->setData (artist.Name_, Role::ArtistName);
-						item->setData (NodeType::Artist, Role::Node);
-					},
-					this,
-					artist.ID_);
-
-			for (auto album : artist.Albums_)
+			if (seenArtists.contains (artist.ID_))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "duplicate artist"
+						<< artist.ID_
+						<< artist.Name_;
+				continue;
+			}
+			seenArtists << artist.ID_;
+
+			const auto artistPos = Artist2Node_.constFind (artist.ID_);
+			if (artistPos == Artist2Node_.constEnd ())
 			{
-				auto albumItem = GetItem (Album2Item_,
-						[album, artist] (QStandardItem *item)
-						{
-							item->setText (QString::fromUtf8 ("%1 — %2")
-									.arg (album->Year_)
-									.arg (album->Name_));
-							item->setData (album->Year_, Role::AlbumYear);
-							item->setData (album->Name_, Role::AlbumName);
-							item->setData (artist.Name_, Role::ArtistName);
-							item->setData (NodeType::Album, Role::Node);
-							if (!album->CoverPath_.isEmpty ())
-								item->setData (album->CoverPath_, Role::AlbumArt);
-						},
-						artistItem,
-						album->ID_,
-						artist.ID_);
+				newArtists << BuildArtist (artist);
+				continue;
+			}
 
-				for (const auto& track : album->Tracks_)
+			const auto artistSlot = *artistPos;
+
+			QVector<int> newAlbums;
+			for (const auto& album : artist.Albums_)
+			{
+				const auto& artist2node = Album2Nodes_.value (album->ID_);
+				const auto albumPos = artist2node.constFind (artist.ID_);
+				if (albumPos == artist2node.constEnd ())
 				{
-					const QString& name = QString::fromUtf8 ("%1 — %2")
-							.arg (track.Number_)
-							.arg (track.Name_);
-					auto item = new QStandardItem (name);
-					item->setEditable (false);
-					item->setData (album->Year_, Role::AlbumYear);
-					item->setData (album->Name_, Role::AlbumName);
-					item->setData (artist.Name_, Role::ArtistName);
-					item->setData (track.Number_, Role::TrackNumber);
-					item->setData (track.Name_, Role::TrackTitle);
-					item->setData (track.FilePath_, Role::TrackPath);
-					item->setData (track.Genres_, Role::TrackGenres);
-					item->setData (track.Length_, Role::TrackLength);
-					item->setData (NodeType::Track, Role::Node);
-					albumItem->appendRow (item);
-
-					Track2Item_ [track.ID_] = item;
+					newAlbums << BuildAlbum (*album, artistSlot);
+					continue;
 				}
+
+				const auto albumSlot = *albumPos;
+
+				QVector<int> newTracks;
+				for (const auto& track : album->Tracks_)
+					if (!Track2Node_.contains (track.ID_))
+						newTracks << BuildTrack (track, albumSlot);
+
+				attach (AlbumIndex (albumSlot), Albums_ [albumSlot].Tracks_, newTracks, Tracks_);
 			}
+
+			attach (ArtistIndex (artistSlot), Artists_ [artistSlot].Albums_, newAlbums, Albums_);
 		}
+
+		attach ({}, RootArtists_, newArtists, Artists_);
 	}
 
 	void LocalCollectionModel::Clear ()
 	{
-		clear ();
+		beginResetModel ();
+
+		Artists_.clear ();
+		Albums_.clear ();
+		Tracks_.clear ();
+
+		FreeArtists_.clear ();
+		FreeAlbums_.clear ();
+		FreeTracks_.clear ();
+
+		RootArtists_.clear ();
+
+		Artist2Node_.clear ();
+		Album2Nodes_.clear ();
+		Track2Node_.clear ();
+
+		StringPool_.clear ();
 
-		Artist2Item_.clear ();
-		Album2Item_.clear ();
-		Track2Item_.clear ();
+		endResetModel ();
 	}
 
 	void LocalCollectionModel::IgnoreTrack (int id)
 	{
-		auto item = Track2Item_.value (id);
-		item->setData (true, IsTrackIgnored);
+		const auto slot = Track2Node_.value (id, -1);
+		if (slot == -1)
+			return;
+
+		Tracks_ [slot].IsIgnored_ = true;
+
+		const auto& index = TrackIndex (slot);
+		emit dataChanged (index, index);
 	}
 
 	void LocalCollectionModel::RemoveTrack (int id)
 	{
-		auto item = Track2Item_.take (id);
-		item->parent ()->removeRow (item->row ());
+		const auto slot = Track2Node_.value (id, -1);
+		if (slot == -1)
+			return;
+
+		const auto albumSlot = Tracks_.at (slot).Album_;
+		const auto row = Tracks_.at (slot).Row_;
+
+		beginRemoveRows (AlbumIndex (albumSlot), row, row);
+		RemoveRow (Tracks_, Albums_ [albumSlot].Tracks_, row);
+		FreeTrack (slot);
+		endRemoveRows ();
 	}
 
 	void LocalCollectionModel::RemoveAlbum (int id)
 	{
-		for (const auto item : Album2Item_.take (id))
-			item->parent ()->removeRow (item->row ());
+		for (const auto slot : Album2Nodes_.value (id))
+		{
+			const auto artistSlot = Albums_.at (slot).Artist_;
+			const auto row = Albums_.at (slot).Row_;
+
+			beginRemoveRows (ArtistIndex (artistSlot), row, row);
+			RemoveRow (Albums_, Artists_ [artistSlot].Albums_, row);
+			FreeAlbum (slot);
+			endRemoveRows ();
+		}
+	}
+
+	void LocalCollectionModel::RemoveArtist (int id)
+	{
+		const auto slot = Artist2Node_.value (id, -1);
+		if (slot == -1)
+			return;
+
+		const auto row = Artists_.at (slot).Row_;
+
+		beginRemoveRows ({}, row, row);
+		RemoveRow (Artists_, RootArtists_, row);
+		FreeArtist (slot);
+		endRemoveRows ();
+	}
+
+	void LocalCollectionModel::SetAlbumArt (int id, const QString& path)
+	{
+		for (const auto slot : Album2Nodes_.value (id))
+		{
+			Albums_ [slot].CoverPath_ = path;
+
+			const auto& index = AlbumIndex (slot);
+			emit dataChanged (index, index);
+		}
 	}
 
 	QVariant LocalCollectionModel::GetTrackData (int trackId, LocalCollectionModel::Role role) const
 	{
-		const auto item = Track2Item_.value (trackId);
-		return item ? item->data (role) : QVariant ();
+		const auto slot = Track2Node_.value (trackId, -1);
+		return slot == -1 ?
+				QVariant {} :
+				GetTrackSlotData (slot, role);
 	}
 
-	void LocalCollectionModel::RemoveArtist (int id)
+	const QString& LocalCollectionModel::Intern (const QString& str)
 	{
-		removeRow (Artist2Item_.take (id)->row ());
+		auto pos = StringPool_.constFind (str);
+		if (pos == StringPool_.constEnd ())
+			pos = StringPool_.insert (str);
+		return *pos;
 	}
 
-	void LocalCollectionModel::SetAlbumArt (int id, const QString& path)
+	int LocalCollectionModel::BuildArtist (const Collection::Artist& artist)
+	{
+		const auto slot = Allocate (Artists_, FreeArtists_,
+				ArtistNode { artist.ID_, -1, Intern (artist.Name_), {} });
+		Artist2Node_ [artist.ID_] = slot;
+
+		for (const auto& album : artist.Albums_)
+		{
+			if (Album2Nodes_.value (album->ID_).contains (artist.ID_))
+				continue;
+
+			const auto albumSlot = BuildAlbum (*album, slot);
+
+			auto& albums = Artists_ [slot].Albums_;
+			Albums_ [albumSlot].Row_ = albums.size ();
+			albums << albumSlot;
+		}
+
+		return slot;
+	}
+
+	int LocalCollectionModel::BuildAlbum (const Collection::Album& album, int artistSlot)
+	{
+		const auto slot = Allocate (Albums_, FreeAlbums_,
+				AlbumNode
+				{
+					album.ID_,
+					-1,
+					artistSlot,
+					album.Year_,
+					Intern (album.Name_),
+					album.CoverPath_,
+					{}
+				});
+		Album2Nodes_ [album.ID_] [Artists_.at (artistSlot).ID_] = slot;
+
+		for (const auto& track : album.Tracks_)
+		{
+			if (Track2Node_.contains (track.ID_))
+				continue;
+
+			const auto trackSlot = BuildTrack (track, slot);
+
+			auto& tracks = Albums_ [slot].Tracks_;
+			Tracks_ [trackSlot].Row_ = tracks.size ();
+			tracks << trackSlot;
+		}
+
+		return slot;
+	}
+
+	int LocalCollectionModel::BuildTrack (const Collection::Track& track, int albumSlot)
+	{
+		const auto& album = Albums_.at (albumSlot);
+		const auto& artist = Artists_.at (album.Artist_);
+
+		const auto& searchKey = (artist.Name_ + '\n' +
+				MakeAlbumTitle (album.Year_, album.Name_) + '\n' +
+				MakeTrackTitle (track.Number_, track.Name_)).toLower ();
+
+		QStringList genres;
+		genres.reserve (track.Genres_.size ());
+		for (const auto& genre : track.Genres_)
+			genres << Intern (genre);
+
+		const auto slot = Allocate (Tracks_, FreeTracks_,
+				TrackNode
+				{
+					track.ID_,
+					-1,
+					albumSlot,
+					track.Number_,
+					track.Length_,
+					false,
+					track.Name_,
+					track.FilePath_,
+					genres,
+					searchKey
+				});
+		Track2Node_ [track.ID_] = slot;
+		return slot;
+	}
+
+	void LocalCollectionModel::FreeArtist (int slot)
+	{
+		for (const auto albumSlot : Artists_.at (slot).Albums_)
+			FreeAlbum (albumSlot);
+
+		Artist2Node_.remove (Artists_.at (slot).ID_);
+
+		Artists_ [slot] = ArtistNode { -1, -1, {}, {} };
+		FreeArtists_ << slot;
+	}
+
+	void LocalCollectionModel::FreeAlbum (int slot)
+	{
+		for (const auto trackSlot : Albums_.at (slot).Tracks_)
+			FreeTrack (trackSlot);
+
+		const auto& album = Albums_.at (slot);
+		auto nodesPos = Album2Nodes_.find (album.ID_);
+		if (nodesPos != Album2Nodes_.end ())
+		{
+			nodesPos->remove (Artists_.at (album.Artist_).ID_);
+			if (nodesPos->isEmpty ())
+				Album2Nodes_.erase (nodesPos);
+		}
+
+		Albums_ [slot] = AlbumNode { -1, -1, -1, 0, {}, {}, {} };
+		FreeAlbums_ << slot;
+	}
+
+	void LocalCollectionModel::FreeTrack (int slot)
+	{
+		Track2Node_.remove (Tracks_.at (slot).ID_);
+
+		Tracks_ [slot] = TrackNode { -1, -1, -1, 0, 0, false, {}, {}, {}, {} };
+		FreeTracks_ << slot;
+	}
+
+	QModelIndex LocalCollectionModel::ArtistIndex (int slot) const
+	{
+		return createIndex (Artists_.at (slot).Row_, 0, MakeId (NodeType::Artist, slot));
+	}
+
+	QModelIndex LocalCollectionModel::AlbumIndex (int slot) const
+	{
+		return createIndex (Albums_.at (slot).Row_, 0, MakeId (NodeType::Album, slot));
+	}
+
+	QModelIndex LocalCollectionModel::TrackIndex (int slot) const
 	{
-		for (const auto item : Album2Item_.value (id))
-			item->setData (path, Role::AlbumArt);
+		return createIndex (Tracks_.at (slot).Row_, 0, MakeId (NodeType::Track, slot));
+	}
+
+	QVariant LocalCollectionModel::GetArtistData (int slot, int role) const
+	{
+		const auto& artist = Artists_.at (slot);
+		switch (role)
+		{
+		case Qt::DisplayRole:
+		case Role::ArtistName:
+			return artist.Name_;
+		case Qt::DecorationRole:
+			return ArtistIcon_;
+		case Role::Node:
+			return NodeType::Artist;
+		default:
+			return {};
+		}
+	}
+
+	QVariant LocalCollectionModel::GetAlbumData (int slot, int role) const
+	{
+		const auto& album = Albums_.at (slot);
+		switch (role)
+		{
+		case Qt::DisplayRole:
+			return MakeAlbumTitle (album.Year_, album.Name_);
+		case Role::AlbumYear:
+			return album.Year_;
+		case Role::AlbumName:
+			return album.Name_;
+		case Role::ArtistName:
+			return Artists_.at (album.Artist_).Name_;
+		case Role::AlbumArt:
+			return album.CoverPath_.isEmpty () ?
+					QVariant {} :
+					QVariant { album.CoverPath_ };
+		case Role::Node:
+			return NodeType::Album;
+		default:
+			return {};
+		}
+	}
+
+	QVariant LocalCollectionModel::GetTrackSlotData (int slot, int role) const
+	{
+		const auto& track = Tracks_.at (slot);
+		const auto& album = Albums_.at (track.Album_);
+		switch (role)
+		{
+		case Qt::DisplayRole:
+			return MakeTrackTitle (track.Number_, track.Title_);
+		case Role::AlbumYear:
+			return album.Year_;
+		case Role::AlbumName:
+			return album.Name_;
+		case Role::ArtistName:
+			return Artists_.at (album.Artist_).Name_;
+		case Role::TrackNumber:
+			return track.Number_;
+		case Role::TrackTitle:
+			return track.Title_;
+		case Role::TrackPath:
+			return track.Path_;
+		case Role::TrackGenres:
+			return track.Genres_;
+		case Role::TrackLength:
+			return track.Length_;
+		case Role::IsTrackIgnored:
+			return track.IsIgnored_;
+		case Role::Node:
+			return NodeType::Track;
+		default:
+			return {};
+		}
+	}
+
+	QStringList LocalCollectionModel::CollectPaths (const QModelIndex& index) const
+	{
+		if (!index.isValid ())
+			return {};
+
+		QStringList paths;
+		const auto addAlbum = [this, &paths] (int albumSlot)
+		{
+			for (const auto trackSlot : Albums_.at (albumSlot).Tracks_)
+				paths << Tracks_.at (trackSlot).Path_;
+		};
+
+		const auto slot = GetSlot (index);
+		switch (GetType (index))
+		{
+		case NodeType::Artist:
+			for (const auto albumSlot : Artists_.at (slot).Albums_)
+				addAlbum (albumSlot);
+			break;
+		case NodeType::Album:
+			addAlbum (slot);
+			break;
+		case NodeType::Track:
+			paths << Tracks_.at (slot).Path_;
+			break;
+		}
+
+		return paths;
 	}
 }
 }
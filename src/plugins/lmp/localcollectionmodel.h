@@ -29,8 +29,12 @@
 
 #pragma once
 
-#include <QStandardItemModel>
+#include <QAbstractItemModel>
 #include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QIcon>
+#include <QStringList>
 #include <util/models/dndactionsmixin.h>
 #include "interfaces/lmp/icollectionmodel.h"
 #include "interfaces/lmp/collectiontypes.h"
@@ -39,16 +43,72 @@ namespace LeechCraft
 {
 namespace LMP
 {
-	class LocalCollectionModel : public Util::DndActionsMixin<QStandardItemModel>
+	/** @brief The tree model of the local collection.
+	 *
+	 * The nodes are kept in compact per-type arrays addressed by slot
+	 * numbers which are encoded into the model indexes, and all the
+	 * data is produced on demand from these arrays. Repeating strings
+	 * like artist and album names or genres are interned.
+	 *
+	 * Each track also has a prebuilt lowercase search key, which is
+	 * used by MatchesFilter() so that filtering doesn't have to walk
+	 * the model through the proxies.
+	 */
+	class LocalCollectionModel : public Util::DndActionsMixin<QAbstractItemModel>
 							   , public ICollectionModel
 	{
 		Q_OBJECT
 
 		QIcon ArtistIcon_ = QIcon::fromTheme ("view-media-artist");
 
-		QHash<int, QStandardItem*> Artist2Item_;
-		QHash<int, QHash<int, QStandardItem*>> Album2Item_;
-		QHash<int, QStandardItem*> Track2Item_;
+		struct ArtistNode
+		{
+			int ID_;
+			int Row_;
+			QString Name_;
+			QVector<int> Albums_;
+		};
+
+		struct AlbumNode
+		{
+			int ID_;
+			int Row_;
+			int Artist_;
+			int Year_;
+			QString Name_;
+			QString CoverPath_;
+			QVector<int> Tracks_;
+		};
+
+		struct TrackNode
+		{
+			int ID_;
+			int Row_;
+			int Album_;
+			int Number_;
+			int Length_;
+			bool IsIgnored_;
+			QString Title_;
+			QString Path_;
+			QStringList Genres_;
+			QString SearchKey_;
+		};
+
+		QVector<ArtistNode> Artists_;
+		QVector<AlbumNode> Albums_;
+		QVector<TrackNode> Tracks_;
+
+		QVector<int> FreeArtists_;
+		QVector<int> FreeAlbums_;
+		QVector<int> FreeTracks_;
+
+		QVector<int> RootArtists_;
+
+		QHash<int, int> Artist2Node_;
+		QHash<int, QHash<int, int>> Album2Nodes_;
+		QHash<int, int> Track2Node_;
+
+		QSet<QString> StringPool_;
 	public:
 		enum NodeType
 		{
@@ -74,10 +134,30 @@ namespace LMP
 
 		LocalCollectionModel (QObject*);
 
-		QStringList mimeTypes () const;
-		QMimeData* mimeData (const QModelIndexList&) const;
+		QModelIndex index (int, int, const QModelIndex& = {}) const override;
+		QModelIndex parent (const QModelIndex&) const override;
+		int rowCount (const QModelIndex& = {}) const override;
+		int columnCount (const QModelIndex& = {}) const override;
+		QVariant data (const QModelIndex&, int = Qt::DisplayRole) const override;
+		Qt::ItemFlags flags (const QModelIndex&) const override;
+
+		QStringList mimeTypes () const override;
+		QMimeData* mimeData (const QModelIndexList&) const override;
+
+		QList<QUrl> ToSourceUrls (const QList<QModelIndex>&) const override;
 
-		QList<QUrl> ToSourceUrls (const QList<QModelIndex>&) const;
+		/** @brief Checks whether the given subtree matches the filter.
+		 *
+		 * A track matches if it isn't ignored and its artist, album,
+		 * year, number or title contain the \em lowerPattern. An
+		 * artist or an album matches if any of its tracks matches.
+		 *
+		 * @param[in] index The index of this model to check.
+		 * @param[in] lowerPattern The lowercase filter string, possibly
+		 * empty.
+		 * @return Whether the \em index should be visible.
+		 */
+		bool MatchesFilter (const QModelIndex& index, const QString& lowerPattern) const;
 
 		void AddArtists (const Collection::Artists_t&);
 		void Clear ();
@@ -90,6 +170,26 @@ namespace LMP
 
 		void SetAlbumArt (int, const QString&);
 		QVariant GetTrackData (int trackId, Role) const;
+	private:
+		const QString& Intern (const QString&);
+
+		int BuildArtist (const Collection::Artist&);
+		int BuildAlbum (const Collection::Album&, int artistSlot);
+		int BuildTrack (const Collection::Track&, int albumSlot);
+
+		void FreeArtist (int);
+		void FreeAlbum (int);
+		void FreeTrack (int);
+
+		QModelIndex ArtistIndex (int) const;
+		QModelIndex AlbumIndex (int) const;
+		QModelIndex TrackIndex (int) const;
+
+		QVariant GetArtistData (int, int) const;
+		QVariant GetAlbumData (int, int) const;
+		QVariant GetTrackSlotData (int, int) const;
+
+		QStringList CollectPaths (const QModelIndex&) const;
 	};
 }
 }
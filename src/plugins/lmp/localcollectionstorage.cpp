@@ -101,62 +101,145 @@ namespace LMP
 		PresentArtists_.clear ();
 	}
 
-	Collection::Artists_t LocalCollectionStorage::AddToCollection (const QList<MediaInfo>& infos)
+	namespace
 	{
-		QMap<int, Collection::Artist> artists;
+		/* Keeps the write transactions short enough so that the other
+		 * connections to the collection database (the GUI one and the
+		 * scanner ones) aren't locked out for the whole import.
+		 */
+		const int TransactionChunkSize = 1000;
+
+		template<typename Cont, typename F, typename C>
+		void ForEachChunk (QSqlDatabase& db, const Cont& cont, F&& f, C&& committed)
+		{
+			auto it = cont.begin ();
+			const auto end = cont.end ();
+			while (it != end)
+			{
+				Util::DBLock lock (db);
+				lock.Init ();
 
-		Util::DBLock lock (DB_);
+				for (int i = 0; i < TransactionChunkSize && it != end; ++i, ++it)
+					f (it);
 
-		lock.Init ();
-		for (const auto& info : infos)
+				lock.Good ();
+
+				committed ();
+			}
+		}
+
+		template<typename Cont, typename F>
+		void ForEachChunk (QSqlDatabase& db, const Cont& cont, F&& f)
 		{
-			Collection::Artist artist
-			{
-				0,
-				info.Artist_,
-				{}
-			};
-			if (!IsPresent (artist, artist.ID_))
-				AddArtist (artist);
-			if (!artists.contains (artist.ID_))
-				artists [artist.ID_] = artist;
+			ForEachChunk (db, cont, std::forward<F> (f), [] {});
+		}
 
-			Collection::Album album
-			{
-				0,
-				info.Album_,
-				info.Year_,
-				{},
-				{}
-			};
-			if (!IsPresent (artist, album, album.ID_))
+		struct AddedTrack
+		{
+			Collection::Artist Artist_;
+			Collection::Album Album_;
+			bool IsNewAlbum_;
+			Collection::Track Track_;
+		};
+
+		void MergeAddedTracks (QMap<int, Collection::Artist>& artists, const QList<AddedTrack>& added)
+		{
+			for (const auto& item : added)
 			{
-				album.CoverPath_ = FindAlbumArtPath (info.LocalPath_);
-				AddAlbum (artist, album);
-				artists [artist.ID_].Albums_ << std::make_shared<Collection::Album> (album);
+				const auto artistId = item.Artist_.ID_;
+				if (!artists.contains (artistId))
+					artists [artistId] = item.Artist_;
+
+				auto& albums = artists [artistId].Albums_;
+				if (item.IsNewAlbum_)
+					albums << std::make_shared<Collection::Album> (item.Album_);
+
+				for (auto& trackAlbum : albums)
+					if (trackAlbum->ID_ == item.Album_.ID_)
+					{
+						trackAlbum->Tracks_ << item.Track_;
+						break;
+					}
 			}
+		}
+	}
 
-			Collection::Track track
-			{
-				0,
-				info.TrackNumber_,
-				info.Title_,
-				info.Length_,
-				info.Genres_,
-				info.LocalPath_
-			};
-			AddTrack (track, artist.ID_, album.ID_);
+	Collection::Artists_t LocalCollectionStorage::AddToCollection (const QList<MediaInfo>& infos)
+	{
+		QMap<int, Collection::Artist> artists;
 
-			for (auto& trackAlbum : artists [artist.ID_].Albums_)
-				if (trackAlbum->ID_ == album.ID_)
-				{
-					trackAlbum->Tracks_ << track;
-					break;
-				}
+		// Only the chunks whose transaction has been committed make it to
+		// the result, and a failed chunk leaves no stale cache entries.
+		QList<AddedTrack> chunkTracks;
+		auto presentArtists = PresentArtists_;
+		auto presentAlbums = PresentAlbums_;
 
-			SetMTime (info.LocalPath_, QFileInfo { info.LocalPath_ }.lastModified ());
+		try
+		{
+			ForEachChunk (DB_, infos,
+					[this, &chunkTracks] (QList<MediaInfo>::const_iterator infoPos)
+					{
+						const auto& info = *infoPos;
+
+						Collection::Artist artist
+						{
+							0,
+							info.Artist_,
+							{}
+						};
+						if (!IsPresent (artist, artist.ID_))
+							AddArtist (artist);
+
+						Collection::Album album
+						{
+							0,
+							info.Album_,
+							info.Year_,
+							{},
+							{}
+						};
+						const bool isNewAlbum = !IsPresent (artist, album, album.ID_);
+						if (isNewAlbum)
+						{
+							album.CoverPath_ = FindAlbumArtPath (info.LocalPath_);
+							AddAlbum (artist, album);
+						}
+
+						Collection::Track track
+						{
+							0,
+							info.TrackNumber_,
+							info.Title_,
+							info.Length_,
+							info.Genres_,
+							info.LocalPath_
+						};
+						AddTrack (track, artist.ID_, album.ID_);
+
+						SetMTime (track.ID_, QFileInfo { info.LocalPath_ }.lastModified ());
+
+						chunkTracks.append ({ artist, album, isNewAlbum, track });
+					},
+					[&]
+					{
+						MergeAddedTracks (artists, chunkTracks);
+						chunkTracks.clear ();
+
+						presentArtists = PresentArtists_;
+						presentAlbums = PresentAlbums_;
+					});
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "import failed after"
+					<< artists.size ()
+					<< "artists, keeping the committed part:"
+					<< e.what ();
+
+			PresentArtists_ = presentArtists;
+			PresentAlbums_ = presentAlbums;
 		}
-		lock.Good ();
 
 		return artists.values ();
 	}
@@ -393,6 +476,28 @@ namespace LMP
 		}
 	}
 
+	QHash<QString, QDateTime> LocalCollectionStorage::GetAllMTimes ()
+	{
+		if (!GetAllFilesMTimes_.exec ())
+		{
+			Util::DBLock::DumpError (GetAllFilesMTimes_);
+			throw std::runtime_error ("cannot get files mtimes");
+		}
+
+		QHash<QString, QDateTime> result;
+		while (GetAllFilesMTimes_.next ())
+			result [GetAllFilesMTimes_.value (0).toString ()] = GetAllFilesMTimes_.value (1).toDateTime ();
+		GetAllFilesMTimes_.finish ();
+		return result;
+	}
+
+	void LocalCollectionStorage::SetMTimes (const QHash<QString, QDateTime>& mtimes)
+	{
+		ForEachChunk (DB_, mtimes,
+				[this] (QHash<QString, QDateTime>::const_iterator pos)
+					{ SetMTime (pos.key (), pos.value ()); });
+	}
+
 	const int LovedStateID = 1;
 	const int BannedStateID = 2;
 
@@ -468,6 +573,13 @@ namespace LMP
 		}
 	}
 
+	void LocalCollectionStorage::SetRgTrackInfos (const QList<QPair<int, RGData>>& infos)
+	{
+		ForEachChunk (DB_, infos,
+				[this] (QList<QPair<int, RGData>>::const_iterator pos)
+					{ SetRgTrackInfo (pos->first, pos->second); });
+	}
+
 	RGData LocalCollectionStorage::GetRgTrackInfo (const QString& filepath)
 	{
 		GetTrackRgData_.bindValue (":filepath", filepath);
@@ -670,6 +782,17 @@ namespace LMP
 		}
 	}
 
+	void LocalCollectionStorage::SetMTime (int trackId, const QDateTime& mtime)
+	{
+		SetFileIdMTime_.bindValue (":track_id", trackId);
+		SetFileIdMTime_.bindValue (":mtime", mtime);
+		if (!SetFileIdMTime_.exec ())
+		{
+			Util::DBLock::DumpError (SetFileIdMTime_);
+			throw std::runtime_error ("cannot set file mtime");
+		}
+	}
+
 	void LocalCollectionStorage::AddToPresent (const Collection::Artist& artist)
 	{
 		PresentArtists_ [artist.Name_] = artist.ID_;
@@ -770,9 +893,15 @@ namespace LMP
 		GetFileMTime_ = QSqlQuery (DB_);
 		GetFileMTime_.prepare ("SELECT MTime FROM fileTimes, tracks WHERE tracks.Path = :filepath AND tracks.Id = fileTimes.TrackID;");
 
+		GetAllFilesMTimes_ = QSqlQuery (DB_);
+		GetAllFilesMTimes_.prepare ("SELECT tracks.Path, fileTimes.MTime FROM tracks LEFT OUTER JOIN fileTimes ON tracks.Id = fileTimes.TrackID;");
+
 		SetFileMTime_ = QSqlQuery (DB_);
 		SetFileMTime_.prepare ("INSERT OR REPLACE INTO fileTimes (TrackID, MTime) VALUES ((SELECT Id FROM tracks WHERE Path = :filepath), :mtime);");
 
+		SetFileIdMTime_ = QSqlQuery (DB_);
+		SetFileIdMTime_.prepare ("INSERT OR REPLACE INTO fileTimes (TrackID, MTime) VALUES (:track_id, :mtime);");
+
 		GetLovedBanned_ = QSqlQuery (DB_);
 		GetLovedBanned_.prepare ("SELECT TrackId FROM lovedBanned WHERE State = :state;");
 
@@ -75,7 +75,9 @@ namespace LMP
 
 		QSqlQuery GetFileIdMTime_;
 		QSqlQuery GetFileMTime_;
+		QSqlQuery GetAllFilesMTimes_;
 		QSqlQuery SetFileMTime_;
+		QSqlQuery SetFileIdMTime_;
 
 		// 1 is loved, 2 is banned
 		QSqlQuery GetLovedBanned_;
@@ -124,6 +126,19 @@ namespace LMP
 		QDateTime GetMTime (const QString&);
 		void SetMTime (const QString&, const QDateTime&);
 
+		/** @brief Returns the modification times of all the tracks.
+		 *
+		 * Tracks without a recorded modification time are mapped to
+		 * an invalid QDateTime.
+		 */
+		QHash<QString, QDateTime> GetAllMTimes ();
+
+		/** @brief Records the modification times of the given tracks.
+		 *
+		 * The updates are committed in transactions of a bounded size.
+		 */
+		void SetMTimes (const QHash<QString, QDateTime>&);
+
 		void SetTrackLoved (int);
 		void SetTrackBanned (int);
 		void ClearTrackLovedBanned (int);
@@ -132,6 +147,7 @@ namespace LMP
 
 		QList<int> GetOutdatedRgTracks ();
 		void SetRgTrackInfo (int, const RGData&);
+		void SetRgTrackInfos (const QList<QPair<int, RGData>>&);
 		RGData GetRgTrackInfo (const QString&);
 	private:
 		void MarkLovedBanned (int, int);
@@ -143,6 +159,7 @@ namespace LMP
 		void AddArtist (Collection::Artist&);
 		void AddAlbum (const Collection::Artist&, Collection::Album&);
 		void AddTrack (Collection::Track&, int, int);
+		void SetMTime (int, const QDateTime&);
 
 		void AddToPresent (const Collection::Artist&);
 		bool IsPresent (const Collection::Artist&, int&) const;
@@ -47,6 +47,14 @@ namespace LMP
 				SIGNAL (directoryChanged (QString)),
 				this,
 				SLOT (handleDirectoryChanged (QString)));
+		connect (Watcher_,
+				SIGNAL (pathChanged (QString)),
+				this,
+				SLOT (handlePathChanged (QString)));
+		connect (Watcher_,
+				SIGNAL (pathRemoved (QString)),
+				this,
+				SLOT (handlePathRemoved (QString)));
 
 		ScanTimer_->setSingleShot (true);
 		connect (ScanTimer_,
@@ -65,11 +73,16 @@ namespace LMP
 		Watcher_->RemoveRoot (path);
 	}
 
-	void LocalCollectionWatcher::ScheduleDir (const QString& dir)
+	void LocalCollectionWatcher::RestartTimer ()
 	{
 		if (ScanTimer_->isActive ())
 			ScanTimer_->stop ();
 		ScanTimer_->start (5000);
+	}
+
+	void LocalCollectionWatcher::ScheduleDir (const QString& dir)
+	{
+		RestartTimer ();
 
 		if (std::any_of (ScheduledDirs_.begin (), ScheduledDirs_.end (),
 				[&dir] (const QString& other) { return dir.startsWith (other); }))
@@ -87,12 +100,46 @@ namespace LMP
 		ScheduleDir (path);
 	}
 
+	void LocalCollectionWatcher::handlePathChanged (const QString& path)
+	{
+		RestartTimer ();
+
+		RemovedPaths_.remove (path);
+		ChangedPaths_ << path;
+	}
+
+	void LocalCollectionWatcher::handlePathRemoved (const QString& path)
+	{
+		RestartTimer ();
+
+		ChangedPaths_.remove (path);
+		RemovedPaths_ << path;
+	}
+
 	void LocalCollectionWatcher::rescanQueue ()
 	{
+		const auto collection = Core::Instance ().GetLocalCollection ();
+
 		for (const auto& path : ScheduledDirs_)
-			Core::Instance ().GetLocalCollection ()->Scan (path, false);
+			collection->Scan (path, false);
+
+		auto isScheduled = [this] (const QString& path)
+		{
+			return std::any_of (ScheduledDirs_.begin (), ScheduledDirs_.end (),
+					[&path] (const QString& dir) { return path.startsWith (dir); });
+		};
+		for (auto it = ChangedPaths_.begin (); it != ChangedPaths_.end (); )
+			if (isScheduled (*it))
+				it = ChangedPaths_.erase (it);
+			else
+				++it;
+
+		if (!ChangedPaths_.isEmpty () || !RemovedPaths_.isEmpty ())
+			collection->HandleChangedPaths (ChangedPaths_, RemovedPaths_);
 
 		ScheduledDirs_.clear ();
+		ChangedPaths_.clear ();
+		RemovedPaths_.clear ();
 	}
 }
 }
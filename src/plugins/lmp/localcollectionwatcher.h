@@ -50,6 +50,8 @@ namespace LMP
 		RecursiveDirWatcher * const Watcher_;
 
 		QList<QString> ScheduledDirs_;
+		QSet<QString> ChangedPaths_;
+		QSet<QString> RemovedPaths_;
 		QTimer * const ScanTimer_;
 	public:
 		LocalCollectionWatcher (QObject* = nullptr);
@@ -57,9 +59,12 @@ namespace LMP
 		void AddPath (const QString&);
 		void RemovePath (const QString&);
 	private:
+		void RestartTimer ();
 		void ScheduleDir (const QString&);
 	private slots:
 		void handleDirectoryChanged (const QString&);
+		void handlePathChanged (const QString&);
+		void handlePathRemoved (const QString&);
 		void rescanQueue ();
 	};
 }
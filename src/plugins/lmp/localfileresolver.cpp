@@ -30,9 +30,11 @@
 #include "localfileresolver.h"
 #include <QtDebug>
 #include <QFileInfo>
+#include <taglib/taglib.h>
 #include <taglib/fileref.h>
 #include <taglib/tag.h>
 #include <util/sll/prelude.h>
+#include <util/sll/util.h>
 #include <util/sll/either.h>
 #include "util/lmp/gstutil.h"
 #include "xmlsettingsmanager.h"
@@ -41,6 +43,40 @@ namespace LeechCraft
 {
 namespace LMP
 {
+	bool operator== (const ResolverCacheKey& left, const ResolverCacheKey& right)
+	{
+		return left.MTime_ == right.MTime_ &&
+				left.Size_ == right.Size_ &&
+				left.Path_ == right.Path_;
+	}
+
+	uint qHash (const ResolverCacheKey& key)
+	{
+		return ::qHash (key.Path_) ^ ::qHash (key.MTime_) ^ ::qHash (key.Size_);
+	}
+
+	namespace
+	{
+		/* TagLib has atomic reference counting for its shared strings and
+		 * lists since 1.10, so distinct FileRefs may be used from different
+		 * threads concurrently. Older versions need every TagLib call
+		 * serialized.
+		 */
+		constexpr bool ConcurrentReads = TAGLIB_MAJOR_VERSION > 1 ||
+				(TAGLIB_MAJOR_VERSION == 1 && TAGLIB_MINOR_VERSION >= 10);
+
+		const int CacheSize = 10000;
+	}
+
+	LocalFileResolver::LocalFileResolver (QObject *parent)
+	: QObject { parent }
+	, Cache_ { CacheSize }
+	{
+		XmlSettingsManager::Instance ().RegisterObject ({ "EnableLocalTagsRecoding", "TagsRecodingRegion" },
+				this, "handleRecodingChanged");
+		handleRecodingChanged ();
+	}
+
 	TagLib::FileRef LocalFileResolver::GetFileRef (const QString& file) const
 	{
 #ifdef Q_OS_WIN32
@@ -52,19 +88,23 @@ namespace LMP
 
 	LocalFileResolver::ResolveResult_t LocalFileResolver::ResolveInfo (const QString& file)
 	{
-		const auto& modified = QFileInfo (file).lastModified ();
+		const QFileInfo fi { file };
+		const ResolverCacheKey key { file, fi.lastModified ().toMSecsSinceEpoch (), fi.size () };
 
+		QString region;
 		{
-			QReadLocker locker (&CacheLock_);
-			if (Cache_.contains (file))
-			{
-				const auto& pair = Cache_ [file];
-				if (pair.first == modified)
-					return ResolveResult_t::Right (pair.second);
-			}
+			QMutexLocker locker { &CacheLock_ };
+			if (const auto info = Cache_.object (key))
+				return ResolveResult_t::Right (*info);
+
+			region = RecodingRegion_;
 		}
 
-		QMutexLocker tlLocker (&TaglibMutex_);
+		if (ConcurrentReads)
+			TaglibLock_.lockForRead ();
+		else
+			TaglibLock_.lockForWrite ();
+		const auto unlockGuard = Util::MakeScopeGuard ([this] { TaglibLock_.unlock (); });
 
 		auto r = GetFileRef (file);
 		auto tag = r.tag ();
@@ -73,10 +113,6 @@ namespace LMP
 
 		auto audio = r.audioProperties ();
 
-		auto& xsm = XmlSettingsManager::Instance ();
-		const auto& region = xsm.property ("EnableLocalTagsRecoding").toBool () ?
-				xsm.property ("TagsRecodingRegion").toString () :
-				QString {};
 		auto ftl = [&region] (const TagLib::String& str)
 		{
 			return GstUtil::FixEncoding (QString::fromUtf8 (str.toCString (true)), region);
@@ -96,22 +132,35 @@ namespace LMP
 			static_cast<qint32> (tag->track ())
 		};
 		{
-			QWriteLocker locker (&CacheLock_);
-			if (Cache_.size () > 200)
-				Cache_.clear ();
-			Cache_ [file] = qMakePair (modified, info);
+			QMutexLocker locker { &CacheLock_ };
+			Cache_.insert (key, new MediaInfo { info });
 		}
 		return ResolveResult_t::Right (info);
 	}
 
-	QMutex& LocalFileResolver::GetMutex ()
+	QReadWriteLock& LocalFileResolver::GetLock ()
 	{
-		return TaglibMutex_;
+		return TaglibLock_;
 	}
 
 	void LocalFileResolver::flushCache ()
 	{
-		QWriteLocker locker { &CacheLock_ };
+		QMutexLocker locker { &CacheLock_ };
+		Cache_.clear ();
+	}
+
+	void LocalFileResolver::handleRecodingChanged ()
+	{
+		auto& xsm = XmlSettingsManager::Instance ();
+		const auto& region = xsm.property ("EnableLocalTagsRecoding").toBool () ?
+				xsm.property ("TagsRecodingRegion").toString () :
+				QString {};
+
+		QMutexLocker locker { &CacheLock_ };
+		if (region == RecodingRegion_)
+			return;
+
+		RecodingRegion_ = region;
 		Cache_.clear ();
 	}
 }
@@ -31,10 +31,9 @@
 
 #include <stdexcept>
 #include <QObject>
-#include <QHash>
+#include <QCache>
 #include <QReadWriteLock>
 #include <QMutex>
-#include <QDateTime>
 #include <taglib/fileref.h>
 #include "interfaces/lmp/itagresolver.h"
 #include "mediainfo.h"
@@ -43,23 +42,46 @@ namespace LeechCraft
 {
 namespace LMP
 {
+	struct ResolverCacheKey
+	{
+		QString Path_;
+		qint64 MTime_;
+		qint64 Size_;
+	};
+
+	bool operator== (const ResolverCacheKey&, const ResolverCacheKey&);
+	uint qHash (const ResolverCacheKey&);
+
+	/** @brief Thread-safe tag resolver for local files.
+	 *
+	 * Tags are read without serializing readers against each other if
+	 * the TagLib in use has atomic reference counting, so several
+	 * threads may resolve different files at once. Tag writers should
+	 * still take GetLock() for writing.
+	 *
+	 * Resolved tags are kept in an LRU cache keyed by path,
+	 * modification time and size.
+	 */
 	class LocalFileResolver : public QObject
 							, public ITagResolver
 	{
 		Q_OBJECT
 		Q_INTERFACES (LeechCraft::LMP::ITagResolver)
 
-		QMutex TaglibMutex_;
-		QReadWriteLock CacheLock_;
-		QHash<QString, QPair<QDateTime, MediaInfo>> Cache_;
+		QReadWriteLock TaglibLock_;
+
+		QMutex CacheLock_;
+		QCache<ResolverCacheKey, MediaInfo> Cache_;
+		QString RecodingRegion_;
 	public:
-		using QObject::QObject;
+		LocalFileResolver (QObject* = nullptr);
 
 		TagLib::FileRef GetFileRef (const QString&) const;
 		ResolveResult_t ResolveInfo (const QString&);
-		QMutex& GetMutex ();
+		QReadWriteLock& GetLock ();
 	private slots:
 		void flushCache ();
+		void handleRecodingChanged ();
 	};
 }
 }
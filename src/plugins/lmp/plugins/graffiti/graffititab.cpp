@@ -38,6 +38,7 @@
 #include <QFutureWatcher>
 #include <QtDebug>
 #include <QSettings>
+#include <QReadWriteLock>
 #include <taglib/fileref.h>
 #include <taglib/tag.h>
 #include <util/tags/tagscompletionmodel.h>
@@ -427,7 +428,7 @@ namespace Graffiti
 		{
 			const auto& newInfo = pair.first;
 
-			QMutexLocker locker (&resolver->GetMutex ());
+			QWriteLocker locker (&resolver->GetLock ());
 			auto file = resolver->GetFileRef (newInfo.LocalPath_);
 			auto tag = file.tag ();
 
@@ -29,9 +29,13 @@
 
 #include "progressmanager.h"
 #include <QStandardItemModel>
+#include <QToolBar>
+#include <QAction>
+#include <util/util.h>
 #include <util/xpc/util.h>
 #include <interfaces/ijobholder.h>
 #include "sync/syncmanagerbase.h"
+#include "rganalysismanager.h"
 
 namespace LeechCraft
 {
@@ -43,6 +47,10 @@ namespace LMP
 	{
 	}
 
+	ProgressManager::~ProgressManager ()
+	{
+	}
+
 	QAbstractItemModel* ProgressManager::GetModel () const
 	{
 		return Model_;
@@ -60,6 +68,29 @@ namespace LMP
 				SLOT (handleUploadProgress (int, int, SyncManagerBase*)));
 	}
 
+	void ProgressManager::AddRgAnalysisManager (RgAnalysisManager *rgMgr)
+	{
+		RgMgr_ = rgMgr;
+
+		RgBar_.reset (new QToolBar);
+		RgPause_ = RgBar_->addAction (tr ("Pause"));
+		RgPause_->setProperty ("ActionIcon", "media-playback-pause");
+		RgPause_->setCheckable (true);
+		connect (RgPause_,
+				&QAction::toggled,
+				RgMgr_,
+				&RgAnalysisManager::SetPaused);
+		connect (RgMgr_,
+				SIGNAL (pausedChanged (bool)),
+				RgPause_,
+				SLOT (setChecked (bool)));
+
+		connect (RgMgr_,
+				SIGNAL (progressChanged (int, int, qint64)),
+				this,
+				SLOT (handleRgProgress (int, int, qint64)));
+	}
+
 	void ProgressManager::HandleWithHash (int done, int total,
 			SyncManagerBase *syncer, Syncer2Row_t& hash, const QString& name, const QString& status)
 	{
@@ -104,5 +135,52 @@ namespace LMP
 		HandleWithHash (done, total, syncer, UpRows_,
 				tr ("Audio upload"), tr ("Uploading..."));
 	}
+
+	void ProgressManager::handleRgProgress (int done, int total, qint64 etaSecs)
+	{
+		if (done == total)
+		{
+			if (!RgRow_.isEmpty ())
+			{
+				Model_->removeRow (RgRow_.first ()->row ());
+				RgRow_.clear ();
+			}
+			return;
+		}
+
+		if (RgRow_.isEmpty ())
+		{
+			RgRow_ = QList<QStandardItem*>
+			{
+				new QStandardItem (tr ("ReplayGain analysis")),
+				new QStandardItem (),
+				new QStandardItem ()
+			};
+			const auto& barVar = QVariant::fromValue<QToolBar*> (RgBar_.get ());
+			for (const auto item : RgRow_)
+			{
+				item->setData (barVar, RoleControls);
+				item->setEditable (false);
+			}
+
+			auto item = RgRow_.at (JobHolderColumn::JobProgress);
+			item->setData (QVariant::fromValue<JobHolderRow> (JobHolderRow::ProcessProgress),
+					CustomDataRoles::RoleJobHolderRow);
+
+			Model_->appendRow (RgRow_);
+		}
+
+		QString status;
+		if (RgMgr_->IsPaused ())
+			status = tr ("Paused");
+		else if (etaSecs < 0)
+			status = tr ("Analysing...");
+		else
+			status = tr ("Analysing, %1 left").arg (Util::MakeTimeFromLong (etaSecs));
+		RgRow_.at (JobHolderColumn::JobStatus)->setText (status);
+
+		Util::SetJobHolderProgress (RgRow_, done, total,
+				tr ("%1 of %2 albums").arg (done).arg (total));
+	}
 }
 }
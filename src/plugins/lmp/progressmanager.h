@@ -29,18 +29,22 @@
 
 #pragma once
 
+#include <memory>
 #include <QObject>
 #include <QHash>
 
 class QAbstractItemModel;
 class QStandardItemModel;
 class QStandardItem;
+class QToolBar;
+class QAction;
 
 namespace LeechCraft
 {
 namespace LMP
 {
 	class SyncManagerBase;
+	class RgAnalysisManager;
 
 	class ProgressManager : public QObject
 	{
@@ -51,18 +55,27 @@ namespace LMP
 		typedef QHash<SyncManagerBase*, QList<QStandardItem*>> Syncer2Row_t;
 		Syncer2Row_t TCRows_;
 		Syncer2Row_t UpRows_;
+
+		RgAnalysisManager *RgMgr_ = nullptr;
+		QList<QStandardItem*> RgRow_;
+		std::unique_ptr<QToolBar> RgBar_;
+		QAction *RgPause_ = nullptr;
 	public:
 		ProgressManager (QObject* = 0);
+		~ProgressManager ();
 
 		QAbstractItemModel* GetModel () const;
 
 		void AddSyncManager (SyncManagerBase*);
+		void AddRgAnalysisManager (RgAnalysisManager*);
 	private:
 		void HandleWithHash (int, int, SyncManagerBase*,
 				Syncer2Row_t&, const QString&, const QString&);
 	private slots:
 		void handleTCProgress (int, int, SyncManagerBase*);
 		void handleUploadProgress (int, int, SyncManagerBase*);
+
+		void handleRgProgress (int, int, qint64);
 	};
 }
 }
@@ -29,8 +29,10 @@
 
 #include "recursivedirwatcher.h"
 
-#ifdef Q_OS_MAC
+#if defined (Q_OS_MAC)
 #include "recursivedirwatcher_mac.h"
+#elif defined (ENABLE_INOTIFY)
+#include "recursivedirwatcher_inotify.h"
 #else
 #include "recursivedirwatcher_generic.h"
 #endif
@@ -47,6 +49,17 @@ namespace LMP
 				SIGNAL (directoryChanged (QString)),
 				this,
 				SIGNAL (directoryChanged (QString)));
+
+#if defined (ENABLE_INOTIFY) && !defined (Q_OS_MAC)
+		connect (Impl_,
+				SIGNAL (pathChanged (QString)),
+				this,
+				SIGNAL (pathChanged (QString)));
+		connect (Impl_,
+				SIGNAL (pathRemoved (QString)),
+				this,
+				SIGNAL (pathRemoved (QString)));
+#endif
 	}
 
 	void RecursiveDirWatcher::AddRoot (const QString& root)
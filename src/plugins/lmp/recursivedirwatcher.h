@@ -48,7 +48,28 @@ namespace LMP
 		void AddRoot (const QString&);
 		void RemoveRoot (const QString&);
 	signals:
+		/** @brief Something has changed somewhere in the given directory.
+		 *
+		 * The backend doesn't know what exactly has changed, so the
+		 * whole directory should be rescanned.
+		 */
 		void directoryChanged (const QString&);
+
+		/** @brief The given file has been written or moved in.
+		 *
+		 * This may also be a directory that has just been created or
+		 * moved in, in which case it should be scanned as a whole.
+		 *
+		 * Only emitted by backends that know the exact paths.
+		 */
+		void pathChanged (const QString&);
+
+		/** @brief The given file or directory has been removed or moved
+		 * out.
+		 *
+		 * Only emitted by backends that know the exact paths.
+		 */
+		void pathRemoved (const QString&);
 	};
 }
 }
@@ -0,0 +1,255 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "recursivedirwatcher_inotify.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <QSocketNotifier>
+#include <QStringList>
+#include <QDir>
+#include <QFile>
+#include <QtConcurrentRun>
+#include <QtDebug>
+#include <util/threads/futures.h>
+
+namespace LeechCraft
+{
+namespace LMP
+{
+	namespace
+	{
+		QStringList CollectSubdirs (const QString& path)
+		{
+			QStringList result { path };
+
+			QDir dir { path };
+			for (const auto& item : dir.entryList (QDir::Dirs | QDir::NoDotAndDotDot))
+				result += CollectSubdirs (dir.filePath (item));
+
+			return result;
+		}
+
+		const uint32_t WatchMask = IN_CLOSE_WRITE |
+				IN_CREATE |
+				IN_DELETE |
+				IN_MOVED_FROM |
+				IN_MOVED_TO |
+				IN_ONLYDIR |
+				IN_EXCL_UNLINK;
+
+		bool IsUnder (const QString& path, const QString& dir)
+		{
+			return path == dir ||
+					(path.startsWith (dir) && path.at (dir.size ()) == '/');
+		}
+	}
+
+	RecursiveDirWatcherImpl::RecursiveDirWatcherImpl (QObject *parent)
+	: QObject { parent }
+	, Fd_ { inotify_init1 (IN_NONBLOCK | IN_CLOEXEC) }
+	{
+		if (Fd_ < 0)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to initialize inotify:"
+					<< std::strerror (errno);
+			return;
+		}
+
+		Notifier_ = new QSocketNotifier { Fd_, QSocketNotifier::Read, this };
+		connect (Notifier_,
+				SIGNAL (activated (int)),
+				this,
+				SLOT (readEvents ()));
+	}
+
+	RecursiveDirWatcherImpl::~RecursiveDirWatcherImpl ()
+	{
+		if (Fd_ >= 0)
+			close (Fd_);
+	}
+
+	void RecursiveDirWatcherImpl::AddRoot (const QString& root)
+	{
+		if (Fd_ < 0 || Roots_.contains (root))
+			return;
+
+		Roots_ << root;
+
+		qDebug () << Q_FUNC_INFO << "scanning" << root;
+		AddSubtree (root);
+	}
+
+	void RecursiveDirWatcherImpl::RemoveRoot (const QString& root)
+	{
+		if (!Roots_.removeOne (root))
+			return;
+
+		RemoveWatches (root);
+	}
+
+	void RecursiveDirWatcherImpl::AddSubtree (const QString& dir)
+	{
+		Util::Sequence (this, QtConcurrent::run (CollectSubdirs, dir)) >>
+				[this] (const QStringList& paths) { AddWatches (paths); };
+	}
+
+	void RecursiveDirWatcherImpl::AddWatches (const QStringList& dirs)
+	{
+		for (const auto& dir : dirs)
+		{
+			if (!std::any_of (Roots_.begin (), Roots_.end (),
+					[&dir] (const QString& root) { return IsUnder (dir, root); }))
+				continue;
+
+			const auto wd = inotify_add_watch (Fd_, QFile::encodeName (dir).constData (), WatchMask);
+			if (wd < 0)
+			{
+				if (errno == ENOSPC && !WarnedLimit_)
+				{
+					qWarning () << Q_FUNC_INFO
+							<< "inotify watches limit reached, consider increasing"
+							<< "fs.inotify.max_user_watches";
+					WarnedLimit_ = true;
+				}
+				else if (errno != ENOSPC && errno != ENOENT)
+					qWarning () << Q_FUNC_INFO
+							<< "unable to watch"
+							<< dir
+							<< std::strerror (errno);
+				continue;
+			}
+
+			const auto prevDir = WD2Dir_.value (wd);
+			if (!prevDir.isEmpty ())
+				Dir2WD_.remove (prevDir);
+
+			WD2Dir_ [wd] = dir;
+			Dir2WD_ [dir] = wd;
+		}
+	}
+
+	void RecursiveDirWatcherImpl::RemoveWatches (const QString& dir)
+	{
+		for (auto i = Dir2WD_.begin (); i != Dir2WD_.end (); )
+		{
+			if (!IsUnder (i.key (), dir))
+			{
+				++i;
+				continue;
+			}
+
+			inotify_rm_watch (Fd_, i.value ());
+			WD2Dir_.remove (i.value ());
+			i = Dir2WD_.erase (i);
+		}
+	}
+
+	void RecursiveDirWatcherImpl::ForgetWatch (int wd)
+	{
+		const auto& dir = WD2Dir_.take (wd);
+		if (!dir.isEmpty ())
+			Dir2WD_.remove (dir);
+	}
+
+	void RecursiveDirWatcherImpl::HandleEvent (const inotify_event *event)
+	{
+		if (event->mask & IN_Q_OVERFLOW)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "inotify queue overflow, rescanning the roots";
+			for (const auto& root : Roots_)
+				emit directoryChanged (root);
+			return;
+		}
+
+		if (event->mask & IN_IGNORED)
+		{
+			ForgetWatch (event->wd);
+			return;
+		}
+
+		const auto& dir = WD2Dir_.value (event->wd);
+		if (dir.isEmpty () || !event->len)
+			return;
+
+		const auto& path = dir + '/' + QFile::decodeName (event->name);
+
+		if (event->mask & IN_ISDIR)
+		{
+			if (event->mask & (IN_CREATE | IN_MOVED_TO))
+			{
+				AddSubtree (path);
+				emit pathChanged (path);
+			}
+			else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+			{
+				RemoveWatches (path);
+				emit pathRemoved (path);
+			}
+			return;
+		}
+
+		// Plain IN_CREATE is not interesting for files: the data isn't
+		// there yet, and IN_CLOSE_WRITE will follow.
+		if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+			emit pathChanged (path);
+		else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+			emit pathRemoved (path);
+	}
+
+	void RecursiveDirWatcherImpl::readEvents ()
+	{
+		alignas (inotify_event) char buffer [64 * 1024];
+
+		while (true)
+		{
+			const auto length = read (Fd_, buffer, sizeof (buffer));
+			if (length <= 0)
+			{
+				if (length < 0 && errno != EAGAIN && errno != EINTR)
+					qWarning () << Q_FUNC_INFO
+							<< "error reading inotify events:"
+							<< std::strerror (errno);
+				return;
+			}
+
+			for (auto pos = buffer; pos < buffer + length; )
+			{
+				const auto event = reinterpret_cast<const inotify_event*> (pos);
+				HandleEvent (event);
+				pos += sizeof (inotify_event) + event->len;
+			}
+		}
+	}
+}
+}
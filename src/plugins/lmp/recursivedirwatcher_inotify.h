@@ -0,0 +1,90 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+
+class QSocketNotifier;
+
+struct inotify_event;
+
+namespace LeechCraft
+{
+namespace LMP
+{
+	/** @brief inotify-based recursive directory watcher.
+	 *
+	 * A single inotify instance watches every directory below the
+	 * roots. Unlike the generic QFileSystemWatcher-based backend, this
+	 * one reports the exact files that have been written, moved in,
+	 * deleted or moved out, so that only they are re-resolved.
+	 *
+	 * Newly created or moved-in directories start being watched
+	 * automatically and are reported via pathChanged() as a whole.
+	 * If the kernel event queue overflows, each root is reported via
+	 * directoryChanged().
+	 */
+	class RecursiveDirWatcherImpl : public QObject
+	{
+		Q_OBJECT
+
+		const int Fd_;
+		QSocketNotifier *Notifier_ = nullptr;
+
+		QStringList Roots_;
+		QHash<int, QString> WD2Dir_;
+		QHash<QString, int> Dir2WD_;
+
+		bool WarnedLimit_ = false;
+	public:
+		RecursiveDirWatcherImpl (QObject*);
+		~RecursiveDirWatcherImpl ();
+
+		void AddRoot (const QString&);
+		void RemoveRoot (const QString&);
+	private:
+		void AddSubtree (const QString&);
+		void AddWatches (const QStringList&);
+		void RemoveWatches (const QString&);
+		void ForgetWatch (int);
+
+		void HandleEvent (const inotify_event*);
+	private slots:
+		void readEvents ();
+	signals:
+		void directoryChanged (const QString&);
+
+		void pathChanged (const QString&);
+		void pathRemoved (const QString&);
+	};
+}
+}
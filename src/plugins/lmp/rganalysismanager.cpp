@@ -28,16 +28,23 @@
  **********************************************************************/
 
 #include "rganalysismanager.h"
+#include <algorithm>
+#include <QThread>
+#include <QtDebug>
 #include "localcollection.h"
 #include "localcollectionstorage.h"
 #include "engine/rganalyser.h"
-#include "engine/rgfilter.h"
 #include "xmlsettingsmanager.h"
 
 namespace LeechCraft
 {
 namespace LMP
 {
+	namespace
+	{
+		const int ResultsBatchSize = 200;
+	}
+
 	RgAnalysisManager::RgAnalysisManager (LocalCollection *coll, QObject *parent)
 	: QObject { parent }
 	, Coll_ { coll }
@@ -49,6 +56,42 @@ namespace LMP
 
 		XmlSettingsManager::Instance ().RegisterObject ("AutobuildRG",
 				this, "handleScanFinished");
+		XmlSettingsManager::Instance ().RegisterObject ("RgAnalysersCount",
+				this, "rotateQueue");
+	}
+
+	RgAnalysisManager::~RgAnalysisManager ()
+	{
+		FlushResults ();
+	}
+
+	bool RgAnalysisManager::IsPaused () const
+	{
+		return IsPaused_;
+	}
+
+	void RgAnalysisManager::SetPaused (bool paused)
+	{
+		if (paused == IsPaused_)
+			return;
+
+		IsPaused_ = paused;
+		for (const auto& analyser : Analysers_)
+			analyser->SetPaused (paused);
+
+		if (paused)
+		{
+			PauseTimer_.start ();
+			FlushResults ();
+		}
+		else if (PauseTimer_.isValid ())
+			PausedMSecs_ += PauseTimer_.elapsed ();
+
+		emit pausedChanged (paused);
+		EmitProgress ();
+
+		if (!paused)
+			rotateQueue ();
 	}
 
 	namespace
@@ -59,9 +102,67 @@ namespace LMP
 		}
 	}
 
+	int RgAnalysisManager::GetMaxAnalysers () const
+	{
+		const auto count = XmlSettingsManager::Instance ().property ("RgAnalysersCount").toInt ();
+		return count > 0 ?
+				count :
+				std::max (QThread::idealThreadCount (), 1);
+	}
+
+	void RgAnalysisManager::FlushResults ()
+	{
+		if (PendingResults_.isEmpty ())
+			return;
+
+		try
+		{
+			Coll_->GetStorage ()->SetRgTrackInfos (PendingResults_);
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to save RG data for"
+					<< PendingResults_.size ()
+					<< "tracks:"
+					<< e.what ();
+		}
+
+		PendingResults_.clear ();
+	}
+
+	void RgAnalysisManager::EmitProgress ()
+	{
+		if (!TotalAlbums_)
+		{
+			emit progressChanged (0, 0, -1);
+			return;
+		}
+
+		qint64 eta = -1;
+		if (DoneAlbums_ && !IsPaused_)
+		{
+			const auto activeMSecs = Timer_.elapsed () - PausedMSecs_;
+			eta = activeMSecs * (TotalAlbums_ - DoneAlbums_) / DoneAlbums_ / 1000;
+		}
+
+		emit progressChanged (DoneAlbums_, TotalAlbums_, eta);
+	}
+
 	void RgAnalysisManager::handleAnalysed ()
 	{
-		const auto& result = CurrentAnalyser_->GetResult ();
+		const auto analyser = qobject_cast<RgAnalyser*> (sender ());
+		const auto pos = std::find_if (Analysers_.begin (), Analysers_.end (),
+				[analyser] (const std::shared_ptr<RgAnalyser>& other) { return other.get () == analyser; });
+		if (pos == Analysers_.end ())
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unknown analyser"
+					<< sender ();
+			return;
+		}
+
+		const auto& result = analyser->GetResult ();
 
 		for (const auto& track : result.Tracks_)
 		{
@@ -74,39 +175,72 @@ namespace LMP
 				continue;
 			}
 
-			Coll_->GetStorage ()->SetRgTrackInfo (id,
-					{
-						track.TrackGain_,
-						track.TrackPeak_,
-						result.AlbumGain_,
-						result.AlbumPeak_
-					});
+			const RGData data
+			{
+				track.TrackGain_,
+				track.TrackPeak_,
+				result.AlbumGain_,
+				result.AlbumPeak_
+			};
+			PendingResults_.append (qMakePair (id, data));
 		}
 
-		CurrentAnalyser_.reset ();
+		if (PendingResults_.size () >= ResultsBatchSize)
+			FlushResults ();
+
+		Analysers_.erase (pos);
+
+		++DoneAlbums_;
+		EmitProgress ();
+
 		rotateQueue ();
 	}
 
 	void RgAnalysisManager::rotateQueue ()
 	{
-		if (AlbumsQueue_.isEmpty ())
-			return;
-
 		if (!IsScanAllowed ())
-		{
 			AlbumsQueue_.clear ();
-			return;
+
+		const auto maxAnalysers = GetMaxAnalysers ();
+		while (!IsPaused_ &&
+				!AlbumsQueue_.isEmpty () &&
+				Analysers_.size () < maxAnalysers)
+		{
+			QStringList paths;
+			for (const auto& track : AlbumsQueue_.takeFirst ()->Tracks_)
+				paths << track.FilePath_;
+
+			if (paths.isEmpty ())
+			{
+				++DoneAlbums_;
+				continue;
+			}
+
+			const auto analyser = std::make_shared<RgAnalyser> (paths);
+			connect (analyser.get (),
+					SIGNAL (finished ()),
+					this,
+					SLOT (handleAnalysed ()));
+			Analysers_ << analyser;
 		}
 
-		QStringList paths;
-		for (const auto& track : AlbumsQueue_.takeFirst ()->Tracks_)
-			paths << track.FilePath_;
+		if (!AlbumsQueue_.isEmpty () || !Analysers_.isEmpty ())
+			return;
+
+		FlushResults ();
 
-		CurrentAnalyser_ = std::make_shared<RgAnalyser> (paths);
-		connect (CurrentAnalyser_.get (),
-				SIGNAL (finished ()),
-				this,
-				SLOT (handleAnalysed ()));
+		if (TotalAlbums_)
+			qDebug () << Q_FUNC_INFO
+					<< "analysed"
+					<< DoneAlbums_
+					<< "albums in"
+					<< (Timer_.elapsed () - PausedMSecs_) / 1000
+					<< "seconds";
+
+		ScheduledAlbums_.clear ();
+		TotalAlbums_ = 0;
+		DoneAlbums_ = 0;
+		EmitProgress ();
 	}
 
 	void RgAnalysisManager::handleScanFinished ()
@@ -119,16 +253,35 @@ namespace LMP
 		for (const auto track : Coll_->GetStorage ()->GetOutdatedRgTracks ())
 			albums << Coll_->GetTrackAlbumId (track);
 
-		const bool wasEmpty = AlbumsQueue_.isEmpty ();
+		const bool wasIdle = AlbumsQueue_.isEmpty () && Analysers_.isEmpty ();
+		if (wasIdle)
+		{
+			Timer_.start ();
+			PausedMSecs_ = 0;
+			if (IsPaused_)
+				PauseTimer_.start ();
+		}
 
 		for (auto albumId : albums)
+		{
+			if (ScheduledAlbums_.contains (albumId))
+				continue;
+
 			if (const auto& album = Coll_->GetAlbum (albumId))
+			{
 				AlbumsQueue_ << album;
+				ScheduledAlbums_ << albumId;
+				++TotalAlbums_;
+			}
+		}
 
 		qDebug () << AlbumsQueue_.size ()
-				<< "albums to rescan";
-		if (wasEmpty)
-			rotateQueue ();
+				<< "albums to rescan using up to"
+				<< GetMaxAnalysers ()
+				<< "analysers";
+
+		EmitProgress ();
+		rotateQueue ();
 	}
 }
 }
@@ -29,9 +29,12 @@
 
 #pragma once
 
+#include <memory>
 #include <QObject>
 #include <QSet>
+#include <QElapsedTimer>
 #include "interfaces/lmp/collectiontypes.h"
+#include "engine/rgfilter.h"
 
 namespace LeechCraft
 {
@@ -40,22 +43,59 @@ namespace LMP
 	class RgAnalyser;
 	class LocalCollection;
 
+	/** @brief Builds ReplayGain data for the local collection.
+	 *
+	 * Albums with outdated ReplayGain data are analysed by up to
+	 * GetMaxAnalysers() concurrent RgAnalyser pipelines, whose
+	 * streaming threads run with idle priority. Results are written
+	 * to the storage in batches.
+	 */
 	class RgAnalysisManager : public QObject
 	{
 		Q_OBJECT
 
 		LocalCollection * const Coll_;
 
-		std::shared_ptr<RgAnalyser> CurrentAnalyser_;
+		QList<std::shared_ptr<RgAnalyser>> Analysers_;
 
 		QList<Collection::Album_ptr> AlbumsQueue_;
+		QSet<int> ScheduledAlbums_;
+
+		QList<QPair<int, RGData>> PendingResults_;
+
+		bool IsPaused_ = false;
+
+		int TotalAlbums_ = 0;
+		int DoneAlbums_ = 0;
+		QElapsedTimer Timer_;
+		qint64 PausedMSecs_ = 0;
+		QElapsedTimer PauseTimer_;
 	public:
 		RgAnalysisManager (LocalCollection *coll, QObject* = nullptr);
+		~RgAnalysisManager ();
+
+		bool IsPaused () const;
+		void SetPaused (bool);
+	private:
+		int GetMaxAnalysers () const;
+		void FlushResults ();
+		void EmitProgress ();
 	private slots:
 		void handleAnalysed ();
 		void rotateQueue ();
 	public slots:
 		void handleScanFinished ();
+	signals:
+		/** @brief Emitted when the progress of the analysis changes.
+		 *
+		 * @param[out] done The number of albums analysed so far.
+		 * @param[out] total The total number of albums to analyse.
+		 * @param[out] etaSecs The estimated number of seconds left, or
+		 * -1 if it is not known yet.
+		 */
+		void progressChanged (int done, int total, qint64 etaSecs);
+
+		void pausedChanged (bool);
 	};
 }
 }
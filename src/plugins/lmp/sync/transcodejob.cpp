@@ -34,6 +34,7 @@
 #include <QDir>
 #include <QUuid>
 #include <QtDebug>
+#include <QReadWriteLock>
 #include <taglib/tag.h>
 #include "transcodingparams.h"
 #include "core.h"
@@ -152,7 +153,7 @@ namespace LMP
 		{
 			const auto resolver = Core::Instance ().GetLocalFileResolver ();
 
-			QMutexLocker locker (&resolver->GetMutex ());
+			QWriteLocker locker (&resolver->GetLock ());
 
 			auto fromRef = resolver->GetFileRef (from);
 			auto toRef = resolver->GetFileRef (to);
@@ -34,6 +34,9 @@
 #include <interfaces/iplugin2.h>
 #include "interfaces/monocle/iredirectproxy.h"
 #include "pixmapcachemanager.h"
+#include "tilecache.h"
+#include "renderscheduler.h"
+#include "pagecompressedcache.h"
 #include "recentlyopenedmanager.h"
 #include "defaultbackendmanager.h"
 #include "docstatemanager.h"
@@ -46,6 +49,9 @@ namespace Monocle
 {
 	Core::Core ()
 	: CacheManager_ (new PixmapCacheManager (this))
+	, TileCache_ (new TileCache (this))
+	, RenderScheduler_ (new RenderScheduler (this))
+	, PageCompressedCache_ (new PageCompressedCache (this))
 	, ROManager_ (new RecentlyOpenedManager (this))
 	, DefaultBackendManager_ (new DefaultBackendManager (this))
 	, DocStateManager_ (new DocStateManager (this))
@@ -168,6 +174,21 @@ namespace Monocle
 		return CacheManager_;
 	}
 
+	TileCache* Core::GetTileCache () const
+	{
+		return TileCache_;
+	}
+
+	RenderScheduler* Core::GetRenderScheduler () const
+	{
+		return RenderScheduler_;
+	}
+
+	PageCompressedCache* Core::GetPageCompressedCache () const
+	{
+		return PageCompressedCache_;
+	}
+
 	RecentlyOpenedManager* Core::GetROManager () const
 	{
 		return ROManager_;
@@ -44,6 +44,9 @@ namespace Monocle
 {
 	class RecentlyOpenedManager;
 	class PixmapCacheManager;
+	class TileCache;
+	class RenderScheduler;
+	class PageCompressedCache;
 	class DefaultBackendManager;
 	class DocStateManager;
 	class BookmarksManager;
@@ -57,6 +60,9 @@ namespace Monocle
 		QList<QObject*> Backends_;
 
 		PixmapCacheManager *CacheManager_;
+		TileCache *TileCache_;
+		RenderScheduler *RenderScheduler_;
+		PageCompressedCache *PageCompressedCache_;
 		RecentlyOpenedManager *ROManager_;
 		DefaultBackendManager *DefaultBackendManager_;
 		DocStateManager *DocStateManager_;
@@ -78,6 +84,9 @@ namespace Monocle
 		CoreLoadProxy* LoadDocument (const QString&);
 
 		PixmapCacheManager* GetPixmapCacheManager () const;
+		TileCache* GetTileCache () const;
+		RenderScheduler* GetRenderScheduler () const;
+		PageCompressedCache* GetPageCompressedCache () const;
 		RecentlyOpenedManager* GetROManager () const;
 		DefaultBackendManager* GetDefaultBackendManager () const;
 		DocStateManager* GetDocStateManager () const;
@@ -29,6 +29,7 @@
 
 #include "documenttab.h"
 #include <functional>
+#include <memory>
 #include <QToolBar>
 #include <QComboBox>
 #include <QFileDialog>
@@ -52,6 +53,10 @@
 #include <QTreeView>
 #include <QUrl>
 #include <QFuture>
+#include <QProgressDialog>
+#include <QPainter>
+#include <QFileInfo>
+#include <QtConcurrentRun>
 #include <util/util.h>
 #include <util/xpc/stddatafiltermenucreator.h>
 #include <util/gui/findnotification.h>
@@ -94,11 +99,24 @@
 #include "core.h"
 #include "searchtabwidget.h"
 #include "documentbookmarksmanager.h"
+#include "pageprefetcher.h"
+#include "pagesexporter.h"
 
 namespace LeechCraft
 {
 namespace Monocle
 {
+	namespace
+	{
+		QFuture<void> MakeReadyFuture ()
+		{
+			QFutureInterface<void> iface;
+			iface.reportStarted ();
+			iface.reportFinished ();
+			return iface.future ();
+		}
+	}
+
 	class FindDialog : public Util::FindNotification
 	{
 		TextSearchHandler * const SearchHandler_;
@@ -107,6 +125,10 @@ namespace Monocle
 		: Util::FindNotification (Core::Instance ().GetProxy (), parent)
 		, SearchHandler_ (searchHandler)
 		{
+			connect (searchHandler,
+					&TextSearchHandler::searchFinished,
+					this,
+					[this] (bool found) { SetSuccessful (found); });
 		}
 	protected:
 		void handleNext (const QString& text, FindFlags flags)
@@ -142,6 +164,7 @@ namespace Monocle
 		FormManager_ = new FormManager (Ui_.PagesView_, this);
 		AnnManager_ = new AnnManager (Ui_.PagesView_, this);
 		LinksManager_ = new LinksManager (Ui_.PagesView_, this);
+		Prefetcher_ = new PagePrefetcher (this);
 
 		AnnWidget_ = new AnnWidget (AnnManager_);
 
@@ -594,6 +617,15 @@ namespace Monocle
 				SLOT (handleExportPDF ()));
 		Toolbar_->addAction (ExportPDFAction_);
 
+		ExportImagesAction_ = new QAction (tr ("Export pages as images..."), this);
+		ExportImagesAction_->setProperty ("ActionIcon", "image-x-generic");
+		ExportImagesAction_->setEnabled (false);
+		connect (ExportImagesAction_,
+				SIGNAL (triggered ()),
+				this,
+				SLOT (handleExportImages ()));
+		Toolbar_->addAction (ExportImagesAction_);
+
 		Toolbar_->addSeparator ();
 
 		FindAction_ = new QAction (tr ("Find..."), this);
@@ -898,6 +930,7 @@ namespace Monocle
 
 		LayoutManager_->HandleDoc (CurrentDoc_, Pages_);
 		SearchHandler_->HandleDoc (CurrentDoc_, Pages_);
+		Prefetcher_->SetDocument (CurrentDoc_);
 		FormManager_->HandleDoc (CurrentDoc_, Pages_);
 		AnnManager_->HandleDoc (CurrentDoc_, Pages_);
 		LinksManager_->HandleDoc (CurrentDoc_, Pages_);
@@ -948,7 +981,8 @@ namespace Monocle
 		auto saveable = qobject_cast<ISaveableDocument*> (docObj);
 		SaveAction_->setEnabled (saveable && saveable->CanSave ().CanSave_);
 
-		ExportPDFAction_->setEnabled (qobject_cast<ISupportPainting*> (docObj));
+		ExportPDFAction_->setEnabled (true);
+		ExportImagesAction_->setEnabled (true);
 	}
 
 	void DocumentTab::handleNavigateRequested (QString path, int num, double x, double y)
@@ -1102,38 +1136,101 @@ namespace Monocle
 		if (!CurrentDoc_ || !CurrentDoc_->GetNumPages ())
 			return;
 
-		auto paintable = qobject_cast<ISupportPainting*> (CurrentDoc_->GetQObject ());
-		if (!paintable)
-			return;
-
 		const auto& path = QFileDialog::getSaveFileName (this,
 				tr ("Export to PDF"),
 				QDir::homePath ());
 		if (path.isEmpty ())
 			return;
 
-		QPrinter printer;
-		printer.setOutputFormat (QPrinter::PdfFormat);
-		printer.setOutputFileName (path);
-		printer.setPageMargins (0, 0, 0, 0, QPrinter::DevicePixel);
-		printer.setPaperSize (CurrentDoc_->GetPageSize (0), QPrinter::DevicePixel);
-		printer.setFontEmbeddingEnabled (true);
+		const auto printer = std::make_shared<QPrinter> ();
+		printer->setOutputFormat (QPrinter::PdfFormat);
+		printer->setOutputFileName (path);
+		printer->setPageMargins (0, 0, 0, 0, QPrinter::DevicePixel);
+		printer->setPaperSize (CurrentDoc_->GetPageSize (0), QPrinter::DevicePixel);
+		printer->setFontEmbeddingEnabled (true);
 
-		QPainter painter (&printer);
-		painter.setRenderHint (QPainter::Antialiasing);
-		painter.setRenderHint (QPainter::HighQualityAntialiasing);
-		painter.setRenderHint (QPainter::SmoothPixmapTransform);
+		const auto painter = std::make_shared<QPainter> (printer.get ());
+		painter->setRenderHint (QPainter::Antialiasing);
+		painter->setRenderHint (QPainter::HighQualityAntialiasing);
+		painter->setRenderHint (QPainter::SmoothPixmapTransform);
 
+		QList<int> pages;
 		for (int i = 0, numPages = CurrentDoc_->GetNumPages (); i < numPages; ++i)
-		{
-			paintable->PaintPage (&painter, i, 1, 1);
-			if (i != numPages - 1)
-			{
-				printer.newPage ();
-				painter.translate (0, -CurrentDoc_->GetPageSize (i).height ());
-			}
-		}
-		painter.end ();
+			pages << i;
+		const auto lastPage = pages.last ();
+
+		const auto doc = CurrentDoc_;
+		const auto paintable = qobject_cast<ISupportPainting*> (doc->GetQObject ());
+
+		// Documents not supporting painting are exported as images.
+		const auto rasterScale = 2;
+		const auto exporter = new PagesExporter (doc, pages,
+				[paintable, rasterScale] (int) { return paintable ? 1 : rasterScale; }, this);
+		RunExport (exporter, tr ("Exporting to PDF..."),
+				[printer, painter] (bool ok)
+				{
+					if (!ok)
+						printer->abort ();
+					painter->end ();
+				});
+
+		if (paintable)
+			exporter->StartPainting ([doc, paintable, printer, painter, lastPage] (int i)
+					{
+						paintable->PaintPage (painter.get (), i, 1, 1);
+						if (i != lastPage)
+						{
+							printer->newPage ();
+							painter->translate (0, -doc->GetPageSize (i).height ());
+						}
+					});
+		else
+			exporter->StartRendering ([doc, printer, painter, lastPage] (int i, const QImage& img)
+					{
+						painter->drawImage (QRectF { { 0, 0 }, QSizeF { doc->GetPageSize (i) } }, img);
+						if (i != lastPage)
+							printer->newPage ();
+						return MakeReadyFuture ();
+					});
+	}
+
+	void DocumentTab::handleExportImages ()
+	{
+		if (!CurrentDoc_ || !CurrentDoc_->GetNumPages ())
+			return;
+
+		const auto& dirPath = QFileDialog::getExistingDirectory (this,
+				tr ("Export pages as images"),
+				QDir::homePath ());
+		if (dirPath.isEmpty ())
+			return;
+
+		const auto numPages = CurrentDoc_->GetNumPages ();
+		QList<int> pages;
+		for (int i = 0; i < numPages; ++i)
+			pages << i;
+
+		const auto& baseName = QFileInfo { CurrentDocPath_ }.completeBaseName ();
+		const auto digits = QString::number (numPages).size ();
+
+		const auto scale = XmlSettingsManager::Instance ().property ("ExportImagesDPI").toInt () / 72.0;
+		const auto exporter = new PagesExporter (CurrentDoc_, pages,
+				[scale] (int) { return scale; }, this);
+		RunExport (exporter, tr ("Exporting pages as images..."), [] (bool) {});
+		exporter->StartRendering ([dirPath, baseName, digits] (int i, const QImage& img)
+				{
+					const auto& path = QString { "%1/%2-%3.png" }
+							.arg (dirPath)
+							.arg (baseName)
+							.arg (i + 1, digits, 10, QChar { '0' });
+					return QtConcurrent::run ([img, path]
+							{
+								if (!img.save (path))
+									qWarning () << Q_FUNC_INFO
+											<< "unable to save"
+											<< path;
+							});
+				});
 	}
 
 	void DocumentTab::handlePrint ()
@@ -1143,16 +1240,16 @@ namespace Monocle
 
 		const int numPages = CurrentDoc_->GetNumPages ();
 
-		QPrinter printer { QPrinter::HighResolution };
-		QPrintDialog dia { &printer, this };
+		const auto printer = std::make_shared<QPrinter> (QPrinter::HighResolution);
+		QPrintDialog dia { printer.get (), this };
 		dia.setMinMax (1, numPages);
 		dia.addEnabledOption (QAbstractPrintDialog::PrintCurrentPage);
 		if (dia.exec () != QDialog::Accepted)
 			return;
 
-		const auto& pageRect = printer.pageRect (QPrinter::Point);
+		const auto& pageRect = printer->pageRect (QPrinter::Point);
 		const auto& pageSize = pageRect.size ();
-		const auto resScale = printer.resolution () / 72.0;
+		const auto resScale = printer->resolution () / 72.0;
 
 		const auto& range = dia.printRange ();
 		int start = 0, end = 0;
@@ -1165,8 +1262,8 @@ namespace Monocle
 		case QAbstractPrintDialog::Selection:
 			return;
 		case QAbstractPrintDialog::PageRange:
-			start = printer.fromPage () - 1;
-			end = printer.toPage ();
+			start = printer->fromPage () - 1;
+			end = printer->toPage ();
 			break;
 		case QAbstractPrintDialog::CurrentPage:
 			start = GetCurrentPage ();
@@ -1176,30 +1273,84 @@ namespace Monocle
 			break;
 		}
 
-		const auto isp = qobject_cast<ISupportPainting*> (CurrentDoc_->GetQObject ());
-
-		QPainter painter (&printer);
-		painter.setRenderHint (QPainter::Antialiasing);
-		painter.setRenderHint (QPainter::HighQualityAntialiasing);
-		painter.setRenderHint (QPainter::SmoothPixmapTransform);
+		QList<int> pages;
 		for (int i = start; i < end; ++i)
+			pages << i;
+		if (pages.isEmpty ())
+			return;
+		const auto lastPage = pages.last ();
+
+		const auto doc = CurrentDoc_;
+		const auto isp = qobject_cast<ISupportPainting*> (doc->GetQObject ());
+
+		const auto painter = std::make_shared<QPainter> (printer.get ());
+		painter->setRenderHint (QPainter::Antialiasing);
+		painter->setRenderHint (QPainter::HighQualityAntialiasing);
+		painter->setRenderHint (QPainter::SmoothPixmapTransform);
+
+		const auto scaleGetter = [doc, pageSize, resScale] (int i)
 		{
-			const auto& size = CurrentDoc_->GetPageSize (i);
+			const auto& size = doc->GetPageSize (i);
 			const auto scale = std::min (static_cast<double> (pageSize.width ()) / size.width (),
 					static_cast<double> (pageSize.height ()) / size.height ());
+			return resScale * scale;
+		};
 
-			if (isp)
-				isp->PaintPage (&painter, i, resScale * scale, resScale * scale);
-			else
-			{
-				const auto& img = CurrentDoc_->RenderPage (i, resScale * scale, resScale * scale).result ();
-				painter.drawImage (0, 0, img);
-			}
+		const auto exporter = new PagesExporter (doc, pages, scaleGetter, this);
+		RunExport (exporter, tr ("Printing..."),
+				[printer, painter] (bool ok)
+				{
+					if (!ok)
+						printer->abort ();
+					painter->end ();
+				});
 
-			if (i != end - 1)
-				printer.newPage ();
-		}
-		painter.end ();
+		if (isp)
+			exporter->StartPainting ([isp, printer, painter, scaleGetter, lastPage] (int i)
+					{
+						const auto scale = scaleGetter (i);
+						isp->PaintPage (painter.get (), i, scale, scale);
+						if (i != lastPage)
+							printer->newPage ();
+					});
+		else
+			exporter->StartRendering ([printer, painter, lastPage] (int i, const QImage& img)
+					{
+						painter->drawImage (0, 0, img);
+						if (i != lastPage)
+							printer->newPage ();
+						return MakeReadyFuture ();
+					});
+	}
+
+	void DocumentTab::RunExport (PagesExporter *exporter, const QString& label,
+			const std::function<void (bool)>& finishHandler)
+	{
+		const auto dia = new QProgressDialog { label, tr ("Cancel"), 0, 0, this };
+		dia->setAttribute (Qt::WA_DeleteOnClose);
+		dia->setMinimumDuration (500);
+		connect (dia,
+				SIGNAL (canceled ()),
+				exporter,
+				SLOT (cancel ()));
+
+		connect (exporter,
+				&PagesExporter::progress,
+				dia,
+				[dia] (int done, int total)
+				{
+					dia->setMaximum (total);
+					dia->setValue (done);
+				});
+		connect (exporter,
+				&PagesExporter::finished,
+				this,
+				[exporter, dia, finishHandler] (bool ok)
+				{
+					finishHandler (ok);
+					exporter->deleteLater ();
+					dia->close ();
+				});
 	}
 
 	void DocumentTab::handlePresentation ()
@@ -1253,6 +1404,12 @@ namespace Monocle
 		RegenPageVisibility ();
 
 		auto current = GetCurrentPage ();
+
+		const auto scale = LayoutManager_->GetCurrentScale ();
+		Prefetcher_->HandleCurrentPage (current,
+				LayoutManager_->GetLayoutModeCount (),
+				[scale] (int) { return scale; });
+
 		if (PrevCurrentPage_ == current && !force)
 			return;
 
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <functional>
 #include <QWidget>
 #include <QComboBox>
 #include <interfaces/ihavetabs.h>
@@ -58,6 +59,8 @@ namespace Monocle
 	class FindDialog;
 	class FormManager;
 	class LinksManager;
+	class PagePrefetcher;
+	class PagesExporter;
 	class AnnManager;
 	class SearchTabWidget;
 	class DocumentBookmarksManager;
@@ -86,6 +89,7 @@ namespace Monocle
 
 		QAction *SaveAction_ = nullptr;
 		QAction *ExportPDFAction_ = nullptr;
+		QAction *ExportImagesAction_ = nullptr;
 		QAction *FindAction_ = nullptr;
 		FindDialog *FindDialog_ = nullptr;
 
@@ -94,6 +98,7 @@ namespace Monocle
 		FormManager *FormManager_ = nullptr;
 		AnnManager *AnnManager_ = nullptr;
 		LinksManager *LinksManager_ = nullptr;
+		PagePrefetcher *Prefetcher_ = nullptr;
 
 		QDockWidget *DockWidget_ = nullptr;
 		TOCWidget *TOCWidget_ = nullptr;
@@ -177,6 +182,8 @@ namespace Monocle
 		QString GetSelectionText () const;
 
 		void RegenPageVisibility ();
+
+		void RunExport (PagesExporter*, const QString&, const std::function<void (bool)>&);
 	private slots:
 		void handleLoaderReady (DocumentOpenOptions, const IDocument_ptr&, const QString&);
 
@@ -195,6 +202,7 @@ namespace Monocle
 		void selectFile ();
 		void handleSave ();
 		void handleExportPDF ();
+		void handleExportImages ();
 
 		void handlePrint ();
 		void handlePresentation ();
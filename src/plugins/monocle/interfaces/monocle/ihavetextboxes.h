@@ -0,0 +1,104 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QtPlugin>
+#include <QList>
+#include <QRectF>
+#include <QString>
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	/** @brief Describes a single word on a page along with its glyphs.
+	 *
+	 * All the rectangles are in absolute page coordinates, that is,
+	 * from 0 to page width and page height correspondingly as returned
+	 * by IDocument::GetPageSize().
+	 */
+	struct TextBox
+	{
+		/** @brief The text of the word.
+		 */
+		QString Text_;
+
+		/** @brief The bounding rectangle of the word.
+		 */
+		QRectF Rect_;
+
+		/** @brief The bounding rectangles of the characters of the word.
+		 *
+		 * This list may be empty if the format doesn't provide the
+		 * positions of separate glyphs. Otherwise its size should be
+		 * equal to the length of Text_.
+		 */
+		QList<QRectF> CharRects_;
+
+		/** @brief Whether the word is followed by a space.
+		 */
+		bool SpaceAfter_;
+	};
+
+	/** @brief Interface for documents providing positioned text.
+	 *
+	 * This interface should be implemented by the documents of formats
+	 * allowing to extract the words of a page along with their
+	 * positions. It is used to build a persistent text index of the
+	 * document, so that searching the document doesn't require
+	 * querying the backend at all.
+	 *
+	 * @sa IHaveTextContent, ISearchableDocument
+	 */
+	class IHaveTextBoxes
+	{
+	public:
+		/** @brief Virtual destructor.
+		 */
+		virtual ~IHaveTextBoxes () {}
+
+		/** @brief Returns the words found on the given \em page.
+		 *
+		 * The words should be returned in the reading order.
+		 *
+		 * This function is called from a background thread, possibly
+		 * concurrently with other methods of the document (including
+		 * rendering), so the implementation should be thread-safe.
+		 *
+		 * @param[in] page The index of the page to query.
+		 * @return The list of words on the \em page.
+		 */
+		virtual QList<TextBox> GetTextBoxes (int page) = 0;
+	};
+}
+}
+
+Q_DECLARE_INTERFACE (LeechCraft::Monocle::IHaveTextBoxes,
+		"org.LeechCraft.Monocle.IHaveTextBoxes/1.0")
@@ -0,0 +1,86 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <QImage>
+
+class QRect;
+
+template<typename>
+class QFuture;
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	/** @brief Interface for documents supporting rendering page regions.
+	 *
+	 * This interface should be implemented by IDocument objects that
+	 * can efficiently render only a part of a page. It is used when
+	 * the page is shown at a high zoom level, so that only the
+	 * visible parts of the page are rendered instead of allocating an
+	 * image for the whole page.
+	 *
+	 * @sa IDocument
+	 */
+	class ISupportRegionRendering
+	{
+	public:
+		virtual ~ISupportRegionRendering () {}
+
+		/** @brief Renders the given region of the given \em page.
+		 *
+		 * This function should return an image with the \em rect part
+		 * of the \em page rendered at the given \em xScale and
+		 * \em yScale. The \em rect is in the coordinates of the page
+		 * scaled by \em xScale and \em yScale, that is, the returned
+		 * image should be equal to the \em rect part of the image
+		 * returned by the IDocument::RenderPage() method called with
+		 * the same \em page, \em xScale and \em yScale. Thus the
+		 * size of the returned image should be equal to the size of
+		 * the \em rect.
+		 *
+		 * @param[in] page The index of the page to render.
+		 * @param[in] xScale The scale of the <em>x</em> axis.
+		 * @param[in] yScale The scale of the <em>y</em> axis.
+		 * @param[in] rect The region of the scaled page to render.
+		 * @return The rendering of the given region of the page.
+		 *
+		 * @sa IDocument::RenderPage()
+		 */
+		virtual QFuture<QImage> RenderPageRegion (int page,
+				double xScale, double yScale, const QRect& rect) = 0;
+	};
+}
+}
+
+Q_DECLARE_INTERFACE (LeechCraft::Monocle::ISupportRegionRendering,
+		"org.LeechCraft.Monocle.ISupportRegionRendering/1.0")
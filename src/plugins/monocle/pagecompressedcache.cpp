@@ -0,0 +1,239 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "pagecompressedcache.h"
+#include <algorithm>
+#include <cstring>
+#include <QtConcurrentRun>
+#include <QtDebug>
+#include <util/threads/futures.h>
+#include "xmlsettingsmanager.h"
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	bool operator== (const PageKey& k1, const PageKey& k2)
+	{
+		return k1.Doc_ == k2.Doc_ &&
+				k1.Page_ == k2.Page_ &&
+				k1.XScale_ == k2.XScale_ &&
+				k1.YScale_ == k2.YScale_;
+	}
+
+	uint qHash (const PageKey& key)
+	{
+		return ::qHash (key.Doc_) ^
+				::qHash (key.Page_ << 16) ^
+				::qHash ((key.XScale_ << 8) + key.YScale_);
+	}
+
+	namespace
+	{
+		const double ScalePrecision = 1000;
+
+		// Speed matters way more than the ratio here.
+		const int CompressionLevel = 1;
+	}
+
+	PageCompressedCache::PageCompressedCache (QObject *parent)
+	: QObject { parent }
+	{
+		XmlSettingsManager::Instance ().RegisterObject ("CompressedCacheSize",
+				this, "handleCacheSizeChanged");
+		handleCacheSizeChanged ();
+	}
+
+	PageKey PageCompressedCache::MakeKey (QObject *doc, int page, double xScale, double yScale)
+	{
+		return
+		{
+			doc,
+			page,
+			qRound (xScale * ScalePrecision),
+			qRound (yScale * ScalePrecision)
+		};
+	}
+
+	bool PageCompressedCache::IsEnabled () const
+	{
+		return Cache_.maxCost () > 0;
+	}
+
+	bool PageCompressedCache::Contains (const PageKey& key) const
+	{
+		return Cache_.contains (key) || InFlight_.contains (key);
+	}
+
+	void PageCompressedCache::Insert (const PageKey& key, const QImage& image)
+	{
+		if (!IsEnabled () ||
+				image.isNull () ||
+				Cache_.contains (key) ||
+				Pending_.contains (key))
+			return;
+
+		WatchDoc (key.Doc_);
+
+		Pending_ << key;
+
+		Util::Sequence (this,
+				QtConcurrent::run ([image]
+					{
+						return Entry
+						{
+							qCompress (image.constBits (), image.byteCount (), CompressionLevel),
+							image.size (),
+							image.format (),
+							image.bytesPerLine ()
+						};
+					})) >>
+				[this, key] (const Entry& entry)
+				{
+					if (!Pending_.remove (key))
+						return;
+
+					if (!Cache_.insert (key, new Entry (entry), entry.Data_.size ()))
+						qWarning () << Q_FUNC_INFO
+								<< "page doesn't fit into the cache:"
+								<< entry.Data_.size ()
+								<< Cache_.maxCost ();
+				};
+	}
+
+	void PageCompressedCache::Insert (const PageKey& key, const QFuture<QImage>& future)
+	{
+		if (!IsEnabled () || Cache_.contains (key))
+			return;
+
+		WatchDoc (key.Doc_);
+
+		InFlight_ [key] = future;
+		Util::Sequence (this, future) >>
+				[this, key, future] (const QImage& img)
+				{
+					// The page might have been removed or rendered anew.
+					if (InFlight_.value (key) != future)
+						return;
+
+					InFlight_.remove (key);
+					Insert (key, img);
+				};
+	}
+
+	QFuture<QImage> PageCompressedCache::Get (const PageKey& key) const
+	{
+		const auto inFlight = InFlight_.find (key);
+		if (inFlight != InFlight_.end ())
+			return *inFlight;
+
+		const auto entryPtr = Cache_.object (key);
+		if (!entryPtr)
+			return Util::MakeReadyFuture (QImage {});
+
+		return QtConcurrent::run ([entry = *entryPtr]
+				{
+					const auto& data = qUncompress (entry.Data_);
+					if (data.size () != entry.BytesPerLine_ * entry.Size_.height ())
+					{
+						qWarning () << Q_FUNC_INFO
+								<< "unexpected data size"
+								<< data.size ()
+								<< entry.Size_;
+						return QImage {};
+					}
+
+					QImage image { entry.Size_, entry.Format_ };
+					for (int y = 0; y < entry.Size_.height (); ++y)
+						std::memcpy (image.scanLine (y),
+								data.constData () + y * entry.BytesPerLine_,
+								std::min (entry.BytesPerLine_, image.bytesPerLine ()));
+					return image;
+				});
+	}
+
+	void PageCompressedCache::RemovePage (QObject *doc, int page)
+	{
+		for (const auto& key : Cache_.keys ())
+			if (key.Doc_ == doc && key.Page_ == page)
+				Cache_.remove (key);
+
+		for (auto i = InFlight_.begin (); i != InFlight_.end (); )
+			if (i.key ().Doc_ == doc && i.key ().Page_ == page)
+				i = InFlight_.erase (i);
+			else
+				++i;
+
+		for (auto i = Pending_.begin (); i != Pending_.end (); )
+			if (i->Doc_ == doc && i->Page_ == page)
+				i = Pending_.erase (i);
+			else
+				++i;
+	}
+
+	void PageCompressedCache::WatchDoc (QObject *doc)
+	{
+		if (KnownDocs_.contains (doc))
+			return;
+
+		KnownDocs_ << doc;
+		connect (doc,
+				SIGNAL (destroyed (QObject*)),
+				this,
+				SLOT (handleDocDestroyed (QObject*)));
+	}
+
+	void PageCompressedCache::handleDocDestroyed (QObject *doc)
+	{
+		KnownDocs_.remove (doc);
+
+		for (const auto& key : Cache_.keys ())
+			if (key.Doc_ == doc)
+				Cache_.remove (key);
+
+		for (auto i = InFlight_.begin (); i != InFlight_.end (); )
+			if (i.key ().Doc_ == doc)
+				i = InFlight_.erase (i);
+			else
+				++i;
+
+		for (auto i = Pending_.begin (); i != Pending_.end (); )
+			if (i->Doc_ == doc)
+				i = Pending_.erase (i);
+			else
+				++i;
+	}
+
+	void PageCompressedCache::handleCacheSizeChanged ()
+	{
+		const auto mibs = XmlSettingsManager::Instance ().property ("CompressedCacheSize").toInt ();
+		Cache_.setMaxCost (mibs * 1024 * 1024);
+	}
+}
+}
@@ -0,0 +1,124 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QSet>
+#include <QImage>
+#include <QFuture>
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	struct PageKey
+	{
+		QObject *Doc_;
+		int Page_;
+		int XScale_;
+		int YScale_;
+	};
+
+	bool operator== (const PageKey&, const PageKey&);
+	uint qHash (const PageKey&);
+
+	/** @brief Keeps compressed renderings of pages under a global budget.
+	 *
+	 * This is the second tier of the rendered pages storage: the pages
+	 * evicted from the pixmap cache and the prefetched pages are kept
+	 * here compressed, so that displaying them again only requires
+	 * decompressing instead of rendering.
+	 *
+	 * The cache is shared by all the opened documents, and its total
+	 * size is controlled by the CompressedCacheSize setting.
+	 */
+	class PageCompressedCache : public QObject
+	{
+		Q_OBJECT
+	public:
+		struct Entry
+		{
+			QByteArray Data_;
+			QSize Size_;
+			QImage::Format Format_;
+			int BytesPerLine_;
+		};
+	private:
+		QCache<PageKey, Entry> Cache_;
+		QSet<PageKey> Pending_;
+		QHash<PageKey, QFuture<QImage>> InFlight_;
+		QSet<QObject*> KnownDocs_;
+	public:
+		PageCompressedCache (QObject* = nullptr);
+
+		static PageKey MakeKey (QObject*, int page, double xScale, double yScale);
+
+		/** @brief Returns whether the cache is allowed to keep anything.
+		 *
+		 * The CompressedCacheSize setting may be zero.
+		 */
+		bool IsEnabled () const;
+
+		/** @brief Returns whether the page is stored or being rendered.
+		 */
+		bool Contains (const PageKey&) const;
+
+		/** @brief Compresses and stores the \em image in background.
+		 */
+		void Insert (const PageKey&, const QImage& image);
+
+		/** @brief Stores the page once its rendering is finished.
+		 *
+		 * Until then, Get() returns the \em future, so that the page
+		 * isn't rendered once more by whoever needs it meanwhile.
+		 */
+		void Insert (const PageKey&, const QFuture<QImage>& future);
+
+		/** @brief Decompresses the page in background.
+		 *
+		 * If the page is still being rendered, the future of the
+		 * rendering is returned instead. A null image is returned if
+		 * there is no such page in the cache.
+		 */
+		QFuture<QImage> Get (const PageKey&) const;
+
+		/** @brief Drops all the renderings of the given page.
+		 */
+		void RemovePage (QObject*, int page);
+	private:
+		void WatchDoc (QObject*);
+	private slots:
+		void handleDocDestroyed (QObject*);
+		void handleCacheSizeChanged ();
+	};
+}
+}
@@ -29,6 +29,7 @@
 
 #include "pagegraphicsitem.h"
 #include <limits>
+#include <algorithm>
 #include <cmath>
 #include <QtDebug>
 #include <QtConcurrentRun>
@@ -39,11 +40,15 @@
 #include <QGraphicsScene>
 #include <QGraphicsView>
 #include <QMenu>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
 #include <QWidgetAction>
 #include <interfaces/core/iiconthememanager.h>
 #include <util/threads/futures.h>
+#include "interfaces/monocle/isupportregionrendering.h"
 #include "core.h"
 #include "pixmapcachemanager.h"
+#include "pagecompressedcache.h"
 #include "arbitraryrotationwidget.h"
 #include "pageslayoutmanager.h"
 
@@ -54,8 +59,10 @@ namespace Monocle
 	PageGraphicsItem::PageGraphicsItem (IDocument_ptr doc, int page, QGraphicsItem *parent)
 	: QGraphicsPixmapItem (parent)
 	, Doc_ (doc)
+	, RegionRenderer_ (qobject_cast<ISupportRegionRendering*> (doc->GetQObject ()))
 	, PageNum_ (page)
 	{
+		setFlag (ItemUsesExtendedStyleOption);
 		setTransformationMode (Qt::SmoothTransformation);
 		setShapeMode (QGraphicsPixmapItem::BoundingRectShape);
 		setPixmap (QPixmap (Doc_->GetPageSize (page)));
@@ -72,6 +79,11 @@ namespace Monocle
 		LayoutManager_ = manager;
 	}
 
+	void PageGraphicsItem::SetRenderPriority (RenderPriority priority)
+	{
+		Priority_ = priority;
+	}
+
 	void PageGraphicsItem::SetReleaseHandler (std::function<void (int, QPointF)> handler)
 	{
 		ReleaseHandler_ = handler;
@@ -138,37 +150,97 @@ namespace Monocle
 
 	void PageGraphicsItem::ClearPixmap ()
 	{
+		if (PixmapXScale_ > 0 && PixmapYScale_ > 0)
+		{
+			const auto& key = PageCompressedCache::MakeKey (Doc_->GetQObject (),
+					PageNum_, PixmapXScale_, PixmapYScale_);
+			Core::Instance ().GetPageCompressedCache ()->Insert (key, pixmap ().toImage ());
+		}
+
 		setPixmap (QPixmap { QSize { 1, 1 } });
+		PixmapXScale_ = PixmapYScale_ = 0;
 
 		Invalid_ = true;
 	}
 
 	void PageGraphicsItem::UpdatePixmap ()
 	{
+		Core::Instance ().GetTileCache ()->RemovePage (Doc_->GetQObject (), PageNum_);
+		Core::Instance ().GetPageCompressedCache ()->RemovePage (Doc_->GetQObject (), PageNum_);
+		PendingTiles_.clear ();
+
 		Invalid_ = true;
 		if (IsDisplayed ())
 			update ();
 	}
 
+	namespace
+	{
+		/** The preview of a tiled page is rendered so that its larger
+		 * side is no more than this.
+		 */
+		const qreal TiledPreviewSize = 1024;
+	}
+
 	void PageGraphicsItem::paint (QPainter *painter,
 			const QStyleOptionGraphicsItem *option, QWidget *w)
 	{
+		if (IsTiled ())
+		{
+			PaintTiled (painter, option);
+			Core::Instance ().GetPixmapCacheManager ()->PixmapPainted (this);
+			return;
+		}
+
 		if (Invalid_ && IsDisplayed ())
 		{
 			Invalid_ = false;
 
 			setPixmap (GetEmptyPixmap (true));
-
-			Util::Sequence (this, Doc_->RenderPage (PageNum_, XScale_, YScale_)) >>
+			PixmapXScale_ = PixmapYScale_ = 0;
+
+			// Prefetched or evicted pages are already rendered at this
+			// scale, so just decompress them.
+			const auto compressed = Core::Instance ().GetPageCompressedCache ();
+			const auto& key = PageCompressedCache::MakeKey (Doc_->GetQObject (), PageNum_, XScale_, YScale_);
+			const auto& future = compressed->Contains (key) ?
+					compressed->Get (key) :
+					Core::Instance ().GetRenderScheduler ()->RenderPage (Doc_,
+							PageNum_, XScale_, YScale_, GetRenderContext ());
+			Util::Sequence (this, future) >>
 					[&, prevXScale = XScale_, prevYScale = YScale_] (const QImage& img)
 					{
+						const bool scaleChanged =
+								std::abs (prevXScale - XScale_) > std::numeric_limits<double>::epsilon () * XScale_ ||
+								std::abs (prevYScale - YScale_) > std::numeric_limits<double>::epsilon () * YScale_;
+
+						// The request has been dropped by the scheduler, or
+						// the compressed page has been evicted meanwhile.
+						if (img.isNull ())
+						{
+							if (!scaleChanged)
+							{
+								Invalid_ = true;
+								if (IsDisplayed ())
+									update ();
+							}
+							return;
+						}
+
 						setPixmap (QPixmap::fromImage (img));
 
-						if (std::abs (prevXScale - XScale_) > std::numeric_limits<double>::epsilon () * XScale_ ||
-							std::abs (prevYScale - YScale_) > std::numeric_limits<double>::epsilon () * YScale_)
-							UpdatePixmap ();
+						if (scaleChanged)
+						{
+							Invalid_ = true;
+							if (IsDisplayed ())
+								update ();
+						}
 						else
+						{
+							PixmapXScale_ = prevXScale;
+							PixmapYScale_ = prevYScale;
 							Core::Instance ().GetPixmapCacheManager ()->PixmapChanged (this);
+						}
 					};
 		}
 
@@ -238,6 +310,117 @@ namespace Monocle
 		return px;
 	}
 
+	RenderScheduler::Context PageGraphicsItem::GetRenderContext ()
+	{
+		return { this, Priority_, [this] { return IsDisplayed (); } };
+	}
+
+	bool PageGraphicsItem::IsTiled () const
+	{
+		if (!RegionRenderer_)
+			return false;
+
+		return TileCache::ShouldTile (boundingRect ().size ());
+	}
+
+	void PageGraphicsItem::PaintTiled (QPainter *painter, const QStyleOptionGraphicsItem *option)
+	{
+		const auto& bounding = boundingRect ();
+
+		if (Invalid_ && IsDisplayed ())
+		{
+			Invalid_ = false;
+
+			setPixmap ({});
+			PixmapXScale_ = PixmapYScale_ = 0;
+
+			const auto& pageSize = Doc_->GetPageSize (PageNum_);
+			const auto previewScale = std::min (TiledPreviewSize / std::max (pageSize.width (), pageSize.height ()),
+					std::min (XScale_, YScale_));
+			const auto scheduler = Core::Instance ().GetRenderScheduler ();
+			Util::Sequence (this, scheduler->RenderPage (Doc_, PageNum_, previewScale, previewScale, GetRenderContext ())) >>
+					[this] (const QImage& img)
+					{
+						if (img.isNull ())
+						{
+							Invalid_ = true;
+							return;
+						}
+
+						setPixmap (QPixmap::fromImage (img));
+						Core::Instance ().GetPixmapCacheManager ()->PixmapChanged (this);
+						update ();
+					};
+		}
+
+		const auto& exposed = option->exposedRect.intersected (bounding);
+		if (exposed.isEmpty ())
+			return;
+
+		painter->setRenderHint (QPainter::SmoothPixmapTransform);
+		painter->fillRect (exposed, Qt::white);
+
+		const auto& preview = pixmap ();
+		if (preview.width () > 1 && preview.height () > 1)
+			painter->drawPixmap (bounding, preview, preview.rect ());
+
+		const auto tileCache = Core::Instance ().GetTileCache ();
+		const auto docObj = Doc_->GetQObject ();
+
+		const auto& pageRect = bounding.translated (-offset ()).toAlignedRect ();
+		const auto& exposedPage = exposed.translated (-offset ()).toAlignedRect ().intersected (pageRect);
+
+		for (const auto& scaled : tileCache->GetOtherScales (docObj,
+				PageNum_, XScale_, YScale_, MapToDoc (exposedPage)))
+			painter->drawPixmap (MapFromDoc (scaled.DocRect_).translated (offset ()),
+					scaled.Pixmap_, scaled.Pixmap_.rect ());
+
+		const auto tileSize = TileCache::TileSize;
+		for (int ty = exposedPage.top () / tileSize; ty <= exposedPage.bottom () / tileSize; ++ty)
+			for (int tx = exposedPage.left () / tileSize; tx <= exposedPage.right () / tileSize; ++tx)
+			{
+				const auto& tileRect = QRect { tx * tileSize, ty * tileSize, tileSize, tileSize }
+						.intersected (pageRect);
+				if (tileRect.isEmpty ())
+					continue;
+
+				const auto& key = TileCache::MakeKey (docObj, PageNum_, XScale_, YScale_, { tx, ty });
+				const auto& px = tileCache->Get (key);
+				if (px.isNull ())
+					RequestTile (key, tileRect);
+				else
+					painter->drawPixmap (tileRect.topLeft () + offset (), px);
+			}
+	}
+
+	void PageGraphicsItem::RequestTile (const TileKey& key, const QRect& tileRect)
+	{
+		if (PendingTiles_.contains (key))
+			return;
+
+		PendingTiles_ << key;
+
+		auto ctx = GetRenderContext ();
+		ctx.IsWanted_ = [this, key]
+				{
+					return key == TileCache::MakeKey (key.Doc_, PageNum_, XScale_, YScale_, key.Tile_) &&
+							IsDisplayed ();
+				};
+
+		const auto scheduler = Core::Instance ().GetRenderScheduler ();
+		Util::Sequence (this, scheduler->RenderPageRegion (Doc_, PageNum_, XScale_, YScale_, tileRect, ctx)) >>
+				[this, key, tileRect] (const QImage& img)
+				{
+					if (!PendingTiles_.remove (key))
+						return;
+
+					Core::Instance ().GetTileCache ()->Insert (key, QPixmap::fromImage (img));
+
+					if (key == TileCache::MakeKey (key.Doc_, PageNum_, XScale_, YScale_, key.Tile_))
+						update (QRectF { tileRect }.translated (offset ()));
+				};
+	}
+
 	bool PageGraphicsItem::IsDisplayed () const
 	{
 		const auto& thisMapped = mapToScene (boundingRect ()).boundingRect ();
@@ -33,7 +33,10 @@
 #include <memory>
 #include <QGraphicsPixmapItem>
 #include <QPointer>
+#include <QSet>
 #include "interfaces/monocle/idocument.h"
+#include "tilecache.h"
+#include "renderscheduler.h"
 
 template<typename T>
 class QFutureWatcher;
@@ -44,6 +47,7 @@ namespace Monocle
 {
 	class PagesLayoutManager;
 	class ArbitraryRotationWidget;
+	class ISupportRegionRendering;
 
 	class PageGraphicsItem : public QObject
 						   , public QGraphicsPixmapItem
@@ -51,6 +55,7 @@ namespace Monocle
 		Q_OBJECT
 
 		IDocument_ptr Doc_;
+		ISupportRegionRendering * const RegionRenderer_;
 		const int PageNum_;
 
 		qreal XScale_ = 1;
@@ -58,6 +63,16 @@ namespace Monocle
 
 		bool Invalid_ = true;
 
+		/** The scales the current pixmap has been rendered at, or zero
+		 * if it isn't a rendering of the page.
+		 */
+		qreal PixmapXScale_ = 0;
+		qreal PixmapYScale_ = 0;
+
+		QSet<TileKey> PendingTiles_;
+
+		RenderPriority Priority_ = RenderPriority::Visible;
+
 		std::function<void (int, QPointF)> ReleaseHandler_;
 
 		PagesLayoutManager *LayoutManager_ = nullptr;
@@ -78,6 +93,8 @@ namespace Monocle
 
 		void SetLayoutManager (PagesLayoutManager*);
 
+		void SetRenderPriority (RenderPriority);
+
 		void SetReleaseHandler (std::function<void (int, QPointF)>);
 
 		void SetScale (double, double);
@@ -103,6 +120,12 @@ namespace Monocle
 		void contextMenuEvent (QGraphicsSceneContextMenuEvent*);
 	private:
 		QPixmap GetEmptyPixmap (bool fill) const;
+
+		RenderScheduler::Context GetRenderContext ();
+
+		bool IsTiled () const;
+		void PaintTiled (QPainter*, const QStyleOptionGraphicsItem*);
+		void RequestTile (const TileKey&, const QRect&);
 	private slots:
 		void rotateCCW ();
 		void rotateCW ();
@@ -0,0 +1,133 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "pageprefetcher.h"
+#include <algorithm>
+#include <QtDebug>
+#include "core.h"
+#include "pagecompressedcache.h"
+#include "renderscheduler.h"
+#include "tilecache.h"
+#include "xmlsettingsmanager.h"
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	PagePrefetcher::PagePrefetcher (QObject *parent)
+	: QObject { parent }
+	{
+	}
+
+	void PagePrefetcher::SetDocument (const IDocument_ptr& doc)
+	{
+		Core::Instance ().GetRenderScheduler ()->Cancel (this);
+
+		Doc_ = doc;
+		CurrentPage_ = -1;
+		Direction_ = 1;
+	}
+
+	namespace
+	{
+		int GetScreensAhead ()
+		{
+			return XmlSettingsManager::Instance ().property ("PrefetchScreens").toInt ();
+		}
+	}
+
+	void PagePrefetcher::HandleCurrentPage (int page, int pagesPerScreen, const ScaleGetter_f& scaleGetter)
+	{
+		if (!Doc_ || page < 0)
+			return;
+
+		pagesPerScreen = std::max (pagesPerScreen, 1);
+		if (page != CurrentPage_ && CurrentPage_ >= 0)
+			Direction_ = page > CurrentPage_ ? 1 : -1;
+
+		CurrentPage_ = page;
+		PagesPerScreen_ = pagesPerScreen;
+		ScaleGetter_ = scaleGetter;
+
+		const auto screensAhead = GetScreensAhead ();
+		if (screensAhead <= 0 ||
+				!Core::Instance ().GetPageCompressedCache ()->IsEnabled ())
+			return;
+
+		// Nearest pages go last: the scheduler dispatches the queued
+		// requests on the next event loop iteration, the most recent
+		// ones first.
+		for (int i = screensAhead * pagesPerScreen; i > 0; --i)
+			Prefetch (Direction_ > 0 ?
+					page + pagesPerScreen - 1 + i :
+					page - i);
+		for (int i = pagesPerScreen; i > 0; --i)
+			Prefetch (Direction_ > 0 ?
+					page - i :
+					page + pagesPerScreen - 1 + i);
+	}
+
+	bool PagePrefetcher::IsWanted (int page) const
+	{
+		const auto aheadCount = GetScreensAhead () * PagesPerScreen_;
+		const auto behindCount = PagesPerScreen_;
+
+		const auto first = CurrentPage_;
+		const auto last = CurrentPage_ + PagesPerScreen_ - 1;
+		return Direction_ > 0 ?
+				page >= first - behindCount && page <= last + aheadCount :
+				page >= first - aheadCount && page <= last + behindCount;
+	}
+
+	void PagePrefetcher::Prefetch (int page)
+	{
+		if (page < 0 || page >= Doc_->GetNumPages ())
+			return;
+
+		const auto scale = ScaleGetter_ (page);
+
+		const QSizeF size { Doc_->GetPageSize (page) };
+		if (TileCache::ShouldTile (size * scale))
+			return;
+
+		const auto cache = Core::Instance ().GetPageCompressedCache ();
+		const auto& key = PageCompressedCache::MakeKey (Doc_->GetQObject (), page, scale, scale);
+		if (cache->Contains (key))
+			return;
+
+		const RenderScheduler::Context ctx
+		{
+			this,
+			RenderPriority::Nearby,
+			[this, page] { return IsWanted (page); }
+		};
+		cache->Insert (key, Core::Instance ().GetRenderScheduler ()->RenderPage (Doc_, page, scale, scale, ctx));
+	}
+}
+}
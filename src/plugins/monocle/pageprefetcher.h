@@ -0,0 +1,82 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <QObject>
+#include "interfaces/monocle/idocument.h"
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	/** @brief Renders the pages the user is likely to see next.
+	 *
+	 * The prefetcher tracks the direction in which the user moves
+	 * through the document and renders several screens of pages ahead
+	 * and one screen behind the current one. The results are stored in
+	 * the PageCompressedCache, so they cost little memory until they
+	 * are actually displayed.
+	 *
+	 * The number of screens prefetched ahead is controlled by the
+	 * PrefetchScreens setting.
+	 */
+	class PagePrefetcher : public QObject
+	{
+		Q_OBJECT
+	public:
+		using ScaleGetter_f = std::function<double (int)>;
+	private:
+		IDocument_ptr Doc_;
+
+		int CurrentPage_ = -1;
+		int PagesPerScreen_ = 1;
+		int Direction_ = 1;
+		ScaleGetter_f ScaleGetter_;
+	public:
+		PagePrefetcher (QObject* = nullptr);
+
+		void SetDocument (const IDocument_ptr&);
+
+		/** @brief Updates the current page and prefetches around it.
+		 *
+		 * @param[in] page The first page of the current screen.
+		 * @param[in] pagesPerScreen The number of pages shown at once,
+		 * like the one returned by PagesLayoutManager::GetLayoutModeCount().
+		 * @param[in] scaleGetter The function returning the scale the
+		 * given page would be displayed at.
+		 */
+		void HandleCurrentPage (int page, int pagesPerScreen, const ScaleGetter_f& scaleGetter);
+	private:
+		bool IsWanted (int page) const;
+		void Prefetch (int page);
+	};
+}
+}
@@ -0,0 +1,168 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "pagesexporter.h"
+#include <algorithm>
+#include <QThread>
+#include <QTimer>
+#include <QtDebug>
+#include <util/threads/futures.h>
+#include "core.h"
+#include "renderscheduler.h"
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	PagesExporter::PagesExporter (const IDocument_ptr& doc, const QList<int>& pages,
+			const ScaleGetter_f& scaleGetter, QObject *parent)
+	: QObject { parent }
+	, Doc_ { doc }
+	, Pages_ { pages }
+	, ScaleGetter_ { scaleGetter }
+	, Window_ { std::max (QThread::idealThreadCount (), 2) }
+	{
+	}
+
+	void PagesExporter::StartRendering (const ImageSink_f& sink)
+	{
+		ImageSink_ = sink;
+
+		if (Pages_.isEmpty ())
+			Finish (true);
+		else
+			Fill ();
+	}
+
+	void PagesExporter::StartPainting (const PaintSink_f& sink)
+	{
+		PaintSink_ = sink;
+
+		QTimer::singleShot (0,
+				this,
+				SLOT (paintNext ()));
+	}
+
+	void PagesExporter::Fill ()
+	{
+		const auto scheduler = Core::Instance ().GetRenderScheduler ();
+		while (!Done_ &&
+				NextRequest_ < Pages_.size () &&
+				InFlight_ + Ready_.size () + SinkBusy_ < Window_)
+		{
+			const auto idx = NextRequest_++;
+			const auto page = Pages_.at (idx);
+			const auto scale = ScaleGetter_ (page);
+
+			++InFlight_;
+
+			const RenderScheduler::Context ctx { this, RenderPriority::Nearby, {} };
+			Util::Sequence (this, scheduler->RenderPage (Doc_, page, scale, scale, ctx)) >>
+					[this, idx] (const QImage& img)
+					{
+						--InFlight_;
+						if (Done_)
+							return;
+
+						Ready_ [idx] = img;
+						Deliver ();
+					};
+		}
+	}
+
+	void PagesExporter::Deliver ()
+	{
+		if (Done_ || SinkBusy_ || !Ready_.contains (NextDeliver_))
+		{
+			Fill ();
+			return;
+		}
+
+		const auto& img = Ready_.take (NextDeliver_);
+		if (img.isNull ())
+			qWarning () << Q_FUNC_INFO
+					<< "unable to render page"
+					<< Pages_.at (NextDeliver_);
+
+		SinkBusy_ = true;
+		Util::Sequence (this, ImageSink_ (Pages_.at (NextDeliver_), img)) >>
+				[this]
+				{
+					SinkBusy_ = false;
+					if (Done_)
+						return;
+
+					emit progress (++NextDeliver_, Pages_.size ());
+
+					if (NextDeliver_ == Pages_.size ())
+						Finish (true);
+					else
+						Deliver ();
+				};
+
+		Fill ();
+	}
+
+	void PagesExporter::Finish (bool ok)
+	{
+		if (Done_)
+			return;
+
+		Done_ = true;
+		Ready_.clear ();
+		Core::Instance ().GetRenderScheduler ()->Cancel (this);
+
+		emit finished (ok);
+	}
+
+	void PagesExporter::cancel ()
+	{
+		Finish (false);
+	}
+
+	void PagesExporter::paintNext ()
+	{
+		if (Done_)
+			return;
+
+		if (NextDeliver_ >= Pages_.size ())
+		{
+			Finish (true);
+			return;
+		}
+
+		PaintSink_ (Pages_.at (NextDeliver_));
+		emit progress (++NextDeliver_, Pages_.size ());
+
+		QTimer::singleShot (0,
+				this,
+				SLOT (paintNext ()));
+	}
+}
+}
@@ -0,0 +1,104 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <QObject>
+#include <QMap>
+#include <QImage>
+#include <QFuture>
+#include "interfaces/monocle/idocument.h"
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	/** @brief Feeds the pages of a document to a printer or a file.
+	 *
+	 * In the rendering mode, up to a fixed number of pages are rendered
+	 * in parallel on worker threads (via the RenderScheduler) while the
+	 * already rendered ones are passed to the image sink in the order
+	 * of pages. This bounds the memory used by the rendered pages.
+	 *
+	 * In the painting mode, which is used for the documents supporting
+	 * ISupportPainting, the pages are painted one by one, returning to
+	 * the event loop between the pages.
+	 *
+	 * In both modes the progress() signal is emitted after each page,
+	 * and the export can be canceled at any moment. The finished()
+	 * signal is emitted exactly once.
+	 */
+	class PagesExporter : public QObject
+	{
+		Q_OBJECT
+	public:
+		using ScaleGetter_f = std::function<double (int)>;
+
+		/** The image sink is called on the GUI thread. The page is
+		 * considered to be done when the returned future finishes.
+		 */
+		using ImageSink_f = std::function<QFuture<void> (int, const QImage&)>;
+		using PaintSink_f = std::function<void (int)>;
+	private:
+		const IDocument_ptr Doc_;
+		const QList<int> Pages_;
+		const ScaleGetter_f ScaleGetter_;
+		const int Window_;
+
+		ImageSink_f ImageSink_;
+		PaintSink_f PaintSink_;
+
+		QMap<int, QImage> Ready_;
+		int NextRequest_ = 0;
+		int NextDeliver_ = 0;
+		int InFlight_ = 0;
+		bool SinkBusy_ = false;
+
+		bool Done_ = false;
+	public:
+		PagesExporter (const IDocument_ptr&, const QList<int>& pages,
+				const ScaleGetter_f&, QObject* = nullptr);
+
+		void StartRendering (const ImageSink_f&);
+		void StartPainting (const PaintSink_f&);
+	private:
+		void Fill ();
+		void Deliver ();
+		void Finish (bool);
+	public slots:
+		void cancel ();
+	private slots:
+		void paintNext ();
+	signals:
+		void progress (int done, int total);
+		void finished (bool ok);
+	};
+}
+}
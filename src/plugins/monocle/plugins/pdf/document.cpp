@@ -161,6 +161,41 @@ namespace PDF
 		return page->text (rect);
 	}
 
+	QList<TextBox> Document::GetTextBoxes (int pageNum)
+	{
+		// Poppler pages of the same document can't be queried for text
+		// concurrently, so a separate instance is used for that.
+		QMutexLocker locker { &TextDocMutex_ };
+		if (!TextDoc_)
+		{
+			TextDoc_.reset (Poppler::Document::load (DocURL_.toLocalFile ()));
+			if (!TextDoc_)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to load"
+						<< DocURL_;
+				return {};
+			}
+		}
+
+		std::unique_ptr<Poppler::Page> page (TextDoc_->page (pageNum));
+		if (!page)
+			return {};
+
+		QList<TextBox> result;
+		for (const auto box : page->textList ())
+		{
+			QList<QRectF> charRects;
+			const auto& text = box->text ();
+			for (int i = 0; i < text.size (); ++i)
+				charRects << box->charBoundingBox (i);
+
+			result << TextBox { text, box->boundingBox (), charRects, box->hasSpaceAfter () };
+			delete box;
+		}
+		return result;
+	}
+
 	QAbstractItemModel* Document::GetOptContentModel ()
 	{
 		return PDocument_->hasOptionalContent () ?
@@ -238,6 +273,19 @@ namespace PDF
 		page->renderToPainter (painter, 72 * xScale, 72 * yScale);
 	}
 
+	QFuture<QImage> Document::RenderPageRegion (int num, double xScale, double yScale, const QRect& rect)
+	{
+		std::shared_ptr<Poppler::Page> page (PDocument_->page (num));
+		if (!page)
+			return Util::MakeReadyFuture (QImage {});
+
+		return QtConcurrent::run ([=]
+				{
+					return page->renderToImage (72 * xScale, 72 * yScale,
+							rect.x (), rect.y (), rect.width (), rect.height ());
+				});
+	}
+
 	QMap<int, QList<QRectF>> Document::GetTextPositions (const QString& text, Qt::CaseSensitivity cs)
 	{
 		typedef QMap<int, QList<QRectF>> Result_t;
@@ -265,7 +313,7 @@ namespace PDF
 		const auto threadCount = QThread::idealThreadCount ();
 		const auto packSize = numPages / threadCount;
 		for (int i = 0; i < threadCount; ++i)
-			threads.emplace_back (worker, i * packSize, (i == threadCount - 1) ? (numPages % threadCount) : packSize);
+			threads.emplace_back (worker, i * packSize, (i == threadCount - 1) ? (numPages - i * packSize) : packSize);
 
 		for (auto& thread : threads)
 			thread.join ();
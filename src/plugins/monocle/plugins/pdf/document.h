@@ -31,16 +31,19 @@
 
 #include <memory>
 #include <QObject>
+#include <QMutex>
 #include <QUrl>
 #include <interfaces/monocle/idocument.h>
 #include <interfaces/monocle/ihavetoc.h>
 #include <interfaces/monocle/ihavetextcontent.h>
+#include <interfaces/monocle/ihavetextboxes.h>
 #include <interfaces/monocle/ihavefontinfo.h>
 #include <interfaces/monocle/isupportannotations.h>
 #include <interfaces/monocle/isupportforms.h>
 #include <interfaces/monocle/isearchabledocument.h>
 #include <interfaces/monocle/isaveabledocument.h>
 #include <interfaces/monocle/isupportpainting.h>
+#include <interfaces/monocle/isupportregionrendering.h>
 #include <interfaces/monocle/ihaveoptionalcontent.h>
 
 namespace Poppler
@@ -60,11 +63,13 @@ namespace PDF
 				   , public IDocument
 				   , public IHaveTOC
 				   , public IHaveTextContent
+				   , public IHaveTextBoxes
 				   , public IHaveOptionalContent
 				   , public IHaveFontInfo
 				   , public ISupportAnnotations
 				   , public ISupportForms
 				   , public ISupportPainting
+				   , public ISupportRegionRendering
 				   , public ISearchableDocument
 				   , public ISaveableDocument
 	{
@@ -72,11 +77,13 @@ namespace PDF
 		Q_INTERFACES (LeechCraft::Monocle::IDocument
 				LeechCraft::Monocle::IHaveTOC
 				LeechCraft::Monocle::IHaveTextContent
+				LeechCraft::Monocle::IHaveTextBoxes
 				LeechCraft::Monocle::IHaveOptionalContent
 				LeechCraft::Monocle::IHaveFontInfo
 				LeechCraft::Monocle::ISupportAnnotations
 				LeechCraft::Monocle::ISupportForms
 				LeechCraft::Monocle::ISupportPainting
+				LeechCraft::Monocle::ISupportRegionRendering
 				LeechCraft::Monocle::ISearchableDocument
 				LeechCraft::Monocle::ISaveableDocument)
 
@@ -85,6 +92,9 @@ namespace PDF
 		QUrl DocURL_;
 
 		QObject *Plugin_;
+
+		QMutex TextDocMutex_;
+		PDocument_ptr TextDoc_;
 	public:
 		Document (const QString&, QObject*);
 
@@ -102,6 +112,8 @@ namespace PDF
 
 		QString GetTextContent (int, const QRect&);
 
+		QList<TextBox> GetTextBoxes (int);
+
 		QAbstractItemModel* GetOptContentModel ();
 
 		IPendingFontInfoRequest* RequestFontInfos () const;
@@ -112,6 +124,8 @@ namespace PDF
 
 		void PaintPage (QPainter*, int, double, double);
 
+		QFuture<QImage> RenderPageRegion (int, double, double, const QRect&);
+
 		QMap<int, QList<QRectF>> GetTextPositions (const QString&, Qt::CaseSensitivity);
 
 		SaveQueryResult CanSave () const;
@@ -33,6 +33,10 @@
 #include <QKeyEvent>
 #include <QTimer>
 #include <util/threads/futures.h>
+#include "core.h"
+#include "renderscheduler.h"
+#include "pagecompressedcache.h"
+#include "pageprefetcher.h"
 
 namespace LeechCraft
 {
@@ -43,7 +47,10 @@ namespace Monocle
 	, PixmapLabel_ (new QLabel)
 	, Doc_ (doc)
 	, CurrentPage_ (0)
+	, Prefetcher_ (new PagePrefetcher (this))
 	{
+		Prefetcher_->SetDocument (doc);
+
 		setStyleSheet ("background-color: black;");
 
 		auto lay = new QHBoxLayout ();
@@ -69,17 +76,38 @@ namespace Monocle
 
 		CurrentPage_ = page;
 
-		const auto& pageSize = Doc_->GetPageSize (page);
+		const auto scale = GetPageScale (page);
 
-		auto scale = std::min (static_cast<double> (width ()) / pageSize.width (),
-				static_cast<double> (height ()) / pageSize.height ());
+		const auto compressed = Core::Instance ().GetPageCompressedCache ();
+		const auto& key = PageCompressedCache::MakeKey (Doc_->GetQObject (), page, scale, scale);
 
-		Util::Sequence (this, Doc_->RenderPage (page, scale, scale)) >>
+		const RenderScheduler::Context ctx
+		{
+			this,
+			RenderPriority::Visible,
+			[this, page] { return CurrentPage_ == page; }
+		};
+		const auto& future = compressed->Contains (key) ?
+				compressed->Get (key) :
+				Core::Instance ().GetRenderScheduler ()->RenderPage (Doc_, page, scale, scale, ctx);
+		Util::Sequence (this, future) >>
 				[&] (const QImage& img)
 				{
+					if (img.isNull ())
+						return;
+
 					PixmapLabel_->setFixedSize (img.size ());
 					PixmapLabel_->setPixmap (QPixmap::fromImage (img));
 				};
+
+		Prefetcher_->HandleCurrentPage (page, 1, [this] (int num) { return GetPageScale (num); });
+	}
+
+	double PresenterWidget::GetPageScale (int page) const
+	{
+		const auto& pageSize = Doc_->GetPageSize (page);
+		return std::min (static_cast<double> (width ()) / pageSize.width (),
+				static_cast<double> (height ()) / pageSize.height ());
 	}
 
 	void PresenterWidget::closeEvent (QCloseEvent *event)
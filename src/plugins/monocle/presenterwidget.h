@@ -38,6 +38,8 @@ namespace LeechCraft
 {
 namespace Monocle
 {
+	class PagePrefetcher;
+
 	class PresenterWidget : public QWidget
 	{
 		Q_OBJECT
@@ -45,10 +47,14 @@ namespace Monocle
 		QLabel *PixmapLabel_;
 		IDocument_ptr Doc_;
 		int CurrentPage_;
+
+		PagePrefetcher * const Prefetcher_;
 	public:
 		PresenterWidget (IDocument_ptr);
 
 		void NavigateTo (int);
+	private:
+		double GetPageScale (int) const;
 	protected:
 		void closeEvent (QCloseEvent*);
 		void keyPressEvent (QKeyEvent*);
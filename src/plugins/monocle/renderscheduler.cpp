@@ -0,0 +1,229 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "renderscheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <QThread>
+#include <QTimer>
+#include <QtDebug>
+#include <util/threads/futures.h>
+#include "interfaces/monocle/isupportregionrendering.h"
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	RenderScheduler::RenderScheduler (QObject *parent)
+	: QObject { parent }
+	, MaxPerBackend_ { std::max (QThread::idealThreadCount (), 1) }
+	{
+	}
+
+	QFuture<QImage> RenderScheduler::RenderPage (const IDocument_ptr& doc, int page,
+			double xScale, double yScale, const Context& ctx)
+	{
+		return Enqueue ({ doc, page, xScale, yScale, {}, Channel::Page, ctx, 0, {}, {} });
+	}
+
+	QFuture<QImage> RenderScheduler::RenderPageRegion (const IDocument_ptr& doc, int page,
+			double xScale, double yScale, const QRect& rect, const Context& ctx)
+	{
+		if (!qobject_cast<ISupportRegionRendering*> (doc->GetQObject ()))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "document doesn't support region rendering";
+			return Util::MakeReadyFuture (QImage {});
+		}
+
+		return Enqueue ({ doc, page, xScale, yScale, rect, Channel::Region, ctx, 0, {}, {} });
+	}
+
+	void RenderScheduler::Cancel (QObject *requester)
+	{
+		for (auto i = Pending_.begin (); i != Pending_.end (); )
+			if (i->Ctx_.Requester_ == requester)
+			{
+				Drop (*i);
+				i = Pending_.erase (i);
+			}
+			else
+				++i;
+
+		Stats_.QueueDepth_ = Pending_.size ();
+		emit statsChanged ();
+	}
+
+	RenderScheduler::Stats RenderScheduler::GetStats () const
+	{
+		return Stats_;
+	}
+
+	namespace
+	{
+		bool IsSameScale (double s1, double s2)
+		{
+			return std::abs (s1 - s2) <= std::numeric_limits<double>::epsilon () * std::max (s1, s2);
+		}
+
+		void UpdateAverage (double& avg, double value)
+		{
+			const auto alpha = 0.1;
+			avg = avg ? avg * (1 - alpha) + value * alpha : value;
+		}
+	}
+
+	QFuture<QImage> RenderScheduler::Enqueue (Request req)
+	{
+		const auto requester = req.Ctx_.Requester_;
+		if (!KnownRequesters_.contains (requester))
+		{
+			KnownRequesters_ << requester;
+			connect (requester,
+					SIGNAL (destroyed (QObject*)),
+					this,
+					SLOT (handleRequesterDestroyed (QObject*)));
+		}
+
+		for (auto i = Pending_.begin (); i != Pending_.end (); )
+			if (i->Ctx_.Requester_ == requester &&
+					i->Channel_ == req.Channel_ &&
+					i->Page_ == req.Page_ &&
+					(!IsSameScale (i->XScale_, req.XScale_) || !IsSameScale (i->YScale_, req.YScale_)))
+			{
+				Drop (*i);
+				i = Pending_.erase (i);
+			}
+			else
+				++i;
+
+		req.Seq_ = NextSeq_++;
+		req.Queued_.start ();
+		req.Iface_.reportStarted ();
+
+		const auto& future = req.Iface_.future ();
+		Pending_ << req;
+
+		if (!DispatchScheduled_)
+		{
+			DispatchScheduled_ = true;
+			QTimer::singleShot (0,
+					this,
+					SLOT (dispatch ()));
+		}
+
+		return future;
+	}
+
+	void RenderScheduler::Drop (Request& req)
+	{
+		const QImage img;
+		req.Iface_.reportFinished (&img);
+
+		++Stats_.Dropped_;
+	}
+
+	void RenderScheduler::Dispatch ()
+	{
+		while (true)
+		{
+			auto best = Pending_.end ();
+			for (auto i = Pending_.begin (); i != Pending_.end (); ++i)
+			{
+				if (RunningPerBackend_.value (i->Doc_->GetBackendPlugin ()) >= MaxPerBackend_)
+					continue;
+
+				if (best == Pending_.end () ||
+						i->Ctx_.Priority_ > best->Ctx_.Priority_ ||
+						(i->Ctx_.Priority_ == best->Ctx_.Priority_ && i->Seq_ > best->Seq_))
+					best = i;
+			}
+
+			if (best == Pending_.end ())
+				break;
+
+			auto req = *best;
+			Pending_.erase (best);
+
+			if (req.Ctx_.IsWanted_ && !req.Ctx_.IsWanted_ ())
+				Drop (req);
+			else
+				Start (req);
+		}
+
+		Stats_.QueueDepth_ = Pending_.size ();
+		emit statsChanged ();
+	}
+
+	void RenderScheduler::Start (const Request& req)
+	{
+		const auto backend = req.Doc_->GetBackendPlugin ();
+		++RunningPerBackend_ [backend];
+		++Stats_.Running_;
+
+		UpdateAverage (Stats_.AvgWaitMs_, req.Queued_.elapsed ());
+
+		QElapsedTimer renderTimer;
+		renderTimer.start ();
+
+		const auto& future = req.Channel_ == Channel::Page ?
+				req.Doc_->RenderPage (req.Page_, req.XScale_, req.YScale_) :
+				qobject_cast<ISupportRegionRendering*> (req.Doc_->GetQObject ())->
+						RenderPageRegion (req.Page_, req.XScale_, req.YScale_, req.Region_);
+
+		Util::Sequence (this, future) >>
+				[this, req, backend, renderTimer] (const QImage& img)
+				{
+					QFutureInterface<QImage> iface { req.Iface_ };
+					iface.reportFinished (&img);
+
+					UpdateAverage (Stats_.AvgRenderMs_, renderTimer.elapsed ());
+					++Stats_.Finished_;
+					--Stats_.Running_;
+					if (!--RunningPerBackend_ [backend])
+						RunningPerBackend_.remove (backend);
+
+					Dispatch ();
+				};
+	}
+
+	void RenderScheduler::dispatch ()
+	{
+		DispatchScheduled_ = false;
+		Dispatch ();
+	}
+
+	void RenderScheduler::handleRequesterDestroyed (QObject *requester)
+	{
+		KnownRequesters_.remove (requester);
+		Cancel (requester);
+	}
+}
+}
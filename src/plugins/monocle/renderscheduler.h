@@ -0,0 +1,167 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QRect>
+#include <QImage>
+#include <QElapsedTimer>
+#include <QFutureInterface>
+#include "interfaces/monocle/idocument.h"
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	/** @brief The priority of a render request.
+	 *
+	 * Requests with higher priorities are dispatched first.
+	 */
+	enum class RenderPriority
+	{
+		Thumbnail,
+		Nearby,
+		Visible
+	};
+
+	/** @brief Dispatches rendering requests to the document backends.
+	 *
+	 * Instead of calling IDocument::RenderPage() directly, the views
+	 * queue the requests here. The requests are started in the order
+	 * of their priorities (and the most recent first among the ones
+	 * with the same priority), and no more than a fixed number of
+	 * requests are run at once for a single backend plugin.
+	 *
+	 * The newly queued requests are dispatched on the next event loop
+	 * iteration, so the requests queued in a row are ordered among
+	 * each other as described above regardless of the free slots.
+	 *
+	 * A queued request is dropped if a request from the same requester
+	 * for the same page but at a different scale arrives, or if the
+	 * request isn't wanted anymore at the time it would be started. The
+	 * future of a dropped request is finished with a null image.
+	 *
+	 * Requests of a requester are dropped automatically when it is
+	 * destroyed.
+	 */
+	class RenderScheduler : public QObject
+	{
+		Q_OBJECT
+	public:
+		struct Context
+		{
+			QObject *Requester_;
+			RenderPriority Priority_;
+
+			/** An optional function returning whether the result is
+			 * still needed.
+			 */
+			std::function<bool ()> IsWanted_;
+		};
+
+		struct Stats
+		{
+			int QueueDepth_ = 0;
+			int Running_ = 0;
+
+			double AvgWaitMs_ = 0;
+			double AvgRenderMs_ = 0;
+
+			quint64 Finished_ = 0;
+			quint64 Dropped_ = 0;
+		};
+	private:
+		enum class Channel
+		{
+			Page,
+			Region
+		};
+
+		struct Request
+		{
+			IDocument_ptr Doc_;
+			int Page_;
+			double XScale_;
+			double YScale_;
+			QRect Region_;
+			Channel Channel_;
+			Context Ctx_;
+
+			quint64 Seq_;
+			QElapsedTimer Queued_;
+			QFutureInterface<QImage> Iface_;
+		};
+
+		QList<Request> Pending_;
+		QHash<QObject*, int> RunningPerBackend_;
+		QSet<QObject*> KnownRequesters_;
+
+		quint64 NextSeq_ = 0;
+		const int MaxPerBackend_;
+
+		bool DispatchScheduled_ = false;
+
+		Stats Stats_;
+	public:
+		RenderScheduler (QObject* = nullptr);
+
+		QFuture<QImage> RenderPage (const IDocument_ptr&, int page,
+				double xScale, double yScale, const Context&);
+
+		/** @brief Queues rendering a region of the page.
+		 *
+		 * The document should implement ISupportRegionRendering.
+		 *
+		 * @sa ISupportRegionRendering::RenderPageRegion()
+		 */
+		QFuture<QImage> RenderPageRegion (const IDocument_ptr&, int page,
+				double xScale, double yScale, const QRect&, const Context&);
+
+		/** @brief Drops all the queued requests of the \em requester.
+		 */
+		void Cancel (QObject *requester);
+
+		Stats GetStats () const;
+	private:
+		QFuture<QImage> Enqueue (Request);
+		void Drop (Request&);
+		void Dispatch ();
+		void Start (const Request&);
+	private slots:
+		void dispatch ();
+		void handleRequesterDestroyed (QObject*);
+	signals:
+		void statsChanged ();
+	};
+}
+}
@@ -63,6 +63,9 @@ namespace Monocle
 	{
 		Model_->clear ();
 		Root2Results_.clear ();
+
+		CurrentRoot_ = nullptr;
+		CurrentPosIdx_ = 0;
 	}
 
 	void SearchTabWidget::handleSearchResults (const TextSearchHandlerResults& results)
@@ -71,9 +74,22 @@ namespace Monocle
 				[] (const QList<QRectF>& list) { return list.isEmpty (); }))
 			return;
 
+		if (!CurrentRoot_ || results.SearchID_ != CurrentSearchID_)
+		{
+			CurrentSearchID_ = results.SearchID_;
+			CurrentPosIdx_ = 0;
+
+			CurrentRoot_ = new QStandardItem { results.Text_ };
+			CurrentRoot_->setEditable (false);
+			Model_->insertRow (0, CurrentRoot_);
+
+			auto rootResults = results;
+			rootResults.Positions_.clear ();
+			Root2Results_ [CurrentRoot_] = rootResults;
+		}
+
+		auto& rootResults = Root2Results_ [CurrentRoot_];
 
-		QList<QStandardItem*> pageItems;
-		int globalPosIdx = 0;
 		for (const auto& pair : Util::Stlize (results.Positions_))
 		{
 			const auto& posList = pair.second;
@@ -81,30 +97,21 @@ namespace Monocle
 				continue;
 
 			const auto pageItem = new QStandardItem { tr ("Page %1").arg (pair.first + 1) };
-			pageItem->setData (globalPosIdx, static_cast<int> (SearchModelRole::PageFirstIdx));
+			pageItem->setData (CurrentPosIdx_, static_cast<int> (SearchModelRole::PageFirstIdx));
 			pageItem->setEditable (false);
-			for (int i = 0; i < posList.size (); ++i, ++globalPosIdx)
+			for (int i = 0; i < posList.size (); ++i, ++CurrentPosIdx_)
 			{
 				const auto posItem = new QStandardItem { tr ("Occurrence %1").arg (i + 1) };
-				posItem->setData (globalPosIdx, static_cast<int> (SearchModelRole::OverallIdx));
+				posItem->setData (CurrentPosIdx_, static_cast<int> (SearchModelRole::OverallIdx));
 				posItem->setEditable (false);
 				pageItem->appendRow (posItem);
 			}
 
-			pageItems << pageItem;
+			CurrentRoot_->appendRow (pageItem);
+			rootResults.Positions_ [pair.first] = posList;
 		}
 
-		if (pageItems.isEmpty ())
-			return;
-
-		const auto searchItem = new QStandardItem { results.Text_ };
-		searchItem->appendRows (pageItems);
-		searchItem->setEditable (false);
-
-		Root2Results_ [searchItem] = results;
-
-		Model_->insertRow (0, searchItem);
-		Ui_.ResultsTree_->expand (searchItem->index ());
+		Ui_.ResultsTree_->expand (CurrentRoot_->index ());
 	}
 
 	namespace
@@ -56,6 +56,10 @@ namespace Monocle
 		TextSearchHandler * const SearchHandler_;
 
 		QMap<QStandardItem*, TextSearchHandlerResults> Root2Results_;
+
+		quint64 CurrentSearchID_ = 0;
+		QStandardItem *CurrentRoot_ = nullptr;
+		int CurrentPosIdx_ = 0;
 	public:
 		SearchTabWidget (TextSearchHandler*, QWidget* = nullptr);
 
@@ -0,0 +1,442 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "textindex.h"
+#include <algorithm>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QtConcurrentRun>
+#include <QtDebug>
+#include <util/sys/paths.h>
+#include <util/threads/futures.h>
+#include "interfaces/monocle/ihavetextboxes.h"
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	namespace
+	{
+		const quint32 IndexMagic = 0x4d544958;
+		const quint8 IndexVersion = 1;
+
+		void SetupStream (QDataStream& stream)
+		{
+			stream.setVersion (QDataStream::Qt_5_0);
+			stream.setFloatingPointPrecision (QDataStream::SinglePrecision);
+		}
+
+		QString GetIndexFileName (const QString& docPath,
+				const std::shared_ptr<std::atomic<bool>>& cancelled)
+		{
+			QFile file { docPath };
+			if (!file.open (QIODevice::ReadOnly))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to open"
+						<< docPath
+						<< file.errorString ();
+				return {};
+			}
+
+			// Hashed in chunks so that a big document doesn't delay
+			// the cancellation.
+			const qint64 chunkSize = 1024 * 1024;
+
+			QCryptographicHash hash { QCryptographicHash::Sha1 };
+			while (!file.atEnd ())
+			{
+				if (*cancelled)
+					return {};
+
+				const auto& chunk = file.read (chunkSize);
+				if (chunk.isEmpty ())
+				{
+					qWarning () << Q_FUNC_INFO
+							<< "unable to read"
+							<< docPath
+							<< file.errorString ();
+					return {};
+				}
+				hash.addData (chunk);
+			}
+
+			const auto& mtime = QFileInfo { docPath }.lastModified ().toMSecsSinceEpoch ();
+			hash.addData (QByteArray::number (mtime));
+
+			return hash.result ().toHex ();
+		}
+
+		/** Removes the least recently written indexes other than
+		 * \em keepPath until the total size of the cache fits the limit.
+		 */
+		void PruneCache (const QString& dirPath, const QString& keepPath)
+		{
+			const qint64 maxCacheSize = 256 * 1024 * 1024;
+
+			const auto& infos = QDir { dirPath }.entryInfoList (QDir::Files, QDir::Time);
+
+			qint64 totalSize = 0;
+			for (const auto& info : infos)
+				totalSize += info.size ();
+
+			for (auto i = infos.rbegin (); i != infos.rend () && totalSize > maxCacheSize; ++i)
+			{
+				if (i->absoluteFilePath () == QFileInfo { keepPath }.absoluteFilePath ())
+					continue;
+
+				if (!QFile::remove (i->absoluteFilePath ()))
+				{
+					qWarning () << Q_FUNC_INFO
+							<< "unable to remove"
+							<< i->absoluteFilePath ();
+					continue;
+				}
+
+				totalSize -= i->size ();
+			}
+		}
+
+		bool IsSameLine (const QRectF& r1, const QRectF& r2)
+		{
+			return r1.top () < r2.bottom () && r2.top () < r1.bottom ();
+		}
+
+		void WritePage (QDataStream& out, const QList<TextBox>& boxes)
+		{
+			QString text;
+			QVector<QRectF> rects;
+			for (int i = 0; i < boxes.size (); ++i)
+			{
+				const auto& box = boxes.at (i);
+
+				text += box.Text_;
+				if (box.CharRects_.size () == box.Text_.size ())
+					for (const auto& rect : box.CharRects_)
+						rects << rect;
+				else
+					for (int j = 0; j < box.Text_.size (); ++j)
+						rects << box.Rect_;
+
+				if (i == boxes.size () - 1)
+					continue;
+
+				const auto& next = boxes.at (i + 1);
+				if (box.SpaceAfter_ || !IsSameLine (box.Rect_, next.Rect_))
+				{
+					text += ' ';
+					rects << QRectF {};
+				}
+			}
+
+			out << text << static_cast<quint32> (rects.size ());
+			for (const auto& rect : rects)
+				out << static_cast<float> (rect.x ())
+						<< static_cast<float> (rect.y ())
+						<< static_cast<float> (rect.width ())
+						<< static_cast<float> (rect.height ());
+		}
+
+		bool WriteIndex (const QString& path, IHaveTextBoxes *boxesDoc, int numPages,
+				const std::shared_ptr<std::atomic<bool>>& cancelled)
+		{
+			QSaveFile file { path };
+			if (!file.open (QIODevice::WriteOnly))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to open"
+						<< path
+						<< file.errorString ();
+				return false;
+			}
+
+			QDataStream out { &file };
+			SetupStream (out);
+			out << IndexMagic
+					<< IndexVersion
+					<< static_cast<qint32> (numPages);
+
+			for (int i = 0; i < numPages; ++i)
+			{
+				if (*cancelled)
+				{
+					file.cancelWriting ();
+					return false;
+				}
+
+				WritePage (out, boxesDoc->GetTextBoxes (i));
+			}
+
+			return file.commit ();
+		}
+
+		TextIndex::Data_cptr ReadIndex (const QString& path)
+		{
+			QFile file { path };
+			if (!file.open (QIODevice::ReadOnly))
+				return {};
+
+			QDataStream in { &file };
+			SetupStream (in);
+
+			quint32 magic = 0;
+			quint8 version = 0;
+			qint32 numPages = 0;
+			in >> magic >> version >> numPages;
+			if (magic != IndexMagic || version != IndexVersion || numPages < 0)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unknown index format"
+						<< path
+						<< magic
+						<< version;
+				return {};
+			}
+
+			const auto data = std::make_shared<TextIndex::Data> ();
+			data->Path_ = path;
+			data->Texts_.reserve (numPages);
+			data->RectsOffsets_.reserve (numPages);
+			for (int i = 0; i < numPages; ++i)
+			{
+				QString text;
+				in >> text;
+				data->Texts_ << text;
+
+				data->RectsOffsets_ << file.pos ();
+
+				quint32 rectsCount = 0;
+				in >> rectsCount;
+				in.skipRawData (rectsCount * 4 * sizeof (float));
+
+				if (in.status () != QDataStream::Ok)
+				{
+					qWarning () << Q_FUNC_INFO
+							<< "truncated index"
+							<< path;
+					return {};
+				}
+			}
+
+			return data;
+		}
+
+		TextIndex::Data_cptr BuildIndex (const QString& dirPath, const QString& docPath,
+				IHaveTextBoxes *boxesDoc, int numPages,
+				const std::shared_ptr<std::atomic<bool>>& cancelled)
+		{
+			const auto& name = GetIndexFileName (docPath, cancelled);
+			if (name.isEmpty ())
+				return {};
+
+			const auto& path = dirPath + '/' + name;
+			if (QFile::exists (path))
+				if (const auto data = ReadIndex (path))
+					return data;
+
+			if (!WriteIndex (path, boxesDoc, numPages, cancelled))
+				return {};
+
+			PruneCache (dirPath, path);
+
+			return ReadIndex (path);
+		}
+
+		QVector<QRectF> ReadRects (QFile& file, qint64 offset)
+		{
+			if (!file.seek (offset))
+				return {};
+
+			QDataStream in { &file };
+			SetupStream (in);
+
+			quint32 count = 0;
+			in >> count;
+
+			// The count comes from the disk, so it shouldn't be trusted.
+			const auto rectSize = static_cast<qint64> (4 * sizeof (float));
+			const auto available = (file.size () - file.pos ()) / rectSize;
+
+			QVector<QRectF> rects;
+			rects.reserve (static_cast<int> (std::min<qint64> (count, available)));
+			for (quint32 i = 0; i < count && in.status () == QDataStream::Ok; ++i)
+			{
+				float x, y, w, h;
+				in >> x >> y >> w >> h;
+				rects << QRectF { x, y, w, h };
+			}
+			return rects;
+		}
+
+		QList<QRectF> MergeRects (const QVector<QRectF>& rects, int from, int count)
+		{
+			QList<QRectF> result;
+
+			QRectF current;
+			for (int i = from, end = std::min (from + count, rects.size ()); i < end; ++i)
+			{
+				const auto& rect = rects.at (i);
+				if (rect.isEmpty ())
+					continue;
+
+				if (current.isEmpty ())
+					current = rect;
+				else if (IsSameLine (current, rect))
+					current |= rect;
+				else
+				{
+					result << current;
+					current = rect;
+				}
+			}
+
+			if (!current.isEmpty ())
+				result << current;
+
+			return result;
+		}
+
+		void RunSearch (QFutureInterface<PageSearchResult> iface, const TextIndex::Data_cptr& data,
+				const QString& needle, Qt::CaseSensitivity cs)
+		{
+			QFile file { data->Path_ };
+			if (!file.open (QIODevice::ReadOnly))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to open"
+						<< data->Path_
+						<< file.errorString ();
+				iface.reportFinished ();
+				return;
+			}
+
+			for (int page = 0; page < data->Texts_.size () && !iface.isCanceled (); ++page)
+			{
+				const auto& text = data->Texts_.at (page);
+
+				QList<int> positions;
+				for (int pos = text.indexOf (needle, 0, cs); pos >= 0;
+						pos = text.indexOf (needle, pos + needle.size (), cs))
+					positions << pos;
+
+				if (positions.isEmpty ())
+					continue;
+
+				const auto& rects = ReadRects (file, data->RectsOffsets_.at (page));
+
+				PageSearchResult result { page, {} };
+				for (const auto pos : positions)
+				{
+					// A match spanning several lines gets a rect per line.
+					result.Rects_ += MergeRects (rects, pos, needle.size ());
+				}
+
+				if (!result.Rects_.isEmpty ())
+					iface.reportResult (result);
+			}
+
+			iface.reportFinished ();
+		}
+	}
+
+	TextIndex::TextIndex (const IDocument_ptr& doc, QObject *parent)
+	: QObject { parent }
+	, Doc_ { doc }
+	, Cancelled_ { std::make_shared<std::atomic<bool>> (false) }
+	{
+		const auto boxesDoc = qobject_cast<IHaveTextBoxes*> (doc->GetQObject ());
+		const auto& docPath = doc->GetDocURL ().toLocalFile ();
+		if (!boxesDoc || docPath.isEmpty ())
+			return;
+
+		QString dirPath;
+		try
+		{
+			dirPath = Util::GetUserDir (Util::UserDir::Cache, "monocle/textindex").absolutePath ();
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< e.what ();
+			return;
+		}
+
+		BuildFuture_ = QtConcurrent::run (BuildIndex,
+				dirPath, docPath, boxesDoc, doc->GetNumPages (), Cancelled_);
+		Util::Sequence (this, BuildFuture_) >>
+				[this] (const Data_cptr& data)
+				{
+					if (!data)
+						return;
+
+					Data_ = data;
+					emit ready ();
+				};
+	}
+
+	TextIndex::~TextIndex ()
+	{
+		// The builder uses the document, so it should finish before the
+		// document could be destroyed.
+		*Cancelled_ = true;
+		BuildFuture_.waitForFinished ();
+	}
+
+	bool TextIndex::CanIndex (const IDocument_ptr& doc)
+	{
+		return qobject_cast<IHaveTextBoxes*> (doc->GetQObject ()) &&
+				doc->GetDocURL ().isLocalFile ();
+	}
+
+	bool TextIndex::IsReady () const
+	{
+		return static_cast<bool> (Data_);
+	}
+
+	QFuture<PageSearchResult> TextIndex::Search (const QString& text, Qt::CaseSensitivity cs) const
+	{
+		QFutureInterface<PageSearchResult> iface;
+		iface.reportStarted ();
+
+		if (!Data_ || text.isEmpty ())
+		{
+			iface.reportFinished ();
+			return iface.future ();
+		}
+
+		QtConcurrent::run (RunSearch, iface, Data_, text, cs);
+		return iface.future ();
+	}
+}
+}
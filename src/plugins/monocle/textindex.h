@@ -0,0 +1,106 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <atomic>
+#include <QObject>
+#include <QVector>
+#include <QFuture>
+#include <QRectF>
+#include "interfaces/monocle/idocument.h"
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	class IHaveTextBoxes;
+
+	struct PageSearchResult
+	{
+		int Page_ = -1;
+		QList<QRectF> Rects_;
+	};
+
+	/** @brief A persistent full-text index of a document.
+	 *
+	 * The index is built in background from the words returned by the
+	 * IHaveTextBoxes interface of the document and is stored in the
+	 * cache directory, keyed by the hash and the modification time of
+	 * the document file. Thus the document is processed only once
+	 * unless it changes. The least recently written indexes are removed
+	 * when the cache grows too big.
+	 *
+	 * The texts of the pages are kept in memory, while the character
+	 * rectangles are only loaded from the disk for the pages having
+	 * the matches.
+	 */
+	class TextIndex : public QObject
+	{
+		Q_OBJECT
+	public:
+		struct Data
+		{
+			QString Path_;
+			QVector<QString> Texts_;
+			QVector<qint64> RectsOffsets_;
+		};
+		using Data_cptr = std::shared_ptr<const Data>;
+	private:
+		const IDocument_ptr Doc_;
+
+		Data_cptr Data_;
+
+		std::shared_ptr<std::atomic<bool>> Cancelled_;
+		QFuture<Data_cptr> BuildFuture_;
+	public:
+		TextIndex (const IDocument_ptr&, QObject* = nullptr);
+		~TextIndex ();
+
+		static bool CanIndex (const IDocument_ptr&);
+
+		bool IsReady () const;
+
+		/** @brief Searches the index for the given \em text.
+		 *
+		 * The returned future reports a PageSearchResult for each page
+		 * having any matches, in the order of pages, as soon as the page
+		 * is processed. Canceling the future stops the search.
+		 *
+		 * This function may only be called after the index is ready.
+		 *
+		 * @sa IsReady(), ready()
+		 */
+		QFuture<PageSearchResult> Search (const QString& text, Qt::CaseSensitivity) const;
+	signals:
+		void ready ();
+	};
+}
+}
@@ -31,10 +31,13 @@
 #include <QGraphicsView>
 #include <QGraphicsRectItem>
 #include <QtDebug>
+#include <QtConcurrentRun>
 #include <util/sll/qtutil.h>
+#include <util/threads/futures.h>
 #include "interfaces/monocle/isearchabledocument.h"
 #include "pagegraphicsitem.h"
 #include "pageslayoutmanager.h"
+#include "textindex.h"
 
 namespace LeechCraft
 {
@@ -49,11 +52,24 @@ namespace Monocle
 	{
 	}
 
+	TextSearchHandler::~TextSearchHandler ()
+	{
+		CurrentSearch_.cancel ();
+	}
+
 	void TextSearchHandler::HandleDoc (IDocument_ptr doc, const QList<PageGraphicsItem*>& pages)
 	{
+		CancelSearch ();
+
+		delete Index_;
+		Index_ = nullptr;
+
 		Doc_ = doc;
 		Pages_ = pages;
 
+		if (Doc_ && TextIndex::CanIndex (Doc_))
+			Index_ = new TextIndex (Doc_, this);
+
 		CurrentHighlights_.clear ();
 		CurrentRectIndex_ = -1;
 		CurrentSearchString_.clear ();
@@ -102,6 +118,7 @@ namespace Monocle
 	{
 		if (CurrentSearchString_ != results.Text_)
 		{
+			CancelSearch ();
 			ClearHighlights ();
 			CurrentSearchString_ = results.Text_;
 			BuildHighlights (results.Positions_);
@@ -112,25 +129,69 @@ namespace Monocle
 
 	bool TextSearchHandler::RequestSearch (const QString& text, Util::FindNotification::FindFlags flags)
 	{
+		CancelSearch ();
 		ClearHighlights ();
 		CurrentSearchString_ = text;
 
+		const auto searchId = CurrentSearchID_;
+		const auto cs = flags & Util::FindNotification::FindCaseSensitively ?
+				Qt::CaseSensitive :
+				Qt::CaseInsensitive;
+
+		if (Index_ && Index_->IsReady ())
+		{
+			CurrentSearch_ = Index_->Search (text, cs);
+			Util::Sequence (this, CurrentSearch_)
+					.MultipleResults ([this, text, flags, searchId] (const PageSearchResult& result)
+							{
+								if (searchId == CurrentSearchID_)
+									HandlePageResults (text, flags, { { result.Page_, result.Rects_ } });
+							},
+							[this, searchId]
+							{
+								if (searchId == CurrentSearchID_)
+									emit searchFinished (!CurrentHighlights_.isEmpty ());
+							});
+			return true;
+		}
+
+		// The index isn't ready yet or the document doesn't support it,
+		// so fall back to the backend search, still off the GUI thread.
 		const auto searchable = qobject_cast<ISearchableDocument*> (Doc_->GetQObject ());
 		if (!searchable)
 			return false;
 
-		const auto cs = flags & Util::FindNotification::FindCaseSensitively ?
-				Qt::CaseSensitive :
-				Qt::CaseInsensitive;
-		const auto& map = searchable->GetTextPositions (text, cs);
-		emit gotSearchResults ({ text, flags, map });
+		const auto doc = Doc_;
+		Util::Sequence (this, QtConcurrent::run ([doc, searchable, text, cs]
+					{ return searchable->GetTextPositions (text, cs); })) >>
+				[this, text, flags, searchId] (const QMap<int, QList<QRectF>>& map)
+				{
+					if (searchId != CurrentSearchID_)
+						return;
+
+					HandlePageResults (text, flags, map);
+					emit searchFinished (!CurrentHighlights_.isEmpty ());
+				};
+		return true;
+	}
+
+	void TextSearchHandler::CancelSearch ()
+	{
+		++CurrentSearchID_;
+		CurrentSearch_.cancel ();
+	}
+
+	void TextSearchHandler::HandlePageResults (const QString& text,
+			Util::FindNotification::FindFlags flags, const QMap<int, QList<QRectF>>& map)
+	{
+		const auto hadHighlights = !CurrentHighlights_.isEmpty ();
+
+		emit gotSearchResults ({ CurrentSearchID_, text, flags, map });
 
 		BuildHighlights (map);
 
-		if (!CurrentHighlights_.isEmpty ())
+		if (!hadHighlights && !CurrentHighlights_.isEmpty ())
 			SelectItem (0);
-
-		return !CurrentHighlights_.isEmpty ();
 	}
 
 	void TextSearchHandler::BuildHighlights (const QMap<int, QList<QRectF>>& map)
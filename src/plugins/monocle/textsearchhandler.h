@@ -31,6 +31,7 @@
 
 #include <QObject>
 #include <QMap>
+#include <QFuture>
 #include <util/gui/findnotification.h>
 #include "interfaces/monocle/idocument.h"
 
@@ -44,9 +45,17 @@ namespace Monocle
 {
 	class PageGraphicsItem;
 	class PagesLayoutManager;
+	class TextIndex;
+	struct PageSearchResult;
 
+	/** @brief Search results, possibly partial.
+	 *
+	 * The results of a single search are reported page by page, each
+	 * chunk having the same SearchID_.
+	 */
 	struct TextSearchHandlerResults
 	{
+		quint64 SearchID_;
 		QString Text_;
 		Util::FindNotification::FindFlags FindFlags_;
 		QMap<int, QList<QRectF>> Positions_;
@@ -63,12 +72,17 @@ namespace Monocle
 		IDocument_ptr Doc_;
 		QList<PageGraphicsItem*> Pages_;
 
+		TextIndex *Index_ = nullptr;
+
 		QString CurrentSearchString_;
+		quint64 CurrentSearchID_ = 0;
+		QFuture<PageSearchResult> CurrentSearch_;
 
 		QList<QGraphicsRectItem*> CurrentHighlights_;
 		int CurrentRectIndex_;
 	public:
 		TextSearchHandler (QGraphicsView*, PagesLayoutManager*, QObject* = 0);
+		~TextSearchHandler ();
 
 		void HandleDoc (IDocument_ptr, const QList<PageGraphicsItem*>&);
 
@@ -76,6 +90,10 @@ namespace Monocle
 		void SetPreparedResults (const TextSearchHandlerResults&, int selectedItem);
 	private:
 		bool RequestSearch (const QString&, Util::FindNotification::FindFlags);
+		void CancelSearch ();
+
+		void HandlePageResults (const QString&, Util::FindNotification::FindFlags,
+				const QMap<int, QList<QRectF>>&);
 
 		void BuildHighlights (const QMap<int, QList<QRectF>>&);
 		void ClearHighlights ();
@@ -85,6 +103,8 @@ namespace Monocle
 		void navigateRequested (const QString&, int, double, double);
 
 		void gotSearchResults (const TextSearchHandlerResults&);
+
+		void searchFinished (bool found);
 	};
 }
 }
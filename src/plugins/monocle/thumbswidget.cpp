@@ -67,6 +67,7 @@ namespace Monocle
 		for (int i = 0, size = CurrentDoc_->GetNumPages (); i < size; ++i)
 		{
 			auto item = new PageGraphicsItem (CurrentDoc_, i);
+			item->SetRenderPriority (RenderPriority::Thumbnail);
 			Scene_.addItem (item);
 			item->SetReleaseHandler ([this] (int page, const QPointF&) { emit pageClicked (page); });
 			pages << item;
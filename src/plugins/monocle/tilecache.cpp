@@ -0,0 +1,177 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "tilecache.h"
+#include <algorithm>
+#include <QtDebug>
+#include "xmlsettingsmanager.h"
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	bool operator== (const TileKey& k1, const TileKey& k2)
+	{
+		return k1.Doc_ == k2.Doc_ &&
+				k1.Page_ == k2.Page_ &&
+				k1.XScale_ == k2.XScale_ &&
+				k1.YScale_ == k2.YScale_ &&
+				k1.Tile_ == k2.Tile_;
+	}
+
+	uint qHash (const TileKey& key)
+	{
+		return ::qHash (key.Doc_) ^
+				::qHash (key.Page_ << 16) ^
+				::qHash ((key.XScale_ << 8) + key.YScale_) ^
+				::qHash ((key.Tile_.x () << 16) + key.Tile_.y ());
+	}
+
+	namespace
+	{
+		const double ScalePrecision = 1000;
+
+		int GetPixmapCost (const QPixmap& px)
+		{
+			return px.width () * px.height () * px.depth () / 8;
+		}
+	}
+
+	TileCache::TileCache (QObject *parent)
+	: QObject (parent)
+	{
+		XmlSettingsManager::Instance ().RegisterObject ("TileCacheSize",
+				this, "handleCacheSizeChanged");
+		handleCacheSizeChanged ();
+	}
+
+	bool TileCache::ShouldTile (const QSizeF& size)
+	{
+		return size.width () * size.height () > 4 * TileSize * TileSize;
+	}
+
+	TileKey TileCache::MakeKey (QObject *doc, int page, double xScale, double yScale, const QPoint& tile)
+	{
+		return
+		{
+			doc,
+			page,
+			qRound (xScale * ScalePrecision),
+			qRound (yScale * ScalePrecision),
+			tile
+		};
+	}
+
+	QPixmap TileCache::Get (const TileKey& key) const
+	{
+		const auto px = Cache_.object (key);
+		return px ? *px : QPixmap {};
+	}
+
+	void TileCache::Insert (const TileKey& key, const QPixmap& px)
+	{
+		if (px.isNull ())
+			return;
+
+		if (!KnownDocs_.contains (key.Doc_))
+		{
+			KnownDocs_ << key.Doc_;
+			connect (key.Doc_,
+					SIGNAL (destroyed (QObject*)),
+					this,
+					SLOT (handleDocDestroyed (QObject*)));
+		}
+
+		if (!Cache_.insert (key, new QPixmap { px }, GetPixmapCost (px)))
+			qWarning () << Q_FUNC_INFO
+					<< "tile doesn't fit into the cache:"
+					<< GetPixmapCost (px)
+					<< Cache_.maxCost ();
+	}
+
+	QList<TileCache::ScaledTile> TileCache::GetOtherScales (QObject *doc, int page,
+			double xScale, double yScale, const QRectF& docRect) const
+	{
+		const auto& ownKey = MakeKey (doc, page, xScale, yScale, {});
+
+		QList<TileKey> keys;
+		for (const auto& key : Cache_.keys ())
+			if (key.Doc_ == doc &&
+					key.Page_ == page &&
+					(key.XScale_ != ownKey.XScale_ || key.YScale_ != ownKey.YScale_))
+				keys << key;
+
+		std::sort (keys.begin (), keys.end (),
+				[] (const TileKey& k1, const TileKey& k2) { return k1.XScale_ < k2.XScale_; });
+
+		QList<ScaledTile> result;
+		for (const auto& key : keys)
+		{
+			const auto xs = key.XScale_ / ScalePrecision;
+			const auto ys = key.YScale_ / ScalePrecision;
+			const auto px = Cache_.object (key);
+
+			const QRectF rect
+			{
+				key.Tile_.x () * TileSize / xs,
+				key.Tile_.y () * TileSize / ys,
+				px->width () / xs,
+				px->height () / ys
+			};
+			if (rect.intersects (docRect))
+				result << ScaledTile { rect, *px };
+		}
+		return result;
+	}
+
+	void TileCache::RemovePage (QObject *doc, int page)
+	{
+		RemoveIf ([doc, page] (const TileKey& key) { return key.Doc_ == doc && key.Page_ == page; });
+	}
+
+	void TileCache::RemoveIf (const std::function<bool (TileKey)>& pred)
+	{
+		for (const auto& key : Cache_.keys ())
+			if (pred (key))
+				Cache_.remove (key);
+	}
+
+	void TileCache::handleDocDestroyed (QObject *doc)
+	{
+		KnownDocs_.remove (doc);
+		RemoveIf ([doc] (const TileKey& key) { return key.Doc_ == doc; });
+	}
+
+	void TileCache::handleCacheSizeChanged ()
+	{
+		const auto mibs = XmlSettingsManager::Instance ().property ("TileCacheSize").toInt ();
+		Cache_.setMaxCost (mibs * 1024 * 1024);
+	}
+}
+}
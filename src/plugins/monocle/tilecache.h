@@ -0,0 +1,114 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QCache>
+#include <QSet>
+#include <QPoint>
+#include <QPixmap>
+#include <QRectF>
+#include <functional>
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	struct TileKey
+	{
+		QObject *Doc_;
+		int Page_;
+		int XScale_;
+		int YScale_;
+		QPoint Tile_;
+	};
+
+	bool operator== (const TileKey&, const TileKey&);
+	uint qHash (const TileKey&);
+
+	/** @brief Keeps rendered page tiles for all the opened documents.
+	 *
+	 * Tiles are square regions of TileSize pixels of a page rendered
+	 * at some scale. Tiles at different scales are kept together, so
+	 * that the tiles at a previous zoom level could be used as a
+	 * preview while the tiles at the current zoom level are rendered.
+	 *
+	 * The total size of the cache is controlled by the TileCacheSize
+	 * setting.
+	 */
+	class TileCache : public QObject
+	{
+		Q_OBJECT
+
+		QCache<TileKey, QPixmap> Cache_;
+		QSet<QObject*> KnownDocs_;
+	public:
+		static const int TileSize = 512;
+
+		struct ScaledTile
+		{
+			QRectF DocRect_;
+			QPixmap Pixmap_;
+		};
+
+		TileCache (QObject* = nullptr);
+
+		/** @brief Returns whether a page of the given scaled \em size
+		 * should be rendered by tiles.
+		 *
+		 * This is the case for pages having more pixels than several
+		 * tiles.
+		 */
+		static bool ShouldTile (const QSizeF& size);
+
+		static TileKey MakeKey (QObject*, int page, double xScale, double yScale, const QPoint& tile);
+
+		QPixmap Get (const TileKey&) const;
+		void Insert (const TileKey&, const QPixmap&);
+
+		/** @brief Returns the tiles at the scales other than the given.
+		 *
+		 * Only the tiles intersecting the \em docRect (in the page
+		 * coordinates) are returned. The tiles are sorted by their
+		 * scale in ascending order, so drawing them in this order puts
+		 * the most detailed ones on top.
+		 */
+		QList<ScaledTile> GetOtherScales (QObject*, int page,
+				double xScale, double yScale, const QRectF& docRect) const;
+
+		void RemovePage (QObject*, int page);
+	private:
+		void RemoveIf (const std::function<bool (TileKey)>&);
+	private slots:
+		void handleDocDestroyed (QObject*);
+		void handleCacheSizeChanged ();
+	};
+}
+}
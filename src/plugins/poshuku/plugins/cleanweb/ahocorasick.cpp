@@ -0,0 +1,137 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "ahocorasick.h"
+#include <algorithm>
+#include <QtDebug>
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	namespace
+	{
+		auto CharLess (const std::pair<char, int>& pair, char c)
+		{
+			return pair.first < c;
+		}
+	}
+
+	int AhoCorasick::AddPattern (const QByteArray& pattern)
+	{
+		if (pattern.isEmpty ())
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "empty patterns are not supported";
+			return -1;
+		}
+
+		int state = 0;
+		for (const char c : pattern)
+		{
+			auto& next = Nodes_ [state].Next_;
+			const auto pos = std::lower_bound (next.begin (), next.end (), c, &CharLess);
+			if (pos != next.end () && pos->first == c)
+			{
+				state = pos->second;
+				continue;
+			}
+
+			const auto newState = static_cast<int> (Nodes_.size ());
+			next.insert (pos, { c, newState });
+			Nodes_.emplace_back ();
+			state = newState;
+		}
+
+		const auto id = PatternsCount_++;
+		Nodes_ [state].Patterns_.push_back (id);
+		return id;
+	}
+
+	void AhoCorasick::Build ()
+	{
+		std::vector<int> queue;
+		queue.reserve (Nodes_.size ());
+
+		for (const auto& pair : Nodes_ [0].Next_)
+		{
+			Nodes_ [pair.second].Fail_ = 0;
+			Nodes_ [pair.second].DictLink_ = -1;
+			queue.push_back (pair.second);
+		}
+
+		for (size_t i = 0; i < queue.size (); ++i)
+		{
+			const auto state = queue [i];
+			for (const auto& pair : Nodes_ [state].Next_)
+			{
+				const auto child = pair.second;
+
+				auto fail = Nodes_ [state].Fail_;
+				int failNext = GetNext (fail, pair.first);
+				while (failNext < 0 && fail)
+				{
+					fail = Nodes_ [fail].Fail_;
+					failNext = GetNext (fail, pair.first);
+				}
+
+				auto& childNode = Nodes_ [child];
+				childNode.Fail_ = std::max (failNext, 0);
+
+				const auto& failNode = Nodes_ [childNode.Fail_];
+				childNode.DictLink_ = failNode.Patterns_.empty () ?
+						failNode.DictLink_ :
+						childNode.Fail_;
+
+				queue.push_back (child);
+			}
+		}
+	}
+
+	bool AhoCorasick::IsEmpty () const
+	{
+		return !PatternsCount_;
+	}
+
+	int AhoCorasick::GetPatternsCount () const
+	{
+		return PatternsCount_;
+	}
+
+	int AhoCorasick::GetNext (int state, char c) const
+	{
+		const auto& next = Nodes_ [state].Next_;
+		const auto pos = std::lower_bound (next.begin (), next.end (), c, &CharLess);
+		return pos != next.end () && pos->first == c ? pos->second : -1;
+	}
+}
+}
+}
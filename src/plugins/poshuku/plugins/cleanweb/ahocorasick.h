@@ -0,0 +1,121 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <QByteArray>
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	/** @brief Multi-pattern substring matcher.
+	 *
+	 * This is a classic Aho–Corasick automaton: the patterns are added
+	 * via AddPattern(), then Build() computes the failure links, and
+	 * after that ForEachMatch() finds all the occurrences of all the
+	 * patterns in a given string in a single pass.
+	 *
+	 * Patterns are matched byte-wise, so the caller is responsible for
+	 * bringing both the patterns and the text to the same case.
+	 */
+	class AhoCorasick
+	{
+		struct Node
+		{
+			std::vector<std::pair<char, int>> Next_;
+			std::vector<int> Patterns_;
+			int Fail_ = 0;
+			int DictLink_ = -1;
+		};
+
+		std::vector<Node> Nodes_ { 1 };
+		int PatternsCount_ = 0;
+	public:
+		/** @brief Adds the pattern to the automaton.
+		 *
+		 * The automaton should be rebuilt via Build() after all the
+		 * patterns are added.
+		 *
+		 * @param[in] pattern The non-empty pattern to add.
+		 * @return The ID of the pattern that will be passed to the
+		 * ForEachMatch() callback.
+		 */
+		int AddPattern (const QByteArray& pattern);
+
+		void Build ();
+
+		bool IsEmpty () const;
+		int GetPatternsCount () const;
+
+		/** @brief Invokes f for each pattern occurrence in text.
+		 *
+		 * The search stops as soon as f returns true.
+		 *
+		 * @param[in] text The text to search in.
+		 * @param[in] f The functor taking the ID of the found pattern and
+		 * returning whether the search should stop.
+		 * @return Whether the search was stopped by f.
+		 */
+		template<typename F>
+		bool ForEachMatch (const QByteArray& text, F&& f) const
+		{
+			if (!PatternsCount_)
+				return false;
+
+			int state = 0;
+			for (const char c : text)
+			{
+				int next = GetNext (state, c);
+				while (next < 0 && state)
+				{
+					state = Nodes_ [state].Fail_;
+					next = GetNext (state, c);
+				}
+				state = std::max (next, 0);
+
+				for (int s = Nodes_ [state].Patterns_.empty () ? Nodes_ [state].DictLink_ : state;
+						s > 0; s = Nodes_ [s].DictLink_)
+					for (const auto id : Nodes_ [s].Patterns_)
+						if (f (id))
+							return true;
+			}
+
+			return false;
+		}
+	private:
+		int GetNext (int, char) const;
+	};
+}
+}
+}
@@ -29,8 +29,6 @@
 
 #include "core.h"
 #include <algorithm>
-#include <functional>
-#include <thread>
 #include <QNetworkRequest>
 #include <QRegExp>
 #include <QFile>
@@ -42,7 +40,6 @@
 #include <QDir>
 #include <QCoreApplication>
 #include <QtConcurrentRun>
-#include <QtConcurrentMap>
 #include <QMenu>
 #include <QMainWindow>
 #include <QDir>
@@ -61,6 +58,7 @@
 #include <interfaces/poshuku/iinterceptablerequests.h>
 #include <util/threads/futures.h>
 #include "xmlsettingsmanager.h"
+#include "filtercache.h"
 #include "userfiltersmodel.h"
 #include "lineparser.h"
 #include "subscriptionsmodel.h"
@@ -75,36 +73,105 @@ namespace CleanWeb
 {
 	namespace
 	{
-		QList<Filter> ParseToFilters (const QStringList& paths)
+		Filter ParseToFilter (const QString& filePath)
+		{
+			QFile file (filePath);
+			if (!file.open (QIODevice::ReadOnly))
+			{
+				qWarning () << Q_FUNC_INFO
+					<< "could not open file"
+					<< filePath
+					<< file.errorString ();
+				return {};
+			}
+
+			const auto& data = QString::fromUtf8 (file.readAll ());
+			auto rawLines = data.split ('\n', QString::SkipEmptyParts);
+			if (!rawLines.isEmpty ())
+				rawLines.removeAt (0);
+			const auto& lines = Util::Map (rawLines, Util::QStringTrimmed {});
+
+			Filter f;
+			std::for_each (lines.begin (), lines.end (), LineParser (&f));
+
+			f.SD_.Filename_ = QFileInfo (filePath).fileName ();
+
+			return f;
+		}
+
+		QList<Filter> LoadFilters (const QStringList& paths, const QHash<QString, QDateTime>& lastUpdates)
 		{
 			QList<Filter> result;
 			for (const auto& filePath : paths)
 			{
-				QFile file (filePath);
-				if (!file.open (QIODevice::ReadOnly))
+				const auto& lastUpdate = lastUpdates.value (QFileInfo (filePath).fileName ());
+				if (const auto cached = FilterCache::Load (filePath, lastUpdate))
 				{
-					qWarning () << Q_FUNC_INFO
-						<< "could not open file"
-						<< filePath
-						<< file.errorString ();
-					result << Filter ();
+					result << *cached;
 					continue;
 				}
 
-				const auto& data = QString::fromUtf8 (file.readAll ());
-				auto rawLines = data.split ('\n', QString::SkipEmptyParts);
-				if (!rawLines.isEmpty ())
-					rawLines.removeAt (0);
-				const auto& lines = Util::Map (rawLines, Util::QStringTrimmed {});
+				const auto& filter = ParseToFilter (filePath);
+				FilterCache::Save (filter, filePath, lastUpdate);
+				result << filter;
+			}
+			return result;
+		}
+
+		QString ToJSString (QString str)
+		{
+			str.replace ('\\', "\\\\")
+					.replace ('\'', "\\'")
+					.replace ('\n', "\\n")
+					.replace ('\r', "\\r");
+			return '\'' + str + '\'';
+		}
+
+		QString MakeAddStyleJS (const QString& id, const QString& css)
+		{
+			if (css.isEmpty ())
+				return {};
 
-				Filter f;
-				std::for_each (lines.begin (), lines.end (), LineParser (&f));
+			return QString { "addStyle('%1', %2);" }.arg (id, ToJSString (css));
+		}
 
-				f.SD_.Filename_ = QFileInfo (filePath).fileName ();
+		CompiledFilters_ptr CompileFilters (const QList<Filter>& allFilters)
+		{
+			QList<FilterItem_ptr> exceptions;
+			QList<FilterItem_ptr> filters;
+			for (const Filter& filter : allFilters)
+			{
+				for (const auto& item : filter.Exceptions_)
+					if (item->Option_.HideSelector_.isEmpty ())
+						exceptions << item;
 
-				result << f;
+				for (const auto& item : filter.Filters_)
+					if (item->Option_.HideSelector_.isEmpty ())
+						filters << item;
 			}
-			return result;
+
+			QElapsedTimer timer;
+			timer.start ();
+
+			const HidingTable hidingTable { allFilters };
+			const auto compiled = std::make_shared<const CompiledFilters> (CompiledFilters
+					{
+						FilterMatcher { exceptions },
+						FilterMatcher { filters },
+						hidingTable,
+						MakeAddStyleJS ("leechcraft-cleanweb-generic", hidingTable.GetGenericCSS ())
+					});
+
+			qDebug () << Q_FUNC_INFO
+					<< "compiled"
+					<< exceptions.size ()
+					<< "exceptions and"
+					<< filters.size ()
+					<< "filters in"
+					<< timer.elapsed ()
+					<< "ms";
+
+			return compiled;
 		}
 	}
 
@@ -126,10 +193,30 @@ namespace CleanWeb
 		const auto& infos = path.entryInfoList (QDir::Files | QDir::Readable);
 		const auto& paths = Util::Map (infos, &QFileInfo::absoluteFilePath);
 
-		Util::Sequence (nullptr, QtConcurrent::run (ParseToFilters, paths)) >>
-				[this] (const QList<Filter>& filters)
+		QHash<QString, QDateTime> lastUpdates;
+		for (const auto& sd : SubscriptionsModel::LoadSavedSubData ())
+			lastUpdates [sd.Filename_] = sd.LastDateTime_;
+
+		/* The initial set is compiled right in the loading thread, so
+		 * that the requests waiting in WaitCompiledFilters() don't depend
+		 * on the main thread's event loop.
+		 */
+		const auto& userFilter = UserFilters_->GetFilter ();
+		const auto initialGeneration = ++CompiledFiltersGeneration_;
+		InitialLoad_ = QtConcurrent::run ([=]
 				{
+					const auto& filters = LoadFilters (paths, lastUpdates);
+					PublishCompiledFilters (CompileFilters (filters + QList<Filter> { userFilter }),
+							initialGeneration);
+					return filters;
+				});
+
+		Util::Sequence (nullptr, InitialLoad_) >>
+				[this, initialGeneration] (const QList<Filter>& filters)
+				{
+					IgnoreFiltersChanges_ = initialGeneration == CompiledFiltersGeneration_;
 					SubsModel_->SetInitialFilters (filters);
+					IgnoreFiltersChanges_ = false;
 
 					QTimer::singleShot (0,
 							this,
@@ -137,6 +224,11 @@ namespace CleanWeb
 				};
 	}
 
+	Core::~Core ()
+	{
+		InitialLoad_.waitForFinished ();
+	}
+
 	ICoreProxy_ptr Core::GetProxy () const
 	{
 		return Proxy_;
@@ -165,6 +257,18 @@ namespace CleanWeb
 			{ SIGNAL (earliestViewLayout ()), SIGNAL (loadFinished (bool)) },
 			view->GetQWidget ()
 		};
+		new Util::SlotClosure<Util::NoDeletePolicy>
+		{
+			[view, this] { HidingApplied_.remove (view->GetQWidget ()); },
+			view->GetQWidget (),
+			SIGNAL (loadStarted ()),
+			view->GetQWidget ()
+		};
+		connect (view->GetQWidget (),
+				SIGNAL (destroyed (QObject*)),
+				this,
+				SLOT (handleViewDestroyed (QObject*)),
+				Qt::UniqueConnection);
 	}
 
 	void Core::HandleContextMenu (const ContextMenuInfo& r,
@@ -186,111 +290,6 @@ namespace CleanWeb
 		}
 	}
 
-	namespace
-	{
-#if defined (Q_OS_WIN32) || defined (Q_OS_MAC)
-		// Thanks for this goes to http://www.codeproject.com/KB/string/patmatch.aspx
-		bool WildcardMatches (const char *pattern, const char *str)
-		{
-			enum State {
-				Exact,        // exact match
-				Any,        // ?
-				AnyRepeat    // *
-			};
-
-			const char *s = str;
-			const char *p = pattern;
-			const char *q = 0;
-			int state = 0;
-
-			bool match = true;
-			while (match && *p) {
-				if (*p == '*') {
-					state = AnyRepeat;
-					q = p+1;
-				} else if (*p == '?') state = Any;
-				else state = Exact;
-
-				if (*s == 0) break;
-
-				switch (state) {
-					case Exact:
-						match = *s == *p;
-						s++;
-						p++;
-						break;
-
-					case Any:
-						match = true;
-						s++;
-						p++;
-						break;
-
-					case AnyRepeat:
-						match = true;
-						s++;
-
-						if (*s == *q) p++;
-						break;
-				}
-			}
-
-			if (state == AnyRepeat) return (*s == *q);
-			else if (state == Any) return (*s == *p);
-			else return match && (*s == *p);
-		}
-#else
-#include <fnmatch.h>
-
-		bool WildcardMatches (const char *pat, const char *str)
-		{
-			return !fnmatch (pat, str, 0);
-		}
-#endif
-
-		bool Matches (const FilterItem_ptr& item,
-				const QByteArray& urlUtf8, const QString& domain)
-		{
-			const auto& opt = item->Option_;
-			if (opt.MatchObjects_ != FilterOption::MatchObject::All)
-			{
-				if (!(opt.MatchObjects_ & FilterOption::MatchObject::CSS) &&
-						!(opt.MatchObjects_ & FilterOption::MatchObject::Image) &&
-						!(opt.MatchObjects_ & FilterOption::MatchObject::Script) &&
-						!(opt.MatchObjects_ & FilterOption::MatchObject::Object) &&
-						!(opt.MatchObjects_ & FilterOption::MatchObject::ObjSubrequest))
-					return false;
-			}
-
-			if (std::any_of (opt.NotDomains_.begin (), opt.NotDomains_.end (),
-						[&domain, &opt] (const QString& notDomain)
-							{ return domain.endsWith (notDomain, opt.Case_); }))
-				return false;
-
-			if (!opt.Domains_.isEmpty () &&
-					std::none_of (opt.Domains_.begin (), opt.Domains_.end (),
-							[&domain, &opt] (const QString& doDomain)
-								{ return domain.endsWith (doDomain, opt.Case_); }))
-				return false;
-
-			switch (opt.MatchType_)
-			{
-			case FilterOption::MTRegexp:
-				return item->RegExp_.Matches (urlUtf8);
-			case FilterOption::MTWildcard:
-				return WildcardMatches (item->PlainMatcher_.constData (), urlUtf8.constData ());
-			case FilterOption::MTPlain:
-				return urlUtf8.indexOf (item->PlainMatcher_) >= 0;
-			case FilterOption::MTBegin:
-				return urlUtf8.startsWith (item->PlainMatcher_);
-			case FilterOption::MTEnd:
-				return urlUtf8.endsWith (item->PlainMatcher_);
-			}
-
-			return false;
-		}
-	}
-
 	namespace
 	{
 		FilterOption::MatchObjects ResourceType2Objs (IInterceptableRequests::ResourceType type)
@@ -310,9 +309,7 @@ namespace CleanWeb
 			}
 		}
 
-		bool ShouldReject (const IInterceptableRequests::RequestInfo& req,
-				const QList<QList<FilterItem_ptr>>& exceptions,
-				const QList<QList<FilterItem_ptr>>& filters)
+		bool ShouldReject (const IInterceptableRequests::RequestInfo& req, const CompiledFilters& filters)
 		{
 			if (!XmlSettingsManager::Instance ()->property ("EnableFiltering").toBool ())
 				return false;
@@ -320,48 +317,23 @@ namespace CleanWeb
 			if (!req.PageUrl_.isValid ())
 				return false;
 
-			const auto objs = ResourceType2Objs (req.ResourceType_);
-
 			const QUrl& url = req.RequestUrl_;
 			const QString& urlStr = url.toString ();
-			const auto& urlUtf8 = urlStr.toUtf8 ();
-			const QString& cinUrlStr = urlStr.toLower ();
-			const auto& cinUrlUtf8 = cinUrlStr.toUtf8 ();
-
 			const QString& domain = req.PageUrl_.host ();
-			const bool isThirdParty = !url.host ().endsWith (domain);
 
-			auto matches = [=] (const QList<QList<FilterItem_ptr>>& chunks)
+			const RequestContext ctx
 			{
-				return QtConcurrent::blockingMappedReduced (chunks.begin (), chunks.end (),
-						std::function<bool (const QList<FilterItem_ptr>&)>
-						{
-							[=] (const QList<FilterItem_ptr>& items)
-							{
-								for (const auto& item : items)
-								{
-									const auto& opt = item->Option_;
-									if (opt.ThirdParty_ != FilterOption::ThirdParty::Unspecified)
-										if ((opt.ThirdParty_ == FilterOption::ThirdParty::Yes) != isThirdParty)
-											continue;
-
-									if (opt.MatchObjects_ != FilterOption::MatchObject::All &&
-											!(objs & opt.MatchObjects_))
-										continue;
-
-									const auto& utf8 = item->Option_.Case_ == Qt::CaseSensitive ? urlUtf8 : cinUrlUtf8;
-									if (Matches (item, utf8, domain))
-										return true;
-								}
-
-								return false;
-							}
-						},
-						+[] (bool& res, bool value) { res = res || value; });
+				urlStr.toUtf8 (),
+				urlStr.toLower ().toUtf8 (),
+				url.host ().toLower (),
+				domain,
+				ResourceType2Objs (req.ResourceType_),
+				!url.host ().endsWith (domain)
 			};
-			if (matches (exceptions))
+
+			if (filters.Exceptions_.Matches (ctx))
 				return false;
-			if (matches (filters))
+			if (filters.Filters_.Matches (ctx))
 				return true;
 
 			return false;
@@ -373,7 +345,13 @@ namespace CleanWeb
 		auto interceptor = [this] (const IInterceptableRequests::RequestInfo& info)
 				-> IInterceptableRequests::Result_t
 		{
-			if (!ShouldReject (info, ExceptionsCache_, FilterItemsCache_))
+			if (!XmlSettingsManager::Instance ()->property ("EnableFiltering").toBool ())
+				return IInterceptableRequests::Allow {};
+
+			auto filters = std::atomic_load (&CompiledFilters_);
+			if (!filters)
+				filters = WaitCompiledFilters ();
+			if (!filters || !ShouldReject (info, *filters))
 				return IInterceptableRequests::Allow {};
 
 			if (info.View_)
@@ -399,6 +377,44 @@ namespace CleanWeb
 			interceptable->AddInterceptor (interceptor);
 	}
 
+	void Core::PublishCompiledFilters (const CompiledFilters_ptr& compiled, int generation)
+	{
+		{
+			std::lock_guard<std::mutex> guard { CompiledFiltersMutex_ };
+
+			// An older compilation finishing first is still better than
+			// nothing, but it must not replace a newer one.
+			if (generation <= PublishedGeneration_)
+				return;
+
+			PublishedGeneration_ = generation;
+			std::atomic_store (&CompiledFilters_, compiled);
+		}
+
+		CompiledFiltersPublished_.notify_all ();
+	}
+
+	CompiledFilters_ptr Core::WaitCompiledFilters ()
+	{
+		/* Requests issued right before the filters are compiled for the
+		 * first time (like the ones restoring the previous session) would
+		 * pass unfiltered otherwise. The requests are usually issued from
+		 * the GUI thread, so the wait is short, and it's done only once:
+		 * if the filters aren't ready by then (like on the first run
+		 * without snapshots), the requests pass until they are.
+		 */
+		if (GaveUpWaiting_)
+			return {};
+
+		std::unique_lock<std::mutex> lock { CompiledFiltersMutex_ };
+		const bool ready = CompiledFiltersPublished_.wait_for (lock,
+				std::chrono::milliseconds { 250 },
+				[this] { return static_cast<bool> (std::atomic_load (&CompiledFilters_)); });
+		if (!ready)
+			GaveUpWaiting_ = true;
+		return std::atomic_load (&CompiledFilters_);
+	}
+
 	void Core::HandleProvider (QObject *provider)
 	{
 		if (Downloaders_.contains (provider))
@@ -415,9 +431,11 @@ namespace CleanWeb
 				SLOT (handleJobError (int, IDownload::Error)));
 	}
 
-	void Core::Parse (const QString& filePath)
+	void Core::Parse (const QString& filePath, const QDateTime& lastUpdate)
 	{
-		SubsModel_->AddFilter (ParseToFilters ({ filePath }).first ());
+		const auto& filter = ParseToFilter (filePath);
+		FilterCache::Save (filter, filePath, lastUpdate);
+		SubsModel_->AddFilter (filter);
 	}
 
 	bool Core::Add (const QUrl& subscrUrl)
@@ -515,7 +533,7 @@ namespace CleanWeb
 			pj.FileName_,
 			QDateTime::currentDateTime ()
 		};
-		Parse (pj.FullName_);
+		Parse (pj.FullName_, sd.LastDateTime_);
 		PendingJobs_.remove (id);
 		SubsModel_->SetSubData (sd);
 	}
@@ -533,92 +551,44 @@ namespace CleanWeb
 		if (!XmlSettingsManager::Instance ()->property ("EnableElementHiding").toBool ())
 			return;
 
-		if (ScheduledHidings_.contains (view))
+		const auto& filters = std::atomic_load (&CompiledFilters_);
+		if (!filters)
 			return;
 
-		qDebug () << Q_FUNC_INFO << view;
-		ScheduledHidings_ << view;
-
-		const auto& frameUrl = view->GetUrl ();
-		const QString& urlStr = frameUrl.toString ();
-		const auto& urlUtf8 = urlStr.toUtf8 ();
-		const QString& cinUrlStr = urlStr.toLower ();
-		const auto& cinUrlUtf8 = cinUrlStr.toUtf8 ();
-
-		const QString& domain = frameUrl.host ();
-
-		auto allFilters = SubsModel_->GetAllFilters ();
-		allFilters << UserFilters_->GetFilter ();
-
-		const auto future = QtConcurrent::run ([=]
-				{
-					QElapsedTimer timer;
-					timer.start ();
-
-					QStringList sels;
-					for (const Filter& filter : allFilters)
-						for (const auto& item : filter.Filters_)
-						{
-							if (item->Option_.HideSelector_.isEmpty ())
-								continue;
-
-							const auto& opt = item->Option_;
-							const auto& utf8 = opt.Case_ == Qt::CaseSensitive ? urlUtf8 : cinUrlUtf8;
-							if (!Matches (item, utf8, domain))
-								continue;
-
-							sels << item->Option_.HideSelector_;
-						}
-
-					const auto msecs = timer.nsecsElapsed () / 1000000;
-					const auto remaining = 1000 - msecs;
-					if (remaining > 0)
-					{
-						qDebug () << Q_FUNC_INFO
-								<< "sleeping for"
-								<< remaining
-								<< "ms";
-						std::this_thread::sleep_for (std::chrono::milliseconds { remaining });
-					}
-
-					return HidingWorkerResult { view, sels };
-				});
-
-		Util::Sequence (view->GetQWidget (), future) >>
-				[this] (const HidingWorkerResult& result) { HideElementsChunk (result); };
-	}
-
-	void Core::HideElementsChunk (HidingWorkerResult result)
-	{
-		ScheduledHidings_.remove (result.View_);
+		const auto viewObj = view->GetQWidget ();
+		if (HidingApplied_.contains (viewObj))
+			return;
+		HidingApplied_ << viewObj;
 
-		for (auto& selector : result.Selectors_)
-			selector.replace ('\\', "\\\\")
-					.replace ('\'', "\\'")
-					;
+		const auto& url = view->GetUrl ();
+		const auto& pageCss = filters->Hiding_.GetPageCSS (url.host ().toLower ());
 
 		QString js = R"(
 					(function(){
-					var elems = document.querySelectorAll('__SELECTORS__');
-					for (var i = 0; i < elems.length; ++i)
-						elems[i].remove();
-					return elems.length;
+					function addStyle(id, css){
+						if (document.getElementById(id))
+							return;
+						var style = document.createElement('style');
+						style.id = id;
+						style.type = 'text/css';
+						style.appendChild(document.createTextNode(css));
+						(document.head || document.documentElement).appendChild(style);
+					}
+					__GENERIC__
+					__SPECIFIC__
 					})();
 				)";
-		js.replace ("__SELECTORS__", result.Selectors_.join (", "));
+		js.replace ("__GENERIC__", pageCss.UseGeneric_ ? filters->GenericHidingJS_ : QString {});
+		js.replace ("__SPECIFIC__", MakeAddStyleJS ("leechcraft-cleanweb-specific", pageCss.Specific_));
 
-		result.View_->EvaluateJS (js,
-				[result, js] (const QVariant& res)
+		view->EvaluateJS (js,
+				[url] (const QVariant& res)
 				{
-					if (const auto count = res.toInt ())
-						qDebug () << "removed"
-								<< count
-								<< "elements on frame with URL"
-								<< result.View_->GetUrl ();
-					else if (!res.canConvert<int> ())
+					if (!res.isNull ())
 						qWarning () << Q_FUNC_INFO
-								<< "failed to execute JS:"
-								<< js;
+								<< "unexpected element hiding result for"
+								<< url
+								<< res;
 				},
 				IWebView::EvaluateJSFlag::RecurseSubframes);
 	}
@@ -702,67 +672,21 @@ namespace CleanWeb
 	void Core::handleViewDestroyed (QObject *obj)
 	{
 		MoreDelayedURLs_.remove (obj);
+		HidingApplied_.remove (obj);
 	}
 
 	void Core::regenFilterCaches ()
 	{
-		ExceptionsCache_.clear ();
-		FilterItemsCache_.clear ();
+		if (IgnoreFiltersChanges_)
+			return;
 
 		auto allFilters = SubsModel_->GetAllFilters ();
 		allFilters << UserFilters_->GetFilter ();
 
-		int exceptionsCount = 0;
-		int filtersCount = 0;
-		for (const Filter& filter : allFilters)
-		{
-			exceptionsCount += filter.Exceptions_.size ();
-			filtersCount += filter.Filters_.size ();
-		}
-
-		auto idealThreads = std::max (QThread::idealThreadCount (), 2);
-
-		const int exChunkSize = std::max (exceptionsCount / idealThreads / 4, 200);
-		const int fChunkSize = std::max (filtersCount / idealThreads / 4, 200);
-		qDebug () << Q_FUNC_INFO << exceptionsCount << filtersCount << exChunkSize << fChunkSize;
-
-		QList<FilterItem_ptr> lastItemsChunk, lastExceptionsChunk;
-		lastItemsChunk.reserve (fChunkSize);
-		lastExceptionsChunk.reserve (exChunkSize);
-
-		for (const Filter& filter : allFilters)
-		{
-			for (const auto& item : filter.Exceptions_)
-			{
-				if (!item->Option_.HideSelector_.isEmpty ())
-					continue;
-
-				lastExceptionsChunk << item;
-				if (lastExceptionsChunk.size () >= exChunkSize)
-				{
-					ExceptionsCache_ << lastExceptionsChunk;
-					lastExceptionsChunk.clear ();
-				}
-			}
-
-			for (const auto& item : filter.Filters_)
-			{
-				if (!item->Option_.HideSelector_.isEmpty ())
-					continue;
-
-				lastItemsChunk << item;
-				if (lastItemsChunk.size () >= fChunkSize)
-				{
-					FilterItemsCache_ << lastItemsChunk;
-					lastItemsChunk.clear ();
-				}
-			}
-		}
-
-		if (!lastItemsChunk.isEmpty ())
-			FilterItemsCache_ << lastItemsChunk;
-		if (!lastExceptionsChunk.isEmpty ())
-			ExceptionsCache_ << lastExceptionsChunk;
+		const auto generation = ++CompiledFiltersGeneration_;
+		Util::Sequence (this, QtConcurrent::run (CompileFilters, allFilters)) >>
+				[this, generation] (const CompiledFilters_ptr& compiled)
+					{ PublishCompiledFilters (compiled, generation); };
 	}
 }
 }
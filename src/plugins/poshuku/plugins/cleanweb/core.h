@@ -29,17 +29,25 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <QAbstractItemModel>
 #include <QHash>
+#include <QSet>
 #include <QStringList>
 #include <QNetworkReply>
 #include <QDateTime>
+#include <QFuture>
 #include <QWebPage>
 #include <interfaces/iinfo.h>
 #include <interfaces/idownload.h>
 #include <interfaces/poshuku/poshukutypes.h>
 #include <interfaces/core/ihookproxy.h>
 #include "filter.h"
+#include "filtermatcher.h"
+#include "hidingtable.h"
 
 class QNetworkRequest;
 class QWebPage;
@@ -56,12 +64,17 @@ namespace CleanWeb
 	class UserFiltersModel;
 	class SubscriptionsModel;
 
-	struct HidingWorkerResult
+	struct CompiledFilters
 	{
-		IWebView *View_;
-		QStringList Selectors_;
+		FilterMatcher Exceptions_;
+		FilterMatcher Filters_;
+
+		HidingTable Hiding_;
+		QString GenericHidingJS_;
 	};
 
+	using CompiledFilters_ptr = std::shared_ptr<const CompiledFilters>;
+
 	class Core : public QObject
 	{
 		Q_OBJECT
@@ -69,8 +82,21 @@ namespace CleanWeb
 		UserFiltersModel * const UserFilters_;
 		SubscriptionsModel * const SubsModel_;
 
-		QList<QList<FilterItem_ptr>> ExceptionsCache_;
-		QList<QList<FilterItem_ptr>> FilterItemsCache_;
+		/** Accessed from the requests interceptor, which may run in
+		 * any thread, so it should only be read via std::atomic_load()
+		 * and replaced via PublishCompiledFilters().
+		 */
+		CompiledFilters_ptr CompiledFilters_;
+		std::atomic<int> CompiledFiltersGeneration_ { 0 };
+
+		std::mutex CompiledFiltersMutex_;
+		std::condition_variable CompiledFiltersPublished_;
+		int PublishedGeneration_ = 0;
+		std::atomic<bool> GaveUpWaiting_ { false };
+
+		bool IgnoreFiltersChanges_ = false;
+
+		QFuture<QList<Filter>> InitialLoad_;
 
 		QObjectList Downloaders_;
 
@@ -85,11 +111,16 @@ namespace CleanWeb
 
 		QHash<QObject*, QSet<QUrl>> MoreDelayedURLs_;
 
-		QSet<IWebView*> ScheduledHidings_;
+		/** The views whose frames already have the hiding stylesheets for
+		 * the current load, so that the later layout notifications don't
+		 * inject them once again.
+		 */
+		QSet<QObject*> HidingApplied_;
 
 		const ICoreProxy_ptr Proxy_;
 	public:
 		Core (SubscriptionsModel*, UserFiltersModel*, const ICoreProxy_ptr&);
+		~Core ();
 
 		ICoreProxy_ptr GetProxy () const;
 
@@ -137,9 +168,11 @@ namespace CleanWeb
 	private:
 		void HandleProvider (QObject*);
 
-		void Parse (const QString&);
+		void Parse (const QString&, const QDateTime&);
+
+		void PublishCompiledFilters (const CompiledFilters_ptr&, int);
+		CompiledFilters_ptr WaitCompiledFilters ();
 
-		void HideElementsChunk (HidingWorkerResult);
 		void DelayedRemoveElements (IWebView*, const QUrl&);
 		void HandleViewLayout (IWebView*);
 	private slots:
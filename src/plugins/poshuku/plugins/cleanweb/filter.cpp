@@ -37,6 +37,33 @@ namespace Poshuku
 {
 namespace CleanWeb
 {
+	LazyRegExp::LazyRegExp (const QString& pattern, Qt::CaseSensitivity cs)
+	: Data_ { std::make_shared<Data> () }
+	{
+		Data_->Pattern_ = pattern;
+		Data_->Case_ = cs;
+	}
+
+	bool LazyRegExp::Matches (const QByteArray& str) const
+	{
+		if (!Data_)
+			return false;
+
+		std::call_once (Data_->CompiledFlag_,
+				[this] { Data_->Compiled_ = Util::RegExp { Data_->Pattern_, Data_->Case_ }; });
+		return Data_->Compiled_.Matches (str);
+	}
+
+	QString LazyRegExp::GetPattern () const
+	{
+		return Data_ ? Data_->Pattern_ : QString {};
+	}
+
+	Qt::CaseSensitivity LazyRegExp::GetCaseSensitivity () const
+	{
+		return Data_ ? Data_->Case_ : Qt::CaseSensitivity {};
+	}
+
 	QDataStream& operator<< (QDataStream& out, const FilterOption& opt)
 	{
 		qint8 version = 3;
@@ -160,14 +187,14 @@ namespace CleanWeb
 		{
 			QRegExp rx;
 			in >> rx;
-			item.RegExp_ = Util::RegExp (rx.pattern (), rx.caseSensitivity ());
+			item.RegExp_ = LazyRegExp (rx.pattern (), rx.caseSensitivity ());
 		}
 		else if (version == 2)
 		{
 			QString str;
 			quint8 cs;
 			in >> str >> cs;
-			item.RegExp_ = Util::RegExp (str, static_cast<Qt::CaseSensitivity> (cs));
+			item.RegExp_ = LazyRegExp (str, static_cast<Qt::CaseSensitivity> (cs));
 		}
 		in >> item.Option_;
 		return in;
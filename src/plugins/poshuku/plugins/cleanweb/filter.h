@@ -30,6 +30,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <QMetaType>
 #include <QStringList>
 #include <QDateTime>
@@ -110,11 +111,46 @@ namespace CleanWeb
 		QDateTime LastDateTime_;
 	};
 
+	/** @brief A regular expression compiled on its first use.
+	 *
+	 * Most of the regexp filters never get a chance to be checked
+	 * against any URL, so there is no point in compiling all of them
+	 * when the filters are loaded.
+	 *
+	 * Copies share the compiled regexp, and compilation is thread-safe.
+	 */
+	class LazyRegExp
+	{
+		struct Data
+		{
+			QString Pattern_;
+			Qt::CaseSensitivity Case_;
+
+			std::once_flag CompiledFlag_;
+			Util::RegExp Compiled_;
+		};
+		std::shared_ptr<Data> Data_;
+	public:
+		LazyRegExp () = default;
+		LazyRegExp (const QString&, Qt::CaseSensitivity);
+
+		bool Matches (const QByteArray&) const;
+
+		QString GetPattern () const;
+		Qt::CaseSensitivity GetCaseSensitivity () const;
+	};
+
 	struct FilterItem
 	{
-		Util::RegExp RegExp_;
+		LazyRegExp RegExp_;
 		QByteArray PlainMatcher_;
 		FilterOption Option_;
+
+		/** The lowercased host this item is anchored to via the
+		 * <code>||host^</code> syntax, or an empty string if the item is
+		 * not host-anchored.
+		 */
+		QString AnchorHost_;
 	};
 
 	QDebug operator<< (QDebug, const FilterItem&);
@@ -0,0 +1,282 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "filtercache.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtDebug>
+#include <util/sys/paths.h>
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+namespace FilterCache
+{
+	namespace
+	{
+		const quint32 Magic = 0x4c43cb01;
+		const quint16 Version = 3;
+
+		struct Header
+		{
+			qint64 SourceSize_;
+			qint64 SourceMTime_;
+			qint64 LastUpdate_;
+		};
+
+		bool operator== (const Header& h1, const Header& h2)
+		{
+			return h1.SourceSize_ == h2.SourceSize_ &&
+					h1.SourceMTime_ == h2.SourceMTime_ &&
+					h1.LastUpdate_ == h2.LastUpdate_;
+		}
+
+		Header MakeHeader (const QString& sourcePath, const QDateTime& lastUpdate)
+		{
+			const QFileInfo fi { sourcePath };
+			return
+			{
+				fi.size (),
+				fi.lastModified ().toMSecsSinceEpoch (),
+				lastUpdate.toMSecsSinceEpoch ()
+			};
+		}
+
+		QString GetCachePath (const QString& filename)
+		{
+			return Util::GetUserDir (Util::UserDir::Cache, "poshuku/cleanweb").filePath (filename + ".cache");
+		}
+
+		void WriteItems (QDataStream& out, const QList<FilterItem_ptr>& items)
+		{
+			out << static_cast<quint32> (items.size ());
+			for (const auto& item : items)
+			{
+				const auto& opt = item->Option_;
+				out << item->PlainMatcher_
+						<< item->RegExp_.GetPattern ()
+						<< static_cast<quint8> (item->RegExp_.GetCaseSensitivity ())
+						<< item->AnchorHost_
+						<< static_cast<quint8> (opt.Case_)
+						<< static_cast<quint8> (opt.MatchType_)
+						<< static_cast<quint32> (opt.MatchObjects_)
+						<< opt.Domains_
+						<< opt.NotDomains_
+						<< opt.HideSelector_
+						<< static_cast<quint8> (opt.ThirdParty_);
+			}
+		}
+
+		bool ReadItems (QDataStream& in, QList<FilterItem_ptr>& items)
+		{
+			quint32 count = 0;
+			in >> count;
+			if (in.status () != QDataStream::Ok)
+				return false;
+
+			// Each item takes way more than a byte, so a bigger count
+			// means a broken snapshot.
+			const auto dev = in.device ();
+			if (dev && count > dev->bytesAvailable ())
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "items count"
+						<< count
+						<< "exceeds the remaining data";
+				return false;
+			}
+
+			items.reserve (count);
+			for (quint32 i = 0; i < count; ++i)
+			{
+				const auto& item = std::make_shared<FilterItem> ();
+				auto& opt = item->Option_;
+
+				QString rxPattern;
+				quint8 rxCase = 0;
+				quint8 optCase = 0;
+				quint8 matchType = 0;
+				quint32 matchObjects = 0;
+				quint8 thirdParty = 0;
+				in >> item->PlainMatcher_
+						>> rxPattern
+						>> rxCase
+						>> item->AnchorHost_
+						>> optCase
+						>> matchType
+						>> matchObjects
+						>> opt.Domains_
+						>> opt.NotDomains_
+						>> opt.HideSelector_
+						>> thirdParty;
+				if (in.status () != QDataStream::Ok)
+					return false;
+
+				if (!rxPattern.isEmpty ())
+					item->RegExp_ = LazyRegExp { rxPattern, static_cast<Qt::CaseSensitivity> (rxCase) };
+
+				opt.Case_ = static_cast<Qt::CaseSensitivity> (optCase);
+				opt.MatchType_ = static_cast<FilterOption::MatchType> (matchType);
+				opt.MatchObjects_ = FilterOption::MatchObjects (static_cast<int> (matchObjects));
+				opt.ThirdParty_ = static_cast<FilterOption::ThirdParty> (thirdParty);
+
+				items << item;
+			}
+
+			return true;
+		}
+	}
+
+	void Save (const Filter& filter, const QString& sourcePath, const QDateTime& lastUpdate)
+	{
+		if (!lastUpdate.isValid ())
+			return;
+
+		QSaveFile file { GetCachePath (QFileInfo { sourcePath }.fileName ()) };
+		if (!file.open (QIODevice::WriteOnly))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open"
+					<< file.fileName ()
+					<< file.errorString ();
+			return;
+		}
+
+		const auto& header = MakeHeader (sourcePath, lastUpdate);
+
+		QDataStream out { &file };
+		out.setVersion (QDataStream::Qt_5_0);
+		out << Magic
+				<< Version
+				<< header.SourceSize_
+				<< header.SourceMTime_
+				<< header.LastUpdate_;
+		WriteItems (out, filter.Filters_);
+		WriteItems (out, filter.Exceptions_);
+
+		if (!file.commit ())
+			qWarning () << Q_FUNC_INFO
+					<< "unable to commit"
+					<< file.fileName ()
+					<< file.errorString ();
+	}
+
+	boost::optional<Filter> Load (const QString& sourcePath, const QDateTime& lastUpdate)
+	{
+		if (!lastUpdate.isValid ())
+			return {};
+
+		const auto& filename = QFileInfo { sourcePath }.fileName ();
+
+		QFile file { GetCachePath (filename) };
+		if (!file.exists ())
+			return {};
+
+		if (!file.open (QIODevice::ReadOnly))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open"
+					<< file.fileName ()
+					<< file.errorString ();
+			return {};
+		}
+
+		const auto size = file.size ();
+		const auto mapped = file.map (0, size);
+		if (!mapped)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to map"
+					<< file.fileName ()
+					<< file.errorString ();
+			return {};
+		}
+
+		const auto& data = QByteArray::fromRawData (reinterpret_cast<const char*> (mapped), size);
+		QDataStream in { data };
+		in.setVersion (QDataStream::Qt_5_0);
+
+		quint32 magic = 0;
+		quint16 version = 0;
+		Header header {};
+		in >> magic
+				>> version
+				>> header.SourceSize_
+				>> header.SourceMTime_
+				>> header.LastUpdate_;
+		if (magic != Magic || version != Version)
+		{
+			qDebug () << Q_FUNC_INFO
+					<< "unknown cache format for"
+					<< filename
+					<< magic
+					<< version;
+			return {};
+		}
+
+		if (!(header == MakeHeader (sourcePath, lastUpdate)))
+		{
+			qDebug () << Q_FUNC_INFO
+					<< "outdated cache for"
+					<< filename;
+			return {};
+		}
+
+		Filter filter;
+		if (!ReadItems (in, filter.Filters_) ||
+				!ReadItems (in, filter.Exceptions_))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "corrupted cache for"
+					<< filename;
+			return {};
+		}
+
+		filter.SD_.Filename_ = filename;
+		return filter;
+	}
+
+	void Remove (const QString& filename)
+	{
+		const auto& path = GetCachePath (filename);
+		if (QFile::exists (path) && !QFile::remove (path))
+			qWarning () << Q_FUNC_INFO
+					<< "unable to remove"
+					<< path;
+	}
+}
+}
+}
+}
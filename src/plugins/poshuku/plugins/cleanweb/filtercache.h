@@ -0,0 +1,85 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include "filter.h"
+
+class QDateTime;
+class QString;
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	/** @brief Binary snapshots of parsed subscriptions.
+	 *
+	 * Parsing a big subscription takes quite some time, so the parsed
+	 * items are saved into a versioned binary snapshot after the
+	 * subscription is (re)parsed, and the snapshot is used instead of
+	 * parsing the subscription text on the next start.
+	 *
+	 * The snapshot is only considered valid if the subscription file
+	 * has the same size and modification time as when the snapshot was
+	 * written, and if the subscription has the same last update time.
+	 */
+	namespace FilterCache
+	{
+		/** @brief Writes the snapshot of the parsed subscription.
+		 *
+		 * The snapshot is written atomically, so a crash in the middle
+		 * of writing it never leaves a corrupted snapshot behind.
+		 *
+		 * @param[in] filter The filter parsed from the subscription.
+		 * @param[in] sourcePath The path to the subscription text file.
+		 * @param[in] lastUpdate The last update time of the subscription.
+		 */
+		void Save (const Filter& filter, const QString& sourcePath, const QDateTime& lastUpdate);
+
+		/** @brief Loads the snapshot of the subscription, if valid.
+		 *
+		 * @param[in] sourcePath The path to the subscription text file.
+		 * @param[in] lastUpdate The last update time of the subscription.
+		 * @return The filter with the items loaded from the snapshot, or
+		 * an empty optional if there is no valid snapshot.
+		 */
+		boost::optional<Filter> Load (const QString& sourcePath, const QDateTime& lastUpdate);
+
+		/** @brief Removes the snapshot for the given subscription file.
+		 *
+		 * @param[in] filename The name of the subscription file.
+		 */
+		void Remove (const QString& filename);
+	}
+}
+}
+}
@@ -0,0 +1,468 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "filtermatcher.h"
+#include <algorithm>
+#include <QtDebug>
+
+#if !defined (Q_OS_WIN32) && !defined (Q_OS_MAC)
+#include <fnmatch.h>
+#endif
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	namespace
+	{
+#if defined (Q_OS_WIN32) || defined (Q_OS_MAC)
+		// Thanks for this goes to http://www.codeproject.com/KB/string/patmatch.aspx
+		bool WildcardMatches (const char *pattern, const char *str)
+		{
+			enum State {
+				Exact,        // exact match
+				Any,        // ?
+				AnyRepeat    // *
+			};
+
+			const char *s = str;
+			const char *p = pattern;
+			const char *q = 0;
+			int state = 0;
+
+			bool match = true;
+			while (match && *p) {
+				if (*p == '*') {
+					state = AnyRepeat;
+					q = p+1;
+				} else if (*p == '?') state = Any;
+				else state = Exact;
+
+				if (*s == 0) break;
+
+				switch (state) {
+					case Exact:
+						match = *s == *p;
+						s++;
+						p++;
+						break;
+
+					case Any:
+						match = true;
+						s++;
+						p++;
+						break;
+
+					case AnyRepeat:
+						match = true;
+						s++;
+
+						if (*s == *q) p++;
+						break;
+				}
+			}
+
+			if (state == AnyRepeat) return (*s == *q);
+			else if (state == Any) return (*s == *p);
+			else return match && (*s == *p);
+		}
+#else
+		bool WildcardMatches (const char *pat, const char *str)
+		{
+			return !fnmatch (pat, str, 0);
+		}
+#endif
+
+		/** Checks whether the given character is a separator in the
+		 * AdBlock Plus sense, that is, anything but a letter, a digit or
+		 * one of <code>_-.%</code>.
+		 */
+		bool IsSeparator (char c)
+		{
+			return !(c >= 'a' && c <= 'z') &&
+					!(c >= 'A' && c <= 'Z') &&
+					!(c >= '0' && c <= '9') &&
+					c != '_' && c != '-' && c != '.' && c != '%';
+		}
+
+		/** Matches the wildcard pattern containing AdBlock Plus separator
+		 * placeholders (<code>^</code>) which match either a separator
+		 * character or the end of the string.
+		 */
+		bool SeparatorWildcardMatches (const char *pat, const char *str)
+		{
+			const char *starPat = nullptr;
+			const char *starStr = nullptr;
+			while (true)
+			{
+				if (*pat == '*')
+				{
+					starPat = ++pat;
+					starStr = str;
+					continue;
+				}
+
+				if (!*str)
+				{
+					while (*pat == '*' || *pat == '^')
+						++pat;
+					if (!*pat)
+						return true;
+				}
+				else if (*pat)
+				{
+					bool matches = false;
+					int patStep = 1;
+					if (*pat == '^')
+						matches = IsSeparator (*str);
+					else if (*pat == '\\' && pat [1])
+					{
+						matches = pat [1] == *str;
+						patStep = 2;
+					}
+					else
+						matches = *pat == *str;
+
+					if (matches)
+					{
+						pat += patStep;
+						++str;
+						continue;
+					}
+				}
+
+				if (!starPat || !*starStr)
+					return false;
+
+				pat = starPat;
+				str = ++starStr;
+			}
+		}
+	}
+
+	bool Matches (const FilterItem_ptr& item, const QByteArray& urlUtf8, const QString& domain)
+	{
+		const auto& opt = item->Option_;
+		if (opt.MatchObjects_ != FilterOption::MatchObject::All)
+		{
+			if (!(opt.MatchObjects_ & FilterOption::MatchObject::CSS) &&
+					!(opt.MatchObjects_ & FilterOption::MatchObject::Image) &&
+					!(opt.MatchObjects_ & FilterOption::MatchObject::Script) &&
+					!(opt.MatchObjects_ & FilterOption::MatchObject::Object) &&
+					!(opt.MatchObjects_ & FilterOption::MatchObject::ObjSubrequest))
+				return false;
+		}
+
+		if (std::any_of (opt.NotDomains_.begin (), opt.NotDomains_.end (),
+					[&domain, &opt] (const QString& notDomain)
+						{ return domain.endsWith (notDomain, opt.Case_); }))
+			return false;
+
+		if (!opt.Domains_.isEmpty () &&
+				std::none_of (opt.Domains_.begin (), opt.Domains_.end (),
+						[&domain, &opt] (const QString& doDomain)
+							{ return domain.endsWith (doDomain, opt.Case_); }))
+			return false;
+
+		switch (opt.MatchType_)
+		{
+		case FilterOption::MTRegexp:
+			return item->RegExp_.Matches (urlUtf8);
+		case FilterOption::MTWildcard:
+			return item->PlainMatcher_.contains ('^') ?
+					SeparatorWildcardMatches (item->PlainMatcher_.constData (), urlUtf8.constData ()) :
+					WildcardMatches (item->PlainMatcher_.constData (), urlUtf8.constData ());
+		case FilterOption::MTPlain:
+			return urlUtf8.indexOf (item->PlainMatcher_) >= 0;
+		case FilterOption::MTBegin:
+			return urlUtf8.startsWith (item->PlainMatcher_);
+		case FilterOption::MTEnd:
+			return urlUtf8.endsWith (item->PlainMatcher_);
+		}
+
+		return false;
+	}
+
+	namespace
+	{
+		const int MinTokenLength = 3;
+
+		bool IsTokenChar (char c)
+		{
+			return (c >= 'a' && c <= 'z') ||
+					(c >= '0' && c <= '9') ||
+					c == '%';
+		}
+
+		bool IsWildcardAt (const QByteArray& pattern, int pos)
+		{
+			switch (pattern.at (pos))
+			{
+			case '*':
+				return true;
+			case '?':
+				return !pos || pattern.at (pos - 1) != '\\';
+			default:
+				return false;
+			}
+		}
+
+		bool IsIndexable (const FilterItem& item)
+		{
+			switch (item.Option_.MatchType_)
+			{
+			case FilterOption::MTRegexp:
+				return false;
+			case FilterOption::MTWildcard:
+				// Character classes would be treated as literal tokens otherwise.
+				return !item.PlainMatcher_.contains ('[');
+			case FilterOption::MTPlain:
+			case FilterOption::MTBegin:
+			case FilterOption::MTEnd:
+				return true;
+			}
+
+			return false;
+		}
+
+		/** Returns the tokens that are guaranteed to be present as a whole
+		 * in any URL matched by the given item, that is, the alphanumeric
+		 * runs bounded by separators or by the anchored pattern ends.
+		 */
+		QList<QByteArray> GetTokens (const FilterItem& item)
+		{
+			if (!IsIndexable (item))
+				return {};
+
+			const auto type = item.Option_.MatchType_;
+			const auto& pattern = item.PlainMatcher_.toLower ();
+			const auto size = pattern.size ();
+
+			const bool isWildcard = type == FilterOption::MTWildcard;
+			const bool leftAnchored = type == FilterOption::MTBegin ||
+					(isWildcard && !pattern.startsWith ('*'));
+			const bool rightAnchored = type == FilterOption::MTEnd ||
+					(isWildcard && !pattern.endsWith ('*'));
+
+			QList<QByteArray> result;
+			for (int i = 0; i < size; )
+			{
+				if (!IsTokenChar (pattern.at (i)))
+				{
+					++i;
+					continue;
+				}
+
+				const auto start = i;
+				while (i < size && IsTokenChar (pattern.at (i)))
+					++i;
+
+				if (i - start < MinTokenLength)
+					continue;
+
+				const bool leftBounded = start ?
+						!IsWildcardAt (pattern, start - 1) :
+						leftAnchored;
+				const bool rightBounded = i < size ?
+						!IsWildcardAt (pattern, i) :
+						rightAnchored;
+				if (leftBounded && rightBounded)
+					result << pattern.mid (start, i - start);
+			}
+			return result;
+		}
+
+		QByteArray GetLongestLiteral (const FilterItem& item)
+		{
+			if (!IsIndexable (item))
+				return {};
+
+			const auto& pattern = item.PlainMatcher_.toLower ();
+			if (item.Option_.MatchType_ != FilterOption::MTWildcard)
+				return pattern;
+
+			QByteArray longest;
+			int start = 0;
+			for (int i = 0; i <= pattern.size (); ++i)
+			{
+				if (i < pattern.size () &&
+						!IsWildcardAt (pattern, i) &&
+						pattern.at (i) != '\\' &&
+						pattern.at (i) != '^')
+					continue;
+
+				if (i - start > longest.size ())
+					longest = pattern.mid (start, i - start);
+				start = i + 1;
+			}
+			return longest;
+		}
+
+		bool CheckItem (const FilterItem_ptr& item, const RequestContext& ctx)
+		{
+			const auto& opt = item->Option_;
+			if (opt.ThirdParty_ != FilterOption::ThirdParty::Unspecified &&
+					(opt.ThirdParty_ == FilterOption::ThirdParty::Yes) != ctx.IsThirdParty_)
+				return false;
+
+			if (opt.MatchObjects_ != FilterOption::MatchObject::All &&
+					!(ctx.Objects_ & opt.MatchObjects_))
+				return false;
+
+			const auto& utf8 = opt.Case_ == Qt::CaseSensitive ? ctx.UrlUtf8_ : ctx.CinUrlUtf8_;
+			return CleanWeb::Matches (item, utf8, ctx.Domain_);
+		}
+	}
+
+	FilterMatcher::FilterMatcher (const QList<FilterItem_ptr>& items)
+	{
+		QHash<QByteArray, int> tokenCounts;
+		QVector<QList<QByteArray>> itemsTokens;
+		itemsTokens.reserve (items.size ());
+		for (const auto& item : items)
+		{
+			if (!item->AnchorHost_.isEmpty ())
+			{
+				itemsTokens << QList<QByteArray> {};
+				continue;
+			}
+
+			const auto& tokens = GetTokens (*item);
+			for (const auto& token : tokens)
+				++tokenCounts [token];
+			itemsTokens << tokens;
+		}
+
+		for (int i = 0; i < items.size (); ++i)
+		{
+			const auto& item = items.at (i);
+			if (!item->AnchorHost_.isEmpty ())
+			{
+				ByHost_ [item->AnchorHost_] << item;
+				continue;
+			}
+
+			const auto& tokens = itemsTokens.at (i);
+			if (!tokens.isEmpty ())
+			{
+				const auto& rarest = *std::min_element (tokens.begin (), tokens.end (),
+						[&tokenCounts] (const QByteArray& left, const QByteArray& right)
+						{
+							const auto leftCount = tokenCounts.value (left);
+							const auto rightCount = tokenCounts.value (right);
+							return leftCount < rightCount ||
+									(leftCount == rightCount && left.size () > right.size ());
+						});
+				ByToken_ [rarest] << item;
+				continue;
+			}
+
+			const auto& literal = GetLongestLiteral (*item);
+			if (literal.isEmpty ())
+			{
+				Generic_ << item;
+				continue;
+			}
+
+			Literals_.AddPattern (literal);
+			ByLiteral_ << item;
+		}
+
+		Literals_.Build ();
+
+		qDebug () << Q_FUNC_INFO
+				<< items.size ()
+				<< "items;"
+				<< ByHost_.size ()
+				<< "hosts,"
+				<< ByToken_.size ()
+				<< "tokens,"
+				<< ByLiteral_.size ()
+				<< "literals,"
+				<< Generic_.size ()
+				<< "generic";
+	}
+
+	bool FilterMatcher::Matches (const RequestContext& ctx) const
+	{
+		const auto check = [&ctx] (const FilterItem_ptr& item) { return CheckItem (item, ctx); };
+		const auto checkBucket = [&check] (const QVector<FilterItem_ptr>& bucket)
+		{
+			return std::any_of (bucket.begin (), bucket.end (), check);
+		};
+
+		if (!ByHost_.isEmpty ())
+			for (int pos = 0; pos >= 0; )
+			{
+				const auto it = ByHost_.constFind (ctx.Host_.mid (pos));
+				if (it != ByHost_.constEnd () && checkBucket (*it))
+					return true;
+
+				pos = ctx.Host_.indexOf ('.', pos);
+				if (pos >= 0)
+					++pos;
+			}
+
+		if (!ByToken_.isEmpty ())
+		{
+			const auto& url = ctx.CinUrlUtf8_;
+			const auto size = url.size ();
+			for (int i = 0; i < size; )
+			{
+				if (!IsTokenChar (url.at (i)))
+				{
+					++i;
+					continue;
+				}
+
+				const auto start = i;
+				while (i < size && IsTokenChar (url.at (i)))
+					++i;
+
+				if (i - start < MinTokenLength)
+					continue;
+
+				const auto& token = QByteArray::fromRawData (url.constData () + start, i - start);
+				const auto it = ByToken_.constFind (token);
+				if (it != ByToken_.constEnd () && checkBucket (*it))
+					return true;
+			}
+		}
+
+		if (Literals_.ForEachMatch (ctx.CinUrlUtf8_,
+				[this, &check] (int id) { return check (ByLiteral_.at (id)); }))
+			return true;
+
+		return checkBucket (Generic_);
+	}
+}
+}
+}
@@ -0,0 +1,103 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QHash>
+#include <QVector>
+#include "ahocorasick.h"
+#include "filter.h"
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	/** @brief Describes a single request being checked against the
+	 * filters.
+	 */
+	struct RequestContext
+	{
+		/// The UTF-8 representation of the request URL.
+		QByteArray UrlUtf8_;
+
+		/// The lowercased UTF-8 representation of the request URL.
+		QByteArray CinUrlUtf8_;
+
+		/// The lowercased host of the request URL.
+		QString Host_;
+
+		/// The host of the page that has issued the request.
+		QString Domain_;
+
+		FilterOption::MatchObjects Objects_;
+		bool IsThirdParty_;
+	};
+
+	bool Matches (const FilterItem_ptr& item, const QByteArray& urlUtf8, const QString& domain);
+
+	/** @brief A compiled and indexed set of filter items.
+	 *
+	 * Instead of checking every filter item against every request, the
+	 * items are distributed between several indexes when the matcher is
+	 * constructed:
+	 * - host-anchored (<code>||host^</code>) items are put into a hash
+	 *   keyed by the host they are anchored to,
+	 * - items containing a token that is guaranteed to be present in the
+	 *   matching URL are put into a hash keyed by the rarest such token,
+	 * - the remaining non-regexp items are keyed by their longest
+	 *   literal substring in an Aho–Corasick automaton,
+	 * - and only the items not fitting any of the above (mostly regexps)
+	 *   are checked unconditionally.
+	 *
+	 * Thus only a handful of candidate items are fully checked for any
+	 * given request.
+	 *
+	 * The matcher is immutable after construction and thus can be
+	 * safely used from several threads at once.
+	 */
+	class FilterMatcher
+	{
+		QHash<QString, QVector<FilterItem_ptr>> ByHost_;
+		QHash<QByteArray, QVector<FilterItem_ptr>> ByToken_;
+
+		AhoCorasick Literals_;
+		QVector<FilterItem_ptr> ByLiteral_;
+
+		QVector<FilterItem_ptr> Generic_;
+	public:
+		FilterMatcher () = default;
+		explicit FilterMatcher (const QList<FilterItem_ptr>& items);
+
+		bool Matches (const RequestContext& ctx) const;
+	};
+}
+}
+}
@@ -0,0 +1,207 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "hidingtable.h"
+#include <algorithm>
+#include <QtDebug>
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	namespace
+	{
+		const int SelectorsPerCSSRule = 500;
+
+		QString MakeCSS (const QStringList& selectors)
+		{
+			QString result;
+			for (int i = 0; i < selectors.size (); i += SelectorsPerCSSRule)
+				result += selectors.mid (i, SelectorsPerCSSRule).join (", ") +
+						" { display: none !important; }\n";
+			return result;
+		}
+
+		bool IsValidSelector (const QString& selector)
+		{
+			return !selector.isEmpty () &&
+					!selector.contains ('{') &&
+					!selector.contains ('}');
+		}
+
+		bool IsSubdomain (const QString& host, const QString& domain)
+		{
+			return host.size () == domain.size () ?
+					host == domain :
+					host.endsWith (domain) && host.at (host.size () - domain.size () - 1) == '.';
+		}
+
+		bool IsExcluded (const QString& host, const QStringList& notDomains)
+		{
+			return std::any_of (notDomains.begin (), notDomains.end (),
+					[&host] (const QString& domain) { return IsSubdomain (host, domain); });
+		}
+
+		bool IsExceptedOutside (const QString& host, const QVector<QStringList>& domainsLists)
+		{
+			return std::any_of (domainsLists.begin (), domainsLists.end (),
+					[&host] (const QStringList& domains) { return !IsExcluded (host, domains); });
+		}
+
+		template<typename F>
+		void ForEachSuffix (const QString& host, F&& f)
+		{
+			for (int pos = 0; pos >= 0; )
+			{
+				f (host.mid (pos));
+
+				pos = host.indexOf ('.', pos);
+				if (pos >= 0)
+					++pos;
+			}
+		}
+	}
+
+	HidingTable::HidingTable (const QList<Filter>& filters)
+	{
+		QSet<QString> globalExceptions;
+		for (const auto& filter : filters)
+			for (const auto& item : filter.Exceptions_)
+			{
+				const auto& opt = item->Option_;
+				if (opt.HideSelector_.isEmpty ())
+					continue;
+
+				if (!opt.Domains_.isEmpty ())
+					for (const auto& domain : opt.Domains_)
+						ExceptionsByDomain_ [domain.toLower ()] << Rule { opt.HideSelector_, opt.NotDomains_ };
+				else if (!opt.NotDomains_.isEmpty ())
+					ExceptedOutside_ [opt.HideSelector_] << opt.NotDomains_;
+				else
+					globalExceptions << opt.HideSelector_;
+			}
+
+		for (const auto& filter : filters)
+			for (const auto& item : filter.Filters_)
+			{
+				const auto& opt = item->Option_;
+				const auto& selector = opt.HideSelector_;
+				if (!IsValidSelector (selector) || globalExceptions.contains (selector))
+					continue;
+
+				const Rule rule { selector, opt.NotDomains_ };
+				if (!opt.Domains_.isEmpty ())
+					for (const auto& domain : opt.Domains_)
+						ByDomain_ [domain.toLower ()] << rule;
+				else if (ExceptedOutside_.contains (selector))
+					// Only the domains not covered by the exception are left.
+					for (const auto& domain : ExceptedOutside_ [selector].first ())
+						ByDomain_ [domain.toLower ()] << rule;
+				else if (!opt.NotDomains_.isEmpty ())
+					GenericWithExclusions_ << rule;
+				else if (!GenericSet_.contains (selector))
+				{
+					GenericSet_ << selector;
+					Generic_ << selector;
+				}
+			}
+
+		GenericCSS_ = MakeCSS (Generic_);
+
+		qDebug () << Q_FUNC_INFO
+				<< Generic_.size ()
+				<< "generic selectors,"
+				<< GenericWithExclusions_.size ()
+				<< "generic with exclusions,"
+				<< ByDomain_.size ()
+				<< "domains,"
+				<< ExceptionsByDomain_.size ()
+				<< "domains with exceptions,"
+				<< ExceptedOutside_.size ()
+				<< "selectors excepted outside some domains";
+	}
+
+	const QString& HidingTable::GetGenericCSS () const
+	{
+		return GenericCSS_;
+	}
+
+	HidingTable::PageCSS HidingTable::GetPageCSS (const QString& host) const
+	{
+		QSet<QString> excepted;
+		ForEachSuffix (host,
+				[this, &host, &excepted] (const QString& suffix)
+				{
+					const auto it = ExceptionsByDomain_.constFind (suffix);
+					if (it != ExceptionsByDomain_.constEnd ())
+						for (const auto& rule : *it)
+							if (!IsExcluded (host, rule.NotDomains_))
+								excepted << rule.Selector_;
+				});
+
+		QStringList selectors;
+		auto addRules = [&] (const QVector<Rule>& rules)
+		{
+			for (const auto& rule : rules)
+			{
+				if (excepted.contains (rule.Selector_) || IsExcluded (host, rule.NotDomains_))
+					continue;
+
+				const auto outside = ExceptedOutside_.constFind (rule.Selector_);
+				if (outside != ExceptedOutside_.constEnd () && IsExceptedOutside (host, *outside))
+					continue;
+
+				selectors << rule.Selector_;
+			}
+		};
+
+		ForEachSuffix (host,
+				[this, &addRules] (const QString& suffix)
+				{
+					const auto it = ByDomain_.constFind (suffix);
+					if (it != ByDomain_.constEnd ())
+						addRules (*it);
+				});
+		addRules (GenericWithExclusions_);
+
+		const bool useGeneric = std::none_of (excepted.begin (), excepted.end (),
+				[this] (const QString& selector) { return GenericSet_.contains (selector); });
+		if (!useGeneric)
+			for (const auto& selector : Generic_)
+				if (!excepted.contains (selector))
+					selectors << selector;
+
+		selectors.removeDuplicates ();
+		return { useGeneric, MakeCSS (selectors) };
+	}
+}
+}
+}
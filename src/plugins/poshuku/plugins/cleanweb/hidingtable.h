@@ -0,0 +1,97 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include "filter.h"
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	/** @brief Precomputed element hiding rules.
+	 *
+	 * The element hiding rules are split into the generic ones, which
+	 * apply to any page and are thus compiled into a single stylesheet
+	 * once, and the domain-specific ones, which are stored in a table
+	 * keyed by domain.
+	 *
+	 * Thus computing the stylesheet for a page only depends on the
+	 * number of rules related to the page's domain, not on the total
+	 * number of rules.
+	 */
+	class HidingTable
+	{
+		struct Rule
+		{
+			QString Selector_;
+			QStringList NotDomains_;
+		};
+
+		QStringList Generic_;
+		QSet<QString> GenericSet_;
+		QString GenericCSS_;
+
+		QVector<Rule> GenericWithExclusions_;
+		QHash<QString, QVector<Rule>> ByDomain_;
+		QHash<QString, QVector<Rule>> ExceptionsByDomain_;
+
+		/** The selectors excepted everywhere but the given domains
+		 * (<code>~domain#@#selector</code>), mapped to the lists of the
+		 * domains where they still apply, one list per exception.
+		 */
+		QHash<QString, QVector<QStringList>> ExceptedOutside_;
+	public:
+		struct PageCSS
+		{
+			/** Whether the generic stylesheet returned by GetGenericCSS()
+			 * applies to the page as is. If it doesn't, the applicable
+			 * generic rules are included in Specific_.
+			 */
+			bool UseGeneric_;
+
+			/// The stylesheet with the page-specific rules.
+			QString Specific_;
+		};
+
+		HidingTable () = default;
+		explicit HidingTable (const QList<Filter>& filters);
+
+		const QString& GetGenericCSS () const;
+		PageCSS GetPageCSS (const QString& host) const;
+	};
+}
+}
+}
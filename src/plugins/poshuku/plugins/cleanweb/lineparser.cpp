@@ -28,6 +28,7 @@
  **********************************************************************/
 
 #include "lineparser.h"
+#include <QRegExp>
 #include <QtDebug>
 #include "filter.h"
 
@@ -99,7 +100,21 @@ namespace CleanWeb
 			return options;
 		}
 
-		void ParseWithOption (QString actualLine, FilterOption f, QList<FilterItem_ptr>& items)
+		QString GetAnchorHost (const QString& hostPattern)
+		{
+			const auto pos = hostPattern.indexOf (QRegExp { "[/^:]" });
+			if (pos <= 0)
+				return {};
+
+			const auto& host = hostPattern.left (pos);
+			if (host.contains ('*') || host.contains ('?') || host.contains ('|'))
+				return {};
+
+			return host.toLower ();
+		}
+
+		void ParseWithOption (QString actualLine, FilterOption f,
+				QList<FilterItem_ptr>& items, QString anchorHost = {})
 		{
 			if (actualLine.startsWith ('/') &&
 					actualLine.endsWith ('/'))
@@ -108,7 +123,7 @@ namespace CleanWeb
 				f.MatchType_ = FilterOption::MTRegexp;
 				const FilterItem_ptr item (new FilterItem
 						{
-							Util::RegExp (actualLine, f.Case_),
+							LazyRegExp (actualLine, f.Case_),
 							{},
 							f
 						});
@@ -123,11 +138,13 @@ namespace CleanWeb
 
 			if (actualLine.startsWith ("||"))
 			{
+				anchorHost = GetAnchorHost (actualLine.mid (2));
+
 				auto spawned = "." + actualLine.mid (2);
 				if (f.Case_ == Qt::CaseInsensitive)
 					spawned = spawned.toLower ();
 				f.MatchType_ = FilterOption::MTPlain;
-				ParseWithOption (spawned, f, items);
+				ParseWithOption (spawned, f, items, anchorHost);
 
 				actualLine = actualLine.mid (2);
 				actualLine.prepend ('/');
@@ -169,48 +186,46 @@ namespace CleanWeb
 					f.MatchType_ = FilterOption::MTPlain;
 			}
 
-			if (f.MatchType_ == FilterOption::MTWildcard)
-				actualLine.replace ('?', "\\?");
-
-			if (f.MatchType_ != FilterOption::MTRegexp && actualLine.contains ('^'))
+			/* Separators are checked by the wildcard matcher itself, so
+			 * such rules stay on the indexed (non-regexp) path.
+			 */
+			if (actualLine.contains ('^'))
 			{
-				if (!Util::RegExp::IsFast ())
-					return;
-
-				actualLine.replace ('*', ".*");
-				if (f.MatchType_ != FilterOption::MTWildcard)
-					actualLine.replace ('?', "\\?");
 				switch (f.MatchType_)
 				{
 				case FilterOption::MTEnd:
-					actualLine.prepend (".*");
+					actualLine.prepend ('*');
 					break;
 				case FilterOption::MTBegin:
-					actualLine.append (".*");
+					actualLine.append ('*');
 					break;
 				case FilterOption::MTPlain:
-					actualLine.prepend (".*");
-					actualLine.append (".*");
+					actualLine.prepend ('*');
+					actualLine.append ('*');
 					break;
 				case FilterOption::MTWildcard:
 				case FilterOption::MTRegexp:
 					break;
 				}
-				actualLine.replace ('^', "[/?=&]");
-				f.MatchType_ = FilterOption::MTRegexp;
+
+				f.MatchType_ = FilterOption::MTWildcard;
 			}
 
+			if (f.MatchType_ == FilterOption::MTWildcard)
+				actualLine.replace ('?', "\\?");
+
 			const auto& casedOrigStr = (f.Case_ == Qt::CaseSensitive ?
 					actualLine :
 					actualLine.toLower ()).toUtf8 ();
 			const auto& itemRx = f.MatchType_ == FilterOption::MTRegexp ?
-					Util::RegExp (actualLine, f.Case_) :
-					Util::RegExp ();
+					LazyRegExp (actualLine, f.Case_) :
+					LazyRegExp ();
 			const FilterItem_ptr item (new FilterItem
 					{
 						itemRx,
 						casedOrigStr,
-						f
+						f,
+						anchorHost
 					});
 			items << item;
 		}
@@ -227,20 +242,25 @@ namespace CleanWeb
 		QStringList additionalLines;
 		FilterOption f = FilterOption ();
 
-		if (actualLine.contains ("##"))
+		const auto hidingPos = actualLine.indexOf (QRegExp { "#@?#" });
+		if (hidingPos >= 0)
 		{
-			const auto& split = actualLine.split ("##");
-			if (split.size () != 2)
-			{
-				qWarning () << Q_FUNC_INFO
-					<< "incorrect usage of ##-pattern:"
-					<< split.size ()
-					<< line;
-				return;
-			}
+			const bool isException = actualLine.at (hidingPos + 1) == '@';
+			f.HideSelector_ = actualLine.mid (hidingPos + (isException ? 3 : 2)).trimmed ();
+
+			const auto& domains = actualLine.left (hidingPos).toLower ();
+			for (const auto& domain : domains.split (',', QString::SkipEmptyParts))
+				if (domain.startsWith ('~'))
+					f.NotDomains_ << domain.mid (1);
+				else
+					f.Domains_ << domain;
+
+			f.MatchType_ = FilterOption::MTPlain;
+			const FilterItem_ptr item (new FilterItem { {}, {}, f });
+			(isException ? Filter_->Exceptions_ : Filter_->Filters_) << item;
 
-			actualLine = split.at (0);
-			f.HideSelector_ = split.at (1);
+			++Success_;
+			return;
 		}
 
 		if (actualLine.contains ('$'))
@@ -33,6 +33,7 @@
 #include <QDir>
 #include <QtDebug>
 #include <util/sys/paths.h>
+#include "filtercache.h"
 
 namespace LeechCraft
 {
@@ -198,6 +199,8 @@ namespace CleanWeb
 					<< "in"
 					<< path.path ();
 
+		FilterCache::Remove (filename);
+
 		beginRemoveRows ({}, pos, pos);
 		Filters_.removeAt (pos);
 		endRemoveRows ();
@@ -227,12 +230,13 @@ namespace CleanWeb
 		settings.endArray ();
 	}
 
-	void SubscriptionsModel::LoadSettings ()
+	QList<SubscriptionData> SubscriptionsModel::LoadSavedSubData ()
 	{
 		QSettings settings (QCoreApplication::organizationName (),
 				QCoreApplication::applicationName () + "_CleanWeb");
 		int size = settings.beginReadArray ("Subscriptions");
 
+		QList<SubscriptionData> result;
 		for (int i = 0; i < size; ++i)
 		{
 			settings.setArrayIndex (i);
@@ -243,13 +247,21 @@ namespace CleanWeb
 				settings.value ("fileName").toString (),
 				settings.value ("lastDateTime").toDateTime ()
 			};
+			result << sd;
+		}
+
+		settings.endArray ();
+
+		return result;
+	}
+
+	void SubscriptionsModel::LoadSettings ()
+	{
+		for (const auto& sd : LoadSavedSubData ())
 			if (!AssignSD (sd))
 				qWarning () << Q_FUNC_INFO
 					<< "could not find filter for name"
 					<< sd.Filename_;
-		}
-
-		settings.endArray ();
 	}
 
 	bool SubscriptionsModel::AssignSD (const SubscriptionData& sd)
@@ -72,6 +72,8 @@ namespace CleanWeb
 		}
 
 		const QList<Filter>& GetAllFilters () const;
+
+		static QList<SubscriptionData> LoadSavedSubData ();
 	private:
 		void AddImpl (const Filter&);
 		void RemoveFilter (int);
@@ -0,0 +1,167 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "filtermatchertest.h"
+#include <QtTest>
+#include "ahocorasick.cpp"
+#include "filter.cpp"
+#include "filtermatcher.cpp"
+#include "lineparser.cpp"
+
+QTEST_APPLESS_MAIN (LeechCraft::Poshuku::CleanWeb::FilterMatcherTest)
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	namespace
+	{
+		FilterMatcher MakeMatcher (const QStringList& rules)
+		{
+			Filter f;
+			std::for_each (rules.begin (), rules.end (), LineParser (&f));
+			return FilterMatcher { f.Filters_ };
+		}
+
+		RequestContext MakeContext (const QString& urlStr, const QString& pageStr = "http://example.org/")
+		{
+			const QUrl url { urlStr };
+			const auto& domain = QUrl { pageStr }.host ();
+			return
+			{
+				urlStr.toUtf8 (),
+				urlStr.toLower ().toUtf8 (),
+				url.host ().toLower (),
+				domain,
+				FilterOption::MatchObject::All,
+				!url.host ().endsWith (domain)
+			};
+		}
+	}
+
+	void FilterMatcherTest::testAhoCorasick ()
+	{
+		const QList<QByteArray> patterns { "he", "she", "his", "hers", "s" };
+
+		AhoCorasick ac;
+		for (const auto& pattern : patterns)
+			ac.AddPattern (pattern);
+		ac.Build ();
+
+		QList<QByteArray> found;
+		ac.ForEachMatch ("ushers",
+				[&] (int id)
+				{
+					found << patterns.at (id);
+					return false;
+				});
+		std::sort (found.begin (), found.end ());
+
+		QCOMPARE (found, (QList<QByteArray> { "he", "hers", "s", "she" }));
+	}
+
+	void FilterMatcherTest::testHostAnchored ()
+	{
+		const auto& matcher = MakeMatcher ({ "||ads.example.com/" });
+
+		QVERIFY (matcher.Matches (MakeContext ("http://ads.example.com/banner.png")));
+		QVERIFY (matcher.Matches (MakeContext ("https://cdn.ads.example.com/banner.png")));
+		QVERIFY (!matcher.Matches (MakeContext ("http://notads.example.com/banner.png")));
+		QVERIFY (!matcher.Matches (MakeContext ("http://example.com/banner.png")));
+	}
+
+	void FilterMatcherTest::testTokenized ()
+	{
+		const auto& matcher = MakeMatcher ({ "/banner/*/img" });
+
+		QVERIFY (matcher.Matches (MakeContext ("http://example.com/banner/123/img.png")));
+		QVERIFY (!matcher.Matches (MakeContext ("http://example.com/banners/123/img.png")));
+		QVERIFY (!matcher.Matches (MakeContext ("http://example.com/banner/123/pic.png")));
+	}
+
+	void FilterMatcherTest::testLiteral ()
+	{
+		const auto& matcher = MakeMatcher ({ "adframe", "-ad-" });
+
+		QVERIFY (matcher.Matches (MakeContext ("http://example.com/someadframe.js")));
+		QVERIFY (matcher.Matches (MakeContext ("http://example.com/ADFRAMES/")));
+		QVERIFY (matcher.Matches (MakeContext ("http://example.com/top-ad-728.gif")));
+		QVERIFY (!matcher.Matches (MakeContext ("http://example.com/frame.js")));
+	}
+
+	void FilterMatcherTest::testAnchoredEnds ()
+	{
+		const auto& matcher = MakeMatcher ({ "|http://evil.com", "/tracker.js|" });
+
+		QVERIFY (matcher.Matches (MakeContext ("http://evil.com/index.html")));
+		QVERIFY (!matcher.Matches (MakeContext ("http://example.com/?r=http://evil.com")));
+		QVERIFY (matcher.Matches (MakeContext ("http://example.com/js/tracker.js")));
+		QVERIFY (!matcher.Matches (MakeContext ("http://example.com/js/tracker.js?v=2")));
+	}
+
+	void FilterMatcherTest::testSeparators ()
+	{
+		const auto& matcher = MakeMatcher ({ "||tracker.net^", "/pixel^", "|http://cdn.*/ad^" });
+
+		QVERIFY (matcher.Matches (MakeContext ("http://tracker.net/hit?id=1")));
+		QVERIFY (matcher.Matches (MakeContext ("http://www.tracker.net:8080/")));
+		QVERIFY (!matcher.Matches (MakeContext ("http://tracker.network/hit")));
+
+		QVERIFY (matcher.Matches (MakeContext ("http://example.com/pixel?uid=42")));
+		QVERIFY (matcher.Matches (MakeContext ("http://example.com/img/pixel")));
+		QVERIFY (!matcher.Matches (MakeContext ("http://example.com/pixels.png")));
+
+		QVERIFY (matcher.Matches (MakeContext ("http://cdn.example.com/ad/1.png")));
+		QVERIFY (!matcher.Matches (MakeContext ("http://cdn.example.com/add.png")));
+		QVERIFY (!matcher.Matches (MakeContext ("http://example.com/?u=http://cdn.x/ad/")));
+	}
+
+	void FilterMatcherTest::testRegexp ()
+	{
+		const auto& matcher = MakeMatcher ({ "/.*\\/ad[0-9]+\\.js/" });
+
+		QVERIFY (matcher.Matches (MakeContext ("http://example.com/ad123.js")));
+		QVERIFY (!matcher.Matches (MakeContext ("http://example.com/add.js")));
+	}
+
+	void FilterMatcherTest::testOptions ()
+	{
+		const auto& matcher = MakeMatcher ({ "-ads-$third-party", "/promo.png$domain=example.net" });
+
+		QVERIFY (matcher.Matches (MakeContext ("http://ads.net/top-ads-1.png", "http://example.org/")));
+		QVERIFY (!matcher.Matches (MakeContext ("http://example.org/top-ads-1.png", "http://example.org/")));
+
+		QVERIFY (matcher.Matches (MakeContext ("http://cdn.com/promo.png", "http://www.example.net/")));
+		QVERIFY (!matcher.Matches (MakeContext ("http://cdn.com/promo.png", "http://example.org/")));
+	}
+}
+}
+}
@@ -0,0 +1,113 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "hidingtabletest.h"
+#include <QtTest>
+#include "filter.cpp"
+#include "hidingtable.cpp"
+#include "lineparser.cpp"
+
+QTEST_APPLESS_MAIN (LeechCraft::Poshuku::CleanWeb::HidingTableTest)
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	namespace
+	{
+		HidingTable MakeTable (const QStringList& rules)
+		{
+			Filter f;
+			std::for_each (rules.begin (), rules.end (), LineParser (&f));
+			return HidingTable { QList<Filter> { f } };
+		}
+	}
+
+	void HidingTableTest::testGeneric ()
+	{
+		const auto& table = MakeTable ({ "##.banner", "##.ad-box" });
+
+		QVERIFY (table.GetGenericCSS ().contains (".banner"));
+		QVERIFY (table.GetGenericCSS ().contains (".ad-box"));
+
+		const auto& page = table.GetPageCSS ("example.com");
+		QVERIFY (page.UseGeneric_);
+		QVERIFY (page.Specific_.isEmpty ());
+	}
+
+	void HidingTableTest::testDomainSpecific ()
+	{
+		const auto& table = MakeTable ({ "example.com,~www.example.com##.promo", "~example.org##.sidebar-ad" });
+
+		QVERIFY (table.GetGenericCSS ().isEmpty ());
+
+		QVERIFY (table.GetPageCSS ("example.com").Specific_.contains (".promo"));
+		QVERIFY (table.GetPageCSS ("news.example.com").Specific_.contains (".promo"));
+		QVERIFY (!table.GetPageCSS ("www.example.com").Specific_.contains (".promo"));
+		QVERIFY (!table.GetPageCSS ("notexample.com").Specific_.contains (".promo"));
+
+		QVERIFY (table.GetPageCSS ("example.net").Specific_.contains (".sidebar-ad"));
+		QVERIFY (!table.GetPageCSS ("www.example.org").Specific_.contains (".sidebar-ad"));
+	}
+
+	void HidingTableTest::testExceptions ()
+	{
+		const auto& table = MakeTable ({ "##.banner", "##.ad-box", "example.com#@#.banner", "#@#.ad-box" });
+
+		QVERIFY (table.GetGenericCSS ().contains (".banner"));
+		QVERIFY (!table.GetGenericCSS ().contains (".ad-box"));
+
+		QVERIFY (table.GetPageCSS ("example.org").UseGeneric_);
+
+		const auto& page = table.GetPageCSS ("www.example.com");
+		QVERIFY (!page.UseGeneric_);
+		QVERIFY (!page.Specific_.contains (".banner"));
+	}
+
+	void HidingTableTest::testNegatedExceptions ()
+	{
+		const auto& table = MakeTable ({
+				"##.teaser",
+				"~example.com#@#.teaser",
+				"##.banner",
+				"example.com,~shop.example.com#@#.banner"
+			});
+
+		QVERIFY (!table.GetGenericCSS ().contains (".teaser"));
+		QVERIFY (!table.GetPageCSS ("example.org").Specific_.contains (".teaser"));
+		QVERIFY (table.GetPageCSS ("www.example.com").Specific_.contains (".teaser"));
+
+		QVERIFY (table.GetPageCSS ("shop.example.com").UseGeneric_);
+		QVERIFY (!table.GetPageCSS ("www.example.com").UseGeneric_);
+	}
+}
+}
+}
@@ -192,8 +192,8 @@ namespace CleanWeb
 	bool UserFiltersModel::Add (const RuleOptionDialog& dia)
 	{
 		const auto& itemRx = dia.GetType () == FilterOption::MTRegexp ?
-				Util::RegExp (dia.GetString (), dia.GetCase ()) :
-				Util::RegExp ();
+				LazyRegExp (dia.GetString (), dia.GetCase ()) :
+				LazyRegExp ();
 		FilterOption fo;
 		fo.Case_ = dia.GetCase ();
 		fo.MatchType_ = dia.GetType ();